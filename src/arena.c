@@ -0,0 +1,85 @@
+/**
+ * @file arena.c
+ * @brief Arena de quadro com contadores de pico (veja arena.h).
+ */
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Arredonda @p n para cima até múltiplo de FRAME_ARENA_ALIGNMENT. */
+static size_t AlignUp(size_t n)
+{
+    return (n + FRAME_ARENA_ALIGNMENT - 1) & ~(size_t)(FRAME_ARENA_ALIGNMENT - 1);
+}
+
+bool FrameArenaInit(FrameArena *a, size_t capacity)
+{
+    memset(a, 0, sizeof(*a));
+    capacity = AlignUp(capacity > 0 ? capacity : 1);
+    a->mem = malloc(capacity + FRAME_ARENA_ALIGNMENT);
+    if (!a->mem) return false;
+    a->base = (unsigned char *)(((uintptr_t)a->mem + FRAME_ARENA_ALIGNMENT - 1) &
+                                ~(uintptr_t)(FRAME_ARENA_ALIGNMENT - 1));
+    a->capacity = capacity;
+    return true;
+}
+
+void FrameArenaFree(FrameArena *a)
+{
+    free(a->mem);
+    memset(a, 0, sizeof(*a));
+}
+
+void FrameArenaReset(FrameArena *a)
+{
+    a->last = a->used;
+    a->used = 0;
+    a->wanted = 0;
+}
+
+void *FrameArenaAlloc(FrameArena *a, size_t bytes)
+{
+    size_t size = AlignUp(bytes > 0 ? bytes : 1);
+    a->wanted += size;
+    if (a->wanted > a->peakWanted) a->peakWanted = a->wanted;
+    if (size > a->capacity - a->used)
+    {
+        a->failures++;
+        return NULL;
+    }
+    void *p = a->base + a->used;
+    a->used += size;
+    if (a->used > a->peak) a->peak = a->used;
+    return p;
+}
+
+void *FrameArenaAllocUpTo(FrameArena *a, size_t bytes, size_t unit, size_t *got)
+{
+    size_t size = AlignUp(bytes > 0 ? bytes : 1), left = a->capacity - a->used;
+    a->wanted += size;
+    if (a->wanted > a->peakWanted) a->peakWanted = a->wanted;
+    if (size <= left)
+    {
+        bytes = bytes > 0 ? bytes : 1;
+    }
+    else
+    {
+        // whole units of what is left; capacity and cursor are aligned, so is the rest
+        a->failures++;
+        if (unit < 1) unit = 1;
+        bytes = left/unit*unit;
+        size = AlignUp(bytes);
+        if (bytes == 0)
+        {
+            *got = 0;
+            return NULL;
+        }
+    }
+    void *p = a->base + a->used;
+    a->used += size;
+    if (a->used > a->peak) a->peak = a->used;
+    *got = bytes;
+    return p;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file arena.h
+ * @brief Arena de quadro: alocação por incremento de ponteiro, devolvida inteira a cada quadro.
+ *
+ * Os dados transitórios de um quadro (visibilidade por entidade, linhas de
+ * anotação, quads de texto) saem de um único bloco reservado no início do
+ * programa. FrameArenaAlloc só avança um deslocamento e FrameArenaReset o
+ * zera, então o laço de render não chama malloc/free. A capacidade é fixa:
+ * um pedido que não cabe devolve NULL, e quem pede decide como degradar.
+ *
+ * Os contadores de pico dizem quanto um cenário usou de fato (@c peak) e
+ * quanto teria pedido sem limite (@c peakWanted), para dimensionar a arena de
+ * implantações com memória fixa. Entidades de vida longa ficam no
+ * EntityPool (entities.h), não aqui.
+ */
+#ifndef WOE_ARENA_H
+#define WOE_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Alinhamento (bytes) de cada alocação; o mesmo dos arrays SoA. */
+#define FRAME_ARENA_ALIGNMENT 64
+
+/** Bloco de um quadro; escrito apenas pela thread dona. */
+typedef struct FrameArena {
+    unsigned char *base;    /**< Início alinhado do bloco. */
+    size_t capacity;        /**< Bytes utilizáveis. */
+    size_t used;            /**< Bytes entregues no quadro atual. */
+    size_t wanted;          /**< Bytes pedidos no quadro atual, inclusive os recusados. */
+    size_t last;            /**< @c used do quadro anterior. */
+    size_t peak;            /**< Maior @c used de um quadro desde FrameArenaInit. */
+    size_t peakWanted;      /**< Maior @c wanted de um quadro: a capacidade que teria bastado. */
+    long long failures;     /**< Pedidos recusados desde FrameArenaInit. */
+    void *mem;              /**< Bloco alocado (para free). */
+} FrameArena;
+
+/** @brief Reserva @p capacity bytes (arredondados para FRAME_ARENA_ALIGNMENT). */
+bool FrameArenaInit(FrameArena *a, size_t capacity);
+
+/** @brief Libera o bloco e deixa a arena zerada. */
+void FrameArenaFree(FrameArena *a);
+
+/**
+ * @brief Encerra o quadro: guarda o uso em @c last e devolve todo o bloco.
+ *
+ * Tudo o que foi alocado desde o último reset fica inválido.
+ */
+void FrameArenaReset(FrameArena *a);
+
+/**
+ * @brief @p bytes alinhados a FRAME_ARENA_ALIGNMENT, válidos até o próximo FrameArenaReset.
+ *
+ * A memória não é zerada.
+ * @return NULL se não couber no que resta do quadro (contado em @c failures).
+ */
+void *FrameArenaAlloc(FrameArena *a, size_t bytes);
+
+/**
+ * @brief Até @p bytes, em múltiplos de @p unit: o pedido inteiro se couber, senão o que resta do quadro.
+ *
+ * Para buffers que funcionam com menos espaço (lotes que enviam antes de
+ * encher). O pedido conta inteiro em @c wanted e, se não couber, uma vez em
+ * @c failures.
+ * @param got [out] Bytes entregues (0 com retorno NULL).
+ */
+void *FrameArenaAllocUpTo(FrameArena *a, size_t bytes, size_t unit, size_t *got);
+
+/** @brief Array de @p n elementos de @p type na arena @p a (NULL se não couber). */
+#define FRAME_ARENA_ARRAY(a, type, n) ((type *)FrameArenaAlloc((a), sizeof(type)*(size_t)(n)))
+
+#endif /* WOE_ARENA_H */
@@ -0,0 +1,1231 @@
+/**
+ * @file woe_bench.c
+ * @brief Microbenchmarks dos solvers de ângulos e dos helpers de desenho.
+ *
+ * Mede ns por item (par, orientação ou entidade) de ForwardFromYPR, BasisFromYPR, ComputeAzEl,
+ * ComputeSphericalAngles, do solver vetorial e de SolveEngagements, nas versões
+ * escalares (por nível de trigonometria) e em lote (por ISA SIMD suportada),
+ * sobre distribuições de entrada que incluem elevações quase singulares.
+ * A curva de escalonamento mede SolveEngagementsParallel com 1, 2, 4, ... threads
+ * e o caso "culling" compara o solver completo com o descarte por grade espacial.
+ * Em seguida, se houver contexto OpenGL, mede DrawAircraft (imediato e
+ * instanciado) e DrawArc3D (imediato e em LineBatch) com N entidades por quadro.
+ *
+ * Os resultados saem em JSON (um registro por caso) para acompanhar regressões
+ * entre versões; um resumo legível vai para stderr.
+ *
+ * Com --regress mede, no lugar disso, o erro de j e G de cada variante do
+ * solver (cadeia por nível de trigonometria, lotes por ISA, forma vetorial)
+ * contra uma só referência em double, calculada de yaw/pitch numa grade densa
+ * de alvos e orientações, com o ns/par de cada uma, e sai com 1 se alguma
+ * passar dos limites gravados ou ficar mais lenta que a linha de base
+ * (RunRegress).
+ *
+ * @code
+ * woe_bench [--n N] [--json ARQUIVO] [--entities N] [--threads N] [--no-render]
+ * woe_bench --regress [--baseline ARQUIVO] [--save-baseline ARQUIVO] [--json ARQUIVO]
+ * @endcode
+ */
+#include "raylib.h"
+#include "woe_core.h"
+#include "render.h"
+#include "text.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Número padrão de itens por chamada dos casos de geometria. */
+static const int BENCH_DEFAULT_ITEMS = 4096;
+/** Aeronaves usadas no caso SolveEngagements (pares = aeronaves x itens). */
+static const int BENCH_SOLVE_AIRCRAFT = 4;
+/** Aeronaves da curva de escalonamento por threads (algumas dezenas de observadores). */
+static const int BENCH_SCALING_AIRCRAFT = 32;
+/** Alcance (unid) e meio-ângulo do cone (rad) do caso com descarte pela grade espacial. */
+static const float BENCH_CULL_RANGE = 60.0f;
+static const float BENCH_CULL_JMAX = 0.5235988f;
+/** Aresta da célula da grade do caso com descarte (unid), ~1/4 do alcance. */
+static const float BENCH_CULL_CELL = 16.0f;
+/** Tempo mínimo (s) de cada amostra; as repetições são calibradas para atingi-lo. */
+static const double BENCH_MIN_SECONDS = 0.02;
+/** Amostras por caso; o relatório usa o mínimo e a mediana. */
+#define BENCH_SAMPLES 7
+/** Quadros de aquecimento do benchmark de renderização. */
+static const int RENDER_WARMUP_FRAMES = 5;
+/** Quadros medidos por caso do benchmark de renderização. */
+static const int RENDER_FRAMES = 30;
+/** Número máximo padrão de entidades do benchmark de renderização. */
+static const int RENDER_DEFAULT_MAX_ENTITIES = 1024;
+
+/** Distribuições de entrada. */
+typedef enum BenchDist {
+    DIST_UNIFORM = 0,   /**< Direções uniformes na esfera, orientação qualquer. */
+    DIST_NEAR_POLE,     /**< ElT e pitch a menos de 1e-3 rad de ±90°. */
+    DIST_HORIZON,       /**< ElT e pitch a menos de 1e-3 rad do horizonte. */
+    DIST_BORESIGHT,     /**< Alvo a menos de 1e-3 rad do vetor frente (j -> 0). */
+    DIST_COUNT
+} BenchDist;
+
+static const char *DIST_NAMES[DIST_COUNT] = { "uniform", "near_pole", "horizon", "boresight" };
+
+/** Entradas e saídas de um conjunto de casos. */
+typedef struct BenchData {
+    int n;              /**< Itens por chamada. */
+    int aircraft;       /**< Aeronaves geradas por BenchFill. */
+    EntityStore air;    /**< @c aircraft aeronaves; a 0 fica na origem. */
+    EntityStore tgt;    /**< n alvos; yaw/pitch/roll são orientações de teste. */
+    PairResults in;     /**< Entradas AzT/ElT/AzR/ElR por item (libm). */
+    PairResults out;    /**< Saídas (capacidade para SolveEngagements). */
+    float *fx, *fy, *fz;/**< Vetores frente por item (aliases de in.j/G/E). */
+    BasisStore basis;   /**< Saída dos casos de base (n orientações). */
+    JobPool *pool;      /**< Pool do caso paralelo (NULL nos demais). */
+    SpatialGrid *grid;  /**< Grade do caso com descarte (NULL nos demais). */
+    CandidatePairs *cand; /**< Saída do caso com descarte. */
+} BenchData;
+
+/** Caso de benchmark: uma função e sua variante. */
+typedef struct BenchCase {
+    const char *name;       /**< Função medida. */
+    const char *variant;    /**< "scalar", "batch", "batch-jg", "batch-j" ou modo do solver. */
+    bool tiered;            /**< Repetido para cada TrigTier. */
+    bool perIsa;            /**< Repetido para cada ISA SIMD suportada. */
+    int arg;                /**< Argumento do caso (modo do solver). */
+    int (*run)(BenchData *d, int arg);  /**< Executa uma vez; devolve itens processados. */
+} BenchCase;
+
+static float Rand01(unsigned int *seed)
+{
+    *seed = *seed*1664525u + 1013904223u;
+    return (float)(*seed >> 8)/16777216.0f;
+}
+
+static float RandRange(unsigned int *seed, float lo, float hi) { return lo + (hi - lo)*Rand01(seed); }
+
+/** Ângulo a até @p eps de ±a0 (sinal aleatório). */
+static float RandNear(unsigned int *seed, float a0, float eps)
+{
+    float s = Rand01(seed) < 0.5f ? -1.0f : 1.0f;
+    return s*(a0 - eps*Rand01(seed));
+}
+
+/**
+ * @brief Preenche alvos e orientações conforme a distribuição.
+ *
+ * Az segue a convenção de ComputeAzEl (a partir de +Y, positivo para +X) e o
+ * vetor frente de ForwardFromYPR é (-sin(yaw)cos(pitch), cos(yaw)cos(pitch), sin(pitch)).
+ */
+static void BenchFill(BenchData *d, BenchDist dist)
+{
+    unsigned int seed = 777u + (unsigned int)dist;
+    d->air.count = 0;
+    for (int a = 0; a < d->aircraft; ++a)
+    {
+        float p = a == 0 ? 0.0f : RandRange(&seed, -5.0f, 5.0f);
+        EntityStoreAdd(&d->air, p, -p, 0.5f*p, RandRange(&seed, -3.14f, 3.14f),
+                       dist == DIST_NEAR_POLE ? RandNear(&seed, 1.5707963f, 1e-3f) : RandRange(&seed, -0.5f, 0.5f), 0.0f);
+    }
+
+    d->tgt.count = 0;
+    for (int i = 0; i < d->n; ++i)
+    {
+        float yaw = RandRange(&seed, -3.14159f, 3.14159f);
+        float roll = RandRange(&seed, -3.14159f, 3.14159f);
+        float pitch, az, el;
+        switch (dist)
+        {
+            case DIST_NEAR_POLE:
+                pitch = RandNear(&seed, 1.5707963f, 1e-3f);
+                az = RandRange(&seed, -3.14159f, 3.14159f);
+                el = RandNear(&seed, 1.5707963f, 1e-3f);
+                break;
+            case DIST_HORIZON:
+                pitch = RandRange(&seed, -1e-3f, 1e-3f);
+                az = RandRange(&seed, -3.14159f, 3.14159f);
+                el = RandRange(&seed, -1e-3f, 1e-3f);
+                break;
+            case DIST_BORESIGHT:
+                pitch = RandRange(&seed, -1.4f, 1.4f);
+                az = -yaw + RandRange(&seed, -1e-3f, 1e-3f);
+                el = pitch + RandRange(&seed, -1e-3f, 1e-3f);
+                break;
+            default:
+                pitch = RandRange(&seed, -1.4f, 1.4f);
+                az = RandRange(&seed, -3.14159f, 3.14159f);
+                el = asinf(RandRange(&seed, -1.0f, 1.0f));
+                break;
+        }
+        float range = RandRange(&seed, 1.0f, 100.0f);
+        EntityStoreAdd(&d->tgt, range*sinf(az)*cosf(el), range*cosf(az)*cosf(el), range*sinf(el), yaw, pitch, roll);
+    }
+
+    TrigTier prev = GetSolverTrigTier();
+    SetSolverTrigTier(TRIG_TIER_LIBM);
+    WoeVec3 A = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeVec3 T = { d->tgt.x[i], d->tgt.y[i], d->tgt.z[i] };
+        ComputeAzEl(A, T, &d->in.AzT[i], &d->in.ElT[i]);
+        WoeVec3 f = ForwardFromYPR(d->tgt.yaw[i], d->tgt.pitch[i], d->tgt.roll[i]);
+        d->fx[i] = f.x; d->fy[i] = f.y; d->fz[i] = f.z;
+        ComputeAzElFromVector(f, &d->in.AzR[i], &d->in.ElR[i]);
+    }
+    SetSolverTrigTier(prev);
+}
+
+static int RunForward(BenchData *d, int arg)
+{
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeVec3 f = ForwardFromYPR(d->tgt.yaw[i], d->tgt.pitch[i], d->tgt.roll[i]);
+        d->out.j[i] = f.x; d->out.G[i] = f.y; d->out.E[i] = f.z;
+    }
+    return d->n;
+}
+
+static int RunForwardBatch(BenchData *d, int arg)
+{
+    ForwardFromYPRBatch(d->n, d->tgt.yaw, d->tgt.pitch, d->tgt.roll, d->out.j, d->out.G, d->out.E);
+    return d->n;
+}
+
+static int RunBasis(BenchData *d, int arg)
+{
+    BasisStore *b = &d->basis;
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeBasis e = BasisFromYPR(d->tgt.yaw[i], d->tgt.pitch[i], d->tgt.roll[i]);
+        b->rx[i] = e.right.x; b->ry[i] = e.right.y; b->rz[i] = e.right.z;
+        b->fx[i] = e.fwd.x;   b->fy[i] = e.fwd.y;   b->fz[i] = e.fwd.z;
+        b->ux[i] = e.up.x;    b->uy[i] = e.up.y;    b->uz[i] = e.up.z;
+        ComputeAzElFromVector(e.fwd, &b->AzR[i], &b->ElR[i]);
+    }
+    return d->n;
+}
+
+static int RunBasisBatch(BenchData *d, int arg)
+{
+    BasisStore *b = &d->basis;
+    ComputeBasisBatch(d->n, d->tgt.yaw, d->tgt.pitch, d->tgt.roll, b->rx, b->ry, b->rz, b->fx, b->fy, b->fz,
+                      b->ux, b->uy, b->uz, b->AzR, b->ElR);
+    return d->n;
+}
+
+static int RunAzEl(BenchData *d, int arg)
+{
+    WoeVec3 A = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeVec3 T = { d->tgt.x[i], d->tgt.y[i], d->tgt.z[i] };
+        ComputeAzEl(A, T, &d->out.AzT[i], &d->out.ElT[i]);
+    }
+    return d->n;
+}
+
+static int RunAzElBatch(BenchData *d, int arg)
+{
+    ComputeAzElBatch(d->n, 0.0f, 0.0f, 0.0f, d->tgt.x, d->tgt.y, d->tgt.z, d->out.AzT, d->out.ElT);
+    return d->n;
+}
+
+static int RunSpherical(BenchData *d, int arg)
+{
+    for (int i = 0; i < d->n; ++i)
+    {
+        ComputeSphericalAngles(d->in.AzT[i], d->in.ElT[i], d->in.AzR[i], d->in.ElR[i],
+                               &d->out.j[i], &d->out.G[i], &d->out.E[i], &d->out.F[i], &d->out.J[i]);
+    }
+    return d->n;
+}
+
+static int RunSphericalBatch(BenchData *d, int arg)
+{
+    ComputeSphericalAnglesBatch(d->n, d->in.AzT, d->in.ElT, d->in.AzR, d->in.ElR,
+                                d->out.j, d->out.G, d->out.E, d->out.F, d->out.J);
+    return d->n;
+}
+
+static int RunSphericalBatchJG(BenchData *d, int arg)
+{
+    ComputeSphericalAnglesJGBatch(d->n, d->in.AzT, d->in.ElT, d->in.AzR, d->in.ElR, d->out.j, d->out.G);
+    return d->n;
+}
+
+static int RunSphericalBatchJ(BenchData *d, int arg)
+{
+    ComputeSphericalAnglesJBatch(d->n, d->in.AzT, d->in.ElT, d->in.AzR, d->in.ElR, d->out.j);
+    return d->n;
+}
+
+static int RunVector(BenchData *d, int arg)
+{
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeVec3 f = { d->fx[i], d->fy[i], d->fz[i] };
+        WoeVec3 los = { d->tgt.x[i], d->tgt.y[i], d->tgt.z[i] };
+        ComputeSphericalAnglesVector(f, los, &d->out.j[i], &d->out.G[i]);
+    }
+    return d->n;
+}
+
+static int RunVectorBatch(BenchData *d, int arg)
+{
+    // one aircraft against every target, as SolveEngagements does
+    WoeVec3 f = { d->fx[0], d->fy[0], d->fz[0] };
+    ComputeSphericalAnglesVectorBatch(d->n, f, 0.0f, 0.0f, 0.0f, d->tgt.x, d->tgt.y, d->tgt.z,
+                                      d->out.j, d->out.G);
+    return d->n;
+}
+
+static int RunSolve(BenchData *d, int arg)
+{
+    SolveEngagements(&d->air, &d->tgt, &d->out, (SolverMode)arg);
+    return d->air.count*d->tgt.count;
+}
+
+static int RunSolveParallel(BenchData *d, int arg)
+{
+    SolveEngagementsParallel(d->pool, &d->air, &d->tgt, &d->out, (SolverMode)arg);
+    return d->air.count*d->tgt.count;
+}
+
+/** Atualização da grade + SolveEngagementsCulled; conta todos os pares, descartados ou não. */
+static int RunSolveCulled(BenchData *d, int arg)
+{
+    SpatialGridUpdate(d->grid, &d->tgt);
+    SolveEngagementsCulled(NULL, &d->air, &d->tgt, d->grid, BENCH_CULL_RANGE, BENCH_CULL_JMAX, d->cand, (SolverMode)arg);
+    return d->air.count*d->tgt.count;
+}
+
+static const BenchCase CASES[] = {
+    { "ForwardFromYPR",               "scalar", true,  false, 0, RunForward },
+    { "ForwardFromYPR",               "batch",  true,  false, 0, RunForwardBatch },
+    { "BasisFromYPR",                 "scalar", true,  false, 0, RunBasis },
+    { "BasisFromYPR",                 "batch",  false, true,  0, RunBasisBatch },
+    { "ComputeAzEl",                  "scalar", true,  false, 0, RunAzEl },
+    { "ComputeAzEl",                  "batch",  false, true,  0, RunAzElBatch },
+    { "ComputeSphericalAngles",       "scalar", true,  false, 0, RunSpherical },
+    { "ComputeSphericalAngles",       "batch",  false, true,  0, RunSphericalBatch },
+    { "ComputeSphericalAngles",       "batch-jg", false, true,  0, RunSphericalBatchJG },
+    { "ComputeSphericalAngles",       "batch-j",  false, true,  0, RunSphericalBatchJ },
+    { "ComputeSphericalAnglesVector", "scalar", true,  false, 0, RunVector },
+    { "ComputeSphericalAnglesVector", "batch",  true,  false, 0, RunVectorBatch },
+    { "SolveEngagements",             "lote",     false, false, SOLVER_BATCH,  RunSolve },
+    { "SolveEngagements",             "escalar",  false, false, SOLVER_SCALAR, RunSolve },
+    { "SolveEngagements",             "vetorial", false, false, SOLVER_VECTOR, RunSolve },
+};
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Mede um caso: calibra as repetições e devolve ns/item mínimo e mediano.
+ */
+static int TimeCase(const BenchCase *c, BenchData *d, double *nsMin, double *nsMedian)
+{
+    int items = c->run(d, c->arg); // warm-up
+    long reps = 1;
+    for (;;)
+    {
+        double t0 = WoeNow();
+        for (long r = 0; r < reps; ++r) c->run(d, c->arg);
+        if (WoeNow() - t0 >= BENCH_MIN_SECONDS || reps >= (1L << 24)) break;
+        reps *= 2;
+    }
+
+    double ns[BENCH_SAMPLES];
+    for (int s = 0; s < BENCH_SAMPLES; ++s)
+    {
+        double t0 = WoeNow();
+        for (long r = 0; r < reps; ++r) c->run(d, c->arg);
+        ns[s] = (WoeNow() - t0)*1e9/((double)reps*items);
+    }
+    qsort(ns, BENCH_SAMPLES, sizeof(double), CompareDouble);
+    *nsMin = ns[0];
+    *nsMedian = ns[BENCH_SAMPLES/2];
+    return items;
+}
+
+static bool BenchDataInit(BenchData *d, int aircraft, int n)
+{
+    memset(d, 0, sizeof(*d));
+    d->n = n;
+    d->aircraft = aircraft;
+    bool ok = EntityStoreInit(&d->air, aircraft) && EntityStoreInit(&d->tgt, n) &&
+              PairResultsInit(&d->in, n) && PairResultsInit(&d->out, aircraft*n) && BasisStoreInit(&d->basis, n);
+    d->fx = d->in.j; d->fy = d->in.G; d->fz = d->in.E;
+    return ok;
+}
+
+static void BenchDataFree(BenchData *d)
+{
+    EntityStoreFree(&d->air);
+    EntityStoreFree(&d->tgt);
+    PairResultsFree(&d->in);
+    PairResultsFree(&d->out);
+    BasisStoreFree(&d->basis);
+}
+
+/** Escreve um registro JSON; @p trig e @p isa podem ser NULL. */
+static void EmitRecord(FILE *json, bool *first, const char *group, const char *name, const char *variant,
+                       const char *trig, const char *isa, const char *dist, int items, int threads,
+                       double nsMin, double nsMedian)
+{
+    fprintf(json, "%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"variant\": \"%s\", ",
+            *first ? "" : ",", group, name, variant);
+    if (trig) fprintf(json, "\"trig\": \"%s\", ", trig); else fprintf(json, "\"trig\": null, ");
+    if (isa) fprintf(json, "\"isa\": \"%s\", ", isa); else fprintf(json, "\"isa\": null, ");
+    fprintf(json, "\"dist\": \"%s\", \"items\": %d, \"threads\": %d, \"ns_per_item\": %.3f, \"ns_median\": %.3f}",
+            dist, items, threads, nsMin, nsMedian);
+    *first = false;
+}
+
+static void RunGeometry(FILE *json, bool *first, int n)
+{
+    BenchData d;
+    if (!BenchDataInit(&d, BENCH_SOLVE_AIRCRAFT, n))
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para %d itens\n", n);
+        BenchDataFree(&d);
+        return;
+    }
+    SimdIsa isa0 = SimdGetIsa();
+    TrigTier tier0 = GetSolverTrigTier();
+
+    fprintf(stderr, "%-30s %-9s %-7s %-7s %-10s %10s\n", "funcao", "variante", "trig", "isa", "dist", "ns/item");
+    for (int dist = 0; dist < DIST_COUNT; ++dist)
+    {
+        BenchFill(&d, (BenchDist)dist);
+        for (size_t c = 0; c < sizeof(CASES)/sizeof(CASES[0]); ++c)
+        {
+            const BenchCase *bc = &CASES[c];
+            int tiers = bc->tiered ? TRIG_TIER_COUNT : 1;
+            int isas = bc->perIsa ? SIMD_ISA_COUNT : 1;
+            for (int t = 0; t < tiers; ++t)
+            {
+                for (int i = 0; i < isas; ++i)
+                {
+                    if (bc->perIsa && !SimdIsaSupported((SimdIsa)i)) continue;
+                    SetSolverTrigTier(bc->tiered ? (TrigTier)t : tier0);
+                    SimdSetIsa(bc->perIsa ? (SimdIsa)i : isa0);
+                    const char *trigName = bc->tiered ? TrigTierName((TrigTier)t) : NULL;
+                    const char *isaName = bc->perIsa || strcmp(bc->name, "SolveEngagements") == 0
+                                          ? SimdIsaName(SimdGetIsa()) : NULL;
+
+                    double nsMin, nsMedian;
+                    int items = TimeCase(bc, &d, &nsMin, &nsMedian);
+                    EmitRecord(json, first, "geometry", bc->name, bc->variant, trigName, isaName,
+                               DIST_NAMES[dist], items, 1, nsMin, nsMedian);
+                    fprintf(stderr, "%-30s %-9s %-7s %-7s %-10s %10.2f\n", bc->name, bc->variant,
+                            trigName ? trigName : "-", isaName ? isaName : "-", DIST_NAMES[dist], nsMin);
+                }
+            }
+        }
+    }
+    SetSolverTrigTier(tier0);
+    SimdSetIsa(isa0);
+    BenchDataFree(&d);
+}
+
+/**
+ * @brief Curva de escalonamento: SolveEngagementsParallel com 1, 2, 4, ... e @p maxThreads threads.
+ *
+ * Usa BENCH_SCALING_AIRCRAFT aeronaves contra @p n alvos uniformes, solver em lote.
+ */
+static void RunScaling(FILE *json, bool *first, int n, int maxThreads)
+{
+    static const BenchCase scaling = { "SolveEngagementsParallel", "lote", false, false, SOLVER_BATCH, RunSolveParallel };
+    BenchData d;
+    if (!BenchDataInit(&d, BENCH_SCALING_AIRCRAFT, n))
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para %d itens\n", n);
+        BenchDataFree(&d);
+        return;
+    }
+    BenchFill(&d, DIST_UNIFORM);
+
+    double ns1 = 0.0;
+    for (int threads = 1; ; threads = threads*2 < maxThreads ? threads*2 : maxThreads) // always finish at maxThreads
+    {
+        JobPool pool;
+        if (!JobPoolInit(&pool, threads))
+        {
+            fprintf(stderr, "woe_bench: nao foi possivel criar %d threads\n", threads);
+            break;
+        }
+        d.pool = &pool;
+        double nsMin, nsMedian;
+        int items = TimeCase(&scaling, &d, &nsMin, &nsMedian);
+        JobPoolFree(&pool);
+        d.pool = NULL;
+
+        if (threads == 1) ns1 = nsMin;
+        EmitRecord(json, first, "scaling", scaling.name, scaling.variant, NULL, SimdIsaName(SimdGetIsa()),
+                   DIST_NAMES[DIST_UNIFORM], items, threads, nsMin, nsMedian);
+        fprintf(stderr, "%-30s %-9s %3d threads %10.2f ns/par  x%.2f\n", scaling.name, scaling.variant,
+                threads, nsMin, ns1/nsMin);
+        if (threads >= maxThreads) break;
+    }
+    BenchDataFree(&d);
+}
+
+/**
+ * @brief SolveEngagements completo contra o descarte por alcance/cone (grade espacial).
+ *
+ * Mesma cena da curva de escalonamento; ns por par da matriz inteira, de modo que
+ * a razão entre as duas linhas é o ganho do descarte.
+ */
+static void RunCulling(FILE *json, bool *first, int n)
+{
+    static const BenchCase full = { "SolveEngagements", "lote", false, false, SOLVER_BATCH, RunSolve };
+    static const BenchCase culled = { "SolveEngagementsCulled", "lote", false, false, SOLVER_BATCH, RunSolveCulled };
+    BenchData d;
+    SpatialGrid grid;
+    CandidatePairs cand;
+    bool ok = BenchDataInit(&d, BENCH_SCALING_AIRCRAFT, n);
+    bool haveGrid = SpatialGridInit(&grid, n, BENCH_CULL_CELL);
+    bool haveCand = CandidatePairsInit(&cand, BENCH_SCALING_AIRCRAFT, n);
+    if (ok && haveGrid && haveCand)
+    {
+        BenchFill(&d, DIST_UNIFORM);
+        d.grid = &grid;
+        d.cand = &cand;
+        double fullMin, fullMedian, culledMin, culledMedian;
+        int items = TimeCase(&full, &d, &fullMin, &fullMedian);
+        TimeCase(&culled, &d, &culledMin, &culledMedian);
+        const char *isa = SimdIsaName(SimdGetIsa());
+        EmitRecord(json, first, "culling", full.name, full.variant, NULL, isa, DIST_NAMES[DIST_UNIFORM],
+                   items, 1, fullMin, fullMedian);
+        EmitRecord(json, first, "culling", culled.name, culled.variant, NULL, isa, DIST_NAMES[DIST_UNIFORM],
+                   items, 1, culledMin, culledMedian);
+        fprintf(stderr, "%-30s %-9s %10.2f ns/par\n", full.name, full.variant, fullMin);
+        fprintf(stderr, "%-30s %-9s %10.2f ns/par  (%d de %d pares candidatos, x%.1f)\n", culled.name,
+                culled.variant, culledMin, cand.total, items, fullMin/culledMin);
+    }
+    else
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para %d itens\n", n);
+    }
+    if (haveCand) CandidatePairsFree(&cand);
+    if (haveGrid) SpatialGridFree(&grid);
+    BenchDataFree(&d);
+}
+
+/* --- Regressão de precisão e desempenho -------------------------------- */
+
+/** Direções da grade de regressão: azimute (ou yaw) a cada 360/REGRESS_AZ_STEPS graus, mais um a 0,01° de 0 (quase na mira). */
+#define REGRESS_AZ_STEPS 24
+/** Elevações (ou pitch) da grade, em graus, com os polos exatos e a 0,1° deles. */
+static const double REGRESS_EL_DEG[] = { -90.0, -89.9, -75.0, -60.0, -45.0, -30.0, -15.0, 0.0,
+                                         15.0, 30.0, 45.0, 60.0, 75.0, 89.9, 90.0 };
+#define REGRESS_EL_COUNT ((int)(sizeof(REGRESS_EL_DEG)/sizeof(REGRESS_EL_DEG[0])))
+/** Direções da grade; os pares são todas as combinações alvo x orientação da aeronave. */
+#define REGRESS_DIRECTIONS ((REGRESS_AZ_STEPS + 1)*REGRESS_EL_COUNT)
+/** Folga relativa sobre o ns/par da linha de base antes de acusar regressão de desempenho. */
+static const double REGRESS_SPEED_TOLERANCE = 0.25;
+/** G só é comparado nos pares com |sin j| e |cos F| de referência acima disto (~5,7°). */
+static const double REGRESS_G_MIN_SIN = 0.1;
+/** Distância (rad) a ±90° abaixo da qual ElT ou ElR conta como polo exato. */
+static const double REGRESS_POLE_EPS = 1e-6;
+
+/**
+ * @brief Limites gravados de erro contra a referência em double (rad).
+ *
+ * Os de j valem sobre a grade inteira (menos os polos exatos, sem
+ * RegressCase::poles): máximo e médio brutos e o máximo condicionado
+ * |Δj|·sin(j), que isola o piso do acos perto de j = 0 e pi. Os
+ * de G valem nos pares com |sin j| e |cos F| acima de REGRESS_G_MIN_SIN; fora
+ * deles G depende de dígitos que o arredondamento das entradas em float já
+ * tirou (e em |F| = 90° o asin da cadeia escolhe o ramo pelo arredondamento).
+ */
+typedef struct RegressLimit {
+    double maxJ, meanJ, condJ;
+    double maxG, meanG;
+} RegressLimit;
+
+/** Variante do solver na regressão, repetida por nível de trigonometria ou por ISA. */
+typedef struct RegressCase {
+    const char *variant;    /**< "cadeia", "lote", "lote-jg", "lote-j" ou "vetorial". */
+    bool tiered;            /**< Repetido para cada TrigTier (os limites são por nível). */
+    bool perIsa;            /**< Repetido para cada ISA SIMD suportada (um limite só). */
+    bool hasG;              /**< Calcula G. */
+    bool poles;             /**< Também comparado com ElT ou ElR no polo exato (lá a cadeia perde o sinal de tan(El)). */
+    int (*run)(BenchData *d, int arg);
+    RegressLimit limit[TRIG_TIER_COUNT];
+} RegressCase;
+
+static int RunVectorGrid(BenchData *d, int arg)
+{
+    // like RunVector, but the forward vector changes per pair
+    for (int i = 0; i < d->n; ++i)
+    {
+        WoeVec3 f = { d->fx[i], d->fy[i], d->fz[i] };
+        WoeVec3 los = { d->tgt.x[i], d->tgt.y[i], d->tgt.z[i] };
+        ComputeSphericalAnglesVector(f, los, &d->out.j[i], &d->out.G[i]);
+    }
+    return d->n;
+}
+
+static const RegressCase REGRESS_CASES[] = {
+    // recorded on x86-64 with glibc, about twice the measured errors; the j floor is acos near 0 in
+    // f and h (sqrt of the float epsilon, or of the 1.3e-5 sincos error on the visual tier), which
+    // no sin(j) factor conditions away
+    { "cadeia",   true,  false, true,  false, RunSpherical,
+      { { 7e-4, 3.5e-6, 3.5e-4, 1.4e-3, 2.5e-6 }, { 7e-4, 3.5e-6, 3.5e-4, 1.4e-3, 2.5e-6 },
+        { 1.3e-2, 4e-5, 4e-4, 9e-3, 7e-5 } } },
+    { "lote",     false, true,  true,  false, RunSphericalBatch,   { { 7e-4, 3.5e-6, 3.5e-4, 1.4e-3, 2.5e-6 } } },
+    { "lote-jg",  false, true,  true,  false, RunSphericalBatchJG, { { 7e-4, 3.5e-6, 3.5e-4, 1.4e-3, 2.5e-6 } } },
+    { "lote-j",   false, true,  false, false, RunSphericalBatchJ,  { { 7e-4, 3.5e-6, 3.5e-4, 0.0, 0.0 } } },
+    // no tan, so the exact poles are compared too
+    { "vetorial", true,  false, true,  true,  RunVectorGrid,
+      { { 6.5e-7, 1.2e-7, 5.5e-7, 2e-6, 3e-7 }, { 6.5e-7, 1.2e-7, 5.5e-7, 2e-6, 3e-7 },
+        { 8.5e-5, 9e-6, 7.5e-5, 2e-4, 1.5e-5 } } },
+};
+
+/** Referência em double por par da grade: a cadeia de ComputeSphericalAngles sobre yaw/pitch e o alvo. */
+typedef struct RegressRef {
+    double *j, *G, *F;
+    unsigned char *pole;    /**< ElT ou ElR a menos de REGRESS_POLE_EPS de ±90°. */
+} RegressRef;
+
+static double Clamp1(double x) { return x < -1.0 ? -1.0 : x > 1.0 ? 1.0 : x; }
+
+/** A cadeia de triângulos esféricos de ComputeSphericalAngles, em double e com a libm. */
+static void ChainReference(double AzT, double ElT, double AzR, double ElR, double *oj, double *oG, double *oF)
+{
+    double f = acos(Clamp1(cos(AzT)*cos(ElT)));
+    double h = acos(Clamp1(cos(AzR)*cos(ElR)));
+    double C = atan2(tan(ElT), sin(AzT));
+    double D = atan2(tan(ElR), sin(AzR));
+    double J = M_PI - C - D;
+    double j = acos(Clamp1(cos(f)*cos(h) + sin(f)*sin(h)*cos(J)));
+    double E = atan2(tan(AzR), sin(ElR));
+    double denom = sin(j);
+    double F = fabs(denom) > 1e-12 ? asin(Clamp1(sin(J)*sin(f)/denom)) : 0.0;
+    *oj = j;
+    *oG = M_PI - E - F;
+    *oF = F;
+}
+
+/** Direção @p k da grade (rad): azimute a partir de +Y, positivo para +X, e elevação. */
+static void RegressDirection(int k, float *az, float *el)
+{
+    int a = k % (REGRESS_AZ_STEPS + 1), e = k/(REGRESS_AZ_STEPS + 1);
+    double azd = a < REGRESS_AZ_STEPS ? -180.0 + 360.0*a/REGRESS_AZ_STEPS : 0.01;
+    *az = (float)(azd*M_PI/180.0);
+    *el = (float)(REGRESS_EL_DEG[e]*M_PI/180.0);
+}
+
+/**
+ * @brief Preenche @p d com todos os pares da grade e calcula a referência.
+ *
+ * O par i tem o alvo numa direção unitária a partir da origem (d->tgt.x/y/z) e
+ * a aeronave na origem com a orientação de outra direção (d->tgt.yaw/pitch,
+ * roll nulo). A referência sai em double de yaw/pitch, como ForwardFromYPR e
+ * ComputeAzElFromVector fariam sem arredondamento, e das posições do alvo:
+ * nenhuma entrada em float calculada pelo próprio solver entra nela.
+ */
+static void RegressFill(BenchData *d, RegressRef *ref)
+{
+    d->tgt.count = 0;
+    int i = 0;
+    for (int r = 0; r < REGRESS_DIRECTIONS; ++r)
+    {
+        for (int t = 0; t < REGRESS_DIRECTIONS; ++t, ++i)
+        {
+            float az, el, yaw, pitch;
+            RegressDirection(t, &az, &el);
+            RegressDirection(r, &yaw, &pitch);
+            double L[3] = { sin((double)az)*cos((double)el), cos((double)az)*cos((double)el), sin((double)el) };
+            EntityStoreAdd(&d->tgt, (float)L[0], (float)L[1], (float)L[2], yaw, pitch, 0.0f);
+
+            double Tx = d->tgt.x[i], Ty = d->tgt.y[i], Tz = d->tgt.z[i];
+            double AzT = atan2(Tx, Ty), ElT = atan2(Tz, sqrt(Tx*Tx + Ty*Ty));
+            // 0 - s: the forward x of a zero yaw is +0, and the chain's D/E branches read that sign
+            double cp = cos((double)pitch);
+            double Rx = 0.0 - sin((double)yaw)*cp, Ry = cos((double)yaw)*cp, Rz = sin((double)pitch);
+            double AzR = atan2(Rx, Ry), ElR = atan2(Rz, sqrt(Rx*Rx + Ry*Ry));
+            ChainReference(AzT, ElT, AzR, ElR, &ref->j[i], &ref->G[i], &ref->F[i]);
+            ref->pole[i] = fabs(ElT) > 0.5*M_PI - REGRESS_POLE_EPS || fabs(ElR) > 0.5*M_PI - REGRESS_POLE_EPS;
+        }
+    }
+}
+
+/**
+ * @brief Entradas dos solvers pelo caminho do woe3d, no nível e na ISA ativos.
+ *
+ * Vetor frente por ForwardFromYPRBatch (os kernels SIMD fora da libm), AzR/ElR
+ * por ComputeAzElFromVectorBatch e AzT/ElT por ComputeAzElBatch.
+ */
+static void RegressPrepare(BenchData *d)
+{
+    ForwardFromYPRBatch(d->n, d->tgt.yaw, d->tgt.pitch, d->tgt.roll, d->fx, d->fy, d->fz);
+    ComputeAzElFromVectorBatch(d->n, d->fx, d->fy, d->fz, d->in.AzR, d->in.ElR);
+    ComputeAzElBatch(d->n, 0.0f, 0.0f, 0.0f, d->tgt.x, d->tgt.y, d->tgt.z, d->in.AzT, d->in.ElT);
+}
+
+/** Maiores e médios erros de uma variante; pares com saída não finita são contados à parte. */
+typedef struct RegressError {
+    double maxJ, meanJ, condJ;
+    double maxG, meanG;
+    int jPairs;             /**< Pares em que j é comparado. */
+    int gPairs;             /**< Pares em que G é comparado. */
+    int nonFinite;
+} RegressError;
+
+/** Diferença angular em (-pi, pi]. */
+static double AngleDiff(double a, double b)
+{
+    return remainder(a - b, 2.0*M_PI);
+}
+
+static RegressError RegressMeasure(const BenchData *d, const RegressRef *ref, const RegressCase *rc)
+{
+    RegressError e = { 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0 };
+    for (int i = 0; i < d->n; ++i)
+    {
+        if (!rc->poles && ref->pole[i]) continue;
+        double j = d->out.j[i], G = rc->hasG ? d->out.G[i] : 0.0;
+        if (!isfinite(j) || !isfinite(G)) { e.nonFinite++; continue; }
+        double sj = sin(ref->j[i]);
+        double dj = fabs(j - ref->j[i]);
+        e.meanJ += dj;
+        e.jPairs++;
+        if (dj > e.maxJ) e.maxJ = dj;
+        if (dj*sj > e.condJ) e.condJ = dj*sj;
+        if (!rc->hasG || fabs(sj) < REGRESS_G_MIN_SIN || fabs(cos(ref->F[i])) < REGRESS_G_MIN_SIN) continue;
+        double dG = fabs(AngleDiff(G, ref->G[i]));
+        e.meanG += dG;
+        e.gPairs++;
+        if (dG > e.maxG) e.maxG = dG;
+    }
+    if (e.jPairs) e.meanJ /= e.jPairs;
+    if (e.gPairs) e.meanG /= e.gPairs;
+    return e;
+}
+
+/** Linha de base de desempenho: rótulo da variante e ns/par. */
+typedef struct RegressBaseline {
+    int count;
+    char label[64][32];
+    double ns[64];
+} RegressBaseline;
+
+/** Lê uma linha de base gravada por --save-baseline ('#' comenta); false se não abrir. */
+static bool RegressLoadBaseline(const char *path, RegressBaseline *b)
+{
+    memset(b, 0, sizeof(*b));
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f) && b->count < 64)
+    {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %lf", b->label[b->count], &b->ns[b->count]) == 2) b->count++;
+    }
+    fclose(f);
+    return true;
+}
+
+/** ns/par de @p label na linha de base, ou 0 se ela não o tem. */
+static double RegressBaselineNs(const RegressBaseline *b, const char *label)
+{
+    for (int i = 0; i < b->count; ++i)
+        if (strcmp(b->label[i], label) == 0) return b->ns[i];
+    return 0.0;
+}
+
+/** Alvos da verificação com orientação nula; a aeronave fica em (0, 0, 2), a pose inicial do woe3d. */
+static const float REGRESS_YAW0_TARGETS[][3] = {
+    { 8.0f, 6.0f, 4.0f }, { -5.0f, 3.0f, 2.0f }, { 3.0f, -4.0f, 6.0f }, { -2.0f, -7.0f, -1.0f }, { 0.0f, 9.0f, 5.0f },
+};
+#define REGRESS_YAW0_COUNT ((int)(sizeof(REGRESS_YAW0_TARGETS)/sizeof(REGRESS_YAW0_TARGETS[0])))
+/** Maior diferença de G (rad) aceita entre os caminhos com yaw = 0 (folga do nível visual). */
+static const double REGRESS_YAW0_TOL = 1e-3;
+
+/**
+ * @brief Com yaw, pitch e roll nulos, confere que os solvers escalar, em lote e vetorial e a cadeia dão o mesmo G.
+ *
+ * A frente é (0, 1, 0), sobre o corte de AzR = 0: um zero negativo em x vira
+ * o ramo de D/E e espelha G, e a grade, que recebe os ângulos prontos, não
+ * passa por ForwardFromYPR nem por ComputeBasisBatch para perceber.
+ * @return Número de combinações de nível e ISA em desacordo.
+ */
+static int RegressYawZero(void)
+{
+    EntityStore air, tgt;
+    PairResults out;
+    if (!EntityStoreInit(&air, 1) || !EntityStoreInit(&tgt, REGRESS_YAW0_COUNT) ||
+        !PairResultsInit(&out, REGRESS_YAW0_COUNT))
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para a verificacao com yaw = 0\n");
+        EntityStoreFree(&air);
+        EntityStoreFree(&tgt);
+        PairResultsFree(&out);
+        return 1;
+    }
+    WoeVec3 A = { 0.0f, 0.0f, 2.0f };
+    EntityStoreAdd(&air, A.x, A.y, A.z, 0.0f, 0.0f, 0.0f);
+    for (int t = 0; t < REGRESS_YAW0_COUNT; ++t)
+        EntityStoreAdd(&tgt, REGRESS_YAW0_TARGETS[t][0], REGRESS_YAW0_TARGETS[t][1], REGRESS_YAW0_TARGETS[t][2],
+                       0.0f, 0.0f, 0.0f);
+
+    SimdIsa isa0 = SimdGetIsa();
+    TrigTier tier0 = GetSolverTrigTier();
+    int failures = 0;
+    for (int tier = 0; tier < TRIG_TIER_COUNT; ++tier)
+    {
+        for (int isa = 0; isa < SIMD_ISA_COUNT; ++isa)
+        {
+            if (!SimdIsaSupported((SimdIsa)isa)) continue;
+            SetSolverTrigTier((TrigTier)tier);
+            SimdSetIsa((SimdIsa)isa);
+            float Gs[REGRESS_YAW0_COUNT], Gv[REGRESS_YAW0_COUNT];
+            SolveEngagements(&air, &tgt, &out, SOLVER_SCALAR);
+            memcpy(Gs, out.G, sizeof(Gs));
+            SolveEngagements(&air, &tgt, &out, SOLVER_VECTOR);
+            memcpy(Gv, out.G, sizeof(Gv));
+            SolveEngagements(&air, &tgt, &out, SOLVER_BATCH);
+            double worst = 0.0;
+            for (int t = 0; t < REGRESS_YAW0_COUNT; ++t)
+            {
+                // the chain on exact +0 forward angles, and the double reference on the same pose
+                WoeVec3 T = { tgt.x[t], tgt.y[t], tgt.z[t] };
+                float AzT, ElT, Gc;
+                ComputeAzEl(A, T, &AzT, &ElT);
+                ComputeSphericalAngles(AzT, ElT, 0.0f, 0.0f, NULL, &Gc, NULL, NULL, NULL);
+                double jr, Gr, Fr;
+                ChainReference(AzT, ElT, 0.0, 0.0, &jr, &Gr, &Fr);
+                double d[4] = { AngleDiff(Gs[t], Gr), AngleDiff(out.G[t], Gr), AngleDiff(Gv[t], Gr), AngleDiff(Gc, Gr) };
+                for (int k = 0; k < 4; ++k)
+                    if (fabs(d[k]) > worst) worst = fabs(d[k]);
+            }
+            if (worst > REGRESS_YAW0_TOL)
+            {
+                fprintf(stderr, "regressao: yaw = 0 em %s/%s: G diverge em %.2f graus entre escalar, lote, vetorial e cadeia\n",
+                        TrigTierName((TrigTier)tier), SimdIsaName((SimdIsa)isa), worst*180.0/M_PI);
+                failures++;
+            }
+        }
+    }
+    SetSolverTrigTier(tier0);
+    SimdSetIsa(isa0);
+    EntityStoreFree(&air);
+    EntityStoreFree(&tgt);
+    PairResultsFree(&out);
+    return failures;
+}
+
+/** Orientações aleatórias da verificação de ForwardFromYPR contra EntityForward. */
+#define REGRESS_FWD_COUNT 4099
+
+/**
+ * @brief Confere, bit a bit, que ForwardFromYPR e ComputeAzElFromVector dão a mesma frente e o mesmo AzR/ElR
+ *        que EntityForward, com e sem BasisStore, e que ForwardFromYPRBatch, em todo nível e ISA.
+ *
+ * É o contrato de SolveEngagementRowForward: o --headless passa pelo caminho
+ * escalar e a simulação pela base em lote, e ambos devem resolver igual.
+ * @return Número de combinações de nível e ISA em desacordo.
+ */
+static int RegressForwardAgreement(void)
+{
+    EntityStore air;
+    BasisStore basis;
+    float *col = (float *)malloc(sizeof(float)*3*REGRESS_FWD_COUNT);
+    bool okAir = EntityStoreInit(&air, REGRESS_FWD_COUNT), okBasis = BasisStoreInit(&basis, REGRESS_FWD_COUNT);
+    if (!col || !okAir || !okBasis)
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para a verificacao da frente\n");
+        free(col);
+        if (okAir) EntityStoreFree(&air);
+        if (okBasis) BasisStoreFree(&basis);
+        return 1;
+    }
+    unsigned int seed = 20240611u;
+    for (int i = 0; i < REGRESS_FWD_COUNT; ++i)
+    {
+        EntityStoreAdd(&air, 0.0f, 0.0f, 0.0f, RandRange(&seed, -7.0f, 7.0f), RandRange(&seed, -1.6f, 1.6f),
+                       RandRange(&seed, -3.2f, 3.2f));
+    }
+    // the exact zero pose, where a -0 in the forward x flips AzR
+    air.yaw[0] = air.pitch[0] = air.roll[0] = 0.0f;
+    float *bx = col, *by = col + REGRESS_FWD_COUNT, *bz = col + 2*REGRESS_FWD_COUNT;
+
+    SimdIsa isa0 = SimdGetIsa();
+    TrigTier tier0 = GetSolverTrigTier();
+    int failures = 0;
+    for (int tier = 0; tier < TRIG_TIER_COUNT; ++tier)
+    {
+        for (int isa = 0; isa < SIMD_ISA_COUNT; ++isa)
+        {
+            if (!SimdIsaSupported((SimdIsa)isa)) continue;
+            SetSolverTrigTier((TrigTier)tier);
+            SimdSetIsa((SimdIsa)isa);
+            ForwardFromYPRBatch(air.count, air.yaw, air.pitch, air.roll, bx, by, bz);
+            BasisStoreUpdate(&basis, &air);
+            int bad = 0;
+            for (int i = 0; i < air.count; ++i)
+            {
+                WoeVec3 f = ForwardFromYPR(air.yaw[i], air.pitch[i], air.roll[i]);
+                float az, el;
+                ComputeAzElFromVector(f, &az, &el);
+                float ref[5] = { f.x, f.y, f.z, az, el };
+                float got[3][5];
+                WoeVec3 g;
+                air.basis = NULL;
+                EntityForward(&air, i, &g, &got[0][3], &got[0][4]);
+                got[0][0] = g.x; got[0][1] = g.y; got[0][2] = g.z;
+                air.basis = &basis;
+                EntityForward(&air, i, &g, &got[1][3], &got[1][4]);
+                got[1][0] = g.x; got[1][1] = g.y; got[1][2] = g.z;
+                memcpy(got[2], ref, sizeof(ref));
+                got[2][0] = bx[i]; got[2][1] = by[i]; got[2][2] = bz[i];
+                // memcmp, not ==: the sign of a zero matters here
+                if (memcmp(got[0], ref, sizeof(ref)) != 0 || memcmp(got[1], ref, sizeof(ref)) != 0 ||
+                    memcmp(got[2], ref, sizeof(ref)) != 0)
+                    bad++;
+            }
+            air.basis = NULL;
+            if (bad > 0)
+            {
+                fprintf(stderr, "regressao: frente em %s/%s: %d de %d orientacoes com ForwardFromYPR diferente de EntityForward\n",
+                        TrigTierName((TrigTier)tier), SimdIsaName((SimdIsa)isa), bad, air.count);
+                failures++;
+            }
+        }
+    }
+    SetSolverTrigTier(tier0);
+    SimdSetIsa(isa0);
+    EntityStoreFree(&air);
+    BasisStoreFree(&basis);
+    free(col);
+    return failures;
+}
+
+/**
+ * @brief Varre a grade com cada variante do solver e compara precisão e desempenho com os limites.
+ *
+ * A precisão é comparada com os limites gravados em REGRESS_CASES; o
+ * desempenho, com @p baselinePath (se dado), com folga REGRESS_SPEED_TOLERANCE;
+ * por fim RegressYawZero confere G com a orientação nula e
+ * RegressForwardAgreement, a frente escalar contra a da base.
+ * Com @p savePath grava os ns/par medidos como nova linha de base.
+ * @return 0 sem regressões, 1 com alguma, 2 se a linha de base não abriu.
+ */
+static int RunRegress(FILE *json, bool *first, const char *baselinePath, const char *savePath)
+{
+    RegressBaseline base;
+    if (baselinePath && !RegressLoadBaseline(baselinePath, &base))
+    {
+        fprintf(stderr, "woe_bench: nao foi possivel ler a linha de base '%s'\n", baselinePath);
+        return 2;
+    }
+    int n = REGRESS_DIRECTIONS*REGRESS_DIRECTIONS;
+    BenchData d;
+    RegressRef ref;
+    double *refMem = (double *)malloc((sizeof(double)*3 + 1)*(size_t)n);
+    if (!BenchDataInit(&d, 1, n) || !refMem)
+    {
+        fprintf(stderr, "woe_bench: memoria insuficiente para %d pares\n", n);
+        BenchDataFree(&d);
+        free(refMem);
+        return 1;
+    }
+    ref.j = refMem; ref.G = ref.j + n; ref.F = ref.G + n; ref.pole = (unsigned char *)(ref.F + n);
+    RegressFill(&d, &ref);
+    FILE *save = savePath ? fopen(savePath, "w") : NULL;
+    if (savePath && !save) fprintf(stderr, "woe_bench: nao foi possivel criar '%s'\n", savePath);
+    if (save) fprintf(save, "# woe_bench --regress: variante ns/par (%d pares)\n", n);
+
+    SimdIsa isa0 = SimdGetIsa();
+    TrigTier tier0 = GetSolverTrigTier();
+    int failures = 0;
+    fprintf(stderr, "regressao: %d pares (%d direcoes de alvo x %d orientacoes), referencia em double de yaw/pitch\n",
+            n, REGRESS_DIRECTIONS, REGRESS_DIRECTIONS);
+    fprintf(stderr, "%-18s %10s %10s %10s %8s %10s %10s %8s %9s %s\n", "variante", "max dj", "media dj", "cond dj",
+            "pares j", "max dG", "media dG", "pares G", "ns/par", "");
+    for (size_t c = 0; c < sizeof(REGRESS_CASES)/sizeof(REGRESS_CASES[0]); ++c)
+    {
+        const RegressCase *rc = &REGRESS_CASES[c];
+        int tiers = rc->tiered ? TRIG_TIER_COUNT : 1;
+        int isas = rc->perIsa ? SIMD_ISA_COUNT : 1;
+        for (int t = 0; t < tiers; ++t)
+        {
+            for (int i = 0; i < isas; ++i)
+            {
+                if (rc->perIsa && !SimdIsaSupported((SimdIsa)i)) continue;
+                SetSolverTrigTier(rc->tiered ? (TrigTier)t : tier0);
+                SimdSetIsa(rc->perIsa ? (SimdIsa)i : isa0);
+                const char *trigName = rc->tiered ? TrigTierName((TrigTier)t) : NULL;
+                const char *isaName = rc->perIsa ? SimdIsaName((SimdIsa)i) : NULL;
+                char label[32];
+                snprintf(label, sizeof(label), "%s/%s", rc->variant, trigName ? trigName : isaName);
+
+                RegressPrepare(&d);
+                rc->run(&d, 0);
+                RegressError e = RegressMeasure(&d, &ref, rc);
+                BenchCase bc = { "regress", rc->variant, rc->tiered, rc->perIsa, 0, rc->run };
+                double nsMin, nsMedian;
+                TimeCase(&bc, &d, &nsMin, &nsMedian);
+
+                // accuracy against the recorded bounds, speed against the baseline
+                const RegressLimit *lim = &rc->limit[rc->tiered ? t : 0];
+                char why[96] = "";
+                if (e.nonFinite) snprintf(why, sizeof(why), "%d nao finitos", e.nonFinite);
+                else if (e.maxJ > lim->maxJ || e.meanJ > lim->meanJ || e.condJ > lim->condJ)
+                    snprintf(why, sizeof(why), "erro de j");
+                else if (rc->hasG && (e.maxG > lim->maxG || e.meanG > lim->meanG))
+                    snprintf(why, sizeof(why), "erro de G");
+                double nsBase = baselinePath ? RegressBaselineNs(&base, label) : 0.0;
+                if (!why[0] && nsBase > 0.0 && nsMin > nsBase*(1.0 + REGRESS_SPEED_TOLERANCE))
+                    snprintf(why, sizeof(why), "lento: %.2f ns/par na base", nsBase);
+                if (why[0]) failures++;
+
+                fprintf(stderr, "%-18s %10.2e %10.2e %10.2e %8d %10.2e %10.2e %8d %9.2f %s\n", label,
+                        e.maxJ, e.meanJ, e.condJ, e.jPairs, e.maxG, e.meanG, e.gPairs, nsMin, why[0] ? why : "ok");
+                if (save) fprintf(save, "%s %.3f\n", label, nsMin);
+                fprintf(json, "%s\n    {\"group\": \"regress\", \"name\": \"ComputeSphericalAngles\", \"variant\": \"%s\", "
+                        "\"trig\": %s%s%s, \"isa\": %s%s%s, \"items\": %d, \"ns_per_item\": %.3f, \"ns_median\": %.3f, "
+                        "\"max_dj\": %.3e, \"mean_dj\": %.3e, \"cond_dj\": %.3e, \"max_dG\": %.3e, \"mean_dG\": %.3e, "
+                        "\"j_pairs\": %d, \"g_pairs\": %d, \"non_finite\": %d, \"ok\": %s}",
+                        *first ? "" : ",", rc->variant, trigName ? "\"" : "", trigName ? trigName : "null",
+                        trigName ? "\"" : "", isaName ? "\"" : "", isaName ? isaName : "null", isaName ? "\"" : "",
+                        n, nsMin, nsMedian, e.maxJ, e.meanJ, e.condJ, e.maxG, e.meanG, e.jPairs, e.gPairs, e.nonFinite,
+                        why[0] ? "false" : "true");
+                *first = false;
+            }
+        }
+    }
+    SetSolverTrigTier(tier0);
+    SimdSetIsa(isa0);
+    failures += RegressYawZero();
+    failures += RegressForwardAgreement();
+    if (save) fclose(save);
+    if (failures) fprintf(stderr, "regressao: %d variante(s) fora dos limites\n", failures);
+    else fprintf(stderr, "regressao: tudo dentro dos limites\n");
+    BenchDataFree(&d);
+    free(refMem);
+    return failures ? 1 : 0;
+}
+
+/** Casos do benchmark de renderização. */
+typedef enum RenderCase {
+    RENDER_AIRCRAFT = 0,        /**< DrawAircraft por entidade (modo imediato). */
+    RENDER_AIRCRAFT_INSTANCED,  /**< DrawAircraftInstanced, uma chamada por quadro. */
+    RENDER_AIRCRAFT_LOD,        /**< DrawAircraftInstanced com nível de detalhe pela distância, uma chamada por nível. */
+    RENDER_ARC,                 /**< DrawArc3D por entidade. */
+    RENDER_ARC_BATCHED,         /**< LineBatchAddArc por entidade e um LineBatchDraw. */
+    RENDER_LABEL,               /**< snprintf e DrawTextAt3D por entidade. */
+    RENDER_LABEL_BATCHED,       /**< CullLabel, TextLineUpdate e TextBatchAddAt3D por entidade e um TextBatchDraw. */
+    RENDER_CASE_COUNT
+} RenderCase;
+
+static const char *RENDER_CASE_NAMES[RENDER_CASE_COUNT][2] = {
+    { "DrawAircraft", "immediate" },
+    { "DrawAircraft", "instanced" },
+    { "DrawAircraft", "instanced-lod" },
+    { "DrawArc3D",    "immediate" },
+    { "DrawArc3D",    "batched" },
+    { "DrawTextAt3D", "immediate" },
+    { "DrawTextAt3D", "batched" },
+};
+
+/** Desenha as @c e->count entidades de um caso num quadro; devolve o tempo do quadro (s). */
+static double RenderFrame(Camera3D cam, const EntityStore *e, RenderCase rc,
+                          InstancedRenderer *inst, LineBatch *lines, TextBatch *text, TextLine *labels)
+{
+    bool label = rc == RENDER_LABEL || rc == RENDER_LABEL_BATCHED;
+    double t0 = WoeNow();
+    BeginDrawing();
+    ClearBackground(RAYWHITE);
+    BeginMode3D(cam);
+    bool instanced = rc == RENDER_AIRCRAFT_INSTANCED || rc == RENDER_AIRCRAFT_LOD;
+    if (instanced)
+    {
+        InstancedRendererSetCamera(inst, rc == RENDER_AIRCRAFT_LOD ? &cam : NULL, GetScreenHeight());
+        DrawAircraftInstanced(inst, e, 0, NULL, DARKGREEN);
+    }
+    LineBatchClear(lines);
+    for (int i = 0; i < e->count && !instanced && !label; ++i)
+    {
+        Vector3 p = { e->x[i], e->y[i], e->z[i] };
+        if (rc == RENDER_ARC || rc == RENDER_ARC_BATCHED)
+        {
+            Vector3 u = FromWoe(ForwardFromYPR(e->yaw[i], e->pitch[i], 0.0f));
+            Vector3 v = FromWoe(ForwardFromYPR(e->yaw[i] + 0.8f, e->pitch[i] + 0.3f, 0.0f));
+            float ang = acosf(u.x*v.x + u.y*v.y + u.z*v.z);
+            if (rc == RENDER_ARC) DrawArc3D(p, u, v, ang, 1.5f, PURPLE);
+            else LineBatchAddArc(lines, p, u, v, ang, 1.5f, PURPLE);
+        }
+        else
+        {
+            DrawAircraft(p, e->yaw[i], e->pitch[i], e->roll[i], DARKGREEN);
+        }
+    }
+    if (rc == RENDER_ARC_BATCHED) LineBatchDraw(lines);
+    EndMode3D();
+    if (label)
+    {
+        // one Az/El-style label per entity; the scene is static, as tracks mostly are between frames
+        int sw = GetScreenWidth(), sh = GetScreenHeight();
+        Frustum f = FrustumFromCamera(cam, (float)sw/(float)sh);
+        TextBatchClear(text);
+        for (int i = 0; i < e->count; ++i)
+        {
+            Vector3 p = { e->x[i], e->y[i], e->z[i] };
+            if (rc == RENDER_LABEL)
+            {
+                char lab[64];
+                snprintf(lab, sizeof(lab), "%.0f/%.0f", deg(e->yaw[i]), deg(e->pitch[i]));
+                DrawTextAt3D(cam, p, lab, 10, MAROON, sw, sh);
+            }
+            else if (CullLabel(&f, p, NULL))
+            {
+                TextLineUpdate(&labels[i], "%.0f/%.0f", 2, (TextArg[]){ TEXT_NUM(deg(e->yaw[i])), TEXT_NUM(deg(e->pitch[i])) });
+                TextBatchAddAt3D(text, &f, p, labels[i].text, 10, MAROON, sw, sh);
+            }
+        }
+        if (rc == RENDER_LABEL_BATCHED) TextBatchDraw(text);
+    }
+    EndDrawing();
+    return WoeNow() - t0;
+}
+
+static void RunRender(FILE *json, bool *first, int maxEntities)
+{
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(1280, 720, "woe_bench");
+    if (!IsWindowReady())
+    {
+        fprintf(stderr, "woe_bench: sem contexto OpenGL; benchmark de renderizacao ignorado\n");
+        return;
+    }
+    SetTargetFPS(0);
+
+    Camera3D cam = {0};
+    cam.position = (Vector3){ 0.0f, -70.0f, 45.0f };
+    cam.target   = (Vector3){ 0.0f, 0.0f, 0.0f };
+    cam.up       = (Vector3){ 0.0f, 0.0f, 1.0f };
+    cam.fovy     = 60.0f;
+    cam.projection = CAMERA_PERSPECTIVE;
+
+    EntityStore e;
+    if (!EntityStoreInit(&e, maxEntities)) { CloseWindow(); return; }
+    unsigned int seed = 4242u;
+    for (int i = 0; i < maxEntities; ++i)
+    {
+        EntityStoreAdd(&e, RandRange(&seed, -30.0f, 30.0f), RandRange(&seed, -30.0f, 30.0f), RandRange(&seed, 0.0f, 15.0f),
+                       RandRange(&seed, -3.14f, 3.14f), RandRange(&seed, -0.5f, 0.5f), RandRange(&seed, -0.8f, 0.8f));
+    }
+
+    InstancedRenderer inst;
+    bool haveInstancing = InstancedRendererInit(&inst, maxEntities);
+    if (!haveInstancing) fprintf(stderr, "woe_bench: shader de instancing indisponivel; caso instanciado ignorado\n");
+
+    LineBatch lines;
+    bool haveLines = LineBatchInit(&lines, 64*maxEntities);
+    TextBatch text;
+    bool haveText = TextBatchInit(&text, GetFontDefault(), 8*maxEntities);
+    TextLine *labels = (TextLine *)calloc((size_t)maxEntities, sizeof(TextLine));
+
+    double *ft = (double *)malloc(sizeof(double)*RENDER_FRAMES);
+    for (int rc = 0; rc < RENDER_CASE_COUNT && ft && haveLines && haveText && labels; ++rc)
+    {
+        if ((rc == RENDER_AIRCRAFT_INSTANCED || rc == RENDER_AIRCRAFT_LOD) && !haveInstancing) continue;
+        const char *name = RENDER_CASE_NAMES[rc][0], *variant = RENDER_CASE_NAMES[rc][1];
+        for (int n = 16; n <= maxEntities; n *= 4)
+        {
+            e.count = n;
+            for (int f = 0; f < RENDER_WARMUP_FRAMES; ++f) RenderFrame(cam, &e, (RenderCase)rc, &inst, &lines, &text, labels);
+            for (int f = 0; f < RENDER_FRAMES; ++f) ft[f] = RenderFrame(cam, &e, (RenderCase)rc, &inst, &lines, &text, labels);
+            qsort(ft, RENDER_FRAMES, sizeof(double), CompareDouble);
+            double nsMin = ft[0]*1e9/n, nsMedian = ft[RENDER_FRAMES/2]*1e9/n;
+            EmitRecord(json, first, "render", name, variant, NULL, NULL, "scene", n, 1, nsMin, nsMedian);
+            fprintf(stderr, "%-30s %-9s %7d entidades %10.2f ns/entidade  %8.3f ms/quadro\n",
+                    name, variant, n, nsMedian, nsMedian*n*1e-6);
+            if (n < maxEntities && n*4 > maxEntities) n = maxEntities/4; // always finish at maxEntities
+        }
+    }
+    free(ft);
+    free(labels);
+    if (haveText) TextBatchFree(&text);
+    if (haveLines) LineBatchFree(&lines);
+
+    if (haveInstancing) InstancedRendererFree(&inst);
+    EntityStoreFree(&e);
+    CloseWindow();
+}
+
+static void PrintUsage(const char *prog)
+{
+    fprintf(stderr,
+            "uso: %s [--n N] [--json ARQUIVO] [--entities N] [--threads N] [--no-render]\n"
+            "       %s --regress [--baseline ARQUIVO] [--save-baseline ARQUIVO] [--json ARQUIVO]\n"
+            "  --n N          itens por chamada nos casos de geometria (padrao %d)\n"
+            "  --json ARQUIVO grava os resultados em JSON (padrao: stdout; '-' = stdout)\n"
+            "  --entities N   maximo de entidades no benchmark de renderizacao (padrao %d)\n"
+            "  --threads N    maximo de threads na curva de escalonamento (padrao: CPUs)\n"
+            "  --no-render    apenas geometria, sem abrir janela\n"
+            "  --regress      compara j e G de cada variante do solver com uma referencia em double de yaw/pitch\n"
+            "                 numa grade densa (polos e j = 0/180 inclusos); sai com 1 se alguma passar dos limites\n"
+            "  --baseline     com --regress, acusa variantes %.0f%% mais lentas que esta linha de base\n"
+            "  --save-baseline  com --regress, grava os ns/par medidos como linha de base\n",
+            prog, prog, BENCH_DEFAULT_ITEMS, RENDER_DEFAULT_MAX_ENTITIES, REGRESS_SPEED_TOLERANCE*100.0);
+}
+
+int main(int argc, char **argv)
+{
+    int n = BENCH_DEFAULT_ITEMS;
+    int maxEntities = RENDER_DEFAULT_MAX_ENTITIES;
+    const char *jsonPath = "-";
+    int maxThreads = WoeCpuCount();
+    bool render = true;
+    bool regress = false;
+    const char *baselinePath = NULL, *savePath = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--n") == 0 && i + 1 < argc) n = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--entities") == 0 && i + 1 < argc) maxEntities = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) maxThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-render") == 0) render = false;
+        else if (strcmp(argv[i], "--regress") == 0) regress = true;
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--save-baseline") == 0 && i + 1 < argc) savePath = argv[++i];
+        else
+        {
+            PrintUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+    if (n < 1 || maxEntities < 16 || maxThreads < 1 || maxThreads > JOB_MAX_THREADS)
+    {
+        fprintf(stderr, "woe_bench: --n deve ser >= 1, --entities >= 16 e --threads entre 1 e %d\n", JOB_MAX_THREADS);
+        return 2;
+    }
+
+    FILE *json = strcmp(jsonPath, "-") == 0 ? stdout : fopen(jsonPath, "w");
+    if (!json) { fprintf(stderr, "woe_bench: nao foi possivel criar '%s'\n", jsonPath); return 1; }
+
+    SimdIsa isa = SimdGetIsa();
+    fprintf(json, "{\n  \"schema\": 1,\n  \"simd_isa\": \"%s\",\n  \"simd_lanes\": %d,\n  \"items\": %d,\n  \"results\": [",
+            SimdIsaName(isa), SimdIsaLanes(isa), n);
+    bool first = true;
+    int status = 0;
+    if (regress) status = RunRegress(json, &first, baselinePath, savePath);
+    else
+    {
+        RunGeometry(json, &first, n);
+        RunScaling(json, &first, n, maxThreads);
+        RunCulling(json, &first, n);
+        if (render) RunRender(json, &first, maxEntities);
+    }
+    fprintf(json, "\n  ]\n}\n");
+
+    if (json != stdout) { if (fclose(json) != 0 && status == 0) status = 1; }
+    else fflush(json);
+    return status;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file entities.c
+ * @brief Alocação dos buffers SoA de entidades e de resultados por par.
+ */
+#include "entities.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Arredonda @p n para cima até múltiplo de ENTITY_LANE_PAD. */
+static int PadLanes(int n)
+{
+    return (n + ENTITY_LANE_PAD - 1)/ENTITY_LANE_PAD*ENTITY_LANE_PAD;
+}
+
+/**
+ * @brief Aloca um bloco com @p arrays arrays de @p lanes floats, cada um alinhado.
+ *
+ * Preenche @p out[i] com o início de cada array e devolve o ponteiro base
+ * (a ser passado a free), ou NULL em falha.
+ */
+static void *AllocSoA(int arrays, int lanes, float **out[])
+{
+    size_t stride = (size_t)lanes*sizeof(float);
+    void *mem = malloc(stride*(size_t)arrays + ENTITY_ALIGNMENT);
+    if (!mem) return NULL;
+    memset(mem, 0, stride*(size_t)arrays + ENTITY_ALIGNMENT);
+
+    uintptr_t p = ((uintptr_t)mem + ENTITY_ALIGNMENT - 1) & ~(uintptr_t)(ENTITY_ALIGNMENT - 1);
+    for (int i = 0; i < arrays; ++i)
+    {
+        *out[i] = (float *)(p + stride*(size_t)i);
+    }
+    return mem;
+}
+
+bool EntityStoreInit(EntityStore *s, int capacity)
+{
+    memset(s, 0, sizeof(*s));
+    if (capacity < 1) capacity = 1;
+    int lanes = PadLanes(capacity);
+    float **arrays[] = { &s->x, &s->y, &s->z, &s->yaw, &s->pitch, &s->roll, &s->vx, &s->vy, &s->vz };
+    s->mem = AllocSoA((int)(sizeof(arrays)/sizeof(arrays[0])), lanes, arrays);
+    if (!s->mem) return false;
+    s->capacity = lanes;
+    return true;
+}
+
+void EntityStoreFree(EntityStore *s)
+{
+    free(s->mem);
+    memset(s, 0, sizeof(*s));
+}
+
+int EntityStoreAdd(EntityStore *s, float x, float y, float z,
+                   float yaw, float pitch, float roll)
+{
+    if (s->count >= s->capacity) return -1;
+    int i = s->count++;
+    s->x[i] = x; s->y[i] = y; s->z[i] = z;
+    s->yaw[i] = yaw; s->pitch[i] = pitch; s->roll[i] = roll;
+    s->vx[i] = s->vy[i] = s->vz[i] = 0.0f;
+    return i;
+}
+
+int EntityStoreRemove(EntityStore *s, int i)
+{
+    if (i < 0 || i >= s->count) return -1;
+    int last = --s->count;
+    if (i == last) return -1;
+    s->x[i] = s->x[last]; s->y[i] = s->y[last]; s->z[i] = s->z[last];
+    s->yaw[i] = s->yaw[last]; s->pitch[i] = s->pitch[last]; s->roll[i] = s->roll[last];
+    s->vx[i] = s->vx[last]; s->vy[i] = s->vy[last]; s->vz[i] = s->vz[last];
+    return last;
+}
+
+bool BasisStoreInit(BasisStore *b, int capacity)
+{
+    memset(b, 0, sizeof(*b));
+    if (capacity < 1) capacity = 1;
+    int lanes = PadLanes(capacity);
+    float **arrays[] = { &b->rx, &b->ry, &b->rz, &b->fx, &b->fy, &b->fz,
+                         &b->ux, &b->uy, &b->uz, &b->AzR, &b->ElR };
+    b->mem = AllocSoA((int)(sizeof(arrays)/sizeof(arrays[0])), lanes, arrays);
+    if (!b->mem) return false;
+    b->capacity = lanes;
+    return true;
+}
+
+void BasisStoreFree(BasisStore *b)
+{
+    free(b->mem);
+    memset(b, 0, sizeof(*b));
+}
+
+bool PairResultsInit(PairResults *r, int capacity)
+{
+    memset(r, 0, sizeof(*r));
+    if (capacity < 1) capacity = 1;
+    int lanes = PadLanes(capacity);
+    float **arrays[] = { &r->AzT, &r->ElT, &r->AzR, &r->ElR,
+                         &r->j, &r->G, &r->E, &r->F, &r->J };
+    r->mem = AllocSoA((int)(sizeof(arrays)/sizeof(arrays[0])), lanes, arrays);
+    if (!r->mem) return false;
+    r->capacity = lanes;
+    return true;
+}
+
+void PairResultsFree(PairResults *r)
+{
+    free(r->mem);
+    memset(r, 0, sizeof(*r));
+}
+
+bool EntityPoolInit(EntityPool *p, const EntityStore *s)
+{
+    memset(p, 0, sizeof(*p));
+    int n = s->capacity > 0 ? s->capacity : 1;
+    p->mem = calloc((size_t)n, 2*sizeof(int) + 1);
+    if (!p->mem) return false;
+    p->ids = (int *)p->mem;
+    p->slot = p->ids + n;
+    p->renewed = (unsigned char *)(p->slot + n);
+    p->capacity = n;
+    for (int i = 0; i < n; ++i) p->ids[i] = p->slot[i] = i;
+    EntityPoolSync(p, s);
+    return true;
+}
+
+void EntityPoolFree(EntityPool *p)
+{
+    free(p->mem);
+    memset(p, 0, sizeof(*p));
+}
+
+/** Move o id livre @p id para a posição @p live de @c ids, tornando-o o vivo mais recente. */
+static void TakeId(EntityPool *p, int id)
+{
+    int k = p->slot[id], other = p->ids[p->live];
+    p->ids[k] = other; p->slot[other] = k;
+    p->ids[p->live] = id; p->slot[id] = p->live;
+    p->live++;
+    if (p->live > p->peak) p->peak = p->live;
+}
+
+/** Flags index @p i as holding a different entity than before. */
+static void MarkRenewed(EntityPool *p, int i)
+{
+    if (p->renewed[i]) return;
+    p->renewed[i] = 1;
+    p->renewedCount++;
+}
+
+void EntityPoolSync(EntityPool *p, const EntityStore *s)
+{
+    int n = s->count < p->capacity ? s->count : p->capacity;
+    while (p->live < n)
+    {
+        MarkRenewed(p, p->live);
+        TakeId(p, p->ids[p->live]);
+        p->spawned++;
+    }
+}
+
+int EntityPoolSpawn(EntityPool *p, EntityStore *s, float x, float y, float z,
+                    float yaw, float pitch, float roll)
+{
+    if (p->live >= p->capacity) return -1;
+    int id = p->ids[p->live];
+    return EntityPoolSpawnAt(p, s, id, x, y, z, yaw, pitch, roll) >= 0 ? id : -1;
+}
+
+int EntityPoolSpawnAt(EntityPool *p, EntityStore *s, int id, float x, float y, float z,
+                      float yaw, float pitch, float roll)
+{
+    if ((unsigned)id >= (unsigned)p->capacity) return -1;
+    if (p->slot[id] < p->live) return p->slot[id];
+    int i = EntityStoreAdd(s, x, y, z, yaw, pitch, roll);
+    if (i < 0) return -1;
+    TakeId(p, id);
+    MarkRenewed(p, i);
+    p->spawned++;
+    return i;
+}
+
+bool EntityPoolDespawn(EntityPool *p, EntityStore *s, int id)
+{
+    int i = EntityPoolIndex(p, id);
+    if (i < 0) return false;
+    // the store moves its last entity into i; the id permutation does the same
+    int last = p->live - 1, moved = p->ids[last];
+    EntityStoreRemove(s, i);
+    p->ids[i] = moved; p->slot[moved] = i;
+    p->ids[last] = id; p->slot[id] = last;
+    p->live--;
+    if (i != last) MarkRenewed(p, i);
+    p->despawned++;
+    return true;
+}
+
+void EntityPoolClearRenewed(EntityPool *p)
+{
+    if (p->renewedCount == 0) return;
+    memset(p->renewed, 0, (size_t)p->capacity);
+    p->renewedCount = 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file entities.h
+ * @brief Armazenamento de entidades (aeronaves/alvos) em estrutura de arrays (SoA).
+ *
+ * Posições e orientações ficam em buffers contíguos e alinhados, um por componente,
+ * para que o passe de ângulos percorra a memória de forma sequencial, sem
+ * indireções por ponteiro. Os resultados por par aeronave–alvo também são SoA.
+ */
+#ifndef WOE_ENTITIES_H
+#define WOE_ENTITIES_H
+
+#include <stdbool.h>
+
+/** Alinhamento (bytes) de cada array SoA; cobre uma linha de cache e AVX-512. */
+#define ENTITY_ALIGNMENT 64
+/** Capacidades são arredondadas para múltiplos deste número de floats (lanes). */
+#define ENTITY_LANE_PAD 16
+
+typedef struct BasisStore BasisStore;
+
+/**
+ * @brief Conjunto de entidades com posição (x, y, z), orientação (yaw, pitch, roll) e velocidade (vx, vy, vz).
+ *
+ * Cada componente é um array de @c capacity floats, alinhado a ENTITY_ALIGNMENT.
+ * Os índices válidos são [0, count).
+ */
+typedef struct EntityStore {
+    int count;      /**< Número de entidades ativas. */
+    int capacity;   /**< Capacidade alocada (múltiplo de ENTITY_LANE_PAD). */
+    float *x;       /**< Posição X (unid). */
+    float *y;       /**< Posição Y (unid). */
+    float *z;       /**< Posição Z (unid). */
+    float *yaw;     /**< Yaw (rad). */
+    float *pitch;   /**< Pitch (rad). */
+    float *roll;    /**< Roll (rad). */
+    float *vx;      /**< Velocidade X (unid/s); estimada pela simulação, zero em EntityStoreAdd. */
+    float *vy;      /**< Velocidade Y (unid/s). */
+    float *vz;      /**< Velocidade Z (unid/s). */
+    const BasisStore *basis; /**< Opcional (não é dono): bases já calculadas da orientação atual; veja BasisStore. */
+    void *mem;      /**< Bloco único que contém todos os arrays. */
+} EntityStore;
+
+/**
+ * @brief Base de orientação (direita, frente, cima) de cada entidade, em SoA.
+ *
+ * São as colunas da matriz de rotação Rz(yaw)*Rx(pitch)*Ry(roll), calculadas
+ * uma vez por atualização com BasisStoreUpdate() (geometry.h), mais o Az/El
+ * do vetor frente. Quando um EntityStore aponta para uma BasisStore com o
+ * mesmo @c count, solver e renderer a usam em vez de refazer a trigonometria;
+ * quem muda a orientação depois disso deve chamar BasisStoreUpdate de novo.
+ */
+struct BasisStore {
+    int count;              /**< Entidades com base válida. */
+    int capacity;           /**< Capacidade alocada (múltiplo de ENTITY_LANE_PAD). */
+    float *rx, *ry, *rz;    /**< Eixo direito (+X do corpo). */
+    float *fx, *fy, *fz;    /**< Eixo frente (+Y do corpo), igual a ForwardFromYPR. */
+    float *ux, *uy, *uz;    /**< Eixo cima (+Z do corpo). */
+    float *AzR, *ElR;       /**< Azimute/elevação do eixo frente (rad). */
+    void *mem;              /**< Bloco único que contém todos os arrays. */
+};
+
+/**
+ * @brief Resultados do passe de ângulos para todos os pares aeronave–alvo.
+ *
+ * O par (a, t) fica no índice @c a*targets + t, de modo que os alvos de uma
+ * mesma aeronave são contíguos.
+ */
+typedef struct PairResults {
+    int aircraft;   /**< Número de aeronaves do último passe. */
+    int targets;    /**< Número de alvos do último passe. */
+    int capacity;   /**< Capacidade em pares. */
+    float *AzT;     /**< Azimute do alvo (rad). */
+    float *ElT;     /**< Elevação do alvo (rad). */
+    float *AzR;     /**< Azimute do vetor frente (rad). */
+    float *ElR;     /**< Elevação do vetor frente (rad). */
+    float *j;       /**< Ângulo j (rad). */
+    float *G;       /**< Ângulo G (rad). */
+    float *E;       /**< Ângulo E (rad). */
+    float *F;       /**< Ângulo F (rad). */
+    float *J;       /**< Ângulo J (rad). */
+    void *mem;      /**< Bloco único que contém todos os arrays. */
+} PairResults;
+
+/**
+ * @brief Inicializa um EntityStore vazio com a capacidade pedida.
+ * @param s Store a inicializar.
+ * @param capacity Número máximo de entidades.
+ * @return true em sucesso; false se a alocação falhar.
+ */
+bool EntityStoreInit(EntityStore *s, int capacity);
+
+/**
+ * @brief Libera a memória do store e o deixa zerado.
+ */
+void EntityStoreFree(EntityStore *s);
+
+/**
+ * @brief Adiciona uma entidade ao final do store.
+ * @return Índice da nova entidade, ou -1 se o store estiver cheio.
+ */
+int EntityStoreAdd(EntityStore *s, float x, float y, float z,
+                   float yaw, float pitch, float roll);
+
+/**
+ * @brief Remove a entidade @p i trazendo a última para o lugar dela.
+ *
+ * Mantém [0, count) contíguo; os índices das demais só mudam para a última.
+ * @return Índice antigo da entidade movida para @p i, ou -1 se nenhuma foi movida.
+ */
+int EntityStoreRemove(EntityStore *s, int i);
+
+/** @brief Reserva bases para até @p capacity entidades. */
+bool BasisStoreInit(BasisStore *b, int capacity);
+
+/** @brief Libera a memória das bases e as deixa zeradas. */
+void BasisStoreFree(BasisStore *b);
+
+/**
+ * @brief Inicializa o buffer de resultados para até @p capacity pares.
+ * @return true em sucesso; false se a alocação falhar.
+ */
+bool PairResultsInit(PairResults *r, int capacity);
+
+/**
+ * @brief Libera a memória dos resultados e os deixa zerados.
+ */
+void PairResultsFree(PairResults *r);
+
+/**
+ * @brief Slots de vida longa de um EntityStore: identificadores estáveis sobre índices densos.
+ *
+ * Cada entidade tem um identificador (handle) em [0, capacity) que não muda
+ * enquanto ela existe, mesmo quando remoções reorganizam o store. @c ids é
+ * uma permutação dos identificadores: os vivos em [0, live), na ordem dos
+ * índices do store, e os livres depois, o mais recentemente liberado
+ * primeiro; @c slot é a inversa. Criar e remover são O(1), sem alocação, e
+ * o slot de uma entidade removida é o primeiro reaproveitado.
+ *
+ * O pool é dono de @c count do store: enquanto ele estiver em uso, crie e
+ * remova só por EntityPoolSpawn/EntityPoolDespawn (ou adote as entidades
+ * acrescentadas por fora com EntityPoolSync).
+ */
+typedef struct EntityPool {
+    int capacity;       /**< Identificadores (a capacidade do store). */
+    int live;           /**< Entidades vivas; igual a @c count do store. */
+    int peak;           /**< Maior @c live desde EntityPoolInit. */
+    int *ids;           /**< [capacity] Identificadores: vivos por índice do store, depois os livres. */
+    int *slot;          /**< [capacity] Posição de cada identificador em @c ids. */
+    unsigned char *renewed;     /**< [capacity] 1 se o ocupante do índice mudou desde EntityPoolClearRenewed. */
+    int renewedCount;   /**< Índices marcados em @c renewed. */
+    long long spawned;  /**< Entidades criadas desde EntityPoolInit. */
+    long long despawned;    /**< Entidades removidas desde EntityPoolInit. */
+    void *mem;          /**< Bloco único de @c ids, @c slot e @c renewed. */
+} EntityPool;
+
+/**
+ * @brief Cria o pool de @p s e adota as entidades que ele já tem.
+ *
+ * A entidade de índice i recebe o identificador i.
+ */
+bool EntityPoolInit(EntityPool *p, const EntityStore *s);
+
+/** @brief Libera o pool (o store não é alterado). */
+void EntityPoolFree(EntityPool *p);
+
+/** @brief Adota as entidades acrescentadas a @p s por fora do pool (índices [live, count)). */
+void EntityPoolSync(EntityPool *p, const EntityStore *s);
+
+/**
+ * @brief Cria uma entidade no primeiro identificador livre.
+ * @return Identificador, ou -1 se o store estiver cheio.
+ */
+int EntityPoolSpawn(EntityPool *p, EntityStore *s, float x, float y, float z,
+                    float yaw, float pitch, float roll);
+
+/**
+ * @brief Garante que o identificador @p id esteja vivo, criando-o com o estado dado se não estiver.
+ *
+ * Uma entidade que já existe não é alterada.
+ * @return Índice da entidade no store, ou -1 se @p id estiver fora de [0, capacity).
+ */
+int EntityPoolSpawnAt(EntityPool *p, EntityStore *s, int id, float x, float y, float z,
+                      float yaw, float pitch, float roll);
+
+/**
+ * @brief Remove a entidade @p id; a última do store passa a ocupar o índice dela.
+ * @return false se @p id não estiver vivo.
+ */
+bool EntityPoolDespawn(EntityPool *p, EntityStore *s, int id);
+
+/** @brief Desmarca todos os índices de @c renewed. */
+void EntityPoolClearRenewed(EntityPool *p);
+
+/** @brief Índice no store da entidade @p id, ou -1 se ela não estiver viva. */
+static inline int EntityPoolIndex(const EntityPool *p, int id)
+{
+    if ((unsigned)id >= (unsigned)p->capacity) return -1;
+    int k = p->slot[id];
+    return k < p->live ? k : -1;
+}
+
+/**
+ * @brief Índice linear do par (a, t) em PairResults.
+ */
+static inline int PairIndex(const PairResults *r, int a, int t) { return a*r->targets + t; }
+
+#endif /* WOE_ENTITIES_H */
@@ -0,0 +1,179 @@
+/**
+ * @file fastmath.h
+ * @brief Trigonometria em float com níveis de precisão selecionáveis.
+ *
+ * Todas as funções recebem o nível (TrigTier) como primeiro argumento:
+ *  - TRIG_TIER_LIBM: chama a libm (sinf, cosf, ...), referência;
+ *  - TRIG_TIER_FLOAT: polinômios do Cephes, erro de poucos ULP (os mesmos usados
+ *    pelos kernels em lote de simd/angles_kernel.h);
+ *  - TRIG_TIER_VISUAL: polinômios de grau menor, erro absoluto abaixo de
+ *    TRIG_VISUAL_MAX_ERR rad; suficiente para HUD e anotações (a 220 px/rad
+ *    isso é menos de 0,05 px).
+ *
+ * As funções são static inline para que o switch do nível seja resolvido no
+ * ponto de chamada quando o nível é constante.
+ */
+#ifndef WOE_FASTMATH_H
+#define WOE_FASTMATH_H
+
+#include <math.h>
+
+/** Erro absoluto máximo (rad, ou unidade do resultado) do nível visual. */
+#define TRIG_VISUAL_MAX_ERR 1e-4f
+
+/** Níveis de precisão da trigonometria. */
+typedef enum TrigTier {
+    TRIG_TIER_LIBM = 0,  /**< libm (referência). */
+    TRIG_TIER_FLOAT,     /**< Precisão float plena, poucos ULP. */
+    TRIG_TIER_VISUAL,    /**< Precisão visual (HUD), ~1e-4. */
+    TRIG_TIER_COUNT
+} TrigTier;
+
+#define FM_PI     3.14159265358979323846f
+#define FM_PIO2   1.57079632679489661923f
+/** pi - FM_PI e pi/2 - FM_PIO2: a parte que o float arredonda para cima. */
+#define FM_PI_LO   -8.7422776e-8f
+#define FM_PIO2_LO -4.3711388e-8f
+#define FM_PIO4   0.78539816339744830962f
+#define FM_2OPI   0.63661977236758134308f
+#define FM_TAN_PIO8 0.4142135623730950f
+
+/** Nome curto do nível ("libm", "float", "visual"). */
+static inline const char *TrigTierName(TrigTier t)
+{
+    switch (t) {
+        case TRIG_TIER_LIBM:   return "libm";
+        case TRIG_TIER_FLOAT:  return "float";
+        case TRIG_TIER_VISUAL: return "visual";
+        default: return "?";
+    }
+}
+
+/**
+ * @brief Seno e cosseno polinomiais após redução por pi/2 (Cody–Waite).
+ * @param t Nível (FLOAT ou VISUAL).
+ * @param x Ângulo (rad).
+ * @param s [out] Seno.
+ * @param c [out] Cosseno.
+ */
+static inline void FmSinCosPoly(TrigTier t, float x, float *s, float *c)
+{
+    // k = floor(x*2/pi + 0.5) in integer arithmetic: the quadrant comes from its low bits
+    float y = x*FM_2OPI + 0.5f;
+    int q = (int)y;
+    q -= (float)q > y;
+    float k = (float)q;
+    float r = x - k*1.5703125f;
+    r = r - k*4.837512969970703125e-4f;
+    r = r - k*7.54978995489188216e-8f;
+
+    float z = r*r, ps, pc;
+    if (t == TRIG_TIER_VISUAL) {
+        // minimax on [-pi/4, pi/4]: sin of degree 5, cos of degree 4 (max error 1.3e-5)
+        ps = (8.1646087e-3f*z - 1.6663459e-1f)*z*r + r;
+        pc = (4.0488936e-2f*z - 4.9977631e-1f)*z + 1.0f;
+    } else {
+        ps = ((-1.9515295891e-4f*z + 8.3321608736e-3f)*z - 1.6666654611e-1f)*z*r + r;
+        pc = ((2.443315711809948e-5f*z - 1.388731625493765e-3f)*z + 4.166664568298827e-2f)*z*z - 0.5f*z + 1.0f;
+    }
+    // odd quadrants swap sin and cos; sin < 0 for q in {2,3}, cos < 0 for q in {1,2}. Done on the
+    // bits: with arbitrary angles a branch per quadrant test mispredicts about half the time
+    union { float f; unsigned int u; } bs = { ps }, bc = { pc }, rs, rc;
+    unsigned int odd = 0u - (unsigned int)(q & 1);
+    rs.u = ((bs.u & ~odd) | (bc.u & odd)) ^ ((unsigned int)(q & 2) << 30);
+    rc.u = ((bc.u & ~odd) | (bs.u & odd)) ^ ((unsigned int)((q + 1) & 2) << 30);
+    *s = rs.f;
+    *c = rc.f;
+}
+
+/** @brief Seno e cosseno de @p x no nível @p t. */
+static inline void TrigSinCos(TrigTier t, float x, float *s, float *c)
+{
+    if (t == TRIG_TIER_LIBM) { *s = sinf(x); *c = cosf(x); return; }
+    FmSinCosPoly(t, x, s, c);
+}
+
+/** @brief Seno no nível @p t. */
+static inline float TrigSin(TrigTier t, float x)
+{
+    if (t == TRIG_TIER_LIBM) return sinf(x);
+    float s, c; FmSinCosPoly(t, x, &s, &c);
+    return s;
+}
+
+/** @brief Cosseno no nível @p t. */
+static inline float TrigCos(TrigTier t, float x)
+{
+    if (t == TRIG_TIER_LIBM) return cosf(x);
+    float s, c; FmSinCosPoly(t, x, &s, &c);
+    return c;
+}
+
+/** @brief Tangente no nível @p t. */
+static inline float TrigTan(TrigTier t, float x)
+{
+    if (t == TRIG_TIER_LIBM) return tanf(x);
+    float s, c; FmSinCosPoly(t, x, &s, &c);
+    return s/c;
+}
+
+/** @brief atan2(y, x) no nível @p t; mesmas convenções de quadrante da libm. */
+static inline float TrigAtan2(TrigTier t, float y, float x)
+{
+    if (t == TRIG_TIER_LIBM) return atan2f(y, x);
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = ax > ay ? ax : ay, mn = ax > ay ? ay : ax;
+    float a = mx > 0.0f ? mn/mx : 0.0f;
+
+    // atan on [0,1]: shift by pi/4 above tan(pi/8)
+    float base = 0.0f;
+    if (a > FM_TAN_PIO8) { a = (a - 1.0f)/(a + 1.0f); base = FM_PIO4; }
+    float z = a*a, p;
+    if (t == TRIG_TIER_VISUAL)
+        p = (1.8107491e-1f*z - 3.3301977e-1f)*z;
+    else
+        p = (((8.05374449538e-2f*z - 1.38776856032e-1f)*z + 1.99777106478e-1f)*z - 3.33329491539e-1f)*z;
+    float r = base + (p*a + a);   // grouped as K_atan2 does, so both round alike
+
+    // FM_PI is above pi: fold the low part in first so results near +-pi round to the correct
+    // side of it, as atan2f does; otherwise sin(atan2(y, x)) can come back with the wrong sign
+    if (ay > ax) r = FM_PIO2 + (FM_PIO2_LO - r);
+    if (signbit(x)) r = FM_PI + (FM_PI_LO - r);
+    return copysignf(r, y);
+}
+
+/** Polinômio de asin para |v| <= 0.5. */
+static inline float FmAsinPoly(TrigTier t, float v)
+{
+    float z = v*v, p;
+    if (t == TRIG_TIER_VISUAL)
+        p = ((5.7553389e-2f*z + 7.3845099e-2f)*z + 1.6668092e-1f)*z;
+    else
+        p = ((((4.2163199048e-2f*z + 2.4181311049e-2f)*z + 4.5470025998e-2f)*z + 7.4953002686e-2f)*z + 1.6666752422e-1f)*z;
+    return p*v + v;
+}
+
+/** @brief asin(x) no nível @p t, com clamp de x em [-1, 1]. */
+static inline float TrigAsin(TrigTier t, float x)
+{
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+    if (t == TRIG_TIER_LIBM) return asinf(x);
+    float a = fabsf(x), r;
+    if (a > 0.5f) r = FM_PIO2 - 2.0f*FmAsinPoly(t, sqrtf(0.5f*(1.0f - a)));
+    else r = FmAsinPoly(t, a);
+    return copysignf(r, x);
+}
+
+/** @brief acos(x) no nível @p t, com clamp de x em [-1, 1]. */
+static inline float TrigAcos(TrigTier t, float x)
+{
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+    if (t == TRIG_TIER_LIBM) return acosf(x);
+    if (x > 0.5f) return 2.0f*FmAsinPoly(t, sqrtf(0.5f*(1.0f - x)));
+    if (x < -0.5f) return FM_PI - 2.0f*FmAsinPoly(t, sqrtf(0.5f*(1.0f + x)));
+    return FM_PIO2 - FmAsinPoly(t, x);
+}
+
+#endif /* WOE_FASTMATH_H */
@@ -0,0 +1,466 @@
+/**
+ * @file geometry.c
+ * @brief Implementação da geometria de engajamento (sem dependência da raylib).
+ */
+#include "geometry.h"
+#include "simd/angles_simd.h"
+#include "threads.h"
+
+#include <stddef.h>
+
+/**
+ * Nível de precisão da trigonometria do solver (ComputeAzEl, ForwardFromYPR, ...).
+ * A thread da simulação o troca entre passos, então só é acessado de forma atômica e
+ * lido uma vez por chamada pública; o núcleo recebe o nível já lido.
+ */
+static volatile int solverTier = TRIG_TIER_LIBM;
+
+void SetSolverTrigTier(TrigTier tier)
+{
+    if (tier >= 0 && tier < TRIG_TIER_COUNT) WoeAtomicStore(&solverTier, (int)tier);
+}
+
+TrigTier GetSolverTrigTier(void)
+{
+    return (TrigTier)WoeAtomicLoad(&solverTier);
+}
+
+static inline float V3Dot(WoeVec3 a, WoeVec3 b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+static inline WoeVec3 V3Cross(WoeVec3 a, WoeVec3 b)
+{
+    return (WoeVec3){ a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x };
+}
+
+static inline float V3Length(WoeVec3 v) { return sqrtf(V3Dot(v, v)); }
+
+/** Az/El da direção @p d no nível @p tier (ComputeAzEl e ComputeAzElFromVector). */
+static inline void AzElOf(TrigTier tier, WoeVec3 d, float *Az, float *El)
+{
+    float horiz = sqrtf(d.x*d.x + d.y*d.y);
+    float az = TrigAtan2(tier, d.x, d.y); // note order per user's formula
+    float el = TrigAtan2(tier, d.z, horiz);
+    if (Az) *Az = az;
+    if (El) *El = el;
+}
+
+void ComputeAzEl(WoeVec3 A, WoeVec3 T, float *Az, float *El)
+{
+    ComputeAzElTier(A, T, GetSolverTrigTier(), Az, El);
+}
+
+void ComputeAzElTier(WoeVec3 A, WoeVec3 T, TrigTier tier, float *Az, float *El)
+{
+    AzElOf(tier, (WoeVec3){ T.x - A.x, T.y - A.y, T.z - A.z }, Az, El);
+}
+
+/**
+ * Nível da orientação (base, vetor frente e seu Az/El) para o nível @p tier do solver:
+ * fora da libm é sempre o float, o dos polinômios de ComputeBasisBatch, para que o
+ * caminho escalar e o da BasisStore deem a mesma frente também no visual.
+ */
+static inline TrigTier OrientationTier(TrigTier tier)
+{
+    return tier == TRIG_TIER_LIBM ? TRIG_TIER_LIBM : TRIG_TIER_FLOAT;
+}
+
+/** ForwardFromYPR no nível @p tier. */
+static inline WoeVec3 ForwardOf(TrigTier tier, float yaw, float pitch)
+{
+    // Middle column of R = Rz(yaw) * Rx(pitch) * Ry(roll): Ry leaves +Y alone, so roll drops out.
+    // The column is unit length by construction; no normalization needed.
+    // x is 0 - sy*cp, not -(sy*cp): at yaw = 0 the latter is -0, atan2 turns it into AzR = -0
+    // and the chain's D/E branches flip to the mirrored G.
+    float cy, sy; TrigSinCos(tier, yaw, &sy, &cy);
+    float cp, sp; TrigSinCos(tier, pitch, &sp, &cp);
+    return (WoeVec3){ 0.0f - sy*cp, cy*cp, sp };
+}
+
+WoeVec3 ForwardFromYPR(float yaw, float pitch, float roll)
+{
+    (void)roll;
+    return ForwardOf(OrientationTier(GetSolverTrigTier()), yaw, pitch);
+}
+
+/** BasisFromYPR no nível @p tier. */
+static inline WoeBasis BasisOf(TrigTier tier, float yaw, float pitch, float roll)
+{
+    float cy, sy; TrigSinCos(tier, yaw, &sy, &cy);
+    float cp, sp; TrigSinCos(tier, pitch, &sp, &cp);
+    float cr, sr; TrigSinCos(tier, roll, &sr, &cr);
+    // columns of Rz(yaw) * Rx(pitch) * Ry(roll); fwd is written exactly as in ForwardFromYPR
+    WoeBasis b;
+    b.right = (WoeVec3){ cy*cr - sy*sp*sr, sy*cr + cy*sp*sr, -cp*sr };
+    b.fwd = (WoeVec3){ 0.0f - sy*cp, cy*cp, sp };
+    b.up = (WoeVec3){ cy*sr + sy*sp*cr, sy*sr - cy*sp*cr, cp*cr };
+    return b;
+}
+
+WoeBasis BasisFromYPR(float yaw, float pitch, float roll)
+{
+    return BasisOf(OrientationTier(GetSolverTrigTier()), yaw, pitch, roll);
+}
+
+void BasisStoreUpdate(BasisStore *b, const EntityStore *s)
+{
+    int n = s->count < b->capacity ? s->count : b->capacity;
+    if (GetSolverTrigTier() != TRIG_TIER_LIBM)
+    {
+        // one SIMD pass over the store; libm stays the per-entity reference below
+        ComputeBasisBatch(n, s->yaw, s->pitch, s->roll, b->rx, b->ry, b->rz, b->fx, b->fy, b->fz,
+                          b->ux, b->uy, b->uz, b->AzR, b->ElR);
+        b->count = n;
+        return;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        WoeBasis e = BasisOf(TRIG_TIER_LIBM, s->yaw[i], s->pitch[i], s->roll[i]);
+        b->rx[i] = e.right.x; b->ry[i] = e.right.y; b->rz[i] = e.right.z;
+        b->fx[i] = e.fwd.x;   b->fy[i] = e.fwd.y;   b->fz[i] = e.fwd.z;
+        b->ux[i] = e.up.x;    b->uy[i] = e.up.y;    b->uz[i] = e.up.z;
+        AzElOf(TRIG_TIER_LIBM, e.fwd, &b->AzR[i], &b->ElR[i]);
+    }
+    b->count = n;
+}
+
+/** Base e Az/El da entidade @p i calculados na hora no nível @p tier, pelo mesmo caminho de BasisStoreUpdate. */
+static WoeBasis EntityBasisNow(TrigTier tier, const EntityStore *s, int i, float *AzR, float *ElR)
+{
+    WoeBasis e;
+    if (tier == TRIG_TIER_LIBM)
+    {
+        e = BasisOf(TRIG_TIER_LIBM, s->yaw[i], s->pitch[i], s->roll[i]);
+        AzElOf(TRIG_TIER_LIBM, e.fwd, AzR, ElR);
+        return e;
+    }
+    ComputeBasisBatch(1, &s->yaw[i], &s->pitch[i], &s->roll[i], &e.right.x, &e.right.y, &e.right.z,
+                      &e.fwd.x, &e.fwd.y, &e.fwd.z, &e.up.x, &e.up.y, &e.up.z, AzR, ElR);
+    return e;
+}
+
+/** EntityForward com o nível @p tier usado quando o instantâneo não traz a base. */
+static void EntityForwardOf(TrigTier tier, const EntityStore *s, int i, WoeVec3 *fwd, float *AzR, float *ElR)
+{
+    const BasisStore *b = s->basis;
+    if (b && b->count == s->count)
+    {
+        *fwd = (WoeVec3){ b->fx[i], b->fy[i], b->fz[i] };
+        *AzR = b->AzR[i];
+        *ElR = b->ElR[i];
+        return;
+    }
+    *fwd = EntityBasisNow(tier, s, i, AzR, ElR).fwd;
+}
+
+void EntityForward(const EntityStore *s, int i, WoeVec3 *fwd, float *AzR, float *ElR)
+{
+    EntityForwardOf(GetSolverTrigTier(), s, i, fwd, AzR, ElR);
+}
+
+WoeBasis EntityBasis(const EntityStore *s, int i)
+{
+    const BasisStore *b = s->basis;
+    if (b && b->count == s->count) return BasisAt(b, i);
+    TrigTier tier = GetSolverTrigTier();
+    if (tier == TRIG_TIER_LIBM) return BasisOf(TRIG_TIER_LIBM, s->yaw[i], s->pitch[i], s->roll[i]);
+    return EntityBasisNow(tier, s, i, NULL, NULL);
+}
+
+void ComputeAzElFromVector(WoeVec3 v, float *Az, float *El)
+{
+    AzElOf(OrientationTier(GetSolverTrigTier()), v, Az, El);
+}
+
+/**
+ * @brief Cadeia de ComputeSphericalAngles no nível @p tier com as saídas @p outs (WOE_SOLVE_OUT_*),
+ *        constante em cada chamada.
+ *
+ * Inline nas três entradas públicas, para o compilador podar o que não é
+ * pedido; as saídas pedidas são obrigatórias.
+ */
+static inline void SphericalChain(TrigTier tier, float AzT, float ElT, float AzR, float ElR, int outs,
+                                  float *out_j, float *out_G, float *out_E, float *out_F, float *out_J)
+{
+    float cf = TrigCos(tier, AzT)*TrigCos(tier, ElT);
+    float f = TrigAcos(tier, cf);
+
+    float ch = TrigCos(tier, AzR)*TrigCos(tier, ElR);
+    float h = TrigAcos(tier, ch);
+
+    // ctn(C) = sin(AzT)/tan(ElT) => C = atan2(tan(ElT), sin(AzT))
+    float C = TrigAtan2(tier, TrigTan(tier, ElT), TrigSin(tier, AzT));
+    // ctn(D) = sin(AzR)/tan(ElR) => D = atan2(tan(ElR), sin(AzR))
+    float D = TrigAtan2(tier, TrigTan(tier, ElR), TrigSin(tier, AzR));
+
+    float J = (float)M_PI - C - D;
+
+    // cos(j) = cos(f)cos(h) + sin(f)sin(h)cos(J)
+    float sin_f, cos_f; TrigSinCos(tier, f, &sin_f, &cos_f);
+    float sin_h, cos_h; TrigSinCos(tier, h, &sin_h, &cos_h);
+    float j = TrigAcos(tier, cos_f*cos_h + sin_f*sin_h*TrigCos(tier, J));
+    *out_j = j;
+    if (outs & WOE_SOLVE_OUT_EFJ) *out_J = J;
+    if (!(outs & (WOE_SOLVE_OUT_G | WOE_SOLVE_OUT_EFJ))) return;
+
+    // E from ctn(E) = sin(ElR)/tan(AzR) => E = atan2(tan(AzR), sin(ElR))
+    float E = TrigAtan2(tier, TrigTan(tier, AzR), TrigSin(tier, ElR));
+
+    // F via sin(F) = sin(J)*sin(f)/sin(j)
+    float denom = TrigSin(tier, j);
+    float F = 0.0f;
+    if (fabsf(denom) > 1e-6f) {
+        float s = TrigSin(tier, J)*sin_f/denom;
+        F = TrigAsin(tier, s);
+    } else {
+        F = 0.0f;
+    }
+
+    if (outs & WOE_SOLVE_OUT_G) *out_G = (float)M_PI - E - F;
+    if (outs & WOE_SOLVE_OUT_EFJ)
+    {
+        *out_E = E;
+        *out_F = F;
+    }
+}
+
+void ComputeSphericalAngles(float AzT, float ElT, float AzR, float ElR,
+                            float *out_j, float *out_G,
+                            float *out_E, float *out_F, float *out_J)
+{
+    float j, G, E, F, J;
+    SphericalChain(GetSolverTrigTier(), AzT, ElT, AzR, ElR, WOE_SOLVE_OUT_ALL, &j, &G, &E, &F, &J);
+    if (out_j) *out_j = j;
+    if (out_G) *out_G = G;
+    if (out_E) *out_E = E;
+    if (out_F) *out_F = F;
+    if (out_J) *out_J = J;
+}
+
+void ComputeSphericalAnglesJG(float AzT, float ElT, float AzR, float ElR, float *out_j, float *out_G)
+{
+    SphericalChain(GetSolverTrigTier(), AzT, ElT, AzR, ElR, WOE_SOLVE_OUT_J | WOE_SOLVE_OUT_G, out_j, out_G, NULL, NULL, NULL);
+}
+
+float ComputeSphericalAnglesJ(float AzT, float ElT, float AzR, float ElR)
+{
+    float j;
+    SphericalChain(GetSolverTrigTier(), AzT, ElT, AzR, ElR, WOE_SOLVE_OUT_J, &j, NULL, NULL, NULL, NULL);
+    return j;
+}
+
+/** ComputeSphericalAnglesVector no nível @p tier. */
+static inline void VectorAngles(TrigTier tier, WoeVec3 fwd, WoeVec3 los, float *out_j, float *out_G)
+{
+    WoeVec3 M = { -fwd.x, fwd.y, fwd.z };
+    WoeVec3 c = V3Cross(los, M);
+    float cl = V3Length(c), lm = V3Dot(los, M);
+    float j = TrigAtan2(tier, cl, lm);
+
+    // F: angle at M from L to the +Y pole, folded into [-pi/2, pi/2] as asinf does in the chain.
+    // The cosine term is (M.M) L.y - M.y (L.M) with the M.y^2 L.y parts cancelled by hand,
+    // so it keeps its digits when M nears -Y (the chain's h -> pi).
+    // On the Y axis itself (zero orientation) the pole direction is undefined; the chain's D = 0
+    // limit takes +X in its place.
+    float mxz = M.x*M.x + M.z*M.z, rm = sqrtf(mxz + M.y*M.y);
+    float sn = rm*(M.x*los.z - M.z*los.x), cs = mxz*los.y - M.y*(M.x*los.x + M.z*los.z);
+    if (mxz == 0.0f) { sn = -M.y*los.z; cs = fabsf(M.y)*los.x; }
+    float F = -TrigAtan2(tier, sn, cs);
+    if (F > 0.5f*(float)M_PI) F = (float)M_PI - F;
+    else if (F < -0.5f*(float)M_PI) F = -(float)M_PI - F;
+    if (cl <= 1e-6f*sqrtf(cl*cl + lm*lm)) F = 0.0f;    // the chain's |sin(j)| <= 1e-6 cut
+
+    // E = atan2(tan(AzR), sin(ElR)) with both arguments scaled by |R.y|*|R|, keeping tan's branch
+    float E = TrigAtan2(tier, (M.y < 0 ? M.x : -M.x)*rm, fabsf(M.y)*M.z);
+    float G = (float)M_PI - E - F;
+
+    if (out_j) *out_j = j;
+    if (out_G) *out_G = G;
+}
+
+void ComputeSphericalAnglesVector(WoeVec3 fwd, WoeVec3 los, float *out_j, float *out_G)
+{
+    VectorAngles(GetSolverTrigTier(), fwd, los, out_j, out_G);
+}
+
+void ForwardFromYPRBatch(int n, const float *yaw, const float *pitch, const float *roll,
+                         float *out_x, float *out_y, float *out_z)
+{
+    TrigTier tier = GetSolverTrigTier();
+    if (tier != TRIG_TIER_LIBM)
+    {
+        ComputeBasisBatch(n, yaw, pitch, roll, NULL, NULL, NULL, out_x, out_y, out_z, NULL, NULL, NULL, NULL, NULL);
+        return;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        WoeVec3 f = ForwardOf(TRIG_TIER_LIBM, yaw[i], pitch[i]);
+        out_x[i] = f.x; out_y[i] = f.y; out_z[i] = f.z;
+    }
+}
+
+void ComputeAzElFromVectorBatch(int n, const float *vx, const float *vy, const float *vz,
+                                float *out_Az, float *out_El)
+{
+    TrigTier tier = OrientationTier(GetSolverTrigTier());
+    for (int i = 0; i < n; ++i)
+    {
+        WoeVec3 v = { vx[i], vy[i], vz[i] };
+        AzElOf(tier, v, out_Az ? &out_Az[i] : NULL, out_El ? &out_El[i] : NULL);
+    }
+}
+
+/** ComputeSphericalAnglesVectorBatch no nível @p tier. */
+static void VectorAnglesBatch(TrigTier tier, int n, WoeVec3 fwd, float ax, float ay, float az,
+                              const float *tx, const float *ty, const float *tz, float *out_j, float *out_G)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        WoeVec3 los = { tx[i] - ax, ty[i] - ay, tz[i] - az };
+        VectorAngles(tier, fwd, los, out_j ? &out_j[i] : NULL, out_G ? &out_G[i] : NULL);
+    }
+}
+
+void ComputeSphericalAnglesVectorBatch(int n, WoeVec3 fwd, float ax, float ay, float az,
+                                       const float *tx, const float *ty, const float *tz,
+                                       float *out_j, float *out_G)
+{
+    VectorAnglesBatch(GetSolverTrigTier(), n, fwd, ax, ay, az, tx, ty, tz, out_j, out_G);
+}
+
+/**
+ * Alvos por bloco do solver paralelo. Cada par lê 3 floats e grava 9 (~48 B),
+ * então 512 alvos ocupam ~24 KiB: entradas e saídas do bloco cabem no L1D.
+ */
+#define SOLVE_TILE_TARGETS 512
+
+/** Zera @p n posições de @p col a partir de @p base (colunas fora de WOE_SOLVE_OUTPUTS). */
+static inline void ZeroColumn(float *col, int base, int n)
+{
+    for (int t = 0; t < n; ++t) col[base + t] = 0.0f;
+}
+
+/** SolveEngagementRowForward no nível @p tier. */
+static void SolveRowForward(TrigTier tier, const EntityStore *air, int a, WoeVec3 fwd, float AzR, float ElR,
+                            int n, const float *tx, const float *ty, const float *tz,
+                            PairResults *out, int base, SolverMode mode)
+{
+    for (int t = 0; t < n; ++t)
+    {
+        out->AzR[base + t] = AzR;
+        out->ElR[base + t] = ElR;
+    }
+    if (!(WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_G)) ZeroColumn(out->G, base, n);
+    if (mode == SOLVER_VECTOR || !(WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_EFJ))
+    {
+        ZeroColumn(out->E, base, n);
+        ZeroColumn(out->F, base, n);
+        ZeroColumn(out->J, base, n);
+    }
+    if (mode == SOLVER_VECTOR)
+    {
+        ComputeAzElBatch(n, air->x[a], air->y[a], air->z[a], tx, ty, tz, &out->AzT[base], &out->ElT[base]);
+        VectorAnglesBatch(tier, n, fwd, air->x[a], air->y[a], air->z[a], tx, ty, tz, &out->j[base],
+                          (WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_G) ? &out->G[base] : NULL);
+        return;
+    }
+    if (mode == SOLVER_SCALAR)
+    {
+        WoeVec3 A = { air->x[a], air->y[a], air->z[a] };
+        for (int t = 0; t < n; ++t)
+        {
+            int k = base + t;
+            WoeVec3 T = { tx[t], ty[t], tz[t] };
+            ComputeAzElTier(A, T, tier, &out->AzT[k], &out->ElT[k]);
+#if WOE_SOLVE_OUTPUTS == WOE_SOLVE_OUT_ALL
+            SphericalChain(tier, out->AzT[k], out->ElT[k], AzR, ElR, WOE_SOLVE_OUT_ALL,
+                           &out->j[k], &out->G[k], &out->E[k], &out->F[k], &out->J[k]);
+#elif WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_G
+            SphericalChain(tier, out->AzT[k], out->ElT[k], AzR, ElR, WOE_SOLVE_OUT_J | WOE_SOLVE_OUT_G,
+                           &out->j[k], &out->G[k], NULL, NULL, NULL);
+#else
+            SphericalChain(tier, out->AzT[k], out->ElT[k], AzR, ElR, WOE_SOLVE_OUT_J,
+                           &out->j[k], NULL, NULL, NULL, NULL);
+#endif
+        }
+        return;
+    }
+    ComputeAzElBatch(n, air->x[a], air->y[a], air->z[a], tx, ty, tz, &out->AzT[base], &out->ElT[base]);
+#if WOE_SOLVE_OUTPUTS == WOE_SOLVE_OUT_ALL
+    ComputeSphericalAnglesBatch(n, &out->AzT[base], &out->ElT[base], &out->AzR[base], &out->ElR[base],
+                                &out->j[base], &out->G[base], &out->E[base], &out->F[base], &out->J[base]);
+#elif WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_G
+    ComputeSphericalAnglesJGBatch(n, &out->AzT[base], &out->ElT[base], &out->AzR[base], &out->ElR[base],
+                                  &out->j[base], &out->G[base]);
+#else
+    ComputeSphericalAnglesJBatch(n, &out->AzT[base], &out->ElT[base], &out->AzR[base], &out->ElR[base],
+                                 &out->j[base]);
+#endif
+}
+
+void SolveEngagementRowForward(const EntityStore *air, int a, WoeVec3 fwd, float AzR, float ElR,
+                               int n, const float *tx, const float *ty, const float *tz,
+                               PairResults *out, int base, SolverMode mode)
+{
+    SolveRowForward(GetSolverTrigTier(), air, a, fwd, AzR, ElR, n, tx, ty, tz, out, base, mode);
+}
+
+void SolveEngagementRow(const EntityStore *air, int a, int n, const float *tx, const float *ty, const float *tz,
+                        PairResults *out, int base, SolverMode mode)
+{
+    SolveEngagementRowTier(air, a, n, tx, ty, tz, out, base, mode, GetSolverTrigTier());
+}
+
+void SolveEngagementRowTier(const EntityStore *air, int a, int n, const float *tx, const float *ty, const float *tz,
+                            PairResults *out, int base, SolverMode mode, TrigTier tier)
+{
+    WoeVec3 fwd;
+    float AzR = 0, ElR = 0;
+    EntityForwardOf(tier, air, a, &fwd, &AzR, &ElR);
+    SolveRowForward(tier, air, a, fwd, AzR, ElR, n, tx, ty, tz, out, base, mode);
+}
+
+/** Resolve os pares (a, t) com t em [t0, t1) e grava em out (dimensões já definidas). */
+static void SolveSegment(const EntityStore *air, const EntityStore *tgt, PairResults *out, SolverMode mode,
+                         int a, int t0, int t1)
+{
+    SolveEngagementRow(air, a, t1 - t0, tgt->x + t0, tgt->y + t0, tgt->z + t0, out, a*tgt->count + t0, mode);
+}
+
+void SolveEngagements(const EntityStore *air, const EntityStore *tgt, PairResults *out, SolverMode mode)
+{
+    if (air->count*tgt->count > out->capacity) return;
+    out->aircraft = air->count;
+    out->targets = tgt->count;
+    for (int a = 0; a < air->count; ++a) SolveSegment(air, tgt, out, mode, a, 0, tgt->count);
+}
+
+/** Contexto de um despacho de SolveEngagementsParallel. */
+typedef struct SolveTiles {
+    const EntityStore *air;
+    const EntityStore *tgt;
+    PairResults *out;
+    SolverMode mode;
+    int tilesPerRow;
+} SolveTiles;
+
+static void SolveTileJob(void *ctx, int job, int worker)
+{
+    const SolveTiles *st = (const SolveTiles *)ctx;
+    (void)worker;
+    int a = job/st->tilesPerRow;
+    int t0 = (job - a*st->tilesPerRow)*SOLVE_TILE_TARGETS;
+    int t1 = t0 + SOLVE_TILE_TARGETS < st->tgt->count ? t0 + SOLVE_TILE_TARGETS : st->tgt->count;
+    SolveSegment(st->air, st->tgt, st->out, st->mode, a, t0, t1);
+}
+
+void SolveEngagementsParallel(JobPool *pool, const EntityStore *air, const EntityStore *tgt,
+                              PairResults *out, SolverMode mode)
+{
+    if (!pool || JobPoolThreads(pool) <= 1) { SolveEngagements(air, tgt, out, mode); return; }
+    if (air->count*tgt->count > out->capacity) return;
+    out->aircraft = air->count;
+    out->targets = tgt->count;
+
+    SolveTiles st = { air, tgt, out, mode, (tgt->count + SOLVE_TILE_TARGETS - 1)/SOLVE_TILE_TARGETS };
+    JobPoolRun(pool, air->count*st.tilesPerRow, SolveTileJob, &st);
+}
@@ -0,0 +1,327 @@
+/**
+ * @file geometry.h
+ * @brief Geometria de engajamento: Az/El, vetor frente e ângulos esféricos j, G, E, F, J.
+ *
+ * Não depende da raylib. WoeVec3 tem o mesmo layout de Vector3 (três floats).
+ * Cada função escalar tem ao lado uma entrada em lote sobre arrays SoA; as
+ * versões em lote da cadeia esférica ficam em simd/angles_simd.h.
+ */
+#ifndef WOE_GEOMETRY_H
+#define WOE_GEOMETRY_H
+
+#include "entities.h"
+#include "fastmath.h"
+#include "jobs.h"
+
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @defgroup solveoutputs Colunas calculadas pelo solver de pares
+ * @brief Escolhidas na compilação: WOE_SOLVE_J_ONLY ou WOE_SOLVE_J_G (opção WOE_SOLVE_OUTPUTS do CMake).
+ *
+ * Por padrão SolveEngagements e seus derivados (descarte, recálculo
+ * incremental, predição) gravam j, G, E, F e J. Com WOE_SOLVE_J_G só j e G
+ * são calculados; com WOE_SOLVE_J_ONLY, só j. As colunas não calculadas são
+ * zeradas, como E/F/J em SOLVER_VECTOR, e Az/El de alvo e frente continuam
+ * gravados. O macro vale para a biblioteca e para quem lê os resultados.
+ * @{
+ */
+#define WOE_SOLVE_OUT_J   1    /**< Coluna j. */
+#define WOE_SOLVE_OUT_G   2    /**< Coluna G. */
+#define WOE_SOLVE_OUT_EFJ 4    /**< Colunas E, F e J. */
+#define WOE_SOLVE_OUT_ALL (WOE_SOLVE_OUT_J | WOE_SOLVE_OUT_G | WOE_SOLVE_OUT_EFJ)
+#if defined(WOE_SOLVE_J_ONLY) && defined(WOE_SOLVE_J_G)
+#error "WOE_SOLVE_J_ONLY e WOE_SOLVE_J_G sao exclusivos"
+#elif defined(WOE_SOLVE_J_ONLY)
+#define WOE_SOLVE_OUTPUTS WOE_SOLVE_OUT_J
+#elif defined(WOE_SOLVE_J_G)
+#define WOE_SOLVE_OUTPUTS (WOE_SOLVE_OUT_J | WOE_SOLVE_OUT_G)
+#else
+/** Colunas que o solver de pares calcula neste build (WOE_SOLVE_OUT_*). */
+#define WOE_SOLVE_OUTPUTS WOE_SOLVE_OUT_ALL
+#endif
+/** @} */
+
+/** Vetor 3D (mundo Z-up), compatível em layout com Vector3 da raylib. */
+typedef struct WoeVec3 { float x, y, z; } WoeVec3;
+
+/** Caminho de cálculo dos ângulos por par. */
+typedef enum SolverMode {
+    SOLVER_BATCH = 0,   /**< Cadeia esférica nos kernels em lote (SIMD). */
+    SOLVER_SCALAR,      /**< Cadeia esférica escalar, referência. */
+    SOLVER_VECTOR,      /**< Solver vetorial: j e G por produtos escalar/vetorial. */
+    SOLVER_MODE_COUNT
+} SolverMode;
+
+/**
+ * @brief Converte graus para radianos.
+ * @param deg Valor em graus.
+ * @return Valor em radianos.
+ */
+static inline float rad(float deg) { return deg*(float)M_PI/180.0f; }
+
+/**
+ * @brief Converte radianos para graus.
+ * @param radv Valor em radianos.
+ * @return Valor em graus.
+ */
+static inline float deg(float radv) { return radv*180.0f/(float)M_PI; }
+
+/**
+ * @brief Versão segura de acosf com clamp do argumento em [-1, 1].
+ */
+static inline float safe_acos(float x) {
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+    return acosf(x);
+}
+
+/**
+ * @brief Define o nível de precisão da trigonometria usada pelas funções escalares deste módulo.
+ *
+ * O padrão é TRIG_TIER_LIBM. Os kernels em lote de simd/angles_simd.h têm
+ * precisão própria e não são afetados. O nível é lido e gravado de forma
+ * atômica e cada chamada pública o lê uma vez; quem roda em paralelo com a
+ * thread que o troca (o render, contra a simulação) passa o nível explícito
+ * às variantes ...Tier em vez de depender dele.
+ */
+void SetSolverTrigTier(TrigTier tier);
+
+/** @brief Nível de precisão atual da trigonometria do solver. */
+TrigTier GetSolverTrigTier(void);
+
+/**
+ * @brief Calcula azimute e elevação do alvo T em relação à aeronave A.
+ *
+ * Fórmulas:
+ *  - Az = atan2( X_T - X_A, Y_T - Y_A )
+ *  - El = atan2( Z_T - Z_A, sqrt((X_T-X_A)^2 + (Y_T-Y_A)^2) )
+ *
+ * @param A Posição da aeronave.
+ * @param T Posição do alvo.
+ * @param Az [out] Azimute (rad).
+ * @param El [out] Elevação (rad).
+ */
+void ComputeAzEl(WoeVec3 A, WoeVec3 T, float *Az, float *El);
+
+/** @brief ComputeAzEl no nível @p tier em vez do nível do solver. */
+void ComputeAzElTier(WoeVec3 A, WoeVec3 T, TrigTier tier, float *Az, float *El);
+
+/**
+ * @brief Calcula o vetor de frente a partir de yaw/pitch/roll.
+ *
+ * Mundo Z-up; yaw em Z, pitch em X, roll em Y. O vetor base é +Y do corpo.
+ * Fora do nível libm usa os polinômios do nível float também no visual, como
+ * ComputeBasisBatch: a frente é a mesma de EntityForward em todos os níveis.
+ * @param yaw Rotação yaw (rad).
+ * @param pitch Rotação pitch (rad).
+ * @param roll Rotação roll (rad).
+ * @return Vetor unitário frente da aeronave.
+ */
+WoeVec3 ForwardFromYPR(float yaw, float pitch, float roll);
+
+/** Base ortonormal do corpo no mundo: colunas da matriz de rotação. */
+typedef struct WoeBasis {
+    WoeVec3 right;  /**< +X do corpo (asa direita). */
+    WoeVec3 fwd;    /**< +Y do corpo, igual a ForwardFromYPR. */
+    WoeVec3 up;     /**< +Z do corpo (deriva). */
+} WoeBasis;
+
+/**
+ * @brief Base completa de yaw/pitch/roll: R = Rz(yaw)*Rx(pitch)*Ry(roll).
+ *
+ * Uma única avaliação de seno/cosseno por ângulo e nenhuma normalização (as
+ * colunas já são unitárias e ortogonais). Ao contrário de derivar a direita
+ * por produto vetorial com o "cima" do mundo, não degenera em pitch = ±90° e
+ * inclui o roll.
+ */
+WoeBasis BasisFromYPR(float yaw, float pitch, float roll);
+
+/** @brief Base da entidade @p i de uma BasisStore. */
+static inline WoeBasis BasisAt(const BasisStore *b, int i)
+{
+    return (WoeBasis){ { b->rx[i], b->ry[i], b->rz[i] }, { b->fx[i], b->fy[i], b->fz[i] },
+                       { b->ux[i], b->uy[i], b->uz[i] } };
+}
+
+/**
+ * @brief Calcula a base e o Az/El do vetor frente das entidades [0, s->count) de @p s.
+ *
+ * No nível libm (a referência) é BasisFromYPR entidade a entidade. Nos níveis
+ * float e visual é uma única passada SIMD de ComputeBasisBatch (angles_simd.h),
+ * com os polinômios do nível float; o solver (vetor frente, AzR/ElR) e as
+ * matrizes de modelo do render (InstancedRendererShare) leem o resultado.
+ */
+void BasisStoreUpdate(BasisStore *b, const EntityStore *s);
+
+/**
+ * @brief Vetor frente e seu Az/El da entidade @p i.
+ *
+ * Lidos de @c s->basis quando ela cobre o store; senão calculados na hora
+ * pelo mesmo caminho de BasisStoreUpdate (mesmos valores, bit a bit).
+ */
+void EntityForward(const EntityStore *s, int i, WoeVec3 *fwd, float *AzR, float *ElR);
+
+/** @brief Base da entidade @p i: de @c s->basis quando ela cobre o store, senão calculada como em BasisStoreUpdate. */
+WoeBasis EntityBasis(const EntityStore *s, int i);
+
+/**
+ * @brief Calcula azimute/elevação de um vetor no espaço.
+ *
+ * É o Az/El da orientação (AzR/ElR): como ForwardFromYPR, fora da libm usa o
+ * nível float também no visual, e bate bit a bit com o AzR/ElR de ComputeBasisBatch.
+ * @param v Vetor 3D (não precisa ser unitário).
+ * @param Az [out] Azimute (rad).
+ * @param El [out] Elevação (rad).
+ */
+void ComputeAzElFromVector(WoeVec3 v, float *Az, float *El);
+
+/**
+ * @brief Deriva ângulos esféricos a partir de Az/El do alvo (T) e do vetor frente (R).
+ *
+ * Calcula j e G, além dos intermediários E, F, J usados no HUD.
+ * @param AzT Azimute do alvo (rad).
+ * @param ElT Elevação do alvo (rad).
+ * @param AzR Azimute do vetor frente (rad).
+ * @param ElR Elevação do vetor frente (rad).
+ * @param out_j [out] Ângulo j (rad).
+ * @param out_G [out] Ângulo G (rad).
+ * @param out_E [out] Ângulo E (rad).
+ * @param out_F [out] Ângulo F (rad).
+ * @param out_J [out] Ângulo J (rad).
+ */
+void ComputeSphericalAngles(float AzT, float ElT, float AzR, float ElR,
+                            float *out_j, float *out_G,
+                            float *out_E, float *out_F, float *out_J);
+
+/**
+ * @brief ComputeSphericalAngles só com j e G, sem testes de NULL nem gravações de E, F e J.
+ *
+ * Mesmos valores, bit a bit. As duas saídas são obrigatórias.
+ */
+void ComputeSphericalAnglesJG(float AzT, float ElT, float AzR, float ElR, float *out_j, float *out_G);
+
+/**
+ * @brief ComputeSphericalAngles só com j: para antes de E, F e G (um atan2, um asin e um seno a menos).
+ * @return Ângulo j (rad), o mesmo da versão completa.
+ */
+float ComputeSphericalAnglesJ(float AzT, float ElT, float AzR, float ElR);
+
+/**
+ * @brief Solver vetorial de j e G, sem a cadeia de triângulos esféricos.
+ *
+ * A cadeia de ComputeSphericalAngles mede o azimute de R no sentido oposto ao
+ * de T (por isso J = pi - C - D), o que equivale a espelhar o vetor frente em X:
+ * M = (-R.x, R.y, R.z). O triângulo tem vértices no polo +Y, em L = T - A e em
+ * M, e os ângulos saem dos vetores:
+ *  - j = atan2(|L x M|, L·M);
+ *  - F = ângulo em M de L até o polo +Y, dobrado em [-pi/2, pi/2] como o asinf
+ *    da cadeia o devolve (e zerado quando sin(j) <= 1e-6, como lá);
+ *  - E = atan2(tan(AzR), sin(ElR)) com os dois argumentos multiplicados por
+ *    |R.y|·|R|, o que preserva o ramo de tan(AzR);
+ *  - G = pi - E - F, a mesma convenção da cadeia, em [-pi/2, 5pi/2).
+ *
+ * São três chamadas de atan2f e três raízes, contra cerca de vinte funções
+ * transcendentais da cadeia. Nenhum dos vetores precisa ser unitário.
+ *
+ * j e G coincidem com a cadeia em todo o domínio, a menos do arredondamento;
+ * o corte em R.y = 0 (AzR = ±90°) é o mesmo da cadeia, onde tan(AzR) troca de
+ * sinal e G salta de pi. Com M sobre o eixo Y (orientação nula) a direção do
+ * polo em M não existe e F é medido a partir de +X, o limite D = 0 da cadeia.
+ * Não há tanf nem acos de argumento saturado, então ElR/ElT = ±90° não perdem
+ * dígitos.
+ *
+ * @param fwd Vetor frente R da aeronave.
+ * @param los Linha de visada T - A.
+ * @param out_j [out] Ângulo j (rad).
+ * @param out_G [out] Ângulo G (rad), como em ComputeSphericalAngles.
+ */
+void ComputeSphericalAnglesVector(WoeVec3 fwd, WoeVec3 los, float *out_j, float *out_G);
+
+/**
+ * @brief ForwardFromYPR para @p n orientações em arrays SoA.
+ *
+ * Fora do nível libm usa o kernel SIMD ComputeBasisBatch só com o vetor frente
+ * (igual bit a bit a ForwardFromYPR em todos os níveis).
+ */
+void ForwardFromYPRBatch(int n, const float *yaw, const float *pitch, const float *roll,
+                         float *out_x, float *out_y, float *out_z);
+
+/**
+ * @brief ComputeAzElFromVector para @p n vetores em arrays SoA. Saídas NULL são ignoradas.
+ */
+void ComputeAzElFromVectorBatch(int n, const float *vx, const float *vy, const float *vz,
+                                float *out_Az, float *out_El);
+
+/**
+ * @brief ComputeSphericalAnglesVector de uma aeronave em (ax, ay, az), frente @p fwd,
+ *        contra @p n alvos em arrays SoA. Saídas NULL são ignoradas.
+ */
+void ComputeSphericalAnglesVectorBatch(int n, WoeVec3 fwd, float ax, float ay, float az,
+                                       const float *tx, const float *ty, const float *tz,
+                                       float *out_j, float *out_G);
+
+/**
+ * @brief Resolve a aeronave @p a contra @p n alvos dados por arrays SoA de posição.
+ *
+ * Bloco básico de SolveEngagements: grava os pares em @c out a partir do índice
+ * @p base (n entradas contíguas), sem alterar as dimensões de @p out.
+ */
+void SolveEngagementRow(const EntityStore *air, int a, int n, const float *tx, const float *ty, const float *tz,
+                        PairResults *out, int base, SolverMode mode);
+
+/**
+ * @brief SolveEngagementRow no nível @p tier em vez do nível do solver.
+ *
+ * Para threads que não trocam o nível, como o render resolvendo um par com o
+ * @c trig do instantâneo.
+ */
+void SolveEngagementRowTier(const EntityStore *air, int a, int n, const float *tx, const float *ty, const float *tz,
+                            PairResults *out, int base, SolverMode mode, TrigTier tier);
+
+/**
+ * @brief SolveEngagementRow com o vetor frente da aeronave já calculado.
+ *
+ * @p fwd, @p AzR e @p ElR devem ser ForwardFromYPR da orientação de @p a e
+ * ComputeAzElFromVector dele, no mesmo nível do solver; os resultados são então
+ * idênticos aos de SolveEngagementRow em todos os níveis. Permite reaproveitar
+ * o vetor frente entre passos.
+ */
+void SolveEngagementRowForward(const EntityStore *air, int a, WoeVec3 fwd, float AzR, float ElR,
+                               int n, const float *tx, const float *ty, const float *tz,
+                               PairResults *out, int base, SolverMode mode);
+
+/**
+ * @brief Resolve Az/El e ângulos esféricos para todos os pares aeronave–alvo.
+ *
+ * Para cada aeronave o vetor frente e seus AzR/ElR são calculados uma única vez;
+ * em seguida os kernels em lote (SIMD) percorrem os arrays SoA dos alvos de forma
+ * contígua e gravam os resultados do par (a, t) em @c out no índice
+ * @c a*tgt->count + t. Se @p out não comportar todos os pares, nada é calculado.
+ *
+ * @param air Aeronaves (observadores).
+ * @param tgt Alvos.
+ * @param out [out] Resultados por par.
+ * @param mode Caminho de cálculo; em SOLVER_VECTOR apenas j e G são calculados
+ *             e E, F, J são zerados.
+ * @note As colunas calculadas são as de WOE_SOLVE_OUTPUTS; as demais saem zeradas.
+ */
+void SolveEngagements(const EntityStore *air, const EntityStore *tgt, PairResults *out, SolverMode mode);
+
+/**
+ * @brief SolveEngagements distribuído nas threads de @p pool.
+ *
+ * A matriz de pares é dividida em blocos de uma aeronave por até 512 alvos
+ * contíguos; cada bloco é um job do pool (com roubo de trabalho). Os resultados
+ * são idênticos bit a bit aos de SolveEngagements e vão para o mesmo @p out
+ * pré-alocado; nada é alocado por chamada. Com @p pool NULL ou de uma thread,
+ * equivale a SolveEngagements.
+ */
+void SolveEngagementsParallel(JobPool *pool, const EntityStore *air, const EntityStore *tgt,
+                              PairResults *out, SolverMode mode);
+
+#endif /* WOE_GEOMETRY_H */
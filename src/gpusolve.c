@@ -0,0 +1,396 @@
+/**
+ * @file gpusolve.c
+ * @brief Compute shader do solver de pares e desenho instanciado a partir dos SSBOs (veja gpusolve.h).
+ */
+#include "gpusolve.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// SSBO bindings shared by the compute and the draw shaders
+#define GPU_BIND_AIRCRAFT 0
+#define GPU_BIND_TARGETS 1
+#define GPU_BIND_RESULTS 2
+
+/** Grupos por dimensão de um despacho; o mínimo garantido pelo OpenGL 4.3. */
+#define GPU_MAX_GROUPS_X 65535
+
+// GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT: draws and readbacks see the solve
+#define GPU_BARRIER_BITS 0x2200u
+
+// Port of ComputeAzEl + ComputeSphericalAngles (or ComputeSphericalAnglesVector), one invocation per pair.
+// acos/asin arguments are clamped as in TrigAcos/TrigAsin.
+static const char *SOLVE_CS =
+    "#version 430\n"
+    "layout(local_size_x = 64) in;\n"
+    "layout(std430, binding = 0) readonly buffer Aircraft { vec4 air[]; };\n"
+    "layout(std430, binding = 1) readonly buffer Targets { vec4 tgt[]; };\n"
+    "layout(std430, binding = 2) writeonly buffer Results { float res[]; };\n"
+    "uniform int aircraft;\n"
+    "uniform int targets;\n"
+    "uniform int capacity;\n"
+    "uniform int vectorMode;\n"
+    "const float PI = 3.14159265358979;\n"
+    "void main()\n"
+    "{\n"
+    "    int k = int(gl_GlobalInvocationID.y*gl_NumWorkGroups.x*gl_WorkGroupSize.x + gl_GlobalInvocationID.x);\n"
+    "    if (k >= aircraft*targets) return;\n"
+    "    int a = k/targets, t = k - a*targets;\n"
+    "    vec4 A = air[2*a], R = air[2*a + 1];\n"
+    "    vec3 d = tgt[t].xyz - A.xyz;\n"
+    "    float AzT = atan(d.x, d.y);\n"
+    "    float ElT = atan(d.z, length(d.xy));\n"
+    "    float AzR = A.w, ElR = R.w;\n"
+    "    float j, G, E = 0.0, F = 0.0, J = 0.0;\n"
+    "    if (vectorMode != 0)\n"
+    "    {\n"
+    "        vec3 M = vec3(-R.x, R.y, R.z);\n"
+    "        float cl = length(cross(d, M)), lm = dot(d, M);\n"
+    "        j = atan(cl, lm);\n"
+    "        float mxz = dot(M.xz, M.xz), rm = length(M);\n"
+    "        float sn = rm*(M.x*d.z - M.z*d.x), cs = mxz*d.y - M.y*dot(M.xz, d.xz);\n"
+    "        if (mxz == 0.0) { sn = -M.y*d.z; cs = abs(M.y)*d.x; }\n"
+    "        float Fv = -atan(sn, cs);\n"
+    "        if (Fv > 0.5*PI) Fv = PI - Fv;\n"
+    "        else if (Fv < -0.5*PI) Fv = -PI - Fv;\n"
+    "        if (cl <= 1e-6*sqrt(cl*cl + lm*lm)) Fv = 0.0;\n"
+    "        float Ev = atan((M.y < 0.0 ? M.x : -M.x)*rm, abs(M.y)*M.z);\n"
+    "        G = PI - Ev - Fv;\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "        float f = acos(clamp(cos(AzT)*cos(ElT), -1.0, 1.0));\n"
+    "        float h = acos(clamp(cos(AzR)*cos(ElR), -1.0, 1.0));\n"
+    "        float C = atan(tan(ElT), sin(AzT));\n"
+    "        float D = atan(tan(ElR), sin(AzR));\n"
+    "        J = PI - C - D;\n"
+    "        j = acos(clamp(cos(f)*cos(h) + sin(f)*sin(h)*cos(J), -1.0, 1.0));\n"
+    "        E = atan(tan(AzR), sin(ElR));\n"
+    "        float s = sin(j);\n"
+    "        F = abs(s) > 1e-6 ? asin(clamp(sin(J)*sin(f)/s, -1.0, 1.0)) : 0.0;\n"
+    "        G = PI - E - F;\n"
+    "    }\n"
+    "    res[k] = AzT;\n"
+    "    res[capacity + k] = ElT;\n"
+    "    res[2*capacity + k] = AzR;\n"
+    "    res[3*capacity + k] = ElR;\n"
+    "    res[4*capacity + k] = j;\n"
+    "    res[5*capacity + k] = G;\n"
+    "    res[6*capacity + k] = E;\n"
+    "    res[7*capacity + k] = F;\n"
+    "    res[8*capacity + k] = J;\n"
+    "}\n";
+
+// Arc j of one aircraft against target gl_InstanceID: same construction as ArcPolyline,
+// extruded into a ribbon facing the eye. Degenerate arcs are moved outside the clip volume.
+static const char *ARC_VS =
+    "#version 430\n"
+    "in vec2 vertexPosition;\n"
+    "layout(std430, binding = 0) readonly buffer Aircraft { vec4 air[]; };\n"
+    "layout(std430, binding = 1) readonly buffer Targets { vec4 tgt[]; };\n"
+    "layout(std430, binding = 2) readonly buffer Results { float res[]; };\n"
+    "uniform mat4 mvp;\n"
+    "uniform vec3 eye;\n"
+    "uniform int aircraft;\n"
+    "uniform int targets;\n"
+    "uniform int capacity;\n"
+    "uniform int skip;\n"
+    "uniform float radius;\n"
+    "uniform float halfWidth;\n"
+    "void main()\n"
+    "{\n"
+    "    int t = gl_InstanceID;\n"
+    "    vec3 A = air[2*aircraft].xyz, u = air[2*aircraft + 1].xyz;\n"
+    "    vec3 d = tgt[t].xyz - A;\n"
+    "    float j = min(res[4*capacity + aircraft*targets + t], 6.2831853);\n"
+    "    vec3 n = cross(u, d);\n"
+    "    float nn = length(n);\n"
+    "    if (t == skip || j <= 1e-5 || nn <= 1e-6*length(d)) { gl_Position = vec4(2.0, 2.0, 2.0, 1.0); return; }\n"
+    "    vec3 w = normalize(cross(n/nn, u));\n"
+    "    float s = vertexPosition.x*j;\n"
+    "    vec3 p = A + radius*(cos(s)*u + sin(s)*w);\n"
+    "    vec3 side = normalize(cross(-sin(s)*u + cos(s)*w, eye - p));\n"
+    "    gl_Position = mvp*vec4(p + side*(vertexPosition.y*halfWidth), 1.0);\n"
+    "}\n";
+
+// HUD marker of target gl_InstanceID: radius kpix*j, angle G + roll, as the CPU HUD
+static const char *MARKER_VS =
+    "#version 430\n"
+    "in vec2 vertexPosition;\n"
+    "layout(std430, binding = 2) readonly buffer Results { float res[]; };\n"
+    "uniform vec2 screen;\n"
+    "uniform vec4 hud;\n"
+    "uniform float limit;\n"
+    "uniform float size;\n"
+    "uniform int aircraft;\n"
+    "uniform int targets;\n"
+    "uniform int capacity;\n"
+    "uniform int skip;\n"
+    "out vec2 fragLocal;\n"
+    "void main()\n"
+    "{\n"
+    "    int t = gl_InstanceID, k = aircraft*targets + t;\n"
+    "    float r = hud.z*res[4*capacity + k];\n"
+    "    float g = res[5*capacity + k] + hud.w;\n"
+    "    if (t == skip || r > limit) { gl_Position = vec4(2.0, 2.0, 2.0, 1.0); return; }\n"
+    "    vec2 p = vec2(hud.x + r*sin(g), hud.y - r*cos(g)) + vertexPosition*size;\n"
+    "    fragLocal = vertexPosition;\n"
+    "    gl_Position = vec4(p.x/screen.x*2.0 - 1.0, 1.0 - p.y/screen.y*2.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FLAT_FS =
+    "#version 430\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main() { finalColor = colDiffuse; }\n";
+
+static const char *MARKER_FS =
+    "#version 430\n"
+    "in vec2 fragLocal;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    if (dot(fragLocal, fragLocal) > 1.0) discard;\n"
+    "    finalColor = colDiffuse;\n"
+    "}\n";
+
+#if defined(WOE_GPU_COMPUTE)
+// rlgl has no glMemoryBarrier; GLFW (inside raylib on desktop) resolves it from the context
+typedef void (*WoeGlProc)(void);
+extern WoeGlProc glfwGetProcAddress(const char *name);
+typedef void (*WoeGlMemoryBarrier)(unsigned int barriers);
+static WoeGlMemoryBarrier glMemoryBarrierFn = NULL;
+#endif
+
+static void GpuMemoryBarrier(void)
+{
+#if defined(WOE_GPU_COMPUTE)
+    if (glMemoryBarrierFn) glMemoryBarrierFn(GPU_BARRIER_BITS);
+#endif
+}
+
+/** Compila um shader de desenho; false se caiu no shader padrão da raylib. */
+static bool LoadDrawShader(Shader *sh, const char *vs, const char *fs)
+{
+    *sh = LoadShaderFromMemory(vs, fs);
+    return sh->id != 0 && sh->id != rlGetShaderIdDefault();
+}
+
+/** VAO com um único atributo vec2 (posição 0) lido de @p verts. */
+static bool LoadTemplate(unsigned int *vao, unsigned int *vbo, const float *verts, int count)
+{
+    *vao = rlLoadVertexArray();
+    if (!rlEnableVertexArray(*vao)) return false;
+    *vbo = rlLoadVertexBuffer(verts, (int)sizeof(float)*2*count, false);
+    rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+    rlDisableVertexArray();
+    return *vbo != 0;
+}
+
+bool GpuSolverInit(GpuSolver *g, int maxAir, int maxTgt)
+{
+    memset(g, 0, sizeof(*g));
+#if !defined(WOE_GPU_COMPUTE)
+    return false; // built for the OpenGL 3.3 raylib: no compute shaders in rlgl
+#else
+    if (rlGetVersion() != RL_OPENGL_43) return false;
+    glMemoryBarrierFn = (WoeGlMemoryBarrier)glfwGetProcAddress("glMemoryBarrier");
+    if (!glMemoryBarrierFn) return false;
+#endif
+    if (maxAir < 1) maxAir = 1;
+    if (maxTgt < 1) maxTgt = 1;
+    g->maxAir = maxAir;
+    g->maxTgt = maxTgt;
+    g->capacity = maxAir*maxTgt;
+
+    unsigned int cs = rlCompileShader(SOLVE_CS, RL_COMPUTE_SHADER);
+    g->program = cs ? rlLoadComputeShaderProgram(cs) : 0;
+    if (!g->program) { GpuSolverFree(g); return false; }
+    g->locAircraft = rlGetLocationUniform(g->program, "aircraft");
+    g->locTargets = rlGetLocationUniform(g->program, "targets");
+    g->locCapacity = rlGetLocationUniform(g->program, "capacity");
+    g->locVector = rlGetLocationUniform(g->program, "vectorMode");
+
+    g->upload = (float *)malloc(sizeof(float)*8*(size_t)(maxAir > maxTgt ? maxAir : maxTgt));
+    g->airBuffer = rlLoadShaderBuffer((unsigned int)(sizeof(float)*8*(size_t)maxAir), NULL, RL_DYNAMIC_COPY);
+    g->tgtBuffer = rlLoadShaderBuffer((unsigned int)(sizeof(float)*4*(size_t)maxTgt), NULL, RL_DYNAMIC_COPY);
+    for (int i = 0; i < 2; ++i)
+        g->results[i] = rlLoadShaderBuffer((unsigned int)(sizeof(float)*GPU_SOLVE_COLUMNS*(size_t)g->capacity),
+                                           NULL, RL_STREAM_READ);
+    if (!g->upload || !g->airBuffer || !g->tgtBuffer || !g->results[0] || !g->results[1])
+    {
+        GpuSolverFree(g);
+        return false;
+    }
+
+    if (!LoadDrawShader(&g->arcShader, ARC_VS, FLAT_FS) || !LoadDrawShader(&g->markerShader, MARKER_VS, MARKER_FS))
+    {
+        GpuSolverFree(g);
+        return false;
+    }
+    // ribbon template: two triangles per segment, (s in [0, 1], side -1/+1)
+    float ribbon[GPU_ARC_SEGMENTS*6*2];
+    for (int i = 0; i < GPU_ARC_SEGMENTS; ++i)
+    {
+        float s0 = (float)i/GPU_ARC_SEGMENTS, s1 = (float)(i + 1)/GPU_ARC_SEGMENTS;
+        const float v[12] = { s0, -1, s1, -1, s1, 1, s0, -1, s1, 1, s0, 1 };
+        memcpy(ribbon + 12*i, v, sizeof(v));
+    }
+    static const float quad[12] = { -1, -1, 1, -1, 1, 1, -1, -1, 1, 1, -1, 1 };
+    if (!LoadTemplate(&g->arcVao, &g->arcVbo, ribbon, GPU_ARC_SEGMENTS*6) ||
+        !LoadTemplate(&g->markerVao, &g->markerVbo, quad, 6))
+    {
+        GpuSolverFree(g);
+        return false;
+    }
+    g->ready = true;
+    return true;
+}
+
+void GpuSolverFree(GpuSolver *g)
+{
+    if (g->program) rlUnloadShaderProgram(g->program);
+    if (g->airBuffer) rlUnloadShaderBuffer(g->airBuffer);
+    if (g->tgtBuffer) rlUnloadShaderBuffer(g->tgtBuffer);
+    for (int i = 0; i < 2; ++i)
+        if (g->results[i]) rlUnloadShaderBuffer(g->results[i]);
+    if (g->arcShader.id && g->arcShader.id != rlGetShaderIdDefault()) UnloadShader(g->arcShader);
+    if (g->markerShader.id && g->markerShader.id != rlGetShaderIdDefault()) UnloadShader(g->markerShader);
+    if (g->arcVbo) rlUnloadVertexBuffer(g->arcVbo);
+    if (g->arcVao) rlUnloadVertexArray(g->arcVao);
+    if (g->markerVbo) rlUnloadVertexBuffer(g->markerVbo);
+    if (g->markerVao) rlUnloadVertexArray(g->markerVao);
+    free(g->upload);
+    memset(g, 0, sizeof(*g));
+}
+
+void GpuSolverDispatch(GpuSolver *g, const EntityStore *air, const EntityStore *tgt, SolverMode mode,
+                       long tick, double time)
+{
+    if (!g->ready || air->count > g->maxAir || tgt->count > g->maxTgt) return;
+    int pairs = air->count*tgt->count;
+
+    // aircraft: position and AzR, then the forward vector and ElR, from the step's basis when present
+    for (int a = 0; a < air->count; ++a)
+    {
+        WoeVec3 fwd;
+        float AzR, ElR;
+        EntityForward(air, a, &fwd, &AzR, &ElR);
+        float *v = g->upload + 8*a;
+        v[0] = air->x[a]; v[1] = air->y[a]; v[2] = air->z[a]; v[3] = AzR;
+        v[4] = fwd.x; v[5] = fwd.y; v[6] = fwd.z; v[7] = ElR;
+    }
+    if (air->count > 0) rlUpdateShaderBuffer(g->airBuffer, g->upload, (unsigned int)(sizeof(float)*8*(size_t)air->count), 0);
+    for (int t = 0; t < tgt->count; ++t)
+    {
+        float *v = g->upload + 4*t;
+        v[0] = tgt->x[t]; v[1] = tgt->y[t]; v[2] = tgt->z[t]; v[3] = 0.0f;
+    }
+    if (tgt->count > 0) rlUpdateShaderBuffer(g->tgtBuffer, g->upload, (unsigned int)(sizeof(float)*4*(size_t)tgt->count), 0);
+
+    int b = g->current ^ 1;
+    g->aircraft[b] = air->count;
+    g->targets[b] = tgt->count;
+    g->tick[b] = tick;
+    g->time[b] = time;
+    g->unread[b] = true;
+    g->current = b;
+    g->dispatches++;
+    if (pairs <= 0) return;
+
+    int vectorMode = mode == SOLVER_VECTOR;
+    rlEnableShader(g->program);
+    rlSetUniform(g->locAircraft, &air->count, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(g->locTargets, &tgt->count, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(g->locCapacity, &g->capacity, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(g->locVector, &vectorMode, RL_SHADER_UNIFORM_INT, 1);
+    rlBindShaderBuffer(g->airBuffer, GPU_BIND_AIRCRAFT);
+    rlBindShaderBuffer(g->tgtBuffer, GPU_BIND_TARGETS);
+    rlBindShaderBuffer(g->results[b], GPU_BIND_RESULTS);
+    // beyond the per-dimension group limit the pairs wrap into rows of GPU_MAX_GROUPS_X groups
+    unsigned int groups = (unsigned int)((pairs + GPU_SOLVE_LOCAL_SIZE - 1)/GPU_SOLVE_LOCAL_SIZE);
+    unsigned int gx = groups < GPU_MAX_GROUPS_X ? groups : GPU_MAX_GROUPS_X;
+    rlComputeShaderDispatch(gx, (groups + gx - 1)/gx, 1);
+    rlDisableShader();
+    GpuMemoryBarrier();
+}
+
+/** Vincula os três SSBOs do último despacho e define os uniformes comuns dos shaders de desenho. */
+static void BindDrawCommon(const GpuSolver *g, Shader sh, int a, int skip, Color col)
+{
+    int capacity = g->capacity, targets = g->targets[g->current];
+    rlEnableShader(sh.id);
+    SetShaderValue(sh, GetShaderLocation(sh, "aircraft"), &a, SHADER_UNIFORM_INT);
+    SetShaderValue(sh, GetShaderLocation(sh, "targets"), &targets, SHADER_UNIFORM_INT);
+    SetShaderValue(sh, GetShaderLocation(sh, "capacity"), &capacity, SHADER_UNIFORM_INT);
+    SetShaderValue(sh, GetShaderLocation(sh, "skip"), &skip, SHADER_UNIFORM_INT);
+    Vector4 c = ColorNormalize(col);
+    SetShaderValue(sh, GetShaderLocation(sh, "colDiffuse"), &c, SHADER_UNIFORM_VEC4);
+    rlBindShaderBuffer(g->airBuffer, GPU_BIND_AIRCRAFT);
+    rlBindShaderBuffer(g->tgtBuffer, GPU_BIND_TARGETS);
+    rlBindShaderBuffer(g->results[g->current], GPU_BIND_RESULTS);
+}
+
+void GpuSolverDrawArcs(const GpuSolver *g, int a, int skip, float radius, float halfWidth, Vector3 eye, Color col)
+{
+    int b = g->current;
+    if (!g->ready || a < 0 || a >= g->aircraft[b] || g->targets[b] <= 0) return;
+    rlDrawRenderBatchActive(); // whatever raylib has queued goes first, with its own shader
+    Shader sh = g->arcShader;
+    BindDrawCommon(g, sh, a, skip, col);
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    SetShaderValueMatrix(sh, GetShaderLocation(sh, "mvp"), mvp);
+    SetShaderValue(sh, GetShaderLocation(sh, "eye"), &eye, SHADER_UNIFORM_VEC3);
+    SetShaderValue(sh, GetShaderLocation(sh, "radius"), &radius, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(sh, GetShaderLocation(sh, "halfWidth"), &halfWidth, SHADER_UNIFORM_FLOAT);
+    rlDisableBackfaceCulling(); // the ribbon winding flips with the arc's side
+    rlEnableVertexArray(g->arcVao);
+    rlDrawVertexArrayInstanced(0, GPU_ARC_SEGMENTS*6, g->targets[b]);
+    rlDisableVertexArray();
+    rlEnableBackfaceCulling();
+    rlDisableShader();
+}
+
+void GpuSolverDrawMarkers(const GpuSolver *g, int a, int skip, float cx, float cy, float kpix, float roll,
+                          float limit, float size, int screenW, int screenH, Color col)
+{
+    int b = g->current;
+    if (!g->ready || a < 0 || a >= g->aircraft[b] || g->targets[b] <= 0) return;
+    rlDrawRenderBatchActive();
+    Shader sh = g->markerShader;
+    BindDrawCommon(g, sh, a, skip, col);
+    Vector2 screen = { (float)screenW, (float)screenH };
+    Vector4 hud = { cx, cy, kpix, roll };
+    SetShaderValue(sh, GetShaderLocation(sh, "screen"), &screen, SHADER_UNIFORM_VEC2);
+    SetShaderValue(sh, GetShaderLocation(sh, "hud"), &hud, SHADER_UNIFORM_VEC4);
+    SetShaderValue(sh, GetShaderLocation(sh, "limit"), &limit, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(sh, GetShaderLocation(sh, "size"), &size, SHADER_UNIFORM_FLOAT);
+    rlDisableBackfaceCulling(); // screen y points down, so the quad is wound clockwise
+    rlEnableVertexArray(g->markerVao);
+    rlDrawVertexArrayInstanced(0, 6, g->targets[b]);
+    rlDisableVertexArray();
+    rlEnableBackfaceCulling();
+    rlDisableShader();
+}
+
+bool GpuSolverReadback(GpuSolver *g, PairResults *out, long *tick, double *time)
+{
+    int b = g->current ^ 1;
+    if (!g->ready || !g->unread[b] || g->aircraft[b]*g->targets[b] > out->capacity) return false;
+    g->unread[b] = false;
+    int pairs = g->aircraft[b]*g->targets[b];
+    float *cols[GPU_SOLVE_COLUMNS] = { out->AzT, out->ElT, out->AzR, out->ElR, out->j, out->G, out->E, out->F, out->J };
+    for (int c = 0; pairs > 0 && c < GPU_SOLVE_COLUMNS; ++c)
+        rlReadShaderBuffer(g->results[b], cols[c], (unsigned int)(sizeof(float)*(size_t)pairs),
+                           (unsigned int)(sizeof(float)*(size_t)c*(size_t)g->capacity));
+    out->aircraft = g->aircraft[b];
+    out->targets = g->targets[b];
+    *tick = g->tick[b];
+    *time = g->time[b];
+    g->readbacks++;
+    return true;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file gpusolve.h
+ * @brief Solver de pares em compute shader (OpenGL 4.3), com arcos e marcadores desenhados a partir dos resultados na GPU.
+ *
+ * Caminho opcional ao SolveEngagementsParallel da thread de simulação: a
+ * cada instantâneo novo, a thread de render envia as posições e os vetores
+ * frente das aeronaves e as posições dos alvos para SSBOs e um compute shader
+ * resolve AzT/ElT e j, G, E, F, J de todos os pares, uma invocação por par,
+ * no mesmo leiaute de PairResults (coluna c do par k em c*capacity + k).
+ *
+ * Os resultados não voltam para a CPU para desenhar: os arcos j de uma
+ * aeronave e seus marcadores no HUD são desenhados com instancing, um
+ * vertex shader lendo os mesmos SSBOs por gl_InstanceID. Só a gravação lê os
+ * ângulos de volta, e do buffer do despacho anterior (são dois, alternados),
+ * que a GPU já teve um quadro inteiro para terminar.
+ *
+ * Requer raylib compilada para OpenGL 4.3 e o programa com WOE_GPU_COMPUTE
+ * (opção de mesmo nome no CMake); sem isso, ou se o contexto for mais antigo,
+ * GpuSolverInit devolve false e o solver da CPU continua valendo.
+ */
+#ifndef WOE_GPUSOLVE_H
+#define WOE_GPUSOLVE_H
+
+#include "raylib.h"
+#include "woe_core.h"
+
+/** Invocações por grupo de trabalho do compute shader. */
+#define GPU_SOLVE_LOCAL_SIZE 64
+/** Colunas de resultado por par (AzT, ElT, AzR, ElR, j, G, E, F, J). */
+#define GPU_SOLVE_COLUMNS 9
+/** Segmentos da fita de cada arco j desenhado pela GPU. */
+#define GPU_ARC_SEGMENTS 32
+
+/** Programas, buffers e estado de um solver na GPU; usado só pela thread do contexto GL. */
+typedef struct GpuSolver {
+    bool ready;             /**< Falso sem OpenGL 4.3 ou se algum shader não compilou. */
+    int capacity;           /**< Pares por buffer de resultado. */
+    int maxAir;             /**< Aeronaves que cabem no SSBO de aeronaves. */
+    int maxTgt;             /**< Alvos que cabem no SSBO de alvos. */
+    unsigned int program;   /**< Compute shader do solver. */
+    int locAircraft, locTargets, locCapacity, locVector; /**< Uniformes do compute shader. */
+    unsigned int airBuffer; /**< Aeronaves: (x, y, z, AzR) e (fx, fy, fz, ElR) por entidade. */
+    unsigned int tgtBuffer; /**< Alvos: (x, y, z, 0) por entidade. */
+    unsigned int results[2];/**< Resultados, alternados a cada despacho. */
+    int current;            /**< Buffer do último despacho (o que é desenhado). */
+    int aircraft[2];        /**< Aeronaves resolvidas em cada buffer. */
+    int targets[2];         /**< Alvos resolvidos em cada buffer. */
+    long tick[2];           /**< Passo do instantâneo de cada buffer. */
+    double time[2];         /**< Tempo simulado de cada buffer. */
+    bool unread[2];         /**< Buffer despachado e ainda não lido por GpuSolverReadback. */
+    float *upload;          /**< Área de envio de aeronaves e alvos, reservada uma vez. */
+    Shader arcShader;       /**< Fita dos arcos j, uma instância por alvo. */
+    Shader markerShader;    /**< Marcador do HUD, uma instância por alvo. */
+    unsigned int arcVao, arcVbo;       /**< Modelo da fita: (parâmetro s, lado) por vértice. */
+    unsigned int markerVao, markerVbo; /**< Quad unitário do marcador. */
+    long dispatches;        /**< Despachos desde GpuSolverInit. */
+    long readbacks;         /**< Leituras de volta desde GpuSolverInit. */
+} GpuSolver;
+
+/**
+ * @brief Compila os shaders e reserva SSBOs para @p maxAir aeronaves por @p maxTgt alvos.
+ *
+ * Requer a janela aberta. Em falha (contexto anterior ao 4.3, programa sem
+ * WOE_GPU_COMPUTE, shader inválido) devolve false e @p g fica zerado.
+ */
+bool GpuSolverInit(GpuSolver *g, int maxAir, int maxTgt);
+
+/** @brief Libera programas, buffers e a área de envio. */
+void GpuSolverFree(GpuSolver *g);
+
+/**
+ * @brief Envia @p air e @p tgt e resolve todos os pares no próximo buffer de resultado.
+ *
+ * Não espera a GPU. O vetor frente vem de EntityForward (a base do passo,
+ * quando há). Em SOLVER_VECTOR só j e G são calculados, como na CPU; os
+ * demais modos usam a cadeia de ComputeSphericalAngles, sempre em float da GPU
+ * (o nível de trigonometria não se aplica). Nada é feito se os pares não
+ * couberem.
+ * @param tick Passo do instantâneo, devolvido por GpuSolverReadback.
+ * @param time Tempo simulado do instantâneo.
+ */
+void GpuSolverDispatch(GpuSolver *g, const EntityStore *air, const EntityStore *tgt, SolverMode mode,
+                       long tick, double time);
+
+/**
+ * @brief Arcos j da aeronave @p a contra todos os alvos do último despacho, numa chamada instanciada.
+ *
+ * Mesma forma de LineBatchAddArc (de frente, no plano frente–alvo), com uma
+ * fita de meia largura @p halfWidth voltada para @p eye. Chamar entre
+ * BeginMode3D/EndMode3D.
+ * @param skip Alvo a não desenhar (o par destacado), ou -1.
+ */
+void GpuSolverDrawArcs(const GpuSolver *g, int a, int skip, float radius, float halfWidth, Vector3 eye, Color col);
+
+/**
+ * @brief Marcadores dos alvos no HUD para a aeronave @p a, numa chamada instanciada.
+ *
+ * Mesmo mapeamento do HUD da CPU: raio @p kpix * j a partir de (@p cx, @p cy)
+ * e ângulo G + @p roll; alvos com raio acima de @p limit não aparecem.
+ * @param skip Alvo a não desenhar, ou -1.
+ * @param size Raio do marcador (px).
+ */
+void GpuSolverDrawMarkers(const GpuSolver *g, int a, int skip, float cx, float cy, float kpix, float roll,
+                          float limit, float size, int screenW, int screenH, Color col);
+
+/**
+ * @brief Lê de volta o despacho anterior ao último, se ainda não lido.
+ *
+ * Os nove ângulos vão para @p out (dimensões ajustadas), que deve comportar
+ * GpuSolver::capacity pares.
+ * @param tick [out] Passo do instantâneo lido.
+ * @param time [out] Tempo simulado do instantâneo lido.
+ * @return false se não há despacho novo para ler.
+ */
+bool GpuSolverReadback(GpuSolver *g, PairResults *out, long *tick, double *time);
+
+#endif /* WOE_GPUSOLVE_H */
@@ -0,0 +1,190 @@
+/**
+ * @file incremental.c
+ * @brief Detecção de entidades alteradas e recálculo parcial da matriz (veja incremental.h).
+ */
+#include "incremental.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool IncrementalSolverInit(IncrementalSolver *s, int maxAir, int maxTgt)
+{
+    memset(s, 0, sizeof(*s));
+    if (maxAir < 1) maxAir = 1;
+    if (maxTgt < 1) maxTgt = 1;
+    s->fx = (float *)malloc(sizeof(float)*5*(size_t)maxAir);
+    s->airDirty = (unsigned char *)calloc((size_t)maxAir, 1);
+    s->dirtyTgt = (int *)malloc(sizeof(int)*(size_t)maxTgt);
+    bool ok = s->fx && s->airDirty && s->dirtyTgt &&
+              EntityStoreInit(&s->air, maxAir) && EntityStoreInit(&s->tgt, maxTgt) &&
+              EntityStoreInit(&s->gather, maxTgt) && PairResultsInit(&s->cache, maxAir*maxTgt);
+    if (!ok) { IncrementalSolverFree(s); return false; }
+    s->fy = s->fx + maxAir;
+    s->fz = s->fy + maxAir;
+    s->AzR = s->fz + maxAir;
+    s->ElR = s->AzR + maxAir;
+    return true;
+}
+
+void IncrementalSolverFree(IncrementalSolver *s)
+{
+    EntityStoreFree(&s->air);
+    EntityStoreFree(&s->tgt);
+    EntityStoreFree(&s->gather);
+    PairResultsFree(&s->cache);
+    PairResultsFree(&s->scratch);
+    free(s->fx);
+    free(s->airDirty);
+    free(s->dirtyTgt);
+    memset(s, 0, sizeof(*s));
+}
+
+void IncrementalSolverInvalidate(IncrementalSolver *s)
+{
+    s->valid = false;
+}
+
+/** Contexto de um despacho incremental. */
+typedef struct IncrementalJobs {
+    IncrementalSolver *s;
+    const EntityStore *air;
+    const EntityStore *tgt;
+    SolverMode mode;
+} IncrementalJobs;
+
+/** Tarefa a: a linha inteira se a aeronave mudou; senão, só os alvos sujos dela. */
+static void SolveRowJob(void *ctx, int a, int worker)
+{
+    const IncrementalJobs *j = (const IncrementalJobs *)ctx;
+    IncrementalSolver *s = j->s;
+    const EntityStore *tgt = j->tgt;
+    int targets = tgt->count, base = a*targets;
+
+    if (s->airDirty[a])
+    {
+        WoeVec3 fwd;
+        EntityForward(j->air, a, &fwd, &s->AzR[a], &s->ElR[a]);
+        s->fx[a] = fwd.x; s->fy[a] = fwd.y; s->fz[a] = fwd.z;
+        SolveEngagementRowForward(j->air, a, fwd, s->AzR[a], s->ElR[a], targets, tgt->x, tgt->y, tgt->z,
+                                  &s->cache, base, j->mode);
+        return;
+    }
+
+    // cached forward vector, gathered moved targets, results scattered back into the row
+    int n = s->dirtyTargets;
+    if (n == 0) return;
+    int rb = worker*s->gather.capacity;
+    PairResults *r = &s->scratch;
+    WoeVec3 fwd = { s->fx[a], s->fy[a], s->fz[a] };
+    SolveEngagementRowForward(j->air, a, fwd, s->AzR[a], s->ElR[a], n, s->gather.x, s->gather.y, s->gather.z,
+                              r, rb, j->mode);
+    PairResults *c = &s->cache;
+    for (int k = 0; k < n; ++k)
+    {
+        int i = base + s->dirtyTgt[k], q = rb + k;
+        c->AzT[i] = r->AzT[q]; c->ElT[i] = r->ElT[q];
+        c->AzR[i] = r->AzR[q]; c->ElR[i] = r->ElR[q];
+        c->j[i] = r->j[q]; c->G[i] = r->G[q];
+        c->E[i] = r->E[q]; c->F[i] = r->F[q]; c->J[i] = r->J[q];
+    }
+}
+
+/** Recálculo completo no cache; renova todo vetor frente e estado guardados. */
+static long SolveAll(JobPool *pool, IncrementalSolver *s, const EntityStore *air, const EntityStore *tgt,
+                     SolverMode mode)
+{
+    SolveEngagementsParallel(pool, air, tgt, &s->cache, mode);
+    for (int a = 0; a < air->count; ++a)
+    {
+        WoeVec3 fwd;
+        EntityForward(air, a, &fwd, &s->AzR[a], &s->ElR[a]);
+        s->fx[a] = fwd.x; s->fy[a] = fwd.y; s->fz[a] = fwd.z;
+    }
+    return (long)air->count*tgt->count;
+}
+
+static void CopyFloats(float *dst, const float *src, int n)
+{
+    memcpy(dst, src, sizeof(float)*(size_t)n);
+}
+
+long SolveEngagementsIncremental(JobPool *pool, IncrementalSolver *s, const EntityStore *air,
+                                 const EntityStore *tgt, PairResults *out, SolverMode mode)
+{
+    int na = air->count, nt = tgt->count;
+    if (na*nt > s->cache.capacity || na*nt > out->capacity || na > s->air.capacity || nt > s->tgt.capacity) return 0;
+    // one partial row per thread; sized once, the pool does not change between calls
+    int threads = pool ? JobPoolThreads(pool) : 1;
+    bool scratch = s->scratch.capacity >= threads*s->gather.capacity;
+    if (!scratch)
+    {
+        PairResultsFree(&s->scratch);
+        scratch = PairResultsInit(&s->scratch, threads*s->gather.capacity);
+    }
+
+    TrigTier trig = GetSolverTrigTier();
+    bool full = !s->valid || !scratch || mode != s->mode || trig != s->trig ||
+                na != s->air.count || nt != s->tgt.count;
+    long solved = 0;
+
+    // what moved since the cached state; NaN compares unequal, so it stays dirty rather than stale
+    s->dirtyAircraft = s->dirtyTargets = 0;
+    if (!full)
+    {
+        const EntityStore *c = &s->air;
+        for (int a = 0; a < na; ++a)
+        {
+            bool d = air->x[a] != c->x[a] || air->y[a] != c->y[a] || air->z[a] != c->z[a] ||
+                     air->yaw[a] != c->yaw[a] || air->pitch[a] != c->pitch[a] || air->roll[a] != c->roll[a];
+            s->airDirty[a] = (unsigned char)d;
+            s->dirtyAircraft += d;
+        }
+        c = &s->tgt;
+        for (int t = 0; t < nt; ++t)
+        {
+            if (tgt->x[t] == c->x[t] && tgt->y[t] == c->y[t] && tgt->z[t] == c->z[t]) continue;
+            int k = s->dirtyTargets++;
+            s->dirtyTgt[k] = t;
+            s->gather.x[k] = tgt->x[t]; s->gather.y[k] = tgt->y[t]; s->gather.z[k] = tgt->z[t];
+        }
+        full = s->dirtyTargets > (int)(INCREMENTAL_FULL_FRACTION*(float)nt);
+    }
+
+    if (full)
+    {
+        solved = SolveAll(pool, s, air, tgt, mode);
+        s->dirtyAircraft = na;
+        s->dirtyTargets = nt;
+        s->mode = mode;
+        s->trig = trig;
+        s->valid = true;
+    }
+    else if (s->dirtyAircraft > 0 || s->dirtyTargets > 0)
+    {
+        IncrementalJobs j = { s, air, tgt, mode };
+        if (pool) JobPoolRun(pool, na, SolveRowJob, &j);
+        else for (int a = 0; a < na; ++a) SolveRowJob(&j, a, 0);
+        solved = (long)s->dirtyAircraft*nt + (long)(na - s->dirtyAircraft)*s->dirtyTargets;
+    }
+
+    // the cached state now matches what the cache was computed from
+    s->air.count = na;
+    s->tgt.count = nt;
+    CopyFloats(s->air.x, air->x, na); CopyFloats(s->air.y, air->y, na); CopyFloats(s->air.z, air->z, na);
+    CopyFloats(s->air.yaw, air->yaw, na); CopyFloats(s->air.pitch, air->pitch, na);
+    CopyFloats(s->air.roll, air->roll, na);
+    CopyFloats(s->tgt.x, tgt->x, nt); CopyFloats(s->tgt.y, tgt->y, nt); CopyFloats(s->tgt.z, tgt->z, nt);
+    s->cache.aircraft = na;
+    s->cache.targets = nt;
+    s->recomputed = solved;
+
+    int pairs = na*nt;
+    out->aircraft = na;
+    out->targets = nt;
+    PairResults *c = &s->cache;
+    CopyFloats(out->AzT, c->AzT, pairs); CopyFloats(out->ElT, c->ElT, pairs);
+    CopyFloats(out->AzR, c->AzR, pairs); CopyFloats(out->ElR, c->ElR, pairs);
+    CopyFloats(out->j, c->j, pairs); CopyFloats(out->G, c->G, pairs);
+    CopyFloats(out->E, c->E, pairs); CopyFloats(out->F, c->F, pairs); CopyFloats(out->J, c->J, pairs);
+    return solved;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file incremental.h
+ * @brief Recálculo incremental da matriz de pares: só os pares com uma entidade alterada.
+ *
+ * IncrementalSolver guarda o estado das entidades com que a matriz em cache foi
+ * calculada, o vetor frente (e AzR/ElR) de cada aeronave e os resultados de
+ * todos os pares. A cada chamada compara o estado atual com o guardado: uma
+ * aeronave está suja se a posição ou a orientação mudou, um alvo se a posição
+ * mudou (a orientação do alvo não entra no cálculo). Então
+ *
+ * - linhas de aeronaves sujas são recalculadas inteiras;
+ * - nas demais linhas só os alvos sujos são recalculados, reunidos em SoA e
+ *   resolvidos com o vetor frente em cache (SolveEngagementRowForward);
+ * - pares entre entidades paradas não são tocados.
+ *
+ * Com entidades atualizadas em taxa menor que a da simulação (reprodução de
+ * trilhas, recepção por rede) a maior parte dos passos não recalcula nada. Os
+ * resultados são idênticos aos de SolveEngagements. Trocar solver, nível de
+ * trigonometria ou o número de entidades recalcula tudo.
+ */
+#ifndef WOE_INCREMENTAL_H
+#define WOE_INCREMENTAL_H
+
+#include <stdbool.h>
+#include "entities.h"
+#include "fastmath.h"
+#include "geometry.h"
+#include "jobs.h"
+
+/** Fração de alvos sujos acima da qual a matriz toda é recalculada. */
+#define INCREMENTAL_FULL_FRACTION 0.5f
+
+/** Cache da matriz de pares e do estado que a gerou. Os campos são internos. */
+typedef struct IncrementalSolver {
+    EntityStore air;            /**< Estado das aeronaves usado no cache. */
+    EntityStore tgt;            /**< Estado dos alvos usado no cache (só x, y, z). */
+    PairResults cache;          /**< Resultados de todos os pares, a*targets + t. */
+    float *fx, *fy, *fz;        /**< [maxAir] vetor frente em cache por aeronave. */
+    float *AzR, *ElR;           /**< [maxAir] Az/El do vetor frente em cache. */
+    unsigned char *airDirty;    /**< [maxAir] 1 se a aeronave mudou neste passo. */
+    int *dirtyTgt;              /**< [maxTgt] índices dos alvos que mudaram neste passo. */
+    EntityStore gather;         /**< Posições dos alvos sujos reunidas em SoA. */
+    PairResults scratch;        /**< Linhas parciais por thread (cresce na primeira chamada com o pool). */
+    SolverMode mode;            /**< Solver do cache. */
+    TrigTier trig;              /**< Nível de trigonometria do cache. */
+    bool valid;                 /**< false força o recálculo total. */
+
+    int dirtyAircraft;          /**< Aeronaves sujas no último passo. */
+    int dirtyTargets;           /**< Alvos sujos no último passo. */
+    long recomputed;            /**< Pares recalculados no último passo. */
+} IncrementalSolver;
+
+/** @brief Reserva cache para até @p maxAir x @p maxTgt pares. */
+bool IncrementalSolverInit(IncrementalSolver *s, int maxAir, int maxTgt);
+
+/** @brief Libera os buffers e deixa a estrutura zerada. */
+void IncrementalSolverFree(IncrementalSolver *s);
+
+/** @brief Descarta o cache: a próxima chamada recalcula todos os pares. */
+void IncrementalSolverInvalidate(IncrementalSolver *s);
+
+/**
+ * @brief Atualiza os pares com alguma entidade alterada e copia a matriz para @p out.
+ *
+ * Mesmo contrato de SolveEngagementsParallel (pool opcional, @p out
+ * pré-alocado, nada feito se não couber).
+ * @return Pares recalculados.
+ */
+long SolveEngagementsIncremental(JobPool *pool, IncrementalSolver *s, const EntityStore *air,
+                                 const EntityStore *tgt, PairResults *out, SolverMode mode);
+
+#endif /* WOE_INCREMENTAL_H */
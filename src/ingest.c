@@ -0,0 +1,338 @@
+/**
+ * @file ingest.c
+ * @brief Socket UDP, fila SPSC e decodificação das atualizações (veja ingest.h).
+ */
+#if defined(__linux__)
+#define _GNU_SOURCE // recvmmsg
+#elif !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "ingest.h"
+#include "tracks.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#define INGEST_BAD_SOCKET ((intptr_t)INVALID_SOCKET)
+#define SOCK(s) ((SOCKET)(s))
+#define CloseSocket(s) closesocket(SOCK(s))
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define INGEST_BAD_SOCKET ((intptr_t)-1)
+#define SOCK(s) ((int)(s))
+#define CloseSocket(s) close(SOCK(s))
+#endif
+
+// the wire layout is the in-memory layout of these structs
+typedef char IngestHeaderSizeCheck[sizeof(IngestHeader) == 16 ? 1 : -1];
+typedef char IngestUpdateSizeCheck[sizeof(IngestUpdate) == 32 ? 1 : -1];
+typedef char IngestQueuePow2Check[(INGEST_QUEUE_SLOTS & (INGEST_QUEUE_SLOTS - 1)) == 0 ? 1 : -1];
+
+/** Tempo limite da recepção, para que IngestClose nunca espere mais que isso pela thread. */
+#define INGEST_POLL_SECONDS 0.1
+/** Buffer de recepção pedido ao kernel: as rajadas esperam nele enquanto a fila está cheia. */
+#define INGEST_SOCKET_BUFFER (4 << 20)
+/** Um seq mais atrasado que isso é um emissor reiniciado, não um datagrama atrasado. */
+#define INGEST_REORDER_WINDOW 4096
+
+#define QUEUE_MASK (INGEST_QUEUE_SLOTS - 1)
+
+static bool SocketStartup(void)
+{
+#if defined(_WIN32)
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return true;
+#endif
+}
+
+static void SocketCleanup(void)
+{
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+/** Slots livres contíguos a partir de @p head (nunca dá a volta e mantém um vazio). */
+static int ContiguousFree(int head, int tail)
+{
+    int used = (head - tail) & QUEUE_MASK;
+    int room = INGEST_QUEUE_SLOTS - 1 - used;
+    int toEnd = INGEST_QUEUE_SLOTS - head;
+    return room < toEnd ? room : toEnd;
+}
+
+/**
+ * @brief Recebe até @p max datagramas nos slots a partir de @p head.
+ * @return Datagramas recebidos (0 no tempo limite).
+ */
+static int ReceiveBatch(Ingest *in, int head, int max)
+{
+#if defined(__linux__)
+    struct mmsghdr msgs[INGEST_RECV_BATCH];
+    struct iovec iov[INGEST_RECV_BATCH];
+    if (max > INGEST_RECV_BATCH) max = INGEST_RECV_BATCH;
+    memset(msgs, 0, sizeof(msgs[0])*(size_t)max);
+    for (int i = 0; i < max; ++i)
+    {
+        // the kernel writes straight into the queue slots
+        iov[i].iov_base = in->slots[head + i].data.bytes;
+        iov[i].iov_len = INGEST_MAX_DATAGRAM;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // blocks (up to the timeout) for the first datagram, then takes whatever else is queued
+    int n = recvmmsg(SOCK(in->socket), msgs, (unsigned)max, MSG_WAITFORONE, NULL);
+    if (n <= 0) return 0;
+    double now = WoeNow();
+    for (int i = 0; i < n; ++i)
+    {
+        in->slots[head + i].length = (int)msgs[i].msg_len;
+        in->slots[head + i].received = now;
+    }
+    return n;
+#else
+    (void)max;
+    int n = (int)recv(SOCK(in->socket), (char *)in->slots[head].data.bytes, INGEST_MAX_DATAGRAM, 0);
+    if (n <= 0) return 0;
+    in->slots[head].length = n;
+    in->slots[head].received = WoeNow();
+    return 1;
+#endif
+}
+
+static int IngestThreadMain(void *arg)
+{
+    Ingest *in = (Ingest *)arg;
+    int head = WoeAtomicLoad(&in->head);
+    while (WoeAtomicLoad(&in->running))
+    {
+        int room = ContiguousFree(head, WoeAtomicLoad(&in->tail));
+        if (room == 0)
+        {
+            // the simulation drains every step; until then the kernel buffer holds the burst
+            WoeAtomicAdd(&in->full, 1);
+            WoeSleep(0.0002);
+            continue;
+        }
+        int n = ReceiveBatch(in, head, room);
+        if (n == 0) continue;
+        head = (head + n) & QUEUE_MASK;
+        WoeAtomicAdd(&in->packets, n);
+        WoeAtomicStore(&in->head, head); // release: the slots above are visible before the index
+    }
+    return 0;
+}
+
+bool IngestOpen(Ingest *in, int port, const char **error)
+{
+    const char *dummy;
+    if (!error) error = &dummy;
+    memset(in, 0, sizeof(*in));
+    in->socket = INGEST_BAD_SOCKET;
+    in->slots = (IngestSlot *)calloc(INGEST_QUEUE_SLOTS, sizeof(IngestSlot));
+    if (!in->slots) { *error = "memoria insuficiente"; return false; }
+    if (!SocketStartup())
+    {
+        free(in->slots);
+        *error = "rede indisponivel";
+        return false;
+    }
+
+    *error = NULL;
+    in->socket = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (in->socket == INGEST_BAD_SOCKET) *error = "nao foi possivel criar o socket";
+
+    if (!*error)
+    {
+        int buf = INGEST_SOCKET_BUFFER;
+        setsockopt(SOCK(in->socket), SOL_SOCKET, SO_RCVBUF, (const char *)&buf, sizeof(buf));
+#if defined(_WIN32)
+        DWORD timeout = (DWORD)(INGEST_POLL_SECONDS*1000.0);
+#else
+        struct timeval timeout = { 0, (long)(INGEST_POLL_SECONDS*1e6) };
+#endif
+        setsockopt(SOCK(in->socket), SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((unsigned short)port);
+        if (bind(SOCK(in->socket), (const struct sockaddr *)&addr, sizeof(addr)) != 0)
+            *error = "nao foi possivel abrir a porta";
+    }
+    if (!*error)
+    {
+        WoeAtomicStore(&in->running, 1);
+        if (!WoeThreadCreate(&in->thread, IngestThreadMain, in)) *error = "nao foi possivel criar a thread de recepcao";
+    }
+    if (*error)
+    {
+        if (in->socket != INGEST_BAD_SOCKET) CloseSocket(in->socket);
+        SocketCleanup();
+        free(in->slots);
+        memset(in, 0, sizeof(*in));
+        return false;
+    }
+    return true;
+}
+
+void IngestClose(Ingest *in)
+{
+    if (!in->slots) return;
+    WoeAtomicStore(&in->running, 0);
+    WoeThreadJoin(&in->thread);
+    CloseSocket(in->socket);
+    SocketCleanup();
+    free(in->slots);
+    memset(in, 0, sizeof(*in));
+}
+
+/** Decodifica o datagrama de um slot e espalha as atualizações pelos stores. */
+static int ApplySlot(Ingest *in, const IngestSlot *slot, EntityStore *air, EntityStore *tgt,
+                     EntityPool *airPool, EntityPool *tgtPool)
+{
+    const IngestHeader *h = &slot->data.header;
+    if (slot->length < (int)sizeof(IngestHeader) || h->magic != INGEST_MAGIC || h->version != INGEST_VERSION ||
+        h->count > INGEST_MAX_UPDATES || slot->length != (int)(sizeof(IngestHeader) + h->count*sizeof(IngestUpdate)))
+    {
+        in->rejected++;
+        return 0;
+    }
+    // wrap-around compare: anything not after the last applied one is late
+    int32_t ahead = (int32_t)(h->seq - in->lastSeq);
+    if (in->haveSeq && ahead <= 0 && ahead > -INGEST_REORDER_WINDOW)
+    {
+        in->stale++;
+        return 0;
+    }
+    in->lastSeq = h->seq;
+    in->haveSeq = true;
+
+    const IngestUpdate *u = (const IngestUpdate *)(slot->data.bytes + sizeof(IngestHeader));
+    int written = 0;
+    for (int i = 0; i < h->count; ++i)
+    {
+        EntityStore *st = u[i].kind == TRACK_KIND_TARGET ? tgt : air;
+        EntityPool *pool = u[i].kind == TRACK_KIND_TARGET ? tgtPool : airPool;
+        if (u[i].kind > TRACK_KIND_TARGET || u[i].index >= (uint32_t)st->capacity) { in->ignored++; continue; }
+        int k = (int)u[i].index;
+        if (pool)
+        {
+            // ids through the pool: spawned on first sight, slot recycled on despawn
+            if (u[i].flags & INGEST_FLAG_DESPAWN)
+            {
+                if (EntityPoolDespawn(pool, st, k)) ++written;
+                continue;
+            }
+            k = EntityPoolSpawnAt(pool, st, k, u[i].x, u[i].y, u[i].z, u[i].yaw, u[i].pitch, u[i].roll);
+            if (k < 0) { in->ignored++; continue; }
+        }
+        else if (u[i].flags & INGEST_FLAG_DESPAWN)
+        {
+            in->ignored++;
+            continue;
+        }
+        st->x[k] = u[i].x; st->y[k] = u[i].y; st->z[k] = u[i].z;
+        st->yaw[k] = u[i].yaw; st->pitch[k] = u[i].pitch; st->roll[k] = u[i].roll;
+        if (k >= st->count) st->count = k + 1;
+        ++written;
+    }
+    return written;
+}
+
+int IngestApply(Ingest *in, EntityStore *air, EntityStore *tgt, EntityPool *airPool, EntityPool *tgtPool)
+{
+    int tail = in->tail;
+    int head = WoeAtomicLoad(&in->head); // acquire: pairs with the producer's release
+    if (tail == head) return 0;
+
+    double now = WoeNow(), worst = 0.0;
+    int written = 0;
+    for (; tail != head; tail = (tail + 1) & QUEUE_MASK)
+    {
+        const IngestSlot *slot = &in->slots[tail];
+        if (now - slot->received > worst) worst = now - slot->received;
+        written += ApplySlot(in, slot, air, tgt, airPool, tgtPool);
+    }
+    WoeAtomicStore(&in->tail, tail); // hands the slots back to the receiver
+    in->latency = worst;
+    in->applied += written;
+    return written;
+}
+
+bool IngestSenderOpen(IngestSender *s, const char *host, int port, const char **error)
+{
+    const char *dummy;
+    if (!error) error = &dummy;
+    memset(s, 0, sizeof(*s));
+    s->socket = INGEST_BAD_SOCKET;
+    if (!SocketStartup()) { *error = "rede indisponivel"; return false; }
+
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0 || !res)
+    {
+        SocketCleanup();
+        *error = "endereco desconhecido";
+        return false;
+    }
+    struct sockaddr_in addr;
+    memcpy(&addr, res->ai_addr, sizeof(addr));
+    freeaddrinfo(res);
+    addr.sin_port = htons((unsigned short)port);
+    memcpy(s->addr, &addr, sizeof(addr));
+    s->addrLen = (int)sizeof(addr);
+
+    s->socket = (intptr_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s->socket == INGEST_BAD_SOCKET)
+    {
+        SocketCleanup();
+        *error = "nao foi possivel criar o socket";
+        return false;
+    }
+    return true;
+}
+
+void IngestSenderClose(IngestSender *s)
+{
+    if (s->addrLen == 0 || s->socket == INGEST_BAD_SOCKET) return; // never opened or already closed
+    CloseSocket(s->socket);
+    SocketCleanup();
+    memset(s, 0, sizeof(*s));
+}
+
+bool IngestSend(IngestSender *s, const IngestUpdate *u, int n)
+{
+    union { unsigned char bytes[INGEST_MAX_DATAGRAM]; IngestHeader header; } buf;
+    for (int first = 0; first < n; first += INGEST_MAX_UPDATES)
+    {
+        int count = n - first < INGEST_MAX_UPDATES ? n - first : INGEST_MAX_UPDATES;
+        buf.header.magic = INGEST_MAGIC;
+        buf.header.version = INGEST_VERSION;
+        buf.header.count = (uint16_t)count;
+        buf.header.seq = s->seq++;
+        buf.header.reserved = 0;
+        memcpy(buf.bytes + sizeof(IngestHeader), u + first, (size_t)count*sizeof(IngestUpdate));
+        int len = (int)(sizeof(IngestHeader) + (size_t)count*sizeof(IngestUpdate));
+        if ((int)sendto(SOCK(s->socket), (const char *)buf.bytes, len, 0, (const struct sockaddr *)s->addr,
+                        (socklen_t)s->addrLen) != len)
+            return false;
+    }
+    return true;
+}
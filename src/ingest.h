@@ -0,0 +1,140 @@
+/**
+ * @file ingest.h
+ * @brief Recepção de atualizações de trilhas por UDP, entregues à simulação por fila SPSC.
+ *
+ * Datagrama (little-endian, versão 1):
+ * @code
+ * IngestHeader                 16 bytes
+ * IngestUpdate[count]          32 bytes cada, count <= INGEST_MAX_UPDATES
+ * @endcode
+ * A thread de recepção lê os datagramas direto para os slots de uma fila
+ * circular de um produtor e um consumidor (recvmmsg em lotes no Linux,
+ * recvfrom nos demais sistemas), sem cópia intermediária. A thread de
+ * simulação esvazia a fila no início de cada passo com IngestApply, que
+ * decodifica cada slot no próprio buffer e escreve as atualizações direto nos
+ * arrays SoA das entidades. A latência entre a chegada e o cálculo é no
+ * máximo um passo da simulação (1 ms com --sim-hz=1000).
+ *
+ * Há um único emissor por porta: datagramas com @c seq pouco anterior ao
+ * último aplicado (reordenados pela rede) são descartados; um salto grande
+ * para trás é tratado como reinício do emissor.
+ */
+#ifndef WOE_INGEST_H
+#define WOE_INGEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entities.h"
+#include "threads.h"
+
+/** Assinatura no início de cada datagrama ("WOEU" em little-endian). */
+#define INGEST_MAGIC 0x55454f57u
+/** Versão do formato do datagrama. */
+#define INGEST_VERSION 1u
+/** Maior datagrama aceito: cabe num quadro Ethernet sem fragmentação. */
+#define INGEST_MAX_DATAGRAM 1472
+/** Atualizações por datagrama. */
+#define INGEST_MAX_UPDATES ((INGEST_MAX_DATAGRAM - 16)/32)
+/** Slots da fila (potência de dois); um fica sempre vazio. */
+#define INGEST_QUEUE_SLOTS 1024
+/** Datagramas lidos por chamada de recvmmsg. */
+#define INGEST_RECV_BATCH 64
+/** Porta padrão. */
+#define INGEST_DEFAULT_PORT 47800
+/** IngestUpdate::flags: remove a entidade (só com EntityPool; o estado é ignorado). */
+#define INGEST_FLAG_DESPAWN 0x0001u
+
+/** Cabeçalho do datagrama. */
+typedef struct IngestHeader {
+    uint32_t magic;         /**< INGEST_MAGIC. */
+    uint16_t version;       /**< INGEST_VERSION. */
+    uint16_t count;         /**< Atualizações no datagrama. */
+    uint32_t seq;           /**< Número de sequência do emissor (cresce 1 por datagrama). */
+    uint32_t reserved;
+} IngestHeader;
+
+/** Estado novo de uma entidade. */
+typedef struct IngestUpdate {
+    uint16_t kind;          /**< TrackKind: conjunto de destino. */
+    uint16_t flags;         /**< INGEST_FLAG_*; os demais bits são reservados (0). */
+    uint32_t index;         /**< Índice da entidade no conjunto, ou identificador no EntityPool. */
+    float x, y, z;          /**< Posição (unid). */
+    float yaw, pitch, roll; /**< Orientação (rad). */
+} IngestUpdate;
+
+/** Slot da fila: um datagrama como recebido. */
+typedef struct IngestSlot {
+    union {
+        unsigned char bytes[INGEST_MAX_DATAGRAM];
+        IngestHeader header;    /**< Garante o alinhamento dos registros decodificados no lugar. */
+    } data;
+    int length;             /**< Bytes recebidos. */
+    double received;        /**< WoeNow() da recepção. */
+} IngestSlot;
+
+/**
+ * @brief Socket, fila e thread de recepção.
+ *
+ * @c head é do produtor (thread de recepção) e @c tail do consumidor
+ * (IngestApply, sempre a mesma thread); os contadores voláteis podem ser lidos
+ * de qualquer thread.
+ */
+typedef struct Ingest {
+    IngestSlot *slots;      /**< [INGEST_QUEUE_SLOTS] */
+    volatile int head;      /**< Próximo slot a receber. */
+    volatile int tail;      /**< Próximo slot a aplicar. */
+    intptr_t socket;        /**< Socket UDP (interno). */
+    volatile int running;
+    volatile int packets;   /**< Datagramas recebidos. */
+    volatile int full;      /**< Vezes em que a fila encheu e a recepção esperou o consumidor. */
+    WoeThread thread;
+
+    // consumer side
+    uint32_t lastSeq;       /**< @c seq do último datagrama aplicado. */
+    bool haveSeq;
+    long long applied;      /**< Atualizações escritas nas entidades. */
+    int rejected;           /**< Datagramas malformados. */
+    int stale;              /**< Datagramas reordenados descartados. */
+    int ignored;            /**< Atualizações recusadas: índice além da capacidade, pool cheio ou remoção sem pool. */
+    double latency;         /**< Maior atraso (s) entre recepção e aplicação no último IngestApply com dados. */
+} Ingest;
+
+/**
+ * @brief Abre um socket UDP em @p port (todas as interfaces) e inicia a thread de recepção.
+ * @param error [out] Em falha, motivo em texto fixo (pode ser NULL).
+ */
+bool IngestOpen(Ingest *in, int port, const char **error);
+
+/** @brief Para a thread de recepção e fecha o socket. */
+void IngestClose(Ingest *in);
+
+/**
+ * @brief Aplica todos os datagramas na fila a @p air e @p tgt.
+ *
+ * Sem pools (NULL), a entidade de índice k vai para o slot k do seu conjunto;
+ * @c count cresce se preciso e índices além da capacidade são ignorados.
+ * Com o EntityPool do conjunto, @c index é o identificador da entidade: um
+ * identificador novo cria a entidade no fim do store e INGEST_FLAG_DESPAWN a
+ * remove, liberando o slot para a próxima.
+ * @return Atualizações escritas (remoções incluídas).
+ */
+int IngestApply(Ingest *in, EntityStore *air, EntityStore *tgt, EntityPool *airPool, EntityPool *tgtPool);
+
+/** Emissor de datagramas de atualização (para testes e retransmissão de trilhas). */
+typedef struct IngestSender {
+    intptr_t socket;
+    unsigned char addr[32]; /**< Endereço de destino (sockaddr_in, interno). */
+    int addrLen;
+    uint32_t seq;           /**< Próximo número de sequência. */
+} IngestSender;
+
+/** @brief Resolve @p host (nome ou IPv4) e prepara o envio para @p port. */
+bool IngestSenderOpen(IngestSender *s, const char *host, int port, const char **error);
+
+/** @brief Fecha o socket do emissor. */
+void IngestSenderClose(IngestSender *s);
+
+/** @brief Envia @p n atualizações, em tantos datagramas quanto preciso. */
+bool IngestSend(IngestSender *s, const IngestUpdate *u, int n);
+
+#endif /* WOE_INGEST_H */
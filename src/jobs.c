@@ -0,0 +1,125 @@
+/**
+ * @file jobs.c
+ * @brief Pool de threads com roubo de trabalho (veja jobs.h).
+ */
+#include "jobs.h"
+
+#include <string.h>
+
+static int PackRange(int head, int tail) { return head | (tail << 16); }
+
+/** Tira um job do início da faixa (dono). */
+static int PopFront(JobQueue *q)
+{
+    int v = WoeAtomicLoad(&q->range);
+    for (;;)
+    {
+        int head = v & 0xffff, tail = v >> 16;
+        if (head >= tail) return -1;
+        if (WoeAtomicCas(&q->range, &v, PackRange(head + 1, tail))) return head;
+    }
+}
+
+/** Tira um job do fim da faixa (ladrão). */
+static int StealBack(JobQueue *q)
+{
+    int v = WoeAtomicLoad(&q->range);
+    for (;;)
+    {
+        int head = v & 0xffff, tail = v >> 16;
+        if (head >= tail) return -1;
+        if (WoeAtomicCas(&q->range, &v, PackRange(head, tail - 1))) return tail - 1;
+    }
+}
+
+/** Executa jobs até todas as faixas estarem vazias. */
+static void DrainQueues(JobPool *p, int w)
+{
+    int n = p->threads;
+    for (;;)
+    {
+        int job = PopFront(&p->queues[w]);
+        for (int k = 1; job < 0 && k < n; ++k) job = StealBack(&p->queues[(w + k) % n]);
+        if (job < 0) return; // no job is ever added mid-run, so empty means finished
+        p->fn(p->ctx, p->base + job, w);
+    }
+}
+
+static int WorkerMain(void *arg)
+{
+    JobWorker *wk = (JobWorker *)arg;
+    JobPool *p = wk->pool;
+    for (;;)
+    {
+        WoeSemaphoreWait(&p->wake[wk->index]);
+        if (WoeAtomicLoad(&p->quit)) break;
+        DrainQueues(p, wk->index);
+        WoeSemaphorePost(&p->done);
+    }
+    return 0;
+}
+
+bool JobPoolInit(JobPool *p, int threads)
+{
+    memset(p, 0, sizeof(*p));
+    if (threads <= 0) threads = WoeCpuCount();
+    if (threads > JOB_MAX_THREADS) threads = JOB_MAX_THREADS;
+    p->threads = 1;
+    if (!WoeSemaphoreInit(&p->done, 0)) return false;
+    for (int i = 1; i < threads; ++i)
+    {
+        if (!WoeSemaphoreInit(&p->wake[i], 0)) break;
+        p->workers[i].pool = p;
+        p->workers[i].index = i;
+        if (!WoeThreadCreate(&p->handles[i], WorkerMain, &p->workers[i]))
+        {
+            WoeSemaphoreFree(&p->wake[i]);
+            break;
+        }
+        p->threads = i + 1;
+    }
+    if (p->threads == threads) return true;
+    JobPoolFree(p);
+    return false;
+}
+
+void JobPoolFree(JobPool *p)
+{
+    WoeAtomicStore(&p->quit, 1);
+    for (int i = 1; i < p->threads; ++i) WoeSemaphorePost(&p->wake[i]);
+    for (int i = 1; i < p->threads; ++i)
+    {
+        WoeThreadJoin(&p->handles[i]);
+        WoeSemaphoreFree(&p->wake[i]);
+    }
+    WoeSemaphoreFree(&p->done);
+    p->threads = 0;
+}
+
+int JobPoolThreads(const JobPool *p)
+{
+    return p->threads;
+}
+
+void JobPoolRun(JobPool *p, int jobs, JobFn fn, void *ctx)
+{
+    if (p->threads <= 1)
+    {
+        for (int j = 0; j < jobs; ++j) fn(ctx, j, 0);
+        return;
+    }
+    p->fn = fn;
+    p->ctx = ctx;
+    for (int base = 0; base < jobs; base += JOB_MAX_BATCH)
+    {
+        int count = jobs - base < JOB_MAX_BATCH ? jobs - base : JOB_MAX_BATCH;
+        int n = p->threads;
+        p->base = base;
+        // contiguous ranges keep neighbouring tiles on the same core until stealing kicks in
+        for (int w = 0; w < n; ++w)
+            WoeAtomicStore(&p->queues[w].range, PackRange(count*w/n, count*(w + 1)/n));
+        for (int w = 1; w < n; ++w) WoeSemaphorePost(&p->wake[w]);
+        DrainQueues(p, 0);
+        for (int w = 1; w < n; ++w) WoeSemaphoreWait(&p->done);
+    }
+}
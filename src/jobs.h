@@ -0,0 +1,82 @@
+/**
+ * @file jobs.h
+ * @brief Pool de threads com roubo de trabalho para lotes de jobs independentes.
+ *
+ * JobPoolRun() divide os índices [0, jobs) em faixas contíguas, uma por thread.
+ * Cada thread consome a própria faixa pela frente; ao esvaziá-la, rouba jobs
+ * pelo fim da faixa das outras. Cada faixa é um único inteiro atômico
+ * (início | fim << 16) atualizado por CAS, então dono e ladrão nunca pegam o
+ * mesmo job e não há travas no caminho de execução. A thread que chama
+ * participa como thread 0; as demais dormem num semáforo entre chamadas.
+ *
+ * Nada é alocado por chamada: o pool reserva tudo em JobPoolInit().
+ */
+#ifndef WOE_JOBS_H
+#define WOE_JOBS_H
+
+#include <stdbool.h>
+#include "threads.h"
+
+/** Máximo de threads de um pool (incluindo a que chama JobPoolRun). */
+#define JOB_MAX_THREADS 64
+/** Máximo de jobs por despacho interno; lotes maiores são despachados em partes. */
+#define JOB_MAX_BATCH 32767
+
+/**
+ * @brief Função de um job.
+ * @param ctx Contexto passado a JobPoolRun.
+ * @param job Índice do job em [0, jobs).
+ * @param worker Índice da thread que o executa, em [0, JobPoolThreads()).
+ */
+typedef void (*JobFn)(void *ctx, int job, int worker);
+
+/** Faixa de jobs de uma thread, isolada na própria linha de cache. */
+typedef struct JobQueue {
+    volatile int range;     /**< início (bits 0-15) | fim (bits 16-30). */
+    char pad[64 - sizeof(int)];
+} JobQueue;
+
+typedef struct JobPool JobPool;
+
+/** Argumento de partida de uma thread do pool. */
+typedef struct JobWorker {
+    JobPool *pool;
+    int index;
+} JobWorker;
+
+/** Pool de threads. Os campos são internos; use as funções abaixo. */
+struct JobPool {
+    int threads;                            /**< Threads, incluindo a chamadora. */
+    JobQueue queues[JOB_MAX_THREADS];
+    WoeThread handles[JOB_MAX_THREADS];     /**< Índice 0 não usado (thread chamadora). */
+    WoeSemaphore wake[JOB_MAX_THREADS];     /**< Um por thread auxiliar. */
+    WoeSemaphore done;                      /**< Postado por cada auxiliar ao fim do despacho. */
+    JobWorker workers[JOB_MAX_THREADS];
+    JobFn fn;                               /**< Função do despacho atual. */
+    void *ctx;                              /**< Contexto do despacho atual. */
+    int base;                               /**< Primeiro job do despacho atual. */
+    volatile int quit;                      /**< 1 para encerrar as auxiliares. */
+};
+
+/**
+ * @brief Cria o pool e suas threads auxiliares.
+ * @param threads Total de threads; <= 0 usa WoeCpuCount(). Limitado a JOB_MAX_THREADS.
+ *                Com 1, JobPoolRun executa tudo na thread chamadora.
+ * @return false se alguma thread ou semáforo não pôde ser criado.
+ */
+bool JobPoolInit(JobPool *p, int threads);
+
+/** @brief Encerra e aguarda as threads auxiliares. */
+void JobPoolFree(JobPool *p);
+
+/** @brief Número de threads do pool (>= 1). */
+int JobPoolThreads(const JobPool *p);
+
+/**
+ * @brief Executa fn(ctx, job, worker) para cada job em [0, jobs) e espera o fim.
+ *
+ * Não é reentrante: apenas uma thread por vez pode despachar num mesmo pool.
+ */
+void JobPoolRun(JobPool *p, int jobs, JobFn fn, void *ctx);
+
+#endif /* WOE_JOBS_H */
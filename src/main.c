@@ -5,15 +5,35 @@
  * Visualiza uma aeronave e um alvo em 3D, calcula azimute/elevação do alvo e do
  * vetor de frente da aeronave e deriva os ângulos esféricos j, J, E, F e G para
  * desenhar um HUD. Pressione H para alternar rótulos/anotações didáticas.
+ *
+ * Com @c --headless o programa não abre janela: lê trajetórias de um arquivo e
+ * grava j/G/E/F/J por amostra (veja RunHeadless()).
+ *
+ * No modo interativo a integração das entidades e o SolveEngagements rodam numa
+ * thread de simulação com passo fixo (@c --sim-hz, veja sim.h); o laço de
+ * render só amostra o teclado e desenha o instantâneo mais recente.
+ *
+ * Com @c --scenario um roteiro (scenario.h) substitui o teclado e pode correr
+ * acelerado (@c --speed) e saltar por keyframes (@c --seek, PageUp/PageDown);
+ * @c --run-scenario o executa sem janela (veja RunScenario()).
+ *
+ * Com @c --views=N (ou a tecla N) a tela vira uma grade de N vistas, cada uma
+ * acompanhando uma aeronave com câmera e HUD próprios (veja views.h e DrawViewScene()).
+ * Com @c --pacing=on (ou a tecla Y) a cena 3D fica em cache numa render texture
+ * e é refeita numa fração adaptativa da taxa do HUD (veja pacing.h).
  */
 #include "raylib.h"
 #include "raymath.h"
+#include "woe_core.h"
+#include "gpusolve.h"
+#include "render.h"
+#include "pacing.h"
+#include "text.h"
+#include "views.h"
 #include <math.h>
 #include <stdio.h>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * @defgroup config Constantes de configuração
@@ -32,245 +52,776 @@ static const float ROT_SPEED_DEG = 45.0f;
 static const float ROT_SPEED = (float)(ROT_SPEED_DEG * M_PI / 180.0);
 /** Fator de pixels por radiano para o HUD (raio do marcador). */
 static const float HUD_PIXELS_PER_RAD = 220.0f;
+/** Número de alvos adicionais (trilhas) gerados ao redor da cena. */
+static const int DEFAULT_EXTRA_TARGETS = 256;
+/** Número de aeronaves adicionais (observadores) geradas na cena. */
+static const int DEFAULT_EXTRA_AIRCRAFT = 3;
+/** Salto (s) de PageUp/PageDown num cenário. */
+static const double SCENARIO_SEEK_STEP = 5.0;
 /** @} */
 
-/**
- * @brief Converte graus para radianos.
- * @param deg Valor em graus.
- * @return Valor em radianos.
- */
-static inline float rad(float deg) { return deg*(float)M_PI/180.0f; }
+/** Linhas de texto do HUD com formatação em cache (leituras e estatísticas). */
+#define HUD_TEXT_LINES 14
+/** Quads de texto do HUD e do overlay reservados na arena a cada quadro; o lote desenha e recomeça se encher. */
+#define HUD_TEXT_QUADS 4096
+/** Quads por rótulo de trilha ("-180/-90") reservados na arena. */
+#define TRACK_LABEL_QUADS 8
+/** Linhas fixas do lote do quadro (eixos, A-T, mira, nariz). */
+#define FRAME_FIXED_LINES 8
+/** Linhas reservadas por arco j (cerca de 16 segmentos cada). */
+#define FRAME_LINES_PER_ARC 16
+/** Linhas do overlay do profiler (cabeçalho de cada thread e uma por fase). */
+#define PROFILE_OVERLAY_LINES 24
+/** Fases mostradas por thread no overlay. */
+#define PROFILE_OVERLAY_PHASES 8
+/** Janela (s) das médias e máximos do overlay. */
+#define PROFILE_OVERLAY_WINDOW 1.0
 
-/**
- * @brief Converte radianos para graus.
- * @param radv Valor em radianos.
- * @return Valor em graus.
- */
-static inline float deg(float radv) { return radv*180.0f/(float)M_PI; }
+/** Amostras processadas por bloco no modo headless. */
+#define HEADLESS_CHUNK 4096
 
 /**
- * @brief Versão segura de acosf com clamp do argumento em [-1, 1].
+ * @brief Lê uma linha de trajetória "t ax ay az yaw pitch roll tx ty tz" (vírgulas valem como espaço).
+ * @param line Linha lida; é modificada.
+ * @param v [out] Os 10 campos, ângulos ainda em graus.
+ * @return 1 se leu uma amostra, 0 para linha vazia ou comentário, -1 em erro de formato.
  */
-static inline float safe_acos(float x) {
-    if (x > 1.0f) x = 1.0f;
-    if (x < -1.0f) x = -1.0f;
-    return acosf(x);
+static int ParseTrajectoryLine(char *line, float v[10])
+{
+    for (char *c = line; *c; ++c) if (*c == ',') *c = ' ';
+    char *p = line;
+    while (*p == ' ' || *p == '\t') ++p;
+    if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') return 0;
+    return sscanf(p, "%f %f %f %f %f %f %f %f %f %f",
+                  &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9]) == 10 ? 1 : -1;
 }
 
 /**
- * @brief Calcula azimute e elevação do alvo T em relação à aeronave A.
+ * @brief Modo headless: resolve a geometria de um arquivo de trajetórias, sem janela.
+ *
+ * Entrada: texto, uma amostra por linha, campos separados por espaço ou vírgula:
+ * @code
+ * t  ax ay az  yaw pitch roll  tx ty tz
+ * @endcode
+ * com ângulos em graus. Linhas vazias ou iniciadas por '#' são ignoradas.
  *
- * Fórmulas:
- *  - Az = atan2( X_T - X_A, Y_T - Y_A )
- *  - El = atan2( Z_T - Z_A, sqrt((X_T-X_A)^2 + (Y_T-Y_A)^2) )
+ * Saída: CSV com cabeçalho e as colunas
+ * @c t,AzT,ElT,AzR,ElR,j,G,E,F,J (graus). As amostras são lidas em blocos de
+ * HEADLESS_CHUNK e resolvidas sem limite de quadros, na velocidade da CPU.
  *
- * @param A Posição da aeronave.
- * @param T Posição do alvo.
- * @param Az [out] Azimute (rad).
- * @param El [out] Elevação (rad).
+ * @param inPath Arquivo de entrada ("-" para stdin).
+ * @param outPath Arquivo de saída ("-" para stdout).
+ * @param mode Caminho de cálculo (como em SolveEngagements).
+ * @return 0 em sucesso; 1 em erro de E/S ou de formato (mensagem em stderr).
  */
-static void ComputeAzEl(Vector3 A, Vector3 T, float *Az, float *El)
+static int RunHeadless(const char *inPath, const char *outPath, SolverMode mode)
 {
-    Vector3 d = { T.x - A.x, T.y - A.y, T.z - A.z };
-    float horiz = sqrtf(d.x*d.x + d.y*d.y);
-    float az = atan2f(d.x, d.y); // note order per user's formula
-    float el = atan2f(d.z, horiz);
-    if (Az) *Az = az;
-    if (El) *El = el;
+    FILE *in = strcmp(inPath, "-") == 0 ? stdin : fopen(inPath, "r");
+    if (!in) { fprintf(stderr, "woe3d: nao foi possivel abrir '%s'\n", inPath); return 1; }
+    FILE *out = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w");
+    if (!out)
+    {
+        fprintf(stderr, "woe3d: nao foi possivel criar '%s'\n", outPath);
+        if (in != stdin) fclose(in);
+        return 1;
+    }
+
+    // SoA chunk buffers: t + 9 result columns
+    enum { C_T, C_AZT, C_ELT, C_AZR, C_ELR, C_J, C_G, C_E, C_F, C_JJ, C_COUNT };
+    float *col[C_COUNT];
+    float *mem = (float *)malloc(sizeof(float)*HEADLESS_CHUNK*C_COUNT);
+    if (!mem)
+    {
+        fprintf(stderr, "woe3d: memoria insuficiente\n");
+        if (in != stdin) fclose(in);
+        if (out != stdout) fclose(out);
+        return 1;
+    }
+    for (int c = 0; c < C_COUNT; ++c) col[c] = mem + (size_t)c*HEADLESS_CHUNK;
+
+    fprintf(out, "t,AzT,ElT,AzR,ElR,j,G,E,F,J\n");
+
+    char line[512];
+    long lineNo = 0, samples = 0;
+    int n = 0, status = 0;
+    bool eof = false;
+    while (!eof)
+    {
+        if (fgets(line, sizeof(line), in))
+        {
+            ++lineNo;
+            float v[10];
+            int got = ParseTrajectoryLine(line, v);
+            if (got == 0) continue;
+            if (got < 0)
+            {
+                fprintf(stderr, "woe3d: %s:%ld: esperados 10 campos (t ax ay az yaw pitch roll tx ty tz)\n",
+                        inPath, lineNo);
+                status = 1;
+                break;
+            }
+
+            float t = v[0], yaw = v[4], pitch = v[5], roll = v[6];
+            WoeVec3 A = { v[1], v[2], v[3] }, T = { v[7], v[8], v[9] };
+            WoeVec3 fwd = ForwardFromYPR(rad(yaw), rad(pitch), rad(roll));
+            col[C_T][n] = t;
+            ComputeAzEl(A, T, &col[C_AZT][n], &col[C_ELT][n]);
+            ComputeAzElFromVector(fwd, &col[C_AZR][n], &col[C_ELR][n]);
+            if (mode == SOLVER_VECTOR)
+            {
+                ComputeSphericalAnglesVector(fwd, (WoeVec3){ T.x - A.x, T.y - A.y, T.z - A.z }, &col[C_J][n], &col[C_G][n]);
+                col[C_E][n] = col[C_F][n] = col[C_JJ][n] = 0.0f;
+            }
+            else if (mode == SOLVER_SCALAR)
+            {
+                ComputeSphericalAngles(col[C_AZT][n], col[C_ELT][n], col[C_AZR][n], col[C_ELR][n],
+                                       &col[C_J][n], &col[C_G][n], &col[C_E][n], &col[C_F][n], &col[C_JJ][n]);
+            }
+            if (++n < HEADLESS_CHUNK) continue;
+        }
+        else
+        {
+            eof = true;
+            if (ferror(in))
+            {
+                fprintf(stderr, "woe3d: erro de leitura em '%s'\n", inPath);
+                status = 1;
+            }
+        }
+
+        if (mode == SOLVER_BATCH)
+        {
+            ComputeSphericalAnglesBatch(n, col[C_AZT], col[C_ELT], col[C_AZR], col[C_ELR],
+                                        col[C_J], col[C_G], col[C_E], col[C_F], col[C_JJ]);
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            fprintf(out, "%.6f", col[C_T][i]);
+            for (int c = C_AZT; c < C_COUNT; ++c) fprintf(out, ",%.6f", deg(col[c][i]));
+            fputc('\n', out);
+        }
+        samples += n;
+        n = 0;
+    }
+
+    free(mem);
+    if (in != stdin) fclose(in);
+    if (out != stdout) { if (fclose(out) != 0) status = 1; }
+    else fflush(out);
+    if (status == 0) fprintf(stderr, "woe3d: %ld amostras resolvidas\n", samples);
+    return status;
 }
 
 /**
- * @brief Calcula o vetor de frente a partir de yaw/pitch/roll.
+ * @brief Converte trajetórias em texto (formato de RunHeadless) para um arquivo de trilhas binário.
  *
- * Mundo Z-up; yaw em Z, pitch em X, roll em Y. O vetor base é +Y do corpo.
- * @param yaw Rotação yaw (rad).
- * @param pitch Rotação pitch (rad).
- * @param roll Rotação roll (rad).
- * @return Vetor unitário frente da aeronave.
+ * Gera duas trilhas: a aeronave (posição e yaw/pitch/roll) e o alvo (só
+ * posição). Os instantâneos devem ser não decrescentes.
+ * @return 0 em sucesso; 1 em erro (mensagem em stderr).
  */
-static Vector3 ForwardFromYPR(float yaw, float pitch, float roll)
+static int RunConvertTracks(const char *inPath, const char *outPath)
 {
-    // Build rotation matrices and apply to forward = (0,1,0).
-    // Yaw around Z
-    float cy = cosf(yaw), sy = sinf(yaw);
-    // Pitch around X
-    float cp = cosf(pitch), sp = sinf(pitch);
-    // Roll around Y (does not affect forward magnitude but included for completeness)
-    float cr = cosf(roll), sr = sinf(roll);
-
-    // Compose R = Rz(yaw) * Rx(pitch) * Ry(roll)
-    // Apply to forward v=(0,1,0)
-    // First Ry(roll) on v:
-    Vector3 v = { 0.0f*cr + 0.0f*sr, 1.0f, -0.0f*sr + 0.0f*cr }; // still (0,1,0)
-    // Then Rx(pitch):
-    Vector3 v2 = { v.x, cp*v.y - sp*v.z, sp*v.y + cp*v.z };
-    // Then Rz(yaw):
-    Vector3 v3 = { cy*v2.x - sy*v2.y, sy*v2.x + cy*v2.y, v2.z };
-    // Normalize
-    float n = sqrtf(v3.x*v3.x + v3.y*v3.y + v3.z*v3.z);
-    if (n > 0) { v3.x/=n; v3.y/=n; v3.z/=n; }
-    return v3;
+    FILE *in = strcmp(inPath, "-") == 0 ? stdin : fopen(inPath, "r");
+    if (!in) { fprintf(stderr, "woe3d: nao foi possivel abrir '%s'\n", inPath); return 1; }
+
+    TrackSample *buf[2] = { NULL, NULL };
+    int64_t count = 0, capacity = 0;
+    long lineNo = 0;
+    int status = 0;
+    char line[512];
+    while (status == 0 && fgets(line, sizeof(line), in))
+    {
+        ++lineNo;
+        float v[10];
+        int got = ParseTrajectoryLine(line, v);
+        if (got == 0) continue;
+        if (got < 0 || (count > 0 && v[0] < buf[0][count - 1].t))
+        {
+            fprintf(stderr, "woe3d: %s:%ld: %s\n", inPath, lineNo,
+                    got < 0 ? "esperados 10 campos (t ax ay az yaw pitch roll tx ty tz)" : "tempo decrescente");
+            status = 1;
+            break;
+        }
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity*2 : 4096;
+            for (int k = 0; k < 2 && status == 0; ++k)
+            {
+                TrackSample *p = (TrackSample *)realloc(buf[k], sizeof(TrackSample)*(size_t)capacity);
+                if (p) buf[k] = p;
+                else { fprintf(stderr, "woe3d: memoria insuficiente\n"); status = 1; }
+            }
+            if (status) break;
+        }
+        buf[0][count] = (TrackSample){ v[0], v[1], v[2], v[3], rad(v[4]), rad(v[5]), rad(v[6]) };
+        buf[1][count] = (TrackSample){ v[0], v[7], v[8], v[9], 0.0f, 0.0f, 0.0f };
+        ++count;
+    }
+    if (status == 0 && ferror(in)) { fprintf(stderr, "woe3d: erro de leitura em '%s'\n", inPath); status = 1; }
+    if (in != stdin) fclose(in);
+
+    if (status == 0)
+    {
+        const TrackKind kinds[2] = { TRACK_KIND_AIRCRAFT, TRACK_KIND_TARGET };
+        const TrackSample *samples[2] = { buf[0], buf[1] };
+        const int64_t counts[2] = { count, count };
+        if (!TrackFileWrite(outPath, 2, kinds, samples, counts))
+        {
+            fprintf(stderr, "woe3d: nao foi possivel gravar '%s'\n", outPath);
+            status = 1;
+        }
+        else fprintf(stderr, "woe3d: %lld amostras gravadas em 2 trilhas\n", (long long)count);
+    }
+    free(buf[0]);
+    free(buf[1]);
+    return status;
 }
 
+/** Taxa de envio de --send-tracks (Hz). */
+#define SEND_TRACKS_HZ 100.0
+
 /**
- * @brief Calcula azimute/elevação de um vetor no espaço.
- * @param v Vetor 3D (não precisa ser unitário).
- * @param Az [out] Azimute (rad).
- * @param El [out] Elevação (rad).
+ * @brief Reproduz um arquivo de trilhas em tempo real como datagramas de atualização.
+ *
+ * Alimenta outra instância com @c --listen, na mesma máquina ou na rede. A
+ * k-ésima trilha de cada tipo vai para o índice k, como em TrackFileApply.
+ * @param dest "host" ou "host:porta" (porta padrão INGEST_DEFAULT_PORT).
  */
-static void ComputeAzElFromVector(Vector3 v, float *Az, float *El)
+static int RunSendTracks(const char *path, const char *dest)
 {
-    float horiz = sqrtf(v.x*v.x + v.y*v.y);
-    float az = atan2f(v.x, v.y);
-    float el = atan2f(v.z, horiz);
-    if (Az) *Az = az;
-    if (El) *El = el;
+    TrackFile f;
+    const char *err;
+    if (!TrackFileOpen(&f, path, &err)) { fprintf(stderr, "woe3d: '%s': %s\n", path, err); return 1; }
+
+    char host[256];
+    int port = INGEST_DEFAULT_PORT;
+    const char *colon = strrchr(dest, ':');
+    size_t hostLen = colon ? (size_t)(colon - dest) : strlen(dest);
+    if (colon) port = atoi(colon + 1);
+    if (hostLen == 0 || hostLen >= sizeof(host) || port <= 0 || port > 65535)
+    {
+        fprintf(stderr, "woe3d: destino invalido '%s' (esperado HOST[:PORTA])\n", dest);
+        TrackFileClose(&f);
+        return 1;
+    }
+    memcpy(host, dest, hostLen);
+    host[hostLen] = '\0';
+
+    IngestSender sender;
+    IngestUpdate *u = (IngestUpdate *)calloc((size_t)(f.count ? f.count : 1), sizeof(IngestUpdate));
+    if (!u || !IngestSenderOpen(&sender, host, port, &err))
+    {
+        fprintf(stderr, "woe3d: '%s': %s\n", dest, u ? err : "memoria insuficiente");
+        free(u);
+        TrackFileClose(&f);
+        return 1;
+    }
+
+    int status = 0;
+    long frames = 0;
+    double t0 = WoeNow();
+    for (double t = f.start; status == 0; t = f.start + (double)frames/SEND_TRACKS_HZ)
+    {
+        int n = 0, slot[2] = { 0, 0 };
+        for (int e = 0; e < f.count; ++e)
+        {
+            int kind = f.entities[e].kind == TRACK_KIND_TARGET ? 1 : 0;
+            int k = slot[kind]++;
+            TrackSample s;
+            if (!TrackSampleAt(&f, e, t, &s)) continue;
+            u[n++] = (IngestUpdate){ (uint16_t)f.entities[e].kind, 0, (uint32_t)k, s.x, s.y, s.z, s.yaw, s.pitch, s.roll };
+        }
+        if (!IngestSend(&sender, u, n)) { fprintf(stderr, "woe3d: falha ao enviar para '%s'\n", dest); status = 1; }
+        if (t >= f.end) break;
+        ++frames;
+        double wait = t0 + (double)frames/SEND_TRACKS_HZ - WoeNow();
+        if (wait > 0.0) WoeSleep(wait);
+    }
+    if (status == 0) fprintf(stderr, "woe3d: %ld quadros de %d trilhas enviados para %s:%d\n", frames + 1, f.count, host, port);
+    IngestSenderClose(&sender);
+    free(u);
+    TrackFileClose(&f);
+    return status;
 }
 
 /**
- * @brief Deriva ângulos esféricos a partir de Az/El do alvo (T) e do vetor frente (R).
+ * @brief Executa um cenário sem janela, na velocidade da CPU, e grava um CSV de amostras.
+ *
+ * Mesma simulação do modo interativo (SimStep, passo fixo do cenário), sem
+ * thread própria nem espera: o laço só chama SimStep até a duração do
+ * cenário. A cada @p sampleEvery passos (e no último) grava uma linha
+ * @c tick,t,pares,resumo,AzT,ElT,j,G,E,F,J, com o par (0, 0) em graus e o
+ * resumo de SimSnapshotDigest em hexadecimal. Ao fim, informa em stderr os
+ * passos, a velocidade relativa ao tempo real e o resumo final: duas
+ * execuções com as mesmas opções devem dar o mesmo valor.
  *
- * Calcula j e G, além dos intermediários E, F, J usados no HUD.
- * @param AzT Azimute do alvo (rad).
- * @param ElT Elevação do alvo (rad).
- * @param AzR Azimute do vetor frente (rad).
- * @param ElR Elevação do vetor frente (rad).
- * @param out_j [out] Ângulo j (rad).
- * @param out_G [out] Ângulo G (rad).
- * @param out_E [out] Ângulo E (rad).
- * @param out_F [out] Ângulo F (rad).
- * @param out_J [out] Ângulo J (rad).
+ * @param path Arquivo de cenário (scenario.h).
+ * @param outPath CSV de saída ("-" para stdout).
+ * @param sampleEvery Passos entre linhas; <= 0 para uma por segundo simulado.
+ * @param recordPath Gravação colunar de todos os pares (Recorder), ou NULL.
+ * @return 0 em sucesso; 1 em erro (mensagem em stderr).
  */
-static void ComputeSphericalAngles(float AzT, float ElT, float AzR, float ElR,
-                                   float *out_j, float *out_G,
-                                   float *out_E, float *out_F, float *out_J)
+static int RunScenario(const char *path, const char *outPath, long sampleEvery, SolverMode solver, bool cull,
+                       bool incremental, bool predict, float interceptSpeed, int threads, const char *recordPath)
 {
-    float cf = cosf(AzT)*cosf(ElT);
-    float f = safe_acos(cf);
-
-    float ch = cosf(AzR)*cosf(ElR);
-    float h = safe_acos(ch);
-
-    // ctn(C) = sin(AzT)/tan(ElT) => C = atan2(tan(ElT), sin(AzT))
-    float C = atan2f(tanf(ElT), sinf(AzT));
-    // ctn(D) = sin(AzR)/tan(ElR) => D = atan2(tan(ElR), sin(AzR))
-    float D = atan2f(tanf(ElR), sinf(AzR));
-
-    float J = (float)M_PI - C - D;
+    Scenario sc;
+    int line;
+    const char *err;
+    if (!ScenarioLoad(&sc, path, &line, &err))
+    {
+        if (line > 0) fprintf(stderr, "woe3d: %s:%d: %s\n", path, line, err);
+        else fprintf(stderr, "woe3d: '%s': %s\n", path, err);
+        return 1;
+    }
+    FILE *out = strcmp(outPath, "-") == 0 ? stdout : fopen(outPath, "w");
+    if (!out)
+    {
+        fprintf(stderr, "woe3d: nao foi possivel criar '%s'\n", outPath);
+        ScenarioFree(&sc);
+        return 1;
+    }
 
-    // cos(j) = cos(f)cos(h) + sin(f)sin(h)cos(J)
-    float j = safe_acos(cosf(f)*cosf(h) + sinf(f)*sinf(h)*cosf(J));
+    Simulation sim;
+    int maxAir = sc.aircraft > 0 ? sc.aircraft : 1, maxTgt = sc.targets > 0 ? sc.targets : 1;
+    JobPool pool;
+    if (threads <= 0) threads = WoeCpuCount();
+    if (!SimInit(&sim, maxAir, maxTgt, 1.0/sc.dt, MOVE_SPEED, ROT_SPEED))
+    {
+        fprintf(stderr, "woe3d: memoria insuficiente\n");
+        if (out != stdout) fclose(out);
+        ScenarioFree(&sc);
+        return 1;
+    }
+    if (!JobPoolInit(&pool, threads)) JobPoolInit(&pool, 1);
+    ScenarioSpawn(&sc, &sim.air, &sim.tgt);
+    sim.scenario = &sc;
+    sim.pool = &pool;
+    sim.interceptSpeed = interceptSpeed;
+    SimSetSolver(&sim, solver);
+    SimSetCulling(&sim, cull);
+    SimSetIncremental(&sim, incremental);
+    SimSetPrediction(&sim, predict);
+    Recorder recorder;
+    if (recordPath)
+    {
+        if (!RecorderOpen(&recorder, recordPath, maxAir*maxTgt, RECORD_DEFAULT_BLOCK_ROWS, &err))
+        {
+            fprintf(stderr, "woe3d: '%s': %s\n", recordPath, err);
+            JobPoolFree(&pool);
+            SimFree(&sim);
+            if (out != stdout) fclose(out);
+            ScenarioFree(&sc);
+            return 1;
+        }
+        sim.recorder = &recorder;
+    }
 
-    // E from ctn(E) = sin(ElR)/tan(AzR) => E = atan2(tan(AzR), sin(ElR))
-    float E = atan2f(tanf(AzR), sinf(ElR));
+    long steps = (long)(sc.duration/sc.dt + 0.5);
+    if (sampleEvery <= 0) sampleEvery = (long)(1.0/sc.dt + 0.5) > 0 ? (long)(1.0/sc.dt + 0.5) : 1;
+    fprintf(out, "tick,t,pares,resumo,AzT,ElT,j,G,E,F,J\n");
+    double t0 = WoeNow();
+    SimReset(&sim);
+    const SimSnapshot *snap = SimAcquire(&sim);
+    for (;;)
+    {
+        if (snap->tick % sampleEvery == 0 || snap->tick >= steps)
+        {
+            const PairResults *p = &snap->primary;
+            bool any = snap->air.count > 0 && snap->tgt.count > 0;
+            fprintf(out, "%ld,%.6f,%d,%016llx", snap->tick, snap->time,
+                    snap->culled ? snap->cand.total : snap->air.count*snap->tgt.count, SimSnapshotDigest(snap));
+            if (any)
+                fprintf(out, ",%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n", deg(p->AzT[0]), deg(p->ElT[0]), deg(p->j[0]),
+                        deg(p->G[0]), deg(p->E[0]), deg(p->F[0]), deg(p->J[0]));
+            else
+                fprintf(out, ",,,,,,,\n");
+        }
+        if (snap->tick >= steps) break;
+        SimStep(&sim);
+        snap = SimAcquire(&sim);
+    }
+    double elapsed = WoeNow() - t0;
+    unsigned long long digest = SimSnapshotDigest(snap);
 
-    // F via sin(F) = sin(J)*sin(f)/sin(j)
-    float denom = sinf(j);
-    float F = 0.0f;
-    if (fabsf(denom) > 1e-6f) {
-        float s = sinf(J)*sinf(f)/denom;
-        if (s > 1.0f) s = 1.0f;
-        if (s < -1.0f) s = -1.0f;
-        F = asinf(s);
-    } else {
-        F = 0.0f;
+    int status = 0;
+    if (ferror(out)) { fprintf(stderr, "woe3d: erro de escrita em '%s'\n", outPath); status = 1; }
+    if (out != stdout) fclose(out);
+    if (recordPath && !RecorderClose(&recorder))
+    {
+        fprintf(stderr, "woe3d: '%s': erro de escrita na gravacao\n", recordPath);
+        status = 1;
     }
+    fprintf(stderr, "woe3d: %ld passos (%.1f s simulados) em %.3f s, %.1fx o tempo real; resumo %016llx\n",
+            steps, steps*sc.dt, elapsed, elapsed > 0.0 ? steps*sc.dt/elapsed : 0.0, digest);
+    JobPoolFree(&pool);
+    SimFree(&sim);
+    ScenarioFree(&sc);
+    return status;
+}
 
-    float G = (float)M_PI - E - F;
+/** Entradas comuns às vistas de um quadro e contadores somados sobre elas. */
+typedef struct ViewFrame {
+    const SimSnapshot *snap;
+    const EntityStore *air, *tgt;
+    InstancedRenderer *inst;    /**< Com InstancedRendererShare já feito; NULL desenha em modo imediato. */
+    const GpuSolver *gpu;       /**< Resultados na GPU (arcos e marcadores); NULL usa as linhas do instantâneo. */
+    FrameArena *arena;
+    LineBatch *lines;
+    PairResults *own;           /**< Par (aeronave da vista, alvo 0) de cada vista, no índice da vista. */
+    float kpix;                 /**< px por radiano do HUD, na escala da célula. */
+    bool showAnn;
+    CullStats airCull, tgtCull, arcCull;
+} ViewFrame;
 
-    if (out_j) *out_j = j;
-    if (out_G) *out_G = G;
-    if (out_E) *out_E = E;
-    if (out_F) *out_F = F;
-    if (out_J) *out_J = J;
-}
+/** Linha de pares de uma aeronave no instantâneo, como a vista a lê. */
+typedef struct ViewRow {
+    const PairResults *row;     /**< Resultados; NULL sem linha (GPU ou aeronave fora do passe). */
+    const int *rowTarget;       /**< Alvo de cada posição, com descarte; NULL: a posição k é o alvo k. */
+    int count;                  /**< Posições da linha. */
+    int base;                   /**< Índice da posição 0 em @c row (e em SimSnapshot::predict). */
+    int k0;                     /**< Posição do alvo 0, ou -1. */
+    const PredictResults *pred; /**< Predição da linha, se o alvo 0 está nela. */
+} ViewRow;
 
 /**
- * @brief Desenha um modelo simples de aeronave como uma seta em A com yaw/pitch/roll.
- * @param A Posição da aeronave.
- * @param yaw Yaw (rad).
- * @param pitch Pitch (rad).
- * @param roll Roll (rad).
- * @param col Cor do corpo.
+ * @brief Linha da aeronave @p a e par com o alvo 0, resolvido aqui (um alvo), pois pode ter ficado fora do cone.
+ *
+ * O par vai para @c f->own no índice @p v.
  */
-static void DrawAircraft(Vector3 A, float yaw, float pitch, float roll, Color col)
+static ViewRow ViewRowSolve(ViewFrame *f, int v, int a)
 {
-    // Build basis vectors from yaw/pitch/roll: forward, right, up
-    Vector3 fwd = ForwardFromYPR(yaw, pitch, roll);
-
-    // Approximate right = normalize( fwd x worldUp ) then up = right x fwd
-    Vector3 worldUp = {0,0,1};
-    Vector3 right = Vector3CrossProduct(fwd, worldUp);
-    float rn = sqrtf(right.x*right.x + right.y*right.y + right.z*right.z);
-    if (rn < 1e-6f) right = (Vector3){1,0,0}; else { right.x/=rn; right.y/=rn; right.z/=rn; }
-    Vector3 up = Vector3CrossProduct(right, fwd);
-
-    float bodyLen = 3.0f;
-    float bodyRad = 0.2f;
-
-    Vector3 nose = { A.x + fwd.x*bodyLen, A.y + fwd.y*bodyLen, A.z + fwd.z*bodyLen };
-    // Draw body
-    DrawCylinderEx(A, nose, bodyRad, 0.01f, 16, col);
-    // Wings
-    Vector3 wL = { A.x + right.x*1.2f, A.y + right.y*1.2f, A.z + right.z*1.2f };
-    Vector3 wR = { A.x - right.x*1.2f, A.y - right.y*1.2f, A.z - right.z*1.2f };
-    DrawCylinderEx(wL, wR, 0.05f, 0.05f, 8, Fade(col, 0.8f));
-    // Tail fin
-    Vector3 tailTop = { A.x + up.x*0.8f, A.y + up.y*0.8f, A.z + up.z*0.8f };
-    DrawCylinderEx(A, tailTop, 0.03f, 0.03f, 8, Fade(col, 0.8f));
+    const SimSnapshot *snap = f->snap;
+    // slot k holds target k, or the k-th culled candidate
+    ViewRow r = { NULL, NULL, 0, 0, -1, NULL };
+    if (!f->gpu && snap->culled && a < snap->cand.aircraft)
+    {
+        r.base = a*snap->cand.stride;
+        r.row = &snap->cand.pairs;
+        r.count = snap->cand.count[a];
+        r.rowTarget = snap->cand.target + r.base;
+    }
+    else if (!f->gpu && !snap->culled && a < snap->pairs.aircraft)
+    {
+        r.base = a*snap->pairs.targets;
+        r.row = &snap->pairs;
+        r.count = snap->pairs.targets;
+    }
+    for (int k = 0; k < r.count && r.k0 < 0; ++k)
+        if ((r.rowTarget ? r.rowTarget[k] : k) == 0) r.k0 = k;
+    if (snap->predicted && r.k0 >= 0 && a < snap->predict.aircraft) r.pred = &snap->predict;
+    // the snapshot's tier, not the solver's: the sim thread may switch that one meanwhile
+    SolveEngagementRowTier(f->air, a, 1, &f->tgt->x[0], &f->tgt->y[0], &f->tgt->z[0], f->own, v, snap->solver,
+                           snap->trig);
+    return r;
 }
 
 /**
- * @brief Projeta ponto 3D para tela e desenha texto próximo a ele.
+ * @brief Cena 3D da vista @p v, que observa a aeronave @p a, na sua render texture.
+ *
+ * Culling e nível de detalhe com a câmera da vista; as matrizes de modelo
+ * são as compartilhadas do quadro.
  */
-static void DrawTextAt3D(Camera3D cam, Vector3 p, const char *text, int fontSize, Color col, int screenW, int screenH)
+static void DrawViewScene(ViewGrid *g, int v, int a, ViewFrame *f, const ViewRow *r)
 {
-    Vector2 s = GetWorldToScreenEx(p, cam, screenW, screenH);
-    DrawText(text, (int)s.x + 6, (int)s.y - fontSize - 2, fontSize, col);
+    const EntityStore *air = f->air, *tgt = f->tgt;
+    const Camera3D cam = g->cam[v];
+    float j = f->own->j[v];
+    WoeBasis basis = EntityBasis(air, a);
+    Vector3 A = { air->x[a], air->y[a], air->z[a] };
+    Vector3 T = { tgt->x[0], tgt->y[0], tgt->z[0] };
+    Vector3 fwd = FromWoe(basis.fwd);
+
+    unsigned char *airVis = FRAME_ARENA_ARRAY(f->arena, unsigned char, air->count + tgt->count);
+    unsigned char *tgtVis = airVis ? airVis + air->count : NULL;
+    Frustum frustum = FrustumFromCamera(cam, (float)g->cellW/(float)g->cellH);
+    if (airVis)
+    {
+        CullEntities(&frustum, air, 0, AIRCRAFT_BOUND_RADIUS, airVis, &f->airCull);
+        CullEntities(&frustum, tgt, 0, 0.4f, tgtVis, &f->tgtCull);
+    }
+
+    BeginTextureMode(g->target[v]);
+    ClearBackground(RAYWHITE);
+    BeginMode3D(cam);
+    DrawGrid(40, 1.0f);
+    LineBatchBegin(f->lines, f->arena, FRAME_FIXED_LINES + (f->showAnn ? FRAME_LINES_PER_ARC*(r->count + 1) : 0));
+    LineBatchAdd(f->lines, (Vector3){0,0,0}, (Vector3){5,0,0}, RED);
+    LineBatchAdd(f->lines, (Vector3){0,0,0}, (Vector3){0,5,0}, GREEN);
+    LineBatchAdd(f->lines, (Vector3){0,0,0}, (Vector3){0,0,5}, BLUE);
+
+    if (airVis)
+    {
+        // the observer and target 0 stand out; everything else goes through the shared instances
+        if (airVis[a]) DrawAircraftBasis(A, basis, DARKBLUE);
+        if (tgtVis[0]) DrawSphere(T, 0.4f, MAROON);
+        airVis[a] = 0;
+        if (f->inst)
+        {
+            InstancedRendererSetCamera(f->inst, &cam, g->cellH);
+            DrawAircraftInstanced(f->inst, air, 0, airVis, DARKGREEN);
+            DrawTargetsInstanced(f->inst, tgt, 1, tgtVis, 0.15f, Fade(MAROON, 0.5f));
+        }
+        else
+        {
+            for (int i = 0; i < air->count; ++i)
+                if (airVis[i]) DrawAircraftBasis((Vector3){ air->x[i], air->y[i], air->z[i] }, EntityBasis(air, i), DARKGREEN);
+            for (int t = 1; t < tgt->count; ++t)
+                if (tgtVis[t]) DrawSphere((Vector3){ tgt->x[t], tgt->y[t], tgt->z[t] }, 0.15f, Fade(MAROON, 0.5f));
+        }
+    }
+    LineBatchAdd(f->lines, A, T, Fade(MAROON, 0.6f));
+    if (r->pred)
+    {
+        int i = r->base + r->k0;
+        LineBatchAdd(f->lines, A, (Vector3){ r->pred->px[i], r->pred->py[i], r->pred->pz[i] }, Fade(ORANGE, 0.8f));
+    }
+    LineBatchAdd(f->lines, A, Vector3Add(A, Vector3Scale(fwd, 4.0f)), BLUE);
+    if (f->showAnn)
+    {
+        bool arcsVisible = FrustumSphereVisible(&frustum, A, 1.5f);
+        int tested = f->gpu ? tgt->count : r->count + 1;
+        f->arcCull.tested += tested;
+        f->arcCull.visible += arcsVisible ? tested : 0;
+        for (int k = r->count - 1; arcsVisible && k >= -1; --k)
+        {
+            int t = k < 0 ? 0 : r->rowTarget ? r->rowTarget[k] : k;
+            if (k >= 0 && t == 0) continue;
+            Vector3 dAT = { tgt->x[t] - A.x, tgt->y[t] - A.y, tgt->z[t] - A.z };
+            float dn = Vector3Length(dAT);
+            if (dn <= 1e-6f) continue;
+            Vector3 u = Vector3Scale(dAT, 1.0f/dn);
+            if (k < 0) LineBatchAddArc(f->lines, A, fwd, u, j, 1.5f, PURPLE);
+            else LineBatchAddArc(f->lines, A, fwd, u, r->row->j[r->base + k], 1.2f, Fade(PURPLE, 0.2f));
+        }
+        if (f->gpu && arcsVisible) GpuSolverDrawArcs(f->gpu, a, 0, 1.2f, 0.01f, cam.position, Fade(PURPLE, 0.2f));
+    }
+    LineBatchDraw(f->lines);
+    EndMode3D();
+    EndTextureMode();
 }
 
 /**
- * @brief Desenha um arco 3D no plano definido por u e v, centrado em originC.
- * @param originC Centro do arco.
- * @param u Vetor unitário inicial.
- * @param v Vetor unitário final.
- * @param angleJ Ângulo entre u e v (rad).
- * @param radius Raio do arco.
- * @param col Cor do arco.
+ * @brief HUD da vista @p v (aeronave @p a) na tela, centrado na sua célula.
+ *
+ * Fica fora da render texture para ser refeito a cada quadro mesmo com a
+ * cena em cache (pacing.h).
  */
-static void DrawArc3D(Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius, Color col)
+static void DrawViewHud(const ViewGrid *g, int v, int a, const ViewFrame *f, const ViewRow *r,
+                        int screenW, int screenH)
 {
-    if (angleJ <= 1e-5f) return;
-    // plane normal
-    Vector3 n = Vector3CrossProduct(u, v);
-    float nn = Vector3Length(n);
-    if (nn < 1e-6f) return; // nearly colinear
-    n = Vector3Scale(n, 1.0f/nn);
-    // w = normalized (n x u) lies on the plane and orthogonal to u
-    Vector3 w = Vector3CrossProduct(n, u);
-    float wn = Vector3Length(w);
-    if (wn < 1e-6f) return;
-    w = Vector3Scale(w, 1.0f/wn);
-
-    const int steps = 32;
-    float dt = angleJ/steps;
-    Vector3 prev = Vector3Add(originC, Vector3Scale(Vector3Add(Vector3Scale(u, cosf(0)), Vector3Scale(w, sinf(0))), radius));
-    for (int i = 1; i <= steps; ++i)
-    {
-        float t = dt * i;
-        Vector3 curDir = Vector3Add(Vector3Scale(u, cosf(t)), Vector3Scale(w, sinf(t)));
-        Vector3 cur = Vector3Add(originC, Vector3Scale(curDir, radius));
-        DrawLine3D(prev, cur, col);
-        prev = cur;
+    Rectangle cell = ViewGridCell(g, v);
+    float cx = cell.x + 0.5f*cell.width, cy = cell.y + 0.5f*cell.height, limit = 0.45f*cell.height;
+    float kpix = f->kpix, roll = f->air->roll[a];
+    float j = f->own->j[v], G = f->own->G[v];
+    DrawCircleLines((int)cx, (int)cy, 12, BLACK);
+    DrawCircleLines((int)cx, (int)cy, (int)(kpix*rad(10)), LIGHTGRAY);
+    DrawCircleLines((int)cx, (int)cy, (int)(kpix*rad(20)), LIGHTGRAY);
+    DrawCircleLines((int)cx, (int)cy, (int)(kpix*rad(30)), LIGHTGRAY);
+    DrawLine((int)cx - 20, (int)cy, (int)cx + 20, (int)cy, DARKGRAY);
+    DrawLine((int)cx, (int)cy - 20, (int)cx, (int)cy + 20, DARKGRAY);
+    for (int k = 0; k < r->count; ++k)
+    {
+        if (k == r->k0) continue;
+        float rt = kpix*r->row->j[r->base + k];
+        if (rt > limit) continue;
+        float sat, cat; TrigSinCos(GetHudTrigTier(), r->row->G[r->base + k] + roll, &sat, &cat);
+        DrawCircle((int)(cx + rt*sat), (int)(cy - rt*cat), 2, Fade(MAROON, 0.5f));
+    }
+    if (f->gpu)
+        GpuSolverDrawMarkers(f->gpu, a, 0, cx, cy, kpix, roll, limit, 2.0f, screenW, screenH, Fade(MAROON, 0.5f));
+    float rj = kpix*j;
+    if (rj > limit) rj = limit;
+    float sa, ca; TrigSinCos(GetHudTrigTier(), G + roll, &sa, &ca);
+    float hx = cx + rj*sa, hy = cy - rj*ca;
+    DrawCircle((int)hx, (int)hy, 6, MAROON);
+    DrawCircleLines((int)hx, (int)hy, 10, MAROON);
+    if (r->pred)
+    {
+        int i = r->base + r->k0;
+        float rl = kpix*r->pred->lead.j[i];
+        if (rl > limit) rl = limit;
+        float sl, cl; TrigSinCos(GetHudTrigTier(), r->pred->lead.G[i] + roll, &sl, &cl);
+        int lx = (int)(cx + rl*sl), ly = (int)(cy - rl*cl);
+        DrawLine((int)hx, (int)hy, lx, ly, Fade(ORANGE, 0.7f));
+        DrawCircleLines(lx, ly, 8, ORANGE);
     }
 }
 
-int main(void)
+/** Imprime o uso da linha de comando. */
+static void PrintUsage(const char *prog)
 {
+    fprintf(stderr,
+            "uso: %s [--headless ENTRADA [SAIDA]] [--solver=lote|escalar|vetorial] [--trig=libm|float|visual]\n"
+            "          [--render=instanciado|imediato] [--sim-hz=N] [--threads=N] [--cull=on|off]\n"
+            "          [--incremental=on|off] [--predict=on|off] [--intercept-speed=V]\n"
+            "          [--tracks=ARQUIVO] [--convert-tracks ENTRADA SAIDA] [--record=ARQUIVO]\n"
+            "          [--listen[=PORTA]] [--send-tracks ARQUIVO HOST[:PORTA]] [--trace=ARQUIVO]\n"
+            "          [--frame-arena=KB] [--gpu=on|off] [--scenario=ARQUIVO] [--speed=X|max] [--seek=T]\n"
+            "          [--run-scenario ARQUIVO [SAIDA]] [--sample=N] [--views=N]\n"
+            "          [--pacing=on|off] [--fps=N]\n"
+            "  --headless  resolve trajetorias sem janela (ENTRADA/SAIDA podem ser '-')\n"
+            "  --render    desenho das entidades: instancing na GPU (padrao) ou modo imediato\n"
+            "  --sim-hz    taxa fixa da thread de simulacao (padrao %.0f Hz)\n"
+            "  --threads   threads do solver de pares, incluindo a da simulacao (padrao: CPUs - 1)\n"
+            "  --cull      resolve so os alvos no alcance e no cone de 30 graus (padrao on; tecla C)\n"
+            "  --incremental  sem descarte, recalcula so os pares com entidade alterada (padrao on; tecla R)\n"
+            "  --predict   preve interceptacao e ponto de mira de todos os pares resolvidos (padrao on; tecla F)\n"
+            "  --intercept-speed  velocidade do interceptador relativa a aeronave (padrao %.0f unid/s)\n"
+            "  --tracks    reproduz um arquivo de trilhas binario (mapeado em memoria) no lugar do teclado\n"
+            "  --convert-tracks  converte trajetorias em texto (formato do --headless) para trilhas binarias\n"
+            "  --record    grava os angulos de todos os pares a cada passo em formato colunar binario\n"
+            "  --listen    recebe atualizacoes de trilhas por UDP (padrao porta %d) no lugar do teclado\n"
+            "  --send-tracks  envia um arquivo de trilhas em tempo real para uma instancia com --listen\n"
+            "  --trace     ao sair, grava as fases dos ultimos quadros e passos em JSON Chrome trace (Perfetto)\n"
+            "  --frame-arena  memoria fixa dos dados transitorios de cada quadro (padrao: o pior caso da cena)\n"
+            "  --gpu       resolve todos os pares num compute shader OpenGL 4.3 (padrao off; tecla B sem --record)\n"
+            "  --scenario  roteiro de entidades e manobras em passo fixo no lugar do teclado (PageUp/PageDown +-5 s)\n"
+            "  --speed     passos simulados por passo de tempo real (padrao 1; max: sem espera)\n"
+            "  --seek      com --scenario, comeca no instante T (s), a partir do keyframe anterior\n"
+            "  --run-scenario  executa o roteiro sem janela e grava amostras e resumos em CSV (SAIDA pode ser '-')\n"
+            "  --sample    com --run-scenario, passos entre linhas do CSV (padrao: uma por segundo simulado)\n"
+            "  --views     grade de N vistas (1 a %d), uma por aeronave, com camera e HUD proprios (tecla N)\n"
+            "  --pacing    cena 3D em cache, refeita so quando muda e numa fracao adaptativa da taxa (padrao off; tecla Y)\n"
+            "  --fps       taxa de quadros do HUD (padrao 60)\n",
+            prog, SIM_DEFAULT_HZ, (double)PREDICT_DEFAULT_SPEED, INGEST_DEFAULT_PORT, VIEW_MAX);
+}
+
+int main(int argc, char **argv)
+{
+    const char *headlessIn = NULL;
+    const char *headlessOut = "-";
+    SolverMode cliSolver = SOLVER_BATCH;
+    bool cliInstanced = true;
+    bool cliCull = true;
+    bool cliIncremental = true;
+    bool cliPredict = true;
+    float cliInterceptSpeed = PREDICT_DEFAULT_SPEED;
+    long cliFrameArenaKB = 0;
+    bool cliGpu = false;
+    double cliSimHz = SIM_DEFAULT_HZ;
+    int cliThreads = 0;
+    const char *cliTracks = NULL;
+    const char *cliRecord = NULL;
+    int cliListen = 0;
+    const char *cliTrace = NULL;
+    const char *cliScenario = NULL;
+    const char *runScenario = NULL;
+    const char *runScenarioOut = "-";
+    double cliSpeed = 1.0;
+    double cliSeek = -1.0;
+    long cliSample = 0;
+    int cliViews = 1;
+    bool cliPacing = false;
+    int cliFps = 60;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+        {
+            headlessIn = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') headlessOut = argv[++i];
+            else if (i + 1 < argc && strcmp(argv[i + 1], "-") == 0) headlessOut = argv[++i];
+        }
+        else if (strcmp(argv[i], "--convert-tracks") == 0 && i + 2 < argc)
+        {
+            return RunConvertTracks(argv[i + 1], argv[i + 2]);
+        }
+        else if (strcmp(argv[i], "--run-scenario") == 0 && i + 1 < argc)
+        {
+            runScenario = argv[++i];
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || strcmp(argv[i + 1], "-") == 0)) runScenarioOut = argv[++i];
+        }
+        else if (strncmp(argv[i], "--scenario=", 11) == 0 && argv[i][11]) cliScenario = argv[i] + 11;
+        else if (strcmp(argv[i], "--speed=max") == 0) cliSpeed = 0.0;
+        else if (strncmp(argv[i], "--speed=", 8) == 0 && atof(argv[i] + 8) > 0.0) cliSpeed = atof(argv[i] + 8);
+        else if (strncmp(argv[i], "--seek=", 7) == 0 && argv[i][7] && atof(argv[i] + 7) >= 0.0) cliSeek = atof(argv[i] + 7);
+        else if (strncmp(argv[i], "--sample=", 9) == 0 && atol(argv[i] + 9) > 0) cliSample = atol(argv[i] + 9);
+        else if (strncmp(argv[i], "--tracks=", 9) == 0 && argv[i][9]) cliTracks = argv[i] + 9;
+        else if (strncmp(argv[i], "--record=", 9) == 0 && argv[i][9]) cliRecord = argv[i] + 9;
+        else if (strncmp(argv[i], "--trace=", 8) == 0 && argv[i][8]) cliTrace = argv[i] + 8;
+        else if (strcmp(argv[i], "--listen") == 0) cliListen = INGEST_DEFAULT_PORT;
+        else if (strncmp(argv[i], "--listen=", 9) == 0 && atoi(argv[i] + 9) > 0 && atoi(argv[i] + 9) < 65536)
+            cliListen = atoi(argv[i] + 9);
+        else if (strcmp(argv[i], "--send-tracks") == 0 && i + 2 < argc)
+        {
+            return RunSendTracks(argv[i + 1], argv[i + 2]);
+        }
+        else if (strcmp(argv[i], "--solver=lote") == 0) cliSolver = SOLVER_BATCH;
+        else if (strcmp(argv[i], "--solver=escalar") == 0) cliSolver = SOLVER_SCALAR;
+        else if (strcmp(argv[i], "--solver=vetorial") == 0) cliSolver = SOLVER_VECTOR;
+        else if (strcmp(argv[i], "--trig=libm") == 0) SetSolverTrigTier(TRIG_TIER_LIBM);
+        else if (strcmp(argv[i], "--trig=float") == 0) SetSolverTrigTier(TRIG_TIER_FLOAT);
+        else if (strcmp(argv[i], "--trig=visual") == 0) SetSolverTrigTier(TRIG_TIER_VISUAL);
+        else if (strcmp(argv[i], "--render=instanciado") == 0) cliInstanced = true;
+        else if (strcmp(argv[i], "--render=imediato") == 0) cliInstanced = false;
+        else if (strcmp(argv[i], "--cull=on") == 0) cliCull = true;
+        else if (strcmp(argv[i], "--cull=off") == 0) cliCull = false;
+        else if (strcmp(argv[i], "--incremental=on") == 0) cliIncremental = true;
+        else if (strcmp(argv[i], "--incremental=off") == 0) cliIncremental = false;
+        else if (strcmp(argv[i], "--predict=on") == 0) cliPredict = true;
+        else if (strcmp(argv[i], "--predict=off") == 0) cliPredict = false;
+        else if (strncmp(argv[i], "--intercept-speed=", 18) == 0 && atof(argv[i] + 18) > 0.0)
+            cliInterceptSpeed = (float)atof(argv[i] + 18);
+        else if (strcmp(argv[i], "--gpu=on") == 0) cliGpu = true;
+        else if (strcmp(argv[i], "--gpu=off") == 0) cliGpu = false;
+        else if (strncmp(argv[i], "--frame-arena=", 14) == 0 && atol(argv[i] + 14) > 0)
+            cliFrameArenaKB = atol(argv[i] + 14);
+        else if (strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0) cliThreads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--sim-hz=", 9) == 0 && atof(argv[i] + 9) > 0.0) cliSimHz = atof(argv[i] + 9);
+        else if (strncmp(argv[i], "--views=", 8) == 0 && atoi(argv[i] + 8) >= 1 && atoi(argv[i] + 8) <= VIEW_MAX)
+            cliViews = atoi(argv[i] + 8);
+        else if (strcmp(argv[i], "--pacing=on") == 0) cliPacing = true;
+        else if (strcmp(argv[i], "--pacing=off") == 0) cliPacing = false;
+        else if (strncmp(argv[i], "--fps=", 6) == 0 && atoi(argv[i] + 6) > 0) cliFps = atoi(argv[i] + 6);
+        else
+        {
+            PrintUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+    if (headlessIn) return RunHeadless(headlessIn, headlessOut, cliSolver);
+    if (runScenario)
+        return RunScenario(runScenario, runScenarioOut, cliSample, cliSolver, cliCull, cliIncremental, cliPredict,
+                           cliInterceptSpeed, cliThreads, cliRecord);
+    // a script is the only input of a scenario run: no tracks or network on top of it
+    if (cliScenario && (cliTracks || cliListen))
+    {
+        fprintf(stderr, "woe3d: --scenario nao combina com --tracks nem com --listen\n");
+        return 2;
+    }
+    if (cliSeek >= 0.0 && (!cliScenario || cliRecord))
+    {
+        fprintf(stderr, "woe3d: --seek requer --scenario e nao combina com --record\n");
+        return 2;
+    }
+
+    // Recorded tracks are mapped, not read: opening a multi-GB file costs only the header
+    TrackFile tracks;
+    if (cliTracks)
+    {
+        const char *err;
+        if (!TrackFileOpen(&tracks, cliTracks, &err))
+        {
+            fprintf(stderr, "woe3d: '%s': %s\n", cliTracks, err);
+            return 1;
+        }
+    }
+    Scenario scenario;
+    if (cliScenario)
+    {
+        int line;
+        const char *err;
+        if (!ScenarioLoad(&scenario, cliScenario, &line, &err))
+        {
+            if (line > 0) fprintf(stderr, "woe3d: %s:%d: %s\n", cliScenario, line, err);
+            else fprintf(stderr, "woe3d: '%s': %s\n", cliScenario, err);
+            return 1;
+        }
+    }
+
     const int screenWidth = 1280;
     const int screenHeight = 720;
     InitWindow(screenWidth, screenHeight, "Warfare Observation 3D Engagement - Raylib");
-    SetTargetFPS(60);
+    SetTargetFPS(cliFps);
 
     // 3D Camera
     Camera3D cam = {0};
@@ -280,155 +831,666 @@ int main(void)
     cam.fovy     = 60.0f;
     cam.projection = CAMERA_PERSPECTIVE;
 
-    // Entities
-    Vector3 A = {0,0,2}; // aircraft position
-    Vector3 T = {8,6,4}; // target position
+    bool showAnn = true; // toggle annotations
+    bool showTracks = true; // per-track Az/El labels (with annotations on)
+    SolverMode solver = cliSolver;           // requested; the snapshot reports what was used
+    TrigTier trigTier = GetSolverTrigTier();
 
-    // Aircraft orientation (radians)
-    float yaw = rad(20.0f);
-    float pitch = rad(-5.0f);
-    float roll = rad(15.0f);
+    // Simulation: index 0 of each set is the keyboard-controlled A / T
+    Simulation sim;
+    int maxAir = cliScenario ? (scenario.aircraft > 0 ? scenario.aircraft : 1) : 1 + DEFAULT_EXTRA_AIRCRAFT;
+    int maxTgt = cliScenario ? (scenario.targets > 0 ? scenario.targets : 1) : 1 + DEFAULT_EXTRA_TARGETS;
+    int trackAir = 0, trackTgt = 0;
+    for (int e = 0; cliTracks && e < tracks.count; ++e)
+    {
+        if (tracks.entities[e].kind == TRACK_KIND_TARGET) ++trackTgt;
+        else ++trackAir;
+    }
+    if (trackAir > maxAir) maxAir = trackAir;
+    if (trackTgt > maxTgt) maxTgt = trackTgt;
+    if (!SimInit(&sim, maxAir, maxTgt, cliScenario ? 1.0/scenario.dt : cliSimHz, MOVE_SPEED, ROT_SPEED))
+    {
+        TraceLog(LOG_ERROR, "Falha ao alocar o armazenamento de entidades");
+        if (cliTracks) TrackFileClose(&tracks);
+        if (cliScenario) ScenarioFree(&scenario);
+        CloseWindow();
+        return 1;
+    }
+    if (cliScenario) ScenarioSpawn(&scenario, &sim.air, &sim.tgt);
+    else
+    {
+        EntityStoreAdd(&sim.air, 0.0f, 0.0f, 2.0f, rad(20.0f), rad(-5.0f), rad(15.0f));
+        EntityStoreAdd(&sim.tgt, 8.0f, 6.0f, 4.0f, 0.0f, 0.0f, 0.0f);
+        ScenarioScatter(&sim.air, &sim.tgt, DEFAULT_EXTRA_AIRCRAFT, DEFAULT_EXTRA_TARGETS, SCENARIO_DEFAULT_SEED);
+    }
+    SimSetSolver(&sim, solver);
+    bool cull = cliCull;
+    SimSetCulling(&sim, cull);
+    bool incremental = cliIncremental;
+    SimSetIncremental(&sim, incremental);
+    bool predict = cliPredict;
+    SimSetPrediction(&sim, predict);
+    sim.interceptSpeed = cliInterceptSpeed;
+    SimSetSpeed(&sim, cliSpeed);
+    // Scripted runs: keyframes of the working state for seeking, one per scenario interval
+    bool canSeek = false;
+    if (cliScenario)
+    {
+        sim.scenario = &scenario;
+        canSeek = !cliRecord && SimEnableKeyframes(&sim, scenario.keyframe);
+        if (!cliRecord && !canSeek) TraceLog(LOG_WARNING, "Sem memoria para os keyframes; busca desativada");
+    }
 
-    // Interaction speeds
-    const float moveSpeed = 5.0f;
-    const float rotSpeed = rad(45.0f); // deg/s
+    // Pair solver threads: the simulation thread plus helpers; one core is left to the render loop
+    JobPool pool;
+    if (cliThreads <= 0) cliThreads = WoeCpuCount() > 1 ? WoeCpuCount() - 1 : 1;
+    if (!JobPoolInit(&pool, cliThreads))
+    {
+        TraceLog(LOG_WARNING, "Threads do solver indisponiveis; usando apenas a da simulacao");
+        JobPoolInit(&pool, 1);
+    }
+    sim.pool = &pool;
+    if (cliTracks) sim.tracks = &tracks; // the first tracked aircraft/target replace the keyboard-driven ones
+    // Per-step angles of every pair, appended by the simulation thread and written by the recorder's own
+    Recorder recorder;
+    if (cliRecord)
+    {
+        const char *err;
+        if (!RecorderOpen(&recorder, cliRecord, maxAir*maxTgt, RECORD_DEFAULT_BLOCK_ROWS, &err))
+        {
+            fprintf(stderr, "woe3d: '%s': %s\n", cliRecord, err);
+            JobPoolFree(&pool);
+            SimFree(&sim);
+            if (cliTracks) TrackFileClose(&tracks);
+            CloseWindow();
+            return 1;
+        }
+        sim.recorder = &recorder;
+    }
+    // Live track updates: received on their own thread, applied at the start of each step
+    Ingest ingest;
+    if (cliListen)
+    {
+        const char *err;
+        if (!IngestOpen(&ingest, cliListen, &err))
+        {
+            fprintf(stderr, "woe3d: porta %d: %s\n", cliListen, err);
+            if (cliRecord) RecorderClose(&recorder);
+            JobPoolFree(&pool);
+            SimFree(&sim);
+            if (cliTracks) TrackFileClose(&tracks);
+            CloseWindow();
+            return 1;
+        }
+        sim.ingest = &ingest;
+    }
+    // Frame phases of this thread and step phases of the simulation thread, one ring each
+    Profiler profiler;
+    ProfilerInit(&profiler);
+    ProfileRing *ring = ProfilerThread(&profiler, "principal");
+    sim.profiler = &profiler;
+    // Optional pair solve in a compute shader; decided before the first step, since with it on the
+    // recorder is fed from this thread instead of the simulation's
+    GpuSolver gpu;
+    bool haveGpu = GpuSolverInit(&gpu, maxAir, maxTgt);
+    if (cliGpu && !haveGpu) TraceLog(LOG_WARNING, "Compute shader indisponivel (requer OpenGL 4.3); usando o solver da CPU");
+    bool gpuOn = cliGpu && haveGpu;
+    PairResults gpuRead = {0}; // readback of the GPU results, only to record them
+    if (gpuOn && cliRecord && !PairResultsInit(&gpuRead, maxAir*maxTgt))
+    {
+        TraceLog(LOG_WARNING, "Sem memoria para ler os pares da GPU; usando o solver da CPU");
+        gpuOn = false;
+    }
+    SimSetGpuSolve(&sim, gpuOn);
+    long gpuTick = -2; // tick of the last dispatched snapshot
+    bool started;
+    if (canSeek && cliSeek > 0.0)
+    {
+        SimReset(&sim);
+        SimSeek(&sim, cliSeek);
+        started = SimResume(&sim);
+    }
+    else started = SimStart(&sim);
+    if (!started)
+    {
+        TraceLog(LOG_ERROR, "Falha ao iniciar a thread de simulacao");
+        PairResultsFree(&gpuRead);
+        if (haveGpu) GpuSolverFree(&gpu);
+        ProfilerFree(&profiler);
+        if (cliListen) IngestClose(&ingest);
+        if (cliRecord) RecorderClose(&recorder);
+        JobPoolFree(&pool);
+        SimFree(&sim);
+        if (cliTracks) TrackFileClose(&tracks);
+        if (cliScenario) ScenarioFree(&scenario);
+        CloseWindow();
+        return 1;
+    }
 
-    bool showAnn = true; // toggle annotations
+    // GPU instancing for the extra entities; falls back to immediate mode if the shader fails
+    InstancedRenderer inst;
+    bool haveInstancing = InstancedRendererInit(&inst, maxAir > maxTgt ? maxAir : maxTgt);
+    if (!haveInstancing) TraceLog(LOG_WARNING, "Instancing indisponivel; usando modo imediato");
+    bool instanced = cliInstanced && haveInstancing;
 
-    while (!WindowShouldClose())
+    // One render texture and camera per observed aircraft; N switches between them and the single view
+    ViewGrid views;
+    int viewCount = cliViews > 1 ? cliViews : VIEW_DEFAULT_COUNT;
+    bool haveViews = ViewGridInit(&views, viewCount, screenWidth, screenHeight);
+    if (!haveViews) TraceLog(LOG_WARNING, "Render textures indisponiveis; so a vista unica");
+    bool multiView = cliViews > 1 && haveViews;
+    PairResults viewPairs = {0}; // pair (aircraft of the view, target 0) of each view
+    TextLine viewLines[VIEW_MAX] = {{0}};
+    int viewRows[VIEW_MAX] = {0}; // pairs drawn by each view in the frame, -1 without an aircraft
+    ViewRow viewRow[VIEW_MAX];
+
+    // Cached 3D scene: redrawn when it changes and the pacer allows, the HUD goes over it every frame
+    RenderTexture2D sceneTex = LoadRenderTexture(screenWidth, screenHeight);
+    bool havePacing = sceneTex.id != 0;
+    if (cliPacing && !havePacing) TraceLog(LOG_WARNING, "Render texture da cena indisponivel; ritmo fixo");
+    bool paced = cliPacing && havePacing;
+    FramePacer pacer;
+    FramePacerInit(&pacer, cliFps);
+    long sceneTick = -1; // snapshot and drawing options of the cached scene
+    int sceneFlags = -1;
+    CullStats airCull = {0}, tgtCull = {0}, arcCull = {0}, labelCull = {0}; // of the last scene drawn
+
+    // Per-frame transient data (visibility, lines, text quads) comes from one fixed block, returned
+    // whole at the start of every frame; the default covers every entity visible and labeled at once,
+    // with visibility and lines once per view in the grid
+    size_t arenaViews = haveViews ? (size_t)views.count : 1;
+    size_t arenaWorst = ((size_t)(maxAir + maxTgt) + FRAME_ARENA_ALIGNMENT +
+                         (size_t)(FRAME_FIXED_LINES + FRAME_LINES_PER_ARC*(maxTgt + 1))*(2*sizeof(Vector3) + sizeof(Color)) +
+                         FRAME_ARENA_ALIGNMENT)*arenaViews +
+                        (size_t)(HUD_TEXT_QUADS + TRACK_LABEL_QUADS*maxTgt)*sizeof(TextQuad) + FRAME_ARENA_ALIGNMENT;
+    FrameArena arena;
+    size_t arenaMin = ((size_t)(maxAir + maxTgt) + FRAME_ARENA_ALIGNMENT)*arenaViews; // the visibility flags never fail
+    size_t arenaBytes = cliFrameArenaKB > 0 ? (size_t)cliFrameArenaKB*1024 : arenaWorst;
+    bool frameOk = FrameArenaInit(&arena, arenaBytes > arenaMin ? arenaBytes : arenaMin);
+    // Frame line batch: axes, A->T and nose lines, one arc per pair; buffers from the arena
+    LineBatch lines = {0};
+    // All HUD text and 3D labels: one glyph-table batch, lines reformatted only when a shown value changes.
+    // With the scene cached its labels are kept apart, in a batch of their own rebuilt with the scene.
+    TextBatch text, sceneText;
+    TextLine hud[HUD_TEXT_LINES] = {{0}};
+    TextLine labAT = {0}, labAR = {0};
+    TextLine *trackLab = (TextLine *)calloc((size_t)maxTgt, sizeof(TextLine)); // by target index
+    TextLine profLines[PROFILE_OVERLAY_LINES] = {{0}};
+    bool showProfile = true;
+    frameOk = TextBatchInit(&text, GetFontDefault(), 0) && frameOk;
+    frameOk = TextBatchInit(&sceneText, GetFontDefault(), HUD_TEXT_QUADS + TRACK_LABEL_QUADS*maxTgt) && frameOk;
+    frameOk = (!haveViews || PairResultsInit(&viewPairs, VIEW_MAX)) && frameOk;
+    if (!frameOk || !trackLab)
     {
-        float dt = GetFrameTime();
+        TraceLog(LOG_ERROR, "Falha ao alocar os buffers do quadro");
+        PairResultsFree(&viewPairs);
+        if (haveViews) ViewGridFree(&views);
+        if (havePacing) UnloadRenderTexture(sceneTex);
+        TextBatchFree(&sceneText);
+        TextBatchFree(&text);
+        FrameArenaFree(&arena);
+        free(trackLab);
+        if (haveInstancing) InstancedRendererFree(&inst);
+        PairResultsFree(&gpuRead);
+        if (haveGpu) GpuSolverFree(&gpu);
+        SimStop(&sim);
+        ProfilerFree(&profiler);
+        if (cliListen) IngestClose(&ingest);
+        if (cliRecord) RecorderClose(&recorder);
+        JobPoolFree(&pool);
+        SimFree(&sim);
+        if (cliTracks) TrackFileClose(&tracks);
+        if (cliScenario) ScenarioFree(&scenario);
+        CloseWindow();
+        return 1;
+    }
 
+    while (!WindowShouldClose())
+    {
+        // a new frame: everything the last one took from the arena is given back
+        double frameStart = WoeNow();
+        FrameArenaReset(&arena);
+        ProfileBegin(ring, "quadro");
+        ProfileBegin(ring, "entrada");
+        // Held keys are sampled here and integrated by the simulation thread at its own rate
+        int keys = 0;
         // Controls - Move Aircraft (IJKL + U/O for Z)
-        if (IsKeyDown(KEY_I)) A.y += moveSpeed*dt;
-        if (IsKeyDown(KEY_K)) A.y -= moveSpeed*dt;
-        if (IsKeyDown(KEY_J)) A.x -= moveSpeed*dt;
-        if (IsKeyDown(KEY_L)) A.x += moveSpeed*dt;
-        if (IsKeyDown(KEY_U)) A.z += moveSpeed*dt;
-        if (IsKeyDown(KEY_O)) A.z -= moveSpeed*dt;
+        if (IsKeyDown(KEY_I)) keys |= SIM_KEY_AIR_YP;
+        if (IsKeyDown(KEY_K)) keys |= SIM_KEY_AIR_YN;
+        if (IsKeyDown(KEY_J)) keys |= SIM_KEY_AIR_XN;
+        if (IsKeyDown(KEY_L)) keys |= SIM_KEY_AIR_XP;
+        if (IsKeyDown(KEY_U)) keys |= SIM_KEY_AIR_ZP;
+        if (IsKeyDown(KEY_O)) keys |= SIM_KEY_AIR_ZN;
 
         // Controls - Move Target (WASD + Q/E for Z)
-        if (IsKeyDown(KEY_W)) T.y += moveSpeed*dt;
-        if (IsKeyDown(KEY_S)) T.y -= moveSpeed*dt;
-        if (IsKeyDown(KEY_A)) T.x -= moveSpeed*dt;
-        if (IsKeyDown(KEY_D)) T.x += moveSpeed*dt;
-        if (IsKeyDown(KEY_Q)) T.z += moveSpeed*dt;
-        if (IsKeyDown(KEY_E)) T.z -= moveSpeed*dt;
+        if (IsKeyDown(KEY_W)) keys |= SIM_KEY_TGT_YP;
+        if (IsKeyDown(KEY_S)) keys |= SIM_KEY_TGT_YN;
+        if (IsKeyDown(KEY_A)) keys |= SIM_KEY_TGT_XN;
+        if (IsKeyDown(KEY_D)) keys |= SIM_KEY_TGT_XP;
+        if (IsKeyDown(KEY_Q)) keys |= SIM_KEY_TGT_ZP;
+        if (IsKeyDown(KEY_E)) keys |= SIM_KEY_TGT_ZN;
 
         // Controls - Orientation of aircraft (Arrow keys + Z/X for roll)
-        if (IsKeyDown(KEY_LEFT))  yaw -= rotSpeed*dt;
-        if (IsKeyDown(KEY_RIGHT)) yaw += rotSpeed*dt;
-        if (IsKeyDown(KEY_UP))    pitch += rotSpeed*dt;
-        if (IsKeyDown(KEY_DOWN))  pitch -= rotSpeed*dt;
-        if (IsKeyDown(KEY_Z))     roll -= rotSpeed*dt;
-        if (IsKeyDown(KEY_X))     roll += rotSpeed*dt;
+        if (IsKeyDown(KEY_LEFT))  keys |= SIM_KEY_YAW_N;
+        if (IsKeyDown(KEY_RIGHT)) keys |= SIM_KEY_YAW_P;
+        if (IsKeyDown(KEY_UP))    keys |= SIM_KEY_PITCH_P;
+        if (IsKeyDown(KEY_DOWN))  keys |= SIM_KEY_PITCH_N;
+        if (IsKeyDown(KEY_Z))     keys |= SIM_KEY_ROLL_N;
+        if (IsKeyDown(KEY_X))     keys |= SIM_KEY_ROLL_P;
+        if (!cliScenario) SimSetInput(&sim, keys); // a scenario is driven by its script only
         if (IsKeyPressed(KEY_H))  showAnn = !showAnn; // toggle annotations
+        if (IsKeyPressed(KEY_T))  showTracks = !showTracks; // toggle per-track labels
+        if (IsKeyPressed(KEY_P))  showProfile = !showProfile; // toggle profiler overlay
+        if (IsKeyPressed(KEY_V))  // cycle solver
+        {
+            solver = (SolverMode)((solver + 1) % SOLVER_MODE_COUNT);
+            SimSetSolver(&sim, solver);
+        }
+        if (IsKeyPressed(KEY_G) && haveInstancing) instanced = !instanced; // toggle GPU instancing
+        if (IsKeyPressed(KEY_N) && haveViews) multiView = !multiView; // toggle the view grid
+        if (IsKeyPressed(KEY_Y) && havePacing) // toggle the cached, adaptively paced scene
+        {
+            paced = !paced;
+            FramePacerInit(&pacer, cliFps);
+        }
+        if (IsKeyPressed(KEY_C))  // toggle range/cone culling before the solver
+        {
+            cull = !cull;
+            SimSetCulling(&sim, cull);
+        }
+        if (IsKeyPressed(KEY_R))  // toggle incremental recompute of the pair matrix
+        {
+            incremental = !incremental;
+            SimSetIncremental(&sim, incremental);
+        }
+        if (IsKeyPressed(KEY_F))  // toggle lead/intercept prediction
+        {
+            predict = !predict;
+            SimSetPrediction(&sim, predict);
+        }
+        if (IsKeyPressed(KEY_B) && haveGpu && !cliRecord) // toggle the compute-shader pair solve
+        {
+            gpuOn = !gpuOn;
+            SimSetGpuSolve(&sim, gpuOn);
+        }
+        if (canSeek && (IsKeyPressed(KEY_PAGE_UP) || IsKeyPressed(KEY_PAGE_DOWN)))
+        {
+            // jump from the nearest keyframe; the thread is stopped so the working state can be restored
+            SimStop(&sim);
+            double to = sim.time + (IsKeyPressed(KEY_PAGE_UP) ? SCENARIO_SEEK_STEP : -SCENARIO_SEEK_STEP);
+            if (to < 0.0) to = 0.0;
+            if (to > scenario.duration) to = scenario.duration;
+            SimSeek(&sim, to);
+            if (!SimResume(&sim)) TraceLog(LOG_WARNING, "Falha ao retomar a thread de simulacao");
+        }
+        if (IsKeyPressed(KEY_M))  // cycle trig tier
+        {
+            trigTier = (TrigTier)((trigTier + 1) % TRIG_TIER_COUNT);
+            SimSetTrigTier(&sim, trigTier);
+        }
 
-        // Optional: orbit camera with mouse left button
+        ProfileEnd(ring);
+
+        // Latest published step; never waits for the simulation thread
+        ProfileBegin(ring, "cena");
+        const SimSnapshot *snap = SimAcquire(&sim);
+        const EntityStore air = snap->air, tgt = snap->tgt;
+        const PairResults primary = snap->primary;
+        // Row of the controlled aircraft: slot k holds target k, or the k-th culled candidate
+        const PairResults *row = snap->culled ? &snap->cand.pairs : &snap->pairs;
+        int rowCount = snap->culled ? snap->cand.count[0] : snap->pairs.targets;
+        const int *rowTarget = snap->culled ? snap->cand.target : NULL;
+        Vector3 A = { air.x[0], air.y[0], air.z[0] };
+        Vector3 T = { tgt.x[0], tgt.y[0], tgt.z[0] };
+        float roll = air.roll[0];
+
+        // Optional: orbit camera with mouse left button; in the grid, the camera of the view under the mouse
+        cam.target = A;
+        int orbitView = multiView ? ViewGridAt(&views, GetMousePosition()) : -1;
         if (IsMouseButtonDown(MOUSE_BUTTON_LEFT))
         {
-            Vector2 d = GetMouseDelta();
-            Matrix rotZ = MatrixRotate((Vector3){0,0,1}, -d.x*0.003f);
-            Vector3 off = Vector3Subtract(cam.position, A);
-            off = Vector3Transform(off, rotZ);
-            // elevate
-            Matrix rotX = MatrixRotate((Vector3){1,0,0}, d.y*0.003f);
-            off = Vector3Transform(off, rotX);
-            cam.position = Vector3Add(A, off);
+            if (!multiView) CameraOrbit(&cam, GetMouseDelta());
+            else if (orbitView >= 0) CameraOrbit(&views.cam[orbitView], GetMouseDelta());
         }
-        cam.target = A;
 
-        // Computations
-        float AzT=0, ElT=0; ComputeAzEl(A, T, &AzT, &ElT);
-        Vector3 fwd = ForwardFromYPR(yaw, pitch, roll);
-        float AzR=0, ElR=0; ComputeAzElFromVector(fwd, &AzR, &ElR);
+        // With the GPU solve the pair matrix never comes back here: solved once per new snapshot,
+        // then drawn straight from the result buffers (arcs and HUD markers)
+        bool gpuFrame = snap->gpu && haveGpu;
+        if (gpuFrame && snap->tick != gpuTick)
+        {
+            GpuSolverDispatch(&gpu, &air, &tgt, snap->solver, snap->tick, snap->time);
+            gpuTick = snap->tick;
+        }
 
-        float j=0, G=0, E=0, F=0, J=0; // radians
-        ComputeSphericalAngles(AzT, ElT, AzR, ElR, &j, &G, &E, &F, &J);
+        // The scene is redrawn every frame, or with pacing only when something it shows changed (new
+        // snapshot, camera drag, drawing options) and the pacer's divisor allows; a new mode empties the cache
+        int flags = showAnn | showTracks << 1 | instanced << 2 | multiView << 3 | gpuFrame << 4;
+        if (flags != sceneFlags) FramePacerInvalidate(&pacer);
+        bool sceneDirty = snap->tick != sceneTick || flags != sceneFlags || IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+        bool drawScene = !paced || FramePacerBegin(&pacer, sceneDirty);
+        double sceneStart = WoeNow(), sceneTime = 0.0;
+        if (drawScene)
+        {
+            sceneTick = snap->tick;
+            sceneFlags = flags;
+            airCull = tgtCull = arcCull = labelCull = (CullStats){0};
+            TextBatchClear(&sceneText);
+        }
 
-        BeginDrawing();
-        ClearBackground(RAYWHITE);
+        // Frustum visibility per entity, rebuilt with each scene; the arena always has room for it, it is taken first.
+        // The grid culls once per view instead (DrawViewScene).
+        unsigned char *airVis = NULL, *tgtVis = NULL;
 
-        BeginMode3D(cam);
-        DrawGrid(40, 1.0f);
-        // axes
-        DrawLine3D((Vector3){0,0,0}, (Vector3){5,0,0}, RED);
-        DrawLine3D((Vector3){0,0,0}, (Vector3){0,5,0}, GREEN);
-        DrawLine3D((Vector3){0,0,0}, (Vector3){0,0,5}, BLUE);
+        // One frustum per frame; entities, arcs and labels outside it are never submitted
+        Frustum frustum = FrustumFromCamera(cam, (float)screenWidth/(float)screenHeight);
+        if (!multiView && drawScene)
+        {
+            airVis = FRAME_ARENA_ARRAY(&arena, unsigned char, air.count + tgt.count);
+            tgtVis = airVis + air.count;
+            CullEntities(&frustum, &air, 0, AIRCRAFT_BOUND_RADIUS, airVis, &airCull);
+            CullEntities(&frustum, &tgt, 0, 0.4f, tgtVis, &tgtCull); // largest target radius
+        }
+
+        // Orientation basis computed once by the simulation step for the solver
+        WoeBasis basis0 = EntityBasis(&air, 0);
+        Vector3 fwd = FromWoe(basis0.fwd);
+
+        // Pair (0,0) drives the main readouts
+        float AzT = primary.AzT[0], ElT = primary.ElT[0];
+        float AzR = primary.AzR[0], ElR = primary.ElR[0];
+        float j = primary.j[0], G = primary.G[0], E = primary.E[0], F = primary.F[0], J = primary.J[0]; // radians
+
+        ProfileEnd(ring);
 
-        // Draw aircraft and target
-        DrawAircraft(A, yaw, pitch, roll, DARKBLUE);
-        DrawSphere(T, 0.4f, MAROON);
-        DrawLine3D(A, T, Fade(MAROON, 0.6f));
+        // where to point now: the aim point of the predicted intercept (or closest approach)
+        const PredictResults *lead = snap->predicted ? &snap->predictPrimary : NULL;
 
-        // Annotations in 3D: forward vector and arc j
-        Vector3 noseLineEnd = Vector3Add(A, Vector3Scale(fwd, 4.0f));
-        DrawLine3D(A, noseLineEnd, BLUE);
-        if (showAnn)
+        if (multiView)
         {
-            // unit vectors from A
-            Vector3 u = fwd; // already unit
-            Vector3 dAT = Vector3Subtract(T, A);
-            float dn = Vector3Length(dAT);
-            if (dn > 1e-6f)
+            // Grid: each view culls, batches and draws into its own texture from the frame's shared instances;
+            // the textures are the cache, so a reused scene only skips this pass
+            ProfileBegin(ring, "vistas");
+            ViewFrame vf = { snap, &air, &tgt, instanced ? &inst : NULL, gpuFrame ? &gpu : NULL, &arena, &lines,
+                             &viewPairs, HUD_PIXELS_PER_RAD*(float)views.cellH/(float)screenHeight, showAnn,
+                             {0}, {0}, {0} };
+            for (int v = 0; v < views.count; ++v)
             {
-                Vector3 v = Vector3Scale(dAT, 1.0f/dn);
-                DrawArc3D(A, u, v, j, 1.5f, PURPLE);
+                viewRows[v] = -1;
+                if (v >= air.count) continue;
+                viewRow[v] = ViewRowSolve(&vf, v, v);
+                viewRows[v] = viewRow[v].count;
             }
+            if (drawScene)
+            {
+                sceneStart = WoeNow(); // the rows above are solved every frame for the HUDs
+                if (instanced) InstancedRendererShare(&inst, &air, &tgt, 0.15f);
+                for (int v = 0; v < views.count; ++v)
+                {
+                    if (viewRows[v] < 0)
+                    {
+                        BeginTextureMode(views.target[v]);
+                        ClearBackground(LIGHTGRAY);
+                        EndTextureMode();
+                        continue;
+                    }
+                    ViewGridFollow(&views, v, (Vector3){ air.x[v], air.y[v], air.z[v] });
+                    DrawViewScene(&views, v, v, &vf, &viewRow[v]);
+                }
+                if (instanced) InstancedRendererShare(&inst, NULL, NULL, 0.0f);
+                airCull = vf.airCull;
+                tgtCull = vf.tgtCull;
+                arcCull = vf.arcCull;
+                sceneTime = WoeNow() - sceneStart;
+            }
+            ProfileEnd(ring);
+
+            BeginDrawing();
+            ClearBackground(RAYWHITE);
+            ViewGridComposite(&views, DARKGRAY);
+            for (int v = 0; v < views.count; ++v)
+                if (viewRows[v] >= 0) DrawViewHud(&views, v, v, &vf, &viewRow[v], screenWidth, screenHeight);
         }
+        else
+        {
+            ProfileBegin(ring, "3d");
+            if (drawScene)
+            {
+                // with pacing the scene goes to its texture and is pasted on the frames that reuse it
+                if (paced) BeginTextureMode(sceneTex);
+                else BeginDrawing();
+                ClearBackground(RAYWHITE);
 
-        EndMode3D();
+                BeginMode3D(cam);
+                DrawGrid(40, 1.0f);
+                // All annotation lines of the frame go to one batch, drawn after the solids
+                LineBatchBegin(&lines, &arena, FRAME_FIXED_LINES + (showAnn ? FRAME_LINES_PER_ARC*(rowCount + 1) : 0));
+                // axes
+                LineBatchAdd(&lines, (Vector3){0,0,0}, (Vector3){5,0,0}, RED);
+                LineBatchAdd(&lines, (Vector3){0,0,0}, (Vector3){0,5,0}, GREEN);
+                LineBatchAdd(&lines, (Vector3){0,0,0}, (Vector3){0,0,5}, BLUE);
 
-        // HUD overlay
-        int cx = screenWidth/2;
-        int cy = screenHeight/2;
+                // Draw aircraft and target
+                if (airVis[0]) DrawAircraftBasis(A, basis0, DARKBLUE);
+                if (tgtVis[0]) DrawSphere(T, 0.4f, MAROON);
+                if (instanced)
+                {
+                    // LOD per instance from the projected size: full mesh, arrow, then a screen-sized diamond
+                    InstancedRendererSetCamera(&inst, &cam, screenHeight);
+                    DrawAircraftInstanced(&inst, &air, 1, airVis, DARKGREEN);
+                    DrawTargetsInstanced(&inst, &tgt, 1, tgtVis, 0.15f, Fade(MAROON, 0.5f));
+                }
+                else
+                {
+                    for (int a = 1; a < air.count; ++a)
+                    {
+                        if (!airVis[a]) continue;
+                        DrawAircraftBasis((Vector3){ air.x[a], air.y[a], air.z[a] }, EntityBasis(&air, a), DARKGREEN);
+                    }
+                    for (int t = 1; t < tgt.count; ++t)
+                    {
+                        if (!tgtVis[t]) continue;
+                        DrawSphere((Vector3){ tgt.x[t], tgt.y[t], tgt.z[t] }, 0.15f, Fade(MAROON, 0.5f));
+                    }
+                }
+                LineBatchAdd(&lines, A, T, Fade(MAROON, 0.6f));
+                if (lead) LineBatchAdd(&lines, A, (Vector3){ lead->px[0], lead->py[0], lead->pz[0] }, Fade(ORANGE, 0.8f));
 
-        // Radius proportional to j (radians)
-        float kpix = 220.0f; // px per radian
-        float r = kpix * j;
-        if (r > screenHeight*0.45f) r = screenHeight*0.45f;
+                // Annotations in 3D: forward vector and arc j
+                Vector3 noseLineEnd = Vector3Add(A, Vector3Scale(fwd, 4.0f));
+                LineBatchAdd(&lines, A, noseLineEnd, BLUE);
+                if (showAnn)
+                {
+                    // arc j for every solved pair of the controlled aircraft; pair (0,0) highlighted on top.
+                    // All arcs lie within 1.5 of A, so one sphere test covers the whole fan.
+                    Vector3 u = fwd; // already unit
+                    bool arcsVisible = FrustumSphereVisible(&frustum, A, 1.5f);
+                    arcCull.tested = gpuFrame ? tgt.count : rowCount + 1;
+                    arcCull.visible = arcsVisible ? arcCull.tested : 0;
+                    for (int k = rowCount - 1; arcsVisible && k >= -1; --k)
+                    {
+                        int t = k < 0 ? 0 : rowTarget ? rowTarget[k] : k;
+                        if (k >= 0 && t == 0) continue;
+                        Vector3 dAT = { tgt.x[t] - A.x, tgt.y[t] - A.y, tgt.z[t] - A.z };
+                        float dn = Vector3Length(dAT);
+                        if (dn <= 1e-6f) continue;
+                        Vector3 v = Vector3Scale(dAT, 1.0f/dn);
+                        if (k < 0) LineBatchAddArc(&lines, A, u, v, j, 1.5f, PURPLE);
+                        else LineBatchAddArc(&lines, A, u, v, row->j[k], 1.2f, Fade(PURPLE, 0.2f));
+                    }
+                    if (gpuFrame && arcsVisible) GpuSolverDrawArcs(&gpu, 0, 0, 1.2f, 0.01f, cam.position, Fade(PURPLE, 0.2f));
+                }
+                LineBatchDraw(&lines);
+
+                EndMode3D();
+                if (paced) EndTextureMode();
+                sceneTime = WoeNow() - sceneStart;
+            }
+            if (paced)
+            {
+                BeginDrawing();
+                DrawTextureRec(sceneTex.texture, (Rectangle){ 0.0f, 0.0f, (float)screenWidth, -(float)screenHeight },
+                               (Vector2){ 0.0f, 0.0f }, WHITE);
+            }
+            ProfileEnd(ring);
 
-        // HUD angle = G + roll (roll is body roll about forward; we use same sign)
-        float hudAng = G + roll;
-        float hx = cx + r * sinf(hudAng);  // screen x grows to right
-        float hy = cy - r * cosf(hudAng);  // screen y grows downwards
+            // HUD overlay
+            ProfileBegin(ring, "hud");
+            int cx = screenWidth/2;
+            int cy = screenHeight/2;
+
+            // Radius proportional to j (radians)
+            float kpix = 220.0f; // px per radian
+            float r = kpix * j;
+            if (r > screenHeight*0.45f) r = screenHeight*0.45f;
+
+            // HUD angle = G + roll (roll is body roll about forward; we use same sign)
+            float hudAng = G + roll;
+            float sa, ca; TrigSinCos(GetHudTrigTier(), hudAng, &sa, &ca);
+            float hx = cx + r * sa;  // screen x grows to right
+            float hy = cy - r * ca;  // screen y grows downwards
+
+            // Draw HUD elements
+            DrawCircleLines(cx, cy, 12, BLACK);
+            DrawCircleLines(cx, cy, (int)(kpix*rad(10)), LIGHTGRAY);
+            DrawCircleLines(cx, cy, (int)(kpix*rad(20)), LIGHTGRAY);
+            DrawCircleLines(cx, cy, (int)(kpix*rad(30)), LIGHTGRAY);
+
+            DrawLine(cx-20, cy, cx+20, cy, DARKGRAY);
+            DrawLine(cx, cy-20, cx, cy+20, DARKGRAY);
+
+            // Other tracks seen by the controlled aircraft
+            for (int k = 0; k < rowCount; ++k)
+            {
+                if ((rowTarget ? rowTarget[k] : k) == 0) continue;
+                float rt = kpix * row->j[k];
+                if (rt > screenHeight*0.45f) continue;
+                float at = row->G[k] + roll;
+                float sat, cat; TrigSinCos(GetHudTrigTier(), at, &sat, &cat);
+                DrawCircle((int)(cx + rt*sat), (int)(cy - rt*cat), 2, Fade(MAROON, 0.5f));
+            }
+            if (gpuFrame)
+                GpuSolverDrawMarkers(&gpu, 0, 0, (float)cx, (float)cy, kpix, roll, screenHeight*0.45f, 2.0f,
+                                     screenWidth, screenHeight, Fade(MAROON, 0.5f));
+
+            DrawCircle((int)hx, (int)hy, 6, MAROON);
+            DrawCircleLines((int)hx, (int)hy, 10, MAROON);
+
+            // Predicted lead marker: same (j, G + roll) mapping, joined to the target dot
+            if (lead)
+            {
+                float rl = kpix*lead->lead.j[0];
+                if (rl > screenHeight*0.45f) rl = screenHeight*0.45f;
+                float sl, cl; TrigSinCos(GetHudTrigTier(), lead->lead.G[0] + roll, &sl, &cl);
+                int lx = (int)(cx + rl*sl), ly = (int)(cy - rl*cl);
+                DrawLine((int)hx, (int)hy, lx, ly, Fade(ORANGE, 0.7f));
+                DrawCircleLines(lx, ly, 8, ORANGE);
+                DrawLine(lx - 5, ly, lx + 5, ly, ORANGE);
+                DrawLine(lx, ly - 5, lx, ly + 5, ORANGE);
+            }
+
+            ProfileEnd(ring);
+        }
+
+        // Recording with the GPU solve: the previous dispatch, which had a whole frame to finish
+        if (gpuFrame && cliRecord)
+        {
+            ProfileBegin(ring, "leitura");
+            long readTick;
+            double readTime;
+            if (GpuSolverReadback(&gpu, &gpuRead, &readTick, &readTime))
+                RecorderAppendPairs(&recorder, readTick, readTime, &gpuRead);
+            ProfileEnd(ring);
+        }
 
-        // Draw HUD elements
-        DrawCircleLines(cx, cy, 12, BLACK);
-        DrawCircleLines(cx, cy, (int)(kpix*rad(10)), LIGHTGRAY);
-        DrawCircleLines(cx, cy, (int)(kpix*rad(20)), LIGHTGRAY);
-        DrawCircleLines(cx, cy, (int)(kpix*rad(30)), LIGHTGRAY);
+        // Text readouts: every line is cached and only reformatted when a shown value changes
+        ProfileBegin(ring, "texto");
+        int reformats = 0;
+        int labelCount = gpuFrame ? tgt.count : rowCount;
+        TextBatchBegin(&text, &arena, HUD_TEXT_QUADS + (showAnn && showTracks && !multiView && !paced ? TRACK_LABEL_QUADS*labelCount : 0));
+        reformats += TextLineUpdate(&hud[0], "AzT=%.1f deg  ElT=%.1f deg  AzR=%.1f deg  ElR=%.1f deg", 4,
+                                    (TextArg[]){ TEXT_NUM(deg(AzT)), TEXT_NUM(deg(ElT)), TEXT_NUM(deg(AzR)), TEXT_NUM(deg(ElR)) });
+        TextBatchAdd(&text, hud[0].text, 16, 16, 18, BLACK);
 
-        DrawLine(cx-20, cy, cx+20, cy, DARKGRAY);
-        DrawLine(cx, cy-20, cx, cy+20, DARKGRAY);
+        if (!(WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_G) && !gpuFrame)
+            reformats += TextLineUpdate(&hud[1], "j=%.2f deg  (compilado so com j)", 1,
+                                        (TextArg[]){ TEXT_NUM(deg(j)) });
+        else if (snap->solver == SOLVER_VECTOR)
+            reformats += TextLineUpdate(&hud[1], "j=%.2f deg  G=%.2f deg  (vetorial: so j e G)", 2,
+                                        (TextArg[]){ TEXT_NUM(deg(j)), TEXT_NUM(deg(G)) });
+        else if (!(WOE_SOLVE_OUTPUTS & WOE_SOLVE_OUT_EFJ) && !gpuFrame)
+            reformats += TextLineUpdate(&hud[1], "j=%.2f deg  G=%.2f deg  (compilado so com j/G)", 2,
+                                        (TextArg[]){ TEXT_NUM(deg(j)), TEXT_NUM(deg(G)) });
+        else
+            reformats += TextLineUpdate(&hud[1], "j=%.2f deg  J=%.2f deg  E=%.2f deg  F=%.2f deg  G=%.2f deg", 5,
+                                        (TextArg[]){ TEXT_NUM(deg(j)), TEXT_NUM(deg(J)), TEXT_NUM(deg(E)),
+                                                     TEXT_NUM(deg(F)), TEXT_NUM(deg(G)) });
+        TextBatchAdd(&text, hud[1].text, 16, 40, 18, BLACK);
 
-        DrawCircle((int)hx, (int)hy, 6, MAROON);
-        DrawCircleLines((int)hx, (int)hy, 10, MAROON);
+        SimdIsa isa = SimdGetIsa();
+        static const char *solverNames[SOLVER_MODE_COUNT] = { "lote", "escalar", "vetorial" };
+        reformats += TextLineUpdate(&hud[2], "pairs=%d/%d%s  recalc=%d  solver=%s  simd=%s (%d lanes)  trig=%s  render=%s", 9,
+                                    (TextArg[]){ TEXT_NUM(snap->culled ? snap->cand.total : air.count*tgt.count),
+                                                 TEXT_NUM(air.count*tgt.count), TEXT_STR(gpuFrame ? " (gpu)" : snap->culled ? " (cone)" : ""),
+                                                 TEXT_NUM(snap->recomputed),
+                                                 TEXT_STR(solverNames[snap->solver]), TEXT_STR(SimdIsaName(isa)),
+                                                 TEXT_NUM(SimdIsaLanes(isa)), TEXT_STR(TrigTierName(snap->trig)),
+                                                 TEXT_STR(instanced ? "instanciado" : "imediato") });
+        TextBatchAdd(&text, hud[2].text, 16, 64, 18, DARKGRAY);
 
-        // Text readouts
-        char buf[256];
-        snprintf(buf, sizeof(buf),
-                 "AzT=%.1f deg  ElT=%.1f deg  AzR=%.1f deg  ElR=%.1f deg",
-                 deg(AzT), deg(ElT), deg(AzR), deg(ElR));
-        DrawText(buf, 16, 16, 18, BLACK);
+        reformats += TextLineUpdate(&hud[3], "sim=%.0f Hz  tick=%ld  idade=%.1f ms  atrasos=%d  threads=%d", 5,
+                                    (TextArg[]){ TEXT_NUM(sim.rateHz), TEXT_NUM(snap->tick),
+                                                 TEXT_NUM((WoeNow() - snap->published)*1000.0),
+                                                 TEXT_NUM(WoeAtomicLoad(&sim.overruns)), TEXT_NUM(JobPoolThreads(&pool)) });
+        TextBatchAdd(&text, hud[3].text, 16, 88, 18, DARKGRAY);
 
-        snprintf(buf, sizeof(buf),
-                 "j=%.2f deg  J=%.2f deg  E=%.2f deg  F=%.2f deg  G=%.2f deg",
-                 deg(j), deg(J), deg(E), deg(F), deg(G));
-        DrawText(buf, 16, 40, 18, BLACK);
+        TextBatchAdd(&text, "Controls: Aircraft I/K J/L U/O, Target W/S A/D Q/E, Yaw/Pitch Arrows, Roll Z/X, Orbit Cam RMB, Toggle labels H, Track labels T, Solver V, Trig M, Instancing G, Cull C, Incremental R, Predict F, GPU solve B, Profiler P, Seek PgUp/PgDn, Views N, Pacing Y",
+                     16, screenHeight-28, 16, DARKGRAY);
 
-        DrawText("Controls: Aircraft I/K J/L U/O, Target W/S A/D Q/E, Yaw/Pitch Arrows, Roll Z/X, Orbit Cam RMB, Toggle labels H",
-                 16, screenHeight-28, 16, DARKGRAY);
+        // One readout per view, at the bottom of its cell (the last row clears the controls line)
+        for (int v = 0; multiView && v < views.count; ++v)
+        {
+            Rectangle cell = ViewGridCell(&views, v);
+            int ly = (int)(cell.y + cell.height) - 24 - (v/views.cols == views.rows - 1 ? 28 : 0);
+            if (viewRows[v] < 0)
+                reformats += TextLineUpdate(&viewLines[v], "vista %d: sem aeronave", 1, (TextArg[]){ TEXT_NUM(v + 1) });
+            else
+                reformats += TextLineUpdate(&viewLines[v], "aeronave %d  j=%.2f deg  G=%.2f deg  pares=%d", 4,
+                                            (TextArg[]){ TEXT_NUM(v), TEXT_NUM(deg(viewPairs.j[v])),
+                                                         TEXT_NUM(deg(viewPairs.G[v])), TEXT_NUM(viewRows[v]) });
+            TextBatchAdd(&text, viewLines[v].text, (int)cell.x + 8, ly, 16, DARKBLUE);
+        }
 
-        // 2D annotations projected from 3D if enabled
-        if (showAnn)
+        // 2D annotations projected from 3D if enabled; each label is frustum-tested before formatting.
+        // With pacing they belong to the cached scene: rebuilt with it, in its own batch.
+        TextBatch *labels = paced ? &sceneText : &text;
+        if (showAnn && !multiView && drawScene)
         {
             // Labels for A and T
-            DrawTextAt3D(cam, A, "A (aeronave)", 16, DARKBLUE, screenWidth, screenHeight);
-            DrawTextAt3D(cam, T, "T (alvo)", 16, MAROON, screenWidth, screenHeight);
+            if (CullLabel(&frustum, A, &labelCull))
+                TextBatchAddAt3D(labels, &frustum, A, "A (aeronave)", 16, DARKBLUE, screenWidth, screenHeight);
+            if (CullLabel(&frustum, T, &labelCull))
+                TextBatchAddAt3D(labels, &frustum, T, "T (alvo)", 16, MAROON, screenWidth, screenHeight);
 
             // Label for forward vector R at its end
-            DrawTextAt3D(cam, Vector3Add(A, Vector3Scale(fwd, 4.2f)), "R (eixo de rolagem)", 16, BLUE, screenWidth, screenHeight);
+            Vector3 rEnd = Vector3Add(A, Vector3Scale(fwd, 4.2f));
+            if (CullLabel(&frustum, rEnd, &labelCull))
+                TextBatchAddAt3D(labels, &frustum, rEnd, "R (eixo de rolagem)", 16, BLUE, screenWidth, screenHeight);
+
+            // Az/El of every other solved track next to it
+            for (int k = 0; showTracks && k < labelCount; ++k)
+            {
+                int t = rowTarget ? rowTarget[k] : k;
+                if (t == 0) continue;
+                Vector3 p = { tgt.x[t], tgt.y[t], tgt.z[t] };
+                if (!CullLabel(&frustum, p, &labelCull)) continue;
+                float lAz, lEl;
+                if (gpuFrame)
+                    ComputeAzElTier((WoeVec3){ A.x, A.y, A.z }, (WoeVec3){ p.x, p.y, p.z }, snap->trig, &lAz, &lEl);
+                else { lAz = row->AzT[k]; lEl = row->ElT[k]; }
+                reformats += TextLineUpdate(&trackLab[t], "%.0f/%.0f", 2,
+                                            (TextArg[]){ TEXT_NUM(deg(lAz)), TEXT_NUM(deg(lEl)) });
+                TextBatchAddAt3D(labels, &frustum, p, trackLab[t].text, 10, Fade(MAROON, 0.7f), screenWidth, screenHeight);
+            }
 
             // Midpoint along arc j for label
             Vector3 dAT = Vector3Subtract(T, A);
@@ -440,25 +1502,199 @@ int main(void)
                 Vector3 n = Vector3Normalize(Vector3CrossProduct(u, v));
                 Vector3 w = Vector3Normalize(Vector3CrossProduct(n, u));
                 float tmid = j*0.5f;
-                Vector3 midDir = Vector3Add(Vector3Scale(u, cosf(tmid)), Vector3Scale(w, sinf(tmid)));
+                float sm, cm; TrigSinCos(GetHudTrigTier(), tmid, &sm, &cm);
+                Vector3 midDir = Vector3Add(Vector3Scale(u, cm), Vector3Scale(w, sm));
                 Vector3 midPos = Vector3Add(A, Vector3Scale(midDir, 1.6f));
-                DrawTextAt3D(cam, midPos, "j", 18, PURPLE, screenWidth, screenHeight);
+                if (CullLabel(&frustum, midPos, &labelCull))
+                    TextBatchAddAt3D(labels, &frustum, midPos, "j", 18, PURPLE, screenWidth, screenHeight);
 
                 // Show Az/El near the A->T line midpoint
                 Vector3 midAT = Vector3Add(A, Vector3Scale(dAT, 0.5f));
-                char lab[128];
-                snprintf(lab, sizeof(lab), "AzT=%.0f° ElT=%.0f°", deg(AzT), deg(ElT));
-                DrawTextAt3D(cam, midAT, lab, 16, MAROON, screenWidth, screenHeight);
+                if (CullLabel(&frustum, midAT, &labelCull))
+                {
+                    reformats += TextLineUpdate(&labAT, "AzT=%.0f° ElT=%.0f°", 2,
+                                                (TextArg[]){ TEXT_NUM(deg(AzT)), TEXT_NUM(deg(ElT)) });
+                    TextBatchAddAt3D(labels, &frustum, midAT, labAT.text, 16, MAROON, screenWidth, screenHeight);
+                }
 
                 // Show AzR/ElR near forward vector end
-                snprintf(lab, sizeof(lab), "AzR=%.0f° ElR=%.0f°", deg(AzR), deg(ElR));
-                DrawTextAt3D(cam, Vector3Add(A, Vector3Scale(fwd, 4.6f)), lab, 16, BLUE, screenWidth, screenHeight);
+                Vector3 azrPos = Vector3Add(A, Vector3Scale(fwd, 4.6f));
+                if (CullLabel(&frustum, azrPos, &labelCull))
+                {
+                    reformats += TextLineUpdate(&labAR, "AzR=%.0f° ElR=%.0f°", 2,
+                                                (TextArg[]){ TEXT_NUM(deg(AzR)), TEXT_NUM(deg(ElR)) });
+                    TextBatchAddAt3D(labels, &frustum, azrPos, labAR.text, 16, BLUE, screenWidth, screenHeight);
+                }
             }
         }
 
+        // Culling and text stats for this frame (labels counted after the pass above)
+        reformats += TextLineUpdate(&hud[4], "frustum: aeronaves=%d/%d  alvos=%d/%d  arcos=%d/%d  rotulos=%d/%d", 8,
+                                    (TextArg[]){ TEXT_NUM(airCull.visible), TEXT_NUM(airCull.tested),
+                                                 TEXT_NUM(tgtCull.visible), TEXT_NUM(tgtCull.tested),
+                                                 TEXT_NUM(arcCull.visible), TEXT_NUM(arcCull.tested),
+                                                 TEXT_NUM(labelCull.visible), TEXT_NUM(labelCull.tested) });
+        TextBatchAdd(&text, hud[4].text, 16, 112, 18, DARKGRAY);
+        TextLineUpdate(&hud[5], "texto: %d quads  %d linhas refeitas", 2,
+                       (TextArg[]){ TEXT_NUM(text.count), TEXT_NUM(reformats) });
+        TextBatchAdd(&text, hud[5].text, 16, 136, 18, DARKGRAY);
+        if (cliTracks)
+        {
+            double played = snap->time < tracks.end - tracks.start ? snap->time : tracks.end - tracks.start;
+            TextLineUpdate(&hud[6], "replay: %.1f s de %.1f s  (%d trilhas)", 3,
+                           (TextArg[]){ TEXT_NUM(played), TEXT_NUM(tracks.end - tracks.start), TEXT_NUM(tracks.count) });
+            TextBatchAdd(&text, hud[6].text, 16, 160, 18, DARKGRAY);
+        }
+        else if (cliScenario)
+        {
+            const char *ended = snap->time >= scenario.duration ? "  (fim)" : "";
+            if (sim.speed > 0.0)
+                TextLineUpdate(&hud[6], "cenario: %.2f s de %.1f s  velocidade=%.1fx%s", 4,
+                               (TextArg[]){ TEXT_NUM(snap->time), TEXT_NUM(scenario.duration), TEXT_NUM(sim.speed),
+                                            TEXT_STR(ended) });
+            else
+                TextLineUpdate(&hud[6], "cenario: %.2f s de %.1f s  velocidade=max%s", 3,
+                               (TextArg[]){ TEXT_NUM(snap->time), TEXT_NUM(scenario.duration), TEXT_STR(ended) });
+            TextBatchAdd(&text, hud[6].text, 16, 160, 18, DARKGRAY);
+        }
+        int statusY = cliTracks || cliScenario ? 184 : 160;
+        // fixed-footprint sizing: frame arena peak (and what it would have taken), entity pool peaks
+        TextLineUpdate(&hud[10], "memoria: quadro %.0f/%.0f KB  pico %.0f KB  pedido %.0f KB  recusas=%.0f  "
+                       "entidades %d+%d  pico %d+%d  removidas=%.0f", 10,
+                       (TextArg[]){ TEXT_NUM(arena.last/1024.0), TEXT_NUM(arena.capacity/1024.0),
+                                    TEXT_NUM(arena.peak/1024.0), TEXT_NUM(arena.peakWanted/1024.0),
+                                    TEXT_NUM((double)arena.failures), TEXT_NUM(air.count), TEXT_NUM(tgt.count),
+                                    TEXT_NUM(snap->airPeak), TEXT_NUM(snap->tgtPeak), TEXT_NUM((double)snap->despawned) });
+        TextBatchAdd(&text, hud[10].text, 16, statusY, 18, DARKGRAY);
+        statusY += 24;
+        if (instanced)
+        {
+            TextLineUpdate(&hud[11], "lod (malha/simples/ponto): aeronaves %d/%d/%d  alvos %d/%d/%d", 6,
+                           (TextArg[]){ TEXT_NUM(inst.aircraftLod[RENDER_LOD_FULL]), TEXT_NUM(inst.aircraftLod[RENDER_LOD_SIMPLE]),
+                                        TEXT_NUM(inst.aircraftLod[RENDER_LOD_POINT]), TEXT_NUM(inst.targetLod[RENDER_LOD_FULL]),
+                                        TEXT_NUM(inst.targetLod[RENDER_LOD_SIMPLE]), TEXT_NUM(inst.targetLod[RENDER_LOD_POINT]) });
+            TextBatchAdd(&text, hud[11].text, 16, statusY, 18, DARKGRAY);
+            statusY += 24;
+        }
+        if (gpuFrame)
+        {
+            TextLineUpdate(&hud[12], "gpu: %d pares por despacho  despachos=%.0f  leituras=%.0f", 3,
+                           (TextArg[]){ TEXT_NUM(air.count*tgt.count), TEXT_NUM((double)gpu.dispatches),
+                                        TEXT_NUM((double)gpu.readbacks) });
+            TextBatchAdd(&text, hud[12].text, 16, statusY, 18, DARKGRAY);
+            statusY += 24;
+        }
+        if (lead)
+        {
+            if (lead->tgo[0] >= 0.0f)
+                TextLineUpdate(&hud[9], "mira: tgo=%.2f s  aprox=%.2f s  dist=%.2f  v=%.1f unid/s", 4,
+                               (TextArg[]){ TEXT_NUM(lead->tgo[0]), TEXT_NUM(lead->tca[0]), TEXT_NUM(lead->miss[0]),
+                                            TEXT_NUM(sim.interceptSpeed) });
+            else
+                TextLineUpdate(&hud[9], "mira: sem interceptacao  aprox=%.2f s  dist=%.2f  v=%.1f unid/s", 3,
+                               (TextArg[]){ TEXT_NUM(lead->tca[0]), TEXT_NUM(lead->miss[0]),
+                                            TEXT_NUM(sim.interceptSpeed) });
+            TextBatchAdd(&text, hud[9].text, 16, statusY, 18, ORANGE);
+            statusY += 24;
+        }
+        if (cliRecord)
+        {
+            // with the GPU solve this thread is the recorder's producer and reads its counters directly
+            TextLineUpdate(&hud[7], "gravacao: %.0f linhas  %d blocos  descartadas=%.0f", 3,
+                           (TextArg[]){ TEXT_NUM(gpuFrame ? recorder.rows : snap->recorded),
+                                        TEXT_NUM(WoeAtomicLoad(&recorder.written)),
+                                        TEXT_NUM(gpuFrame ? recorder.dropped : snap->recordDropped) });
+            TextBatchAdd(&text, hud[7].text, 16, statusY, 18, DARKGRAY);
+            statusY += 24;
+        }
+        if (cliListen)
+        {
+            TextLineUpdate(&hud[8], "rede: %d pacotes  %.0f atualizacoes  latencia=%.2f ms  fila cheia=%d", 4,
+                           (TextArg[]){ TEXT_NUM(WoeAtomicLoad(&ingest.packets)), TEXT_NUM(snap->ingested),
+                                        TEXT_NUM(snap->ingestLatency*1000.0), TEXT_NUM(WoeAtomicLoad(&ingest.full)) });
+            TextBatchAdd(&text, hud[8].text, 16, statusY, 18, DARKGRAY);
+            statusY += 24;
+        }
+        if (paced)
+        {
+            TextLineUpdate(&hud[13], "ritmo: cena a cada %d quadros  cena %.2f ms  hud %.2f ms  reaproveitados=%.0f", 4,
+                           (TextArg[]){ TEXT_NUM(pacer.divisor), TEXT_NUM(pacer.sceneCost*1000.0),
+                                        TEXT_NUM(pacer.hudCost*1000.0), TEXT_NUM((double)pacer.reused) });
+            TextBatchAdd(&text, hud[13].text, 16, statusY, 18, DARKGRAY);
+        }
+
+        // Profiler overlay, right of the readouts: mean and worst time per phase over the last second
+        if (showProfile)
+        {
+            int px = screenWidth - 330, py = 16, line = 0;
+            TextBatchAdd(&text, "perfil (ms/vez, max, vezes/s)", px, py, 16, DARKGRAY);
+            py += 20;
+            for (int i = 0; i < PROFILE_MAX_THREADS && line < PROFILE_OVERLAY_LINES; ++i)
+            {
+                const ProfileRing *pr = ProfilerRing(&profiler, i);
+                if (!pr) continue;
+                ProfileStat st[PROFILE_OVERLAY_PHASES];
+                int ns = ProfileSummarize(pr, PROFILE_OVERLAY_WINDOW, st, PROFILE_OVERLAY_PHASES);
+                TextBatchAdd(&text, pr->name, px, py, 16, DARKBLUE);
+                py += 20;
+                for (int k = 0; k < ns && line < PROFILE_OVERLAY_LINES; ++k, ++line)
+                {
+                    TextLineUpdate(&profLines[line], "%.2f  %.2f  %.0f", 3,
+                                   (TextArg[]){ TEXT_NUM(st[k].total/st[k].count*1000.0), TEXT_NUM(st[k].max*1000.0),
+                                                TEXT_NUM(st[k].count/PROFILE_OVERLAY_WINDOW) });
+                    TextBatchAdd(&text, st[k].name, px + 12 + 12*st[k].depth, py, 16, DARKGRAY);
+                    TextBatchAdd(&text, profLines[line].text, px + 130, py, 16, DARKGRAY);
+                    py += 20;
+                }
+            }
+        }
+
+        // every HUD and label glyph in one textured draw, on top of the HUD shapes (cached labels first)
+        if (paced && !multiView) TextBatchDraw(&sceneText);
+        TextBatchDraw(&text);
+        ProfileEnd(ring);
+
+        // the frame's cost up to the swap, split into scene and the rest, sets the next divisor
+        if (paced) FramePacerEnd(&pacer, WoeNow() - frameStart, sceneTime);
+
+        // buffer swap plus the SetTargetFPS wait
+        ProfileBegin(ring, "swap");
         EndDrawing();
+        ProfileEnd(ring);
+        ProfileEnd(ring);
     }
 
+    LineBatchFree(&lines);
+    PairResultsFree(&viewPairs);
+    if (haveViews) ViewGridFree(&views);
+    if (havePacing) UnloadRenderTexture(sceneTex);
+    TextBatchFree(&sceneText);
+    TextBatchFree(&text);
+    FrameArenaFree(&arena);
+    free(trackLab);
+    if (haveInstancing) InstancedRendererFree(&inst);
+    SimStop(&sim);
+    PairResultsFree(&gpuRead);
+    if (haveGpu) GpuSolverFree(&gpu);
+    if (cliTrace)
+    {
+        const char *err;
+        long events = ProfilerWriteTrace(&profiler, cliTrace, &err);
+        if (events < 0) fprintf(stderr, "woe3d: '%s': %s\n", cliTrace, err);
+        else fprintf(stderr, "woe3d: %ld intervalos gravados em '%s'\n", events, cliTrace);
+    }
+    ProfilerFree(&profiler);
+    if (cliListen) IngestClose(&ingest);
+    if (cliRecord)
+    {
+        long long rows = recorder.rows, dropped = recorder.dropped;
+        if (!RecorderClose(&recorder)) fprintf(stderr, "woe3d: '%s': erro de escrita na gravacao\n", cliRecord);
+        else fprintf(stderr, "woe3d: %lld linhas gravadas em '%s' (%lld descartadas)\n", rows, cliRecord, dropped);
+    }
+    JobPoolFree(&pool);
+    SimFree(&sim);
+    if (cliTracks) TrackFileClose(&tracks);
+    if (cliScenario) ScenarioFree(&scenario);
     CloseWindow();
     return 0;
 }
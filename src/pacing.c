@@ -0,0 +1,70 @@
+/**
+ * @file pacing.c
+ * @brief Controlador de ritmo da cena em cache (veja pacing.h).
+ */
+#include "pacing.h"
+
+#include <math.h>
+#include <string.h>
+
+void FramePacerInit(FramePacer *p, double hz)
+{
+    memset(p, 0, sizeof(*p));
+    p->budget = PACER_HEADROOM/(hz > 0.0 ? hz : 60.0);
+    p->divisor = 1;
+}
+
+void FramePacerInvalidate(FramePacer *p)
+{
+    p->valid = false;
+}
+
+bool FramePacerBegin(FramePacer *p, bool dirty)
+{
+    p->frames++;
+    p->since++;
+    bool draw = !p->valid || (dirty && p->since >= p->divisor);
+    if (draw)
+    {
+        p->since = 0;
+        p->valid = true;
+        p->scenes++;
+    }
+    else p->reused++;
+    return draw;
+}
+
+/** Menor divisor cujo custo amortizado h + c/d cabe no orçamento, limitado a [1, PACER_MAX_DIVISOR]. */
+static int WantedDivisor(const FramePacer *p)
+{
+    double room = p->budget - p->hudCost;
+    if (p->hudCost + p->sceneCost <= p->budget) return 1;
+    if (room <= 0.0) return PACER_MAX_DIVISOR; // the HUD alone is over: the scene gets all it can give
+    double d = ceil(p->sceneCost/room);
+    return d < PACER_MAX_DIVISOR ? (int)d : PACER_MAX_DIVISOR;
+}
+
+void FramePacerEnd(FramePacer *p, double work, double scene)
+{
+    double hud = work - scene > 0.0 ? work - scene : 0.0;
+    // the first sample seeds the average instead of being pulled towards zero
+    p->hudCost = p->frames > 1 ? p->hudCost + PACER_SMOOTHING*(hud - p->hudCost) : hud;
+    if (scene > 0.0)
+        p->sceneCost = p->scenes > 1 ? p->sceneCost + PACER_SMOOTHING*(scene - p->sceneCost) : scene;
+
+    int want = WantedDivisor(p);
+    if (want > p->divisor)
+    {
+        p->divisor = want;
+        p->settle = 0;
+    }
+    else if (want < p->divisor)
+    {
+        if (++p->settle >= PACER_SETTLE_FRAMES)
+        {
+            p->divisor--;
+            p->settle = 0;
+        }
+    }
+    else p->settle = 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file pacing.h
+ * @brief Ritmo adaptativo do quadro: HUD em toda a taxa, cena 3D em cache e refeita numa fração dela.
+ *
+ * Com o ritmo ligado (--pacing=on, tecla Y) a cena 3D (grade, entidades,
+ * arcos e rótulos 3D) é desenhada numa render texture e só é refeita quando
+ * algo que ela mostra mudou (instantâneo novo, câmera, opções de desenho) e
+ * já passaram @c divisor quadros desde a última; nos outros quadros a textura
+ * em cache é colada e o HUD (leituras de j/G, marcadores, texto) é refeito
+ * por cima, na taxa cheia.
+ *
+ * O divisor se adapta ao orçamento do quadro medido: com os custos médios
+ * de HUD (h) e de cena (c) e o orçamento b = PACER_HEADROOM / taxa, é o
+ * menor d com h + c/d <= b, limitado a [1, PACER_MAX_DIVISOR]. Sobe na hora
+ * e desce um passo por vez, depois de PACER_SETTLE_FRAMES quadros seguidos
+ * pedindo menos. Os tempos são de CPU (envio dos comandos), sem a espera do
+ * SetTargetFPS. Sem dependência da raylib.
+ */
+#ifndef WOE_PACING_H
+#define WOE_PACING_H
+
+#include <stdbool.h>
+
+/** Maior divisor: a cena cai no máximo para 1/8 da taxa do HUD. */
+#define PACER_MAX_DIVISOR 8
+/** Fração do período do quadro que HUD e cena podem ocupar, em média. */
+#define PACER_HEADROOM 0.8
+/** Quadros seguidos pedindo divisor menor antes de descer um passo. */
+#define PACER_SETTLE_FRAMES 30
+/** Peso de cada amostra nas médias móveis exponenciais de custo. */
+#define PACER_SMOOTHING 0.1
+
+/** Controlador de ritmo; todos os campos são de leitura para o HUD. */
+typedef struct FramePacer {
+    double budget;      /**< Orçamento por quadro (s): PACER_HEADROOM / taxa. */
+    int divisor;        /**< Cena refeita no máximo a cada @c divisor quadros. */
+    int since;          /**< Quadros desde a última cena desenhada. */
+    int settle;         /**< Quadros seguidos pedindo divisor menor. */
+    bool valid;         /**< Falso até a primeira cena: o cache está vazio. */
+    double hudCost;     /**< Custo médio do quadro sem a cena (s). */
+    double sceneCost;   /**< Custo médio de desenhar a cena (s). */
+    long frames;        /**< Quadros desde FramePacerInit. */
+    long scenes;        /**< Cenas desenhadas. */
+    long reused;        /**< Quadros que colaram a cena em cache. */
+} FramePacer;
+
+/** @brief Começa com divisor 1 e cache vazio, para uma taxa de quadros de @p hz. */
+void FramePacerInit(FramePacer *p, double hz);
+
+/** @brief Esvazia o cache: o próximo quadro desenha a cena. */
+void FramePacerInvalidate(FramePacer *p);
+
+/**
+ * @brief Decide se este quadro desenha a cena.
+ * @param dirty Algo que a cena mostra mudou desde a última desenhada.
+ * @return true se a cena deve ser refeita (cache vazio, ou @p dirty e o divisor vencido).
+ */
+bool FramePacerBegin(FramePacer *p, bool dirty);
+
+/**
+ * @brief Registra os custos do quadro e ajusta o divisor.
+ * @param work Tempo do quadro até antes da troca de buffers (s).
+ * @param scene Parte de @p work gasta desenhando a cena (s); 0 se foi reaproveitada.
+ */
+void FramePacerEnd(FramePacer *p, double work, double scene);
+
+#endif /* WOE_PACING_H */
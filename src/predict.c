@@ -0,0 +1,136 @@
+/**
+ * @file predict.c
+ * @brief Predição de interceptação por linhas e blocos de pares (veja predict.h).
+ */
+#include "predict.h"
+#include "simd/angles_simd.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Alvos por job de PredictEngagements; mesmo bloco do solver paralelo. */
+#define PREDICT_TILE_TARGETS 512
+
+bool PredictResultsInit(PredictResults *p, int capacity)
+{
+    memset(p, 0, sizeof(*p));
+    if (capacity < 1) capacity = 1;
+    int lanes = (capacity + ENTITY_LANE_PAD - 1)/ENTITY_LANE_PAD*ENTITY_LANE_PAD;
+    size_t stride = (size_t)lanes*sizeof(float);
+    p->mem = calloc(1, 6*stride + ENTITY_ALIGNMENT);
+    if (!p->mem || !PairResultsInit(&p->lead, capacity))
+    {
+        PredictResultsFree(p);
+        return false;
+    }
+    uintptr_t base = ((uintptr_t)p->mem + ENTITY_ALIGNMENT - 1) & ~(uintptr_t)(ENTITY_ALIGNMENT - 1);
+    float **arrays[6] = { &p->px, &p->py, &p->pz, &p->tgo, &p->tca, &p->miss };
+    for (int i = 0; i < 6; ++i) *arrays[i] = (float *)(base + stride*(size_t)i);
+    p->capacity = lanes < p->lead.capacity ? lanes : p->lead.capacity;
+    return true;
+}
+
+void PredictResultsFree(PredictResults *p)
+{
+    PairResultsFree(&p->lead);
+    free(p->mem);
+    memset(p, 0, sizeof(*p));
+}
+
+void PredictRow(const EntityStore *air, int a, float speed, int n,
+                const float *tx, const float *ty, const float *tz,
+                const float *tvx, const float *tvy, const float *tvz,
+                PredictResults *out, int base, SolverMode mode)
+{
+    if (n <= 0) return;
+    WoeVec3 fwd;
+    float AzR, ElR;
+    EntityForward(air, a, &fwd, &AzR, &ElR);
+    ComputeInterceptBatch(n, air->x[a], air->y[a], air->z[a], air->vx[a], air->vy[a], air->vz[a],
+                          speed, PREDICT_MAX_TIME, tx, ty, tz, tvx, tvy, tvz,
+                          out->px + base, out->py + base, out->pz + base,
+                          out->tgo + base, out->tca + base, out->miss + base);
+    // the aim points stand in for the targets: same kernels, same solver modes
+    SolveEngagementRowForward(air, a, fwd, AzR, ElR, n, out->px + base, out->py + base, out->pz + base,
+                              &out->lead, base, mode);
+}
+
+/** Contexto de um despacho de PredictEngagements. */
+typedef struct PredictTiles {
+    const EntityStore *air;
+    const EntityStore *tgt;
+    PredictResults *out;
+    float speed;
+    SolverMode mode;
+    int tilesPerRow;
+} PredictTiles;
+
+static void PredictTileJob(void *ctx, int job, int worker)
+{
+    const PredictTiles *pt = (const PredictTiles *)ctx;
+    const EntityStore *tgt = pt->tgt;
+    (void)worker;
+    int a = job/pt->tilesPerRow;
+    int t0 = (job - a*pt->tilesPerRow)*PREDICT_TILE_TARGETS;
+    int t1 = t0 + PREDICT_TILE_TARGETS < tgt->count ? t0 + PREDICT_TILE_TARGETS : tgt->count;
+    PredictRow(pt->air, a, pt->speed, t1 - t0, tgt->x + t0, tgt->y + t0, tgt->z + t0,
+               tgt->vx + t0, tgt->vy + t0, tgt->vz + t0, pt->out, a*tgt->count + t0, pt->mode);
+}
+
+void PredictEngagements(JobPool *pool, const EntityStore *air, const EntityStore *tgt, float speed,
+                        PredictResults *out, SolverMode mode)
+{
+    if (air->count*tgt->count > out->capacity) return;
+    out->aircraft = out->lead.aircraft = air->count;
+    out->targets = out->lead.targets = tgt->count;
+
+    PredictTiles pt = { air, tgt, out, speed, mode, (tgt->count + PREDICT_TILE_TARGETS - 1)/PREDICT_TILE_TARGETS };
+    int jobs = air->count*pt.tilesPerRow;
+    if (pool && JobPoolThreads(pool) > 1)
+    {
+        JobPoolRun(pool, jobs, PredictTileJob, &pt);
+    }
+    else
+    {
+        for (int j = 0; j < jobs; ++j) PredictTileJob(&pt, j, 0);
+    }
+}
+
+/** Contexto de um despacho de PredictCandidates. */
+typedef struct PredictRows {
+    const EntityStore *air;
+    const CandidatePairs *c;
+    PredictResults *out;
+    float speed;
+    SolverMode mode;
+} PredictRows;
+
+static void PredictCandidateRow(void *ctx, int a, int worker)
+{
+    const PredictRows *pr = (const PredictRows *)ctx;
+    const CandidatePairs *c = pr->c;
+    const EntityStore *g = &c->gather;
+    (void)worker;
+    int base = a*c->stride;
+    PredictRow(pr->air, a, pr->speed, c->count[a], g->x + base, g->y + base, g->z + base,
+               g->vx + base, g->vy + base, g->vz + base, pr->out, base, pr->mode);
+}
+
+void PredictCandidates(JobPool *pool, const EntityStore *air, const CandidatePairs *c, float speed,
+                       PredictResults *out, SolverMode mode)
+{
+    if (air->count*c->stride > out->capacity) return;
+    out->aircraft = out->lead.aircraft = air->count;
+    out->targets = out->lead.targets = c->stride;
+
+    PredictRows pr = { air, c, out, speed, mode };
+    if (pool && JobPoolThreads(pool) > 1)
+    {
+        JobPoolRun(pool, air->count, PredictCandidateRow, &pr);
+    }
+    else
+    {
+        for (int a = 0; a < air->count; ++a) PredictCandidateRow(&pr, a, 0);
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file predict.h
+ * @brief Predição de interceptação por par: ponto de mira com avanço, tempo até a interceptação e maior aproximação.
+ *
+ * Com as velocidades de aeronave e alvo (EntityStore::vx/vy/vz), cada par é
+ * extrapolado em movimento retilíneo uniforme. Para um interceptador que sai
+ * da aeronave com velocidade relativa @c speed, o ponto de mira é onde o alvo
+ * estará quando for alcançado; os ângulos j/G desse ponto, vistos do vetor
+ * frente atual, dizem para onde apontar agora (perseguição com avanço). Sem
+ * solução dentro de PREDICT_MAX_TIME o ponto de mira passa a ser a posição
+ * relativa na maior aproximação.
+ *
+ * Uma linha (aeronave contra n alvos) é resolvida por ComputeInterceptBatch,
+ * que escreve os pontos de mira em SoA, seguido dos mesmos kernels em lote de
+ * SolveEngagementRowForward, com os pontos de mira no lugar dos alvos. A
+ * matriz toda é dividida em blocos no pool de threads, como em
+ * SolveEngagementsParallel.
+ */
+#ifndef WOE_PREDICT_H
+#define WOE_PREDICT_H
+
+#include <stdbool.h>
+#include "entities.h"
+#include "geometry.h"
+#include "jobs.h"
+#include "spatial.h"
+
+/** Velocidade padrão do interceptador relativa à aeronave (unid/s). */
+#define PREDICT_DEFAULT_SPEED 20.0f
+/** Horizonte da predição (s): interceptações mais distantes contam como sem solução. */
+#define PREDICT_MAX_TIME 60.0f
+
+/**
+ * @brief Predição de todos os pares, no mesmo leiaute de PairResults (a*targets + t).
+ */
+typedef struct PredictResults {
+    int aircraft;       /**< Aeronaves do último passe. */
+    int targets;        /**< Alvos (ou posições de linha, com candidatos) do último passe. */
+    int capacity;       /**< Capacidade em pares. */
+    PairResults lead;   /**< Ângulos do ponto de mira: AzT/ElT, j, G (e E, F, J fora do solver vetorial). */
+    float *px;          /**< Ponto de mira X (unid, mundo). */
+    float *py;          /**< Ponto de mira Y. */
+    float *pz;          /**< Ponto de mira Z. */
+    float *tgo;         /**< Tempo até a interceptação (s), -1 sem solução. */
+    float *tca;         /**< Instante da maior aproximação sem manobra (s, >= 0). */
+    float *miss;        /**< Distância na maior aproximação (unid). */
+    void *mem;          /**< Bloco único de px..miss. */
+} PredictResults;
+
+/** @brief Reserva a predição para até @p capacity pares. */
+bool PredictResultsInit(PredictResults *p, int capacity);
+
+/** @brief Libera os buffers e deixa a estrutura zerada. */
+void PredictResultsFree(PredictResults *p);
+
+/**
+ * @brief Prediz a aeronave @p a contra @p n alvos dados por arrays SoA de posição e velocidade.
+ *
+ * Grava @p n entradas contíguas a partir de @p base, sem alterar as dimensões de @p out.
+ * @param speed Velocidade do interceptador relativa à aeronave (unid/s).
+ */
+void PredictRow(const EntityStore *air, int a, float speed, int n,
+                const float *tx, const float *ty, const float *tz,
+                const float *tvx, const float *tvy, const float *tvz,
+                PredictResults *out, int base, SolverMode mode);
+
+/**
+ * @brief Prediz todos os pares aeronave–alvo, distribuídos em @p pool (pode ser NULL).
+ *
+ * Nada é calculado se @p out não comportar todos os pares; nada é alocado por chamada.
+ */
+void PredictEngagements(JobPool *pool, const EntityStore *air, const EntityStore *tgt, float speed,
+                        PredictResults *out, SolverMode mode);
+
+/**
+ * @brief Prediz só os pares candidatos de @p c (já preenchido por SolveEngagementsCulled).
+ *
+ * Usa as posições e velocidades reunidas em @c c->gather; o candidato k da
+ * aeronave a vai para o índice a*stride + k, como em @c c->pairs.
+ */
+void PredictCandidates(JobPool *pool, const EntityStore *air, const CandidatePairs *c, float speed,
+                       PredictResults *out, SolverMode mode);
+
+#endif /* WOE_PREDICT_H */
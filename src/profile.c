@@ -0,0 +1,137 @@
+/**
+ * @file profile.c
+ * @brief Registro de threads, resumo e exportação Chrome trace do profiler (veja profile.h).
+ */
+#include "profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void ProfilerInit(Profiler *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->origin = WoeNow();
+}
+
+void ProfilerFree(Profiler *p)
+{
+    for (int i = 0; i < PROFILE_MAX_THREADS; ++i) free(p->rings[i].events);
+    memset(p, 0, sizeof(*p));
+}
+
+ProfileRing *ProfilerThread(Profiler *p, const char *name)
+{
+    int i = WoeAtomicAdd(&p->claimed, 1);
+    if (i >= PROFILE_MAX_THREADS) return NULL;
+    ProfileRing *r = &p->rings[i];
+    r->events = (ProfileEvent *)calloc(PROFILE_RING_EVENTS, sizeof(ProfileEvent));
+    if (!r->events) return NULL;
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->id = i;
+    WoeAtomicAdd(&p->ready, 1 << i);
+    return r;
+}
+
+const ProfileRing *ProfilerRing(const Profiler *p, int i)
+{
+    if (i < 0 || i >= PROFILE_MAX_THREADS) return NULL;
+    return (WoeAtomicLoad((volatile int *)&p->ready) >> i) & 1 ? &p->rings[i] : NULL;
+}
+
+int ProfileSummarize(const ProfileRing *r, double window, ProfileStat *out, int max)
+{
+    if (!r || max <= 0) return 0;
+    unsigned head = (unsigned)WoeAtomicLoad((volatile int *)&r->head);
+    // the writer cannot lap half the ring while we read, so the newer half is never torn
+    unsigned avail = head < PROFILE_RING_EVENTS/2 ? head : PROFILE_RING_EVENTS/2;
+    double since = WoeNow() - window;
+    int n = 0;
+    for (unsigned k = 1; k <= avail; ++k)
+    {
+        const ProfileEvent e = r->events[(head - k) & (PROFILE_RING_EVENTS - 1)];
+        if (e.end < since) break;
+        int s = 0;
+        while (s < n && out[s].name != e.name) ++s;
+        if (s == n)
+        {
+            if (n == max) continue;
+            out[n++] = (ProfileStat){ e.name, e.depth, 0, 0.0, 0.0, e.start };
+        }
+        double d = e.end - e.start;
+        out[s].count++;
+        out[s].total += d;
+        if (d > out[s].max) out[s].max = d;
+    }
+    // most recent occurrence order: outer phase first, then its children as they ran
+    for (int i = 1; i < n; ++i)
+    {
+        ProfileStat v = out[i];
+        int k = i;
+        for (; k > 0 && (out[k - 1].last > v.last || (out[k - 1].last == v.last && out[k - 1].depth > v.depth)); --k)
+            out[k] = out[k - 1];
+        out[k] = v;
+    }
+    return n;
+}
+
+/** Escreve @p s como string JSON; nomes de fase e de thread são ASCII simples, só as aspas pedem cuidado. */
+static void WriteJsonString(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        if ((unsigned char)*s >= 0x20) fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+long ProfilerWriteTrace(const Profiler *p, const char *path, const char **error)
+{
+    const char *dummy;
+    if (!error) error = &dummy;
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        *error = "nao foi possivel criar o arquivo";
+        return -1;
+    }
+
+    long written = 0;
+    bool first = true;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    for (int i = 0; i < PROFILE_MAX_THREADS; ++i)
+    {
+        const ProfileRing *r = ProfilerRing(p, i);
+        if (!r) continue;
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",\n", r->id);
+        WriteJsonString(out, r->name);
+        fputs("}}", out);
+        first = false;
+
+        unsigned head = (unsigned)r->head;
+        unsigned n = head < PROFILE_RING_EVENTS ? head : PROFILE_RING_EVENTS;
+        for (unsigned k = head - n; k != head; ++k)
+        {
+            const ProfileEvent *e = &r->events[k & (PROFILE_RING_EVENTS - 1)];
+            fputs(",\n{\"name\":", out);
+            WriteJsonString(out, e->name);
+            fprintf(out, ",\"cat\":\"woe\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    r->id, (e->start - p->origin)*1e6, (e->end - e->start)*1e6);
+            ++written;
+        }
+    }
+    fputs("\n]}\n", out);
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0) ok = false;
+    if (!ok)
+    {
+        *error = "erro de escrita no trace";
+        return -1;
+    }
+    *error = NULL;
+    return written;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file profile.h
+ * @brief Temporizadores de fase por thread em buffers circulares, resumo para o HUD e exportação Chrome trace.
+ *
+ * Cada thread medida registra, uma vez, um ProfileRing próprio com
+ * ProfilerThread. Depois disso ProfileBegin/ProfileEnd (ou PROFILE_SCOPE)
+ * só leem o relógio e escrevem um ProfileEvent no buffer circular da
+ * própria thread: nada de alocação, travas ou atômicos além da publicação
+ * de @c head. Quando o buffer dá a volta os eventos mais antigos são
+ * sobrescritos, de modo que ele guarda sempre os últimos
+ * PROFILE_RING_EVENTS intervalos.
+ *
+ * Outras threads podem resumir um buffer enquanto ele é escrito
+ * (ProfileSummarize lê só a metade mais recente, que o produtor não
+ * alcança entre duas leituras). ProfilerWriteTrace grava todos os buffers
+ * no formato JSON de eventos do Chrome (chrome://tracing, ui.perfetto.dev);
+ * chame-a com as threads medidas paradas.
+ */
+#ifndef WOE_PROFILE_H
+#define WOE_PROFILE_H
+
+#include <stdbool.h>
+#include "threads.h"
+
+/** Máximo de threads medidas. */
+#define PROFILE_MAX_THREADS 16
+/** Eventos por thread (potência de dois): 64k intervalos, 2 MB por thread. */
+#define PROFILE_RING_EVENTS 65536
+/** Profundidade máxima de aninhamento; intervalos mais fundos não são gravados. */
+#define PROFILE_MAX_DEPTH 8
+/** Nome máximo de uma thread (com o terminador). */
+#define PROFILE_NAME_MAX 32
+
+typedef char ProfileRingPow2Check[(PROFILE_RING_EVENTS & (PROFILE_RING_EVENTS - 1)) == 0 ? 1 : -1];
+
+/** Um intervalo medido. */
+typedef struct ProfileEvent {
+    const char *name;   /**< Nome da fase; texto constante (comparado por ponteiro). */
+    double start;       /**< WoeNow() no início. */
+    double end;         /**< WoeNow() no fim. */
+    int depth;          /**< Aninhamento (0 = fase mais externa). */
+} ProfileEvent;
+
+/** Buffer de uma thread; escrito apenas por ela. */
+typedef struct ProfileRing {
+    char name[PROFILE_NAME_MAX];            /**< Nome da thread no overlay e no trace. */
+    int id;                                 /**< Índice no Profiler (tid no trace). */
+    ProfileEvent *events;                   /**< [PROFILE_RING_EVENTS] */
+    volatile int head;                      /**< Eventos já escritos (módulo 2^32); o próximo vai em head % PROFILE_RING_EVENTS. */
+    int depth;                              /**< Intervalos abertos. */
+    const char *open[PROFILE_MAX_DEPTH];    /**< Nome de cada intervalo aberto. */
+    double openStart[PROFILE_MAX_DEPTH];    /**< Início de cada intervalo aberto. */
+} ProfileRing;
+
+/** Conjunto de buffers de um processo. */
+typedef struct Profiler {
+    ProfileRing rings[PROFILE_MAX_THREADS];
+    volatile int claimed;   /**< Slots de @c rings já tomados. */
+    volatile int ready;     /**< Bit i: rings[i] pronto para leitura. */
+    double origin;          /**< WoeNow() em ProfilerInit; ts 0 do trace. */
+} Profiler;
+
+/** Resumo de uma fase numa janela de tempo. */
+typedef struct ProfileStat {
+    const char *name;   /**< Nome da fase. */
+    int depth;          /**< Aninhamento da ocorrência mais recente. */
+    int count;          /**< Ocorrências na janela. */
+    double total;       /**< Soma das durações (s). */
+    double max;         /**< Maior duração (s). */
+    double last;        /**< Início da ocorrência mais recente (ordena o resumo). */
+} ProfileStat;
+
+/** @brief Zera o profiler e fixa a origem do trace. */
+void ProfilerInit(Profiler *p);
+
+/** @brief Libera os buffers de todas as threads (com elas já paradas). */
+void ProfilerFree(Profiler *p);
+
+/**
+ * @brief Registra a thread chamadora e devolve seu buffer.
+ *
+ * Única alocação do profiler; chame uma vez no início da thread, nunca no caminho quente.
+ * @return NULL se não houver slot ou memória; ProfileBegin/ProfileEnd aceitam NULL e não fazem nada.
+ */
+ProfileRing *ProfilerThread(Profiler *p, const char *name);
+
+/** @brief Abre um intervalo @p name (texto constante) na thread dona de @p r. */
+static inline void ProfileBegin(ProfileRing *r, const char *name)
+{
+    if (!r) return;
+    if (r->depth < PROFILE_MAX_DEPTH)
+    {
+        r->open[r->depth] = name;
+        r->openStart[r->depth] = WoeNow();
+    }
+    r->depth++;
+}
+
+/** @brief Fecha o último intervalo aberto e o grava no buffer. */
+static inline void ProfileEnd(ProfileRing *r)
+{
+    if (!r || r->depth <= 0) return;
+    int d = --r->depth;
+    if (d >= PROFILE_MAX_DEPTH) return;
+    unsigned h = (unsigned)r->head;
+    ProfileEvent *e = &r->events[h & (PROFILE_RING_EVENTS - 1)];
+    e->name = r->open[d];
+    e->start = r->openStart[d];
+    e->end = WoeNow();
+    e->depth = d;
+    WoeAtomicStore(&r->head, (int)(h + 1u));
+}
+
+/**
+ * @brief Mede o bloco seguinte como o intervalo @p name.
+ *
+ * @code
+ * PROFILE_SCOPE(ring, "solucao") { SolveEngagements(...); }
+ * @endcode
+ * Não saia do bloco com break, return ou goto: o intervalo ficaria aberto.
+ */
+#define PROFILE_SCOPE(r, name) \
+    for (int profScope_ = (ProfileBegin((r), (name)), 1); profScope_; profScope_ = 0, ProfileEnd(r))
+
+/**
+ * @brief Resume os intervalos de @p r que terminaram nos últimos @p window segundos.
+ *
+ * Uma entrada por nome, ordenadas pelo início da ocorrência mais recente (as
+ * fases de um quadro aparecem na ordem em que rodaram, a externa primeiro).
+ * Pode ser chamada de qualquer thread.
+ * @return Entradas escritas em @p out (até @p max).
+ */
+int ProfileSummarize(const ProfileRing *r, double window, ProfileStat *out, int max);
+
+/** @brief Buffer @p i se já registrado e pronto, senão NULL. */
+const ProfileRing *ProfilerRing(const Profiler *p, int i);
+
+/**
+ * @brief Grava os eventos de todos os buffers em JSON de trace do Chrome.
+ *
+ * Um evento completo ("ph":"X") por intervalo, em microssegundos desde
+ * ProfilerInit, e o nome de cada thread como metadado.
+ * @param error [out] Em falha, motivo em texto fixo (pode ser NULL).
+ * @return Eventos gravados, ou -1 em erro.
+ */
+long ProfilerWriteTrace(const Profiler *p, const char *path, const char **error);
+
+#endif /* WOE_PROFILE_H */
@@ -0,0 +1,257 @@
+/**
+ * @file recorder.c
+ * @brief Blocos colunares duplos e thread de E/S do gravador (veja recorder.h).
+ */
+#include "recorder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the on-disk layout is the in-memory layout of these structs
+typedef char RecordHeaderSizeCheck[sizeof(RecordFileHeader) == 64 ? 1 : -1];
+typedef char RecordColumnSizeCheck[sizeof(RecordColumn) == 32 ? 1 : -1];
+typedef char RecordBlockSizeCheck[sizeof(RecordBlockHeader) == 64 ? 1 : -1];
+
+/** Nome, tipo e tamanho de cada coluna, na ordem de RecordColumnId. */
+static const RecordColumn COLUMNS[RECORD_COLUMNS] = {
+    { "tick", RECORD_INT64, 8 },
+    { "time", RECORD_FLOAT64, 8 },
+    { "aircraft", RECORD_INT32, 4 },
+    { "target", RECORD_INT32, 4 },
+    { "AzT", RECORD_FLOAT32, 4 },
+    { "ElT", RECORD_FLOAT32, 4 },
+    { "AzR", RECORD_FLOAT32, 4 },
+    { "ElR", RECORD_FLOAT32, 4 },
+    { "j", RECORD_FLOAT32, 4 },
+    { "G", RECORD_FLOAT32, 4 },
+    { "E", RECORD_FLOAT32, 4 },
+    { "F", RECORD_FLOAT32, 4 },
+    { "J", RECORD_FLOAT32, 4 }
+};
+
+static const unsigned char ZEROS[RECORD_ALIGNMENT];
+
+static size_t AlignUp(size_t n)
+{
+    return (n + RECORD_ALIGNMENT - 1)/RECORD_ALIGNMENT*RECORD_ALIGNMENT;
+}
+
+static bool BlockInit(RecorderBlock *b, int capacity)
+{
+    memset(b, 0, sizeof(*b));
+    size_t total = 0;
+    for (int c = 0; c < RECORD_COLUMNS; ++c) total += AlignUp((size_t)capacity*COLUMNS[c].size);
+    b->mem = malloc(total + RECORD_ALIGNMENT);
+    if (!b->mem) return false;
+
+    uintptr_t p = ((uintptr_t)b->mem + RECORD_ALIGNMENT - 1) & ~(uintptr_t)(RECORD_ALIGNMENT - 1);
+    for (int c = 0; c < RECORD_COLUMNS; ++c)
+    {
+        b->col[c] = (void *)p;
+        p += AlignUp((size_t)capacity*COLUMNS[c].size);
+    }
+    return true;
+}
+
+/** Preenchimento até o próximo múltiplo de RECORD_ALIGNMENT. */
+static bool WritePad(FILE *out, size_t written)
+{
+    size_t pad = AlignUp(written) - written;
+    return pad == 0 || fwrite(ZEROS, 1, pad, out) == pad;
+}
+
+static bool WriteBlock(FILE *out, const RecorderBlock *b)
+{
+    RecordBlockHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RECORD_BLOCK_MAGIC, 8);
+    h.rows = (uint32_t)b->rows;
+    h.steps = (uint32_t)b->steps;
+    h.bytes = sizeof(h);
+    for (int c = 0; c < RECORD_COLUMNS; ++c) h.bytes += AlignUp((size_t)b->rows*COLUMNS[c].size);
+    h.firstTick = ((const int64_t *)b->col[RECORD_COL_TICK])[0];
+    h.lastTick = ((const int64_t *)b->col[RECORD_COL_TICK])[b->rows - 1];
+
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+    for (int c = 0; c < RECORD_COLUMNS && ok; ++c)
+    {
+        size_t bytes = (size_t)b->rows*COLUMNS[c].size;
+        ok = fwrite(b->col[c], 1, bytes, out) == bytes && WritePad(out, bytes);
+    }
+    return ok;
+}
+
+static int RecorderThreadMain(void *arg)
+{
+    Recorder *r = (Recorder *)arg;
+    for (;;)
+    {
+        WoeSemaphoreWait(&r->ready);
+        int b = r->next;
+        if (WoeAtomicLoad(&r->queued[b]))
+        {
+            // blocks are queued alternately, so the writer just follows them in turn
+            if (!WoeAtomicLoad(&r->failed) && !WriteBlock(r->out, &r->blocks[b])) WoeAtomicStore(&r->failed, 1);
+            else if (!WoeAtomicLoad(&r->failed)) WoeAtomicAdd(&r->written, 1);
+            r->blocks[b].rows = r->blocks[b].steps = 0;
+            r->next = b ^ 1;
+            WoeAtomicStore(&r->queued[b], 0);
+        }
+        else if (WoeAtomicLoad(&r->quit)) break;
+    }
+    return 0;
+}
+
+bool RecorderOpen(Recorder *r, const char *path, int maxPairs, int blockRows, const char **error)
+{
+    const char *dummy;
+    if (!error) error = &dummy;
+    memset(r, 0, sizeof(*r));
+    r->capacity = blockRows > 0 ? blockRows : RECORD_DEFAULT_BLOCK_ROWS;
+    if (r->capacity < maxPairs) r->capacity = maxPairs;
+
+    if (!BlockInit(&r->blocks[0], r->capacity) || !BlockInit(&r->blocks[1], r->capacity))
+    {
+        free(r->blocks[0].mem);
+        free(r->blocks[1].mem);
+        *error = "memoria insuficiente";
+        return false;
+    }
+    r->out = fopen(path, "wb");
+    if (!r->out)
+    {
+        free(r->blocks[0].mem);
+        free(r->blocks[1].mem);
+        *error = "nao foi possivel criar o arquivo";
+        return false;
+    }
+    // large writes go straight to the file; the blocks already are the buffer
+    setvbuf(r->out, NULL, _IONBF, 0);
+
+    RecordFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RECORD_FILE_MAGIC, 8);
+    h.version = RECORD_FILE_VERSION;
+    h.byteOrder = RECORD_FILE_BYTE_ORDER;
+    h.columns = RECORD_COLUMNS;
+    h.blockRows = (uint32_t)r->capacity;
+    h.alignment = RECORD_ALIGNMENT;
+    bool ok = fwrite(&h, sizeof(h), 1, r->out) == 1 &&
+              fwrite(COLUMNS, sizeof(COLUMNS), 1, r->out) == 1 && WritePad(r->out, sizeof(COLUMNS));
+    *error = ok ? NULL : "erro de escrita no cabecalho";
+    if (ok && !WoeSemaphoreInit(&r->ready, 0)) { ok = false; *error = "nao foi possivel criar o semaforo"; }
+    if (ok && !WoeThreadCreate(&r->thread, RecorderThreadMain, r))
+    {
+        WoeSemaphoreFree(&r->ready);
+        ok = false;
+        *error = "nao foi possivel criar a thread de escrita";
+    }
+    if (!ok)
+    {
+        fclose(r->out);
+        free(r->blocks[0].mem);
+        free(r->blocks[1].mem);
+        memset(r, 0, sizeof(*r));
+    }
+    return ok;
+}
+
+/** Entrega o bloco em preenchimento ao escritor; false se o escritor ainda tem o outro. */
+static bool HandOff(Recorder *r)
+{
+    int other = r->fill ^ 1;
+    if (WoeAtomicLoad(&r->queued[other])) return false;
+    WoeAtomicStore(&r->queued[r->fill], 1);
+    WoeSemaphorePost(&r->ready);
+    r->fill = other;
+    return true;
+}
+
+/**
+ * @brief Bloco com espaço para um passo inteiro de @p rows linhas, ou NULL para descartar o passo.
+ *
+ * Nunca espera: um bloco cheio que não pode ser entregue significa que o disco está atrasado.
+ */
+static RecorderBlock *BeginStep(Recorder *r, int rows)
+{
+    RecorderBlock *b = &r->blocks[r->fill];
+    double now = WoeNow();
+    bool stale = b->rows > 0 && now - b->opened > RECORD_FLUSH_SECONDS;
+    if ((b->rows + rows > r->capacity || stale) && !HandOff(r) && b->rows + rows > r->capacity)
+    {
+        r->dropped += rows;
+        return NULL;
+    }
+    b = &r->blocks[r->fill];
+    if (b->rows == 0) b->opened = now;
+    return b;
+}
+
+/** Copia @p n resultados a partir de @p base para o bloco @p b; @p target NULL significa t == k. */
+static void AppendRun(RecorderBlock *b, long tick, double time, int a, const PairResults *p, size_t base, int n,
+                      const int *target)
+{
+    int row = b->rows;
+    int64_t *tk = (int64_t *)b->col[RECORD_COL_TICK] + row;
+    double *tm = (double *)b->col[RECORD_COL_TIME] + row;
+    int32_t *ai = (int32_t *)b->col[RECORD_COL_AIRCRAFT] + row;
+    int32_t *ti = (int32_t *)b->col[RECORD_COL_TARGET] + row;
+    for (int k = 0; k < n; ++k)
+    {
+        tk[k] = (int64_t)tick;
+        tm[k] = time;
+        ai[k] = a;
+        ti[k] = target ? target[k] : k;
+    }
+    const float *src[9] = { p->AzT, p->ElT, p->AzR, p->ElR, p->j, p->G, p->E, p->F, p->J };
+    for (int c = 0; c < 9; ++c)
+        memcpy((float *)b->col[RECORD_COL_AZT + c] + row, src[c] + base, (size_t)n*sizeof(float));
+    b->rows += n;
+}
+
+void RecorderAppendPairs(Recorder *r, long tick, double time, const PairResults *p)
+{
+    int rows = p->aircraft*p->targets;
+    if (rows <= 0) return;
+    RecorderBlock *b = BeginStep(r, rows);
+    if (!b) return;
+    for (int a = 0; a < p->aircraft; ++a) AppendRun(b, tick, time, a, p, (size_t)a*p->targets, p->targets, NULL);
+    b->steps++;
+    r->rows += rows;
+}
+
+void RecorderAppendCandidates(Recorder *r, long tick, double time, const CandidatePairs *c)
+{
+    if (c->total <= 0) return;
+    RecorderBlock *b = BeginStep(r, c->total);
+    if (!b) return;
+    for (int a = 0; a < c->aircraft; ++a)
+    {
+        size_t base = (size_t)a*c->stride;
+        if (c->count[a] > 0) AppendRun(b, tick, time, a, &c->pairs, base, c->count[a], c->target + base);
+    }
+    b->steps++;
+    r->rows += c->total;
+}
+
+bool RecorderClose(Recorder *r)
+{
+    if (!r->out) return false;
+    // the partial block goes out after the one the writer may still hold
+    if (r->blocks[r->fill].rows > 0)
+    {
+        WoeAtomicStore(&r->queued[r->fill], 1);
+        WoeSemaphorePost(&r->ready);
+    }
+    WoeAtomicStore(&r->quit, 1);
+    WoeSemaphorePost(&r->ready);
+    WoeThreadJoin(&r->thread);
+    WoeSemaphoreFree(&r->ready);
+
+    bool ok = !WoeAtomicLoad(&r->failed);
+    if (fclose(r->out) != 0) ok = false;
+    free(r->blocks[0].mem);
+    free(r->blocks[1].mem);
+    memset(r, 0, sizeof(*r));
+    return ok;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file recorder.h
+ * @brief Gravação colunar dos ângulos por par, escrita numa thread de E/S própria.
+ *
+ * Formato (little-endian, versão 1):
+ * @code
+ * RecordFileHeader                     64 bytes
+ * RecordColumn[columns]                32 bytes cada, completado com zeros até múltiplo de 64
+ * bloco*:
+ *   RecordBlockHeader                  64 bytes
+ *   coluna 0 .. columns-1              rows*size bytes cada, completada com zeros até múltiplo de 64
+ * @endcode
+ * Cada bloco guarda um ou mais passos inteiros, uma linha por par resolvido:
+ * tick, time, aircraft, target e os nove ângulos (AzT, ElT, AzR, ElR, j, G, E,
+ * F, J, em rad). Cada coluna é um array contíguo de um tipo primitivo, sem
+ * nulos, começando em offset múltiplo de 64 — o mesmo leiaute de buffer de uma
+ * coluna Arrow sem bitmap de validade, de modo que um leitor pode embrulhar os
+ * buffers de um bloco diretamente (numpy.frombuffer, pyarrow.Array.from_buffers)
+ * e montar um RecordBatch, ou convertê-lo em Parquet, sem cópia nem conversão.
+ *
+ * RecorderAppendPairs/RecorderAppendCandidates só copiam os arrays de
+ * PairResults para o bloco em preenchimento. Quando ele enche (ou fica velho
+ * demais), é entregue à thread de E/S e o outro bloco passa a ser preenchido.
+ * Se a thread ainda estiver escrevendo o outro bloco (disco lento), o passo é
+ * descartado e contado em @c dropped: a gravação nunca espera o disco.
+ */
+#ifndef WOE_RECORDER_H
+#define WOE_RECORDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "entities.h"
+#include "spatial.h"
+#include "threads.h"
+
+/** Assinatura no início do arquivo. */
+#define RECORD_FILE_MAGIC "WOEREC\0\0"
+/** Assinatura no início de cada bloco. */
+#define RECORD_BLOCK_MAGIC "WOEBLK\0\0"
+/** Versão do formato gravada pelo Recorder. */
+#define RECORD_FILE_VERSION 1u
+/** Valor de byteOrder num arquivo gravado em little-endian. */
+#define RECORD_FILE_BYTE_ORDER 0x01020304u
+/** Alinhamento (bytes, desde o início do arquivo) de cada coluna. */
+#define RECORD_ALIGNMENT 64
+/** Linhas padrão por bloco. */
+#define RECORD_DEFAULT_BLOCK_ROWS 65536
+/** Idade máxima (s) de um bloco parcial antes de ser entregue mesmo sem encher. */
+#define RECORD_FLUSH_SECONDS 1.0
+
+/** Tipo primitivo de uma coluna. */
+typedef enum RecordType {
+    RECORD_INT32 = 1,
+    RECORD_INT64 = 2,
+    RECORD_FLOAT32 = 3,
+    RECORD_FLOAT64 = 4
+} RecordType;
+
+/** Colunas gravadas, na ordem do arquivo. */
+typedef enum RecordColumnId {
+    RECORD_COL_TICK = 0,    /**< int64: número do passo. */
+    RECORD_COL_TIME,        /**< float64: tempo simulado (s). */
+    RECORD_COL_AIRCRAFT,    /**< int32: índice da aeronave. */
+    RECORD_COL_TARGET,      /**< int32: índice do alvo. */
+    RECORD_COL_AZT,         /**< float32: os nove ângulos, na ordem de PairResults. */
+    RECORD_COL_ELT,
+    RECORD_COL_AZR,
+    RECORD_COL_ELR,
+    RECORD_COL_J_SMALL,
+    RECORD_COL_G,
+    RECORD_COL_E,
+    RECORD_COL_F,
+    RECORD_COL_J,
+    RECORD_COLUMNS
+} RecordColumnId;
+
+/** Cabeçalho do arquivo. */
+typedef struct RecordFileHeader {
+    char magic[8];          /**< RECORD_FILE_MAGIC. */
+    uint32_t version;       /**< RECORD_FILE_VERSION. */
+    uint32_t byteOrder;     /**< RECORD_FILE_BYTE_ORDER como gravado. */
+    uint32_t columns;       /**< Entradas na tabela de colunas. */
+    uint32_t blockRows;     /**< Capacidade de um bloco (linhas); informativo. */
+    uint32_t alignment;     /**< RECORD_ALIGNMENT. */
+    uint32_t reserved[9];
+} RecordFileHeader;
+
+/** Entrada da tabela de colunas. */
+typedef struct RecordColumn {
+    char name[24];          /**< Nome, terminado em zero. */
+    uint32_t type;          /**< RecordType. */
+    uint32_t size;          /**< Bytes por valor. */
+} RecordColumn;
+
+/** Cabeçalho de um bloco; as colunas vêm logo depois, na ordem da tabela. */
+typedef struct RecordBlockHeader {
+    char magic[8];          /**< RECORD_BLOCK_MAGIC. */
+    uint32_t rows;          /**< Linhas do bloco. */
+    uint32_t steps;         /**< Passos inteiros contidos no bloco. */
+    uint64_t bytes;         /**< Tamanho do bloco inteiro, cabeçalho incluso. */
+    int64_t firstTick;      /**< Tick da primeira linha. */
+    int64_t lastTick;       /**< Tick da última linha. */
+    uint64_t reserved[3];
+} RecordBlockHeader;
+
+/** Bloco em memória: um array alinhado por coluna. */
+typedef struct RecorderBlock {
+    void *col[RECORD_COLUMNS];  /**< [capacity] valores de cada coluna. */
+    int rows;                   /**< Linhas preenchidas. */
+    int steps;                  /**< Passos preenchidos. */
+    double opened;              /**< WoeNow() da primeira linha. */
+    void *mem;                  /**< Bloco único que contém todas as colunas. */
+} RecorderBlock;
+
+/**
+ * @brief Gravador com dois blocos: um preenchido pelo produtor, outro escrito pela thread de E/S.
+ *
+ * As funções Append devem ser chamadas sempre da mesma thread (a da simulação).
+ */
+typedef struct Recorder {
+    FILE *out;
+    int capacity;               /**< Linhas por bloco. */
+    RecorderBlock blocks[2];
+    int fill;                   /**< Bloco do produtor. */
+    int next;                   /**< Próximo bloco da thread de E/S. */
+    volatile int queued[2];     /**< 1 enquanto o bloco pertence à thread de E/S. */
+    volatile int quit;          /**< 1 quando não haverá mais blocos. */
+    volatile int failed;        /**< 1 após um erro de escrita (os blocos seguintes são descartados). */
+    volatile int written;       /**< Blocos escritos. */
+    long long rows;             /**< Linhas aceitas (produtor). */
+    long long dropped;          /**< Linhas descartadas por falta de bloco livre (produtor). */
+    WoeSemaphore ready;
+    WoeThread thread;
+} Recorder;
+
+/**
+ * @brief Cria @p path, grava o cabeçalho e inicia a thread de E/S.
+ * @param maxPairs Maior número de pares de um passo; um passo nunca é dividido entre blocos.
+ * @param blockRows Linhas por bloco (<= 0 para RECORD_DEFAULT_BLOCK_ROWS); cresce até @p maxPairs.
+ * @param error [out] Em falha, motivo em texto fixo (pode ser NULL).
+ */
+bool RecorderOpen(Recorder *r, const char *path, int maxPairs, int blockRows, const char **error);
+
+/**
+ * @brief Entrega o bloco parcial, espera a thread de E/S terminar e fecha o arquivo.
+ *
+ * Chamar depois que o produtor parou.
+ * @return false se alguma escrita falhou.
+ */
+bool RecorderClose(Recorder *r);
+
+/** @brief Grava todos os pares de @p p (aircraft x targets) como o passo @p tick. */
+void RecorderAppendPairs(Recorder *r, long tick, double time, const PairResults *p);
+
+/** @brief Grava só os pares candidatos de @p c, com o índice real de cada alvo. */
+void RecorderAppendCandidates(Recorder *r, long tick, double time, const CandidatePairs *c);
+
+#endif /* WOE_RECORDER_H */
@@ -0,0 +1,590 @@
+/**
+ * @file render.c
+ * @brief Desenho de aeronaves, arcos e rótulos com a raylib.
+ */
+#include "render.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Nível de precisão da trigonometria de HUD e anotações (DrawArc3D, marcador). */
+static TrigTier hudTier = TRIG_TIER_VISUAL;
+
+void SetHudTrigTier(TrigTier tier)
+{
+    if (tier >= 0 && tier < TRIG_TIER_COUNT) hudTier = tier;
+}
+
+TrigTier GetHudTrigTier(void)
+{
+    return hudTier;
+}
+
+void DrawAircraft(Vector3 A, float yaw, float pitch, float roll, Color col)
+{
+    DrawAircraftBasis(A, BasisFromYPR(yaw, pitch, roll), col);
+}
+
+void DrawAircraftBasis(Vector3 A, WoeBasis b, Color col)
+{
+    Vector3 fwd = FromWoe(b.fwd), right = FromWoe(b.right), up = FromWoe(b.up);
+
+    float bodyLen = 3.0f;
+    float bodyRad = 0.2f;
+
+    Vector3 nose = { A.x + fwd.x*bodyLen, A.y + fwd.y*bodyLen, A.z + fwd.z*bodyLen };
+    // Draw body
+    DrawCylinderEx(A, nose, bodyRad, 0.01f, 16, col);
+    // Wings
+    Vector3 wL = { A.x + right.x*1.2f, A.y + right.y*1.2f, A.z + right.z*1.2f };
+    Vector3 wR = { A.x - right.x*1.2f, A.y - right.y*1.2f, A.z - right.z*1.2f };
+    DrawCylinderEx(wL, wR, 0.05f, 0.05f, 8, Fade(col, 0.8f));
+    // Tail fin
+    Vector3 tailTop = { A.x + up.x*0.8f, A.y + up.y*0.8f, A.z + up.z*0.8f };
+    DrawCylinderEx(A, tailTop, 0.03f, 0.03f, 8, Fade(col, 0.8f));
+}
+
+void DrawTextAt3D(Camera3D cam, Vector3 p, const char *text, int fontSize, Color col, int screenW, int screenH)
+{
+    Vector2 s = GetWorldToScreenEx(p, cam, screenW, screenH);
+    DrawText(text, (int)s.x + 6, (int)s.y - fontSize - 2, fontSize, col);
+}
+
+Frustum FrustumFromCamera(Camera3D cam, float aspect)
+{
+    Matrix view = MatrixLookAt(cam.position, cam.target, cam.up);
+    Matrix proj;
+    if (cam.projection == CAMERA_ORTHOGRAPHIC)
+    {
+        double top = cam.fovy/2.0, right = top*aspect;
+        proj = MatrixOrtho(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+    else
+    {
+        proj = MatrixPerspective(cam.fovy*DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+    Matrix m = MatrixMultiply(view, proj);
+    Frustum f;
+    f.viewProj = m;
+
+    // Gribb/Hartmann: clip = M p, and row 3 +/- rows 0..2 give the six planes
+    Vector4 r0 = { m.m0, m.m4, m.m8,  m.m12 };
+    Vector4 r1 = { m.m1, m.m5, m.m9,  m.m13 };
+    Vector4 r2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 r3 = { m.m3, m.m7, m.m11, m.m15 };
+    f.planes[0] = (Vector4){ r3.x + r0.x, r3.y + r0.y, r3.z + r0.z, r3.w + r0.w };
+    f.planes[1] = (Vector4){ r3.x - r0.x, r3.y - r0.y, r3.z - r0.z, r3.w - r0.w };
+    f.planes[2] = (Vector4){ r3.x + r1.x, r3.y + r1.y, r3.z + r1.z, r3.w + r1.w };
+    f.planes[3] = (Vector4){ r3.x - r1.x, r3.y - r1.y, r3.z - r1.z, r3.w - r1.w };
+    f.planes[4] = (Vector4){ r3.x + r2.x, r3.y + r2.y, r3.z + r2.z, r3.w + r2.w };
+    f.planes[5] = (Vector4){ r3.x - r2.x, r3.y - r2.y, r3.z - r2.z, r3.w - r2.w };
+    for (int i = 0; i < 6; ++i)
+    {
+        Vector4 *p = &f.planes[i];
+        float n = sqrtf(p->x*p->x + p->y*p->y + p->z*p->z);
+        if (n > 0.0f) { p->x /= n; p->y /= n; p->z /= n; p->w /= n; }
+    }
+    return f;
+}
+
+Vector2 FrustumProject(const Frustum *f, Vector3 p, int screenW, int screenH)
+{
+    const Matrix *m = &f->viewProj;
+    float cx = m->m0*p.x + m->m4*p.y + m->m8*p.z + m->m12;
+    float cy = m->m1*p.x + m->m5*p.y + m->m9*p.z + m->m13;
+    float cw = m->m3*p.x + m->m7*p.y + m->m11*p.z + m->m15;
+    // NDC to pixels with y down, as GetWorldToScreenEx
+    return (Vector2){ (cx/cw + 1.0f)*0.5f*(float)screenW, (1.0f - cy/cw)*0.5f*(float)screenH };
+}
+
+bool FrustumSphereVisible(const Frustum *f, Vector3 c, float radius)
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        const Vector4 *p = &f->planes[i];
+        if (p->x*c.x + p->y*c.y + p->z*c.z + p->w < -radius) return false;
+    }
+    return true;
+}
+
+int CullEntities(const Frustum *f, const EntityStore *s, int first, float radius, unsigned char *visible, CullStats *stats)
+{
+    int n = 0;
+    for (int i = first; i < s->count; ++i)
+    {
+        bool in = FrustumSphereVisible(f, (Vector3){ s->x[i], s->y[i], s->z[i] }, radius);
+        visible[i] = in ? 1 : 0;
+        n += in;
+    }
+    if (stats)
+    {
+        stats->tested += s->count > first ? s->count - first : 0;
+        stats->visible += n;
+    }
+    return n;
+}
+
+bool CullLabel(const Frustum *f, Vector3 p, CullStats *stats)
+{
+    bool in = FrustumSphereVisible(f, p, 0.0f);
+    if (stats) { stats->tested++; stats->visible += in; }
+    return in;
+}
+
+/** Segmentos da tabela unitária de arco em [0, 2pi]; passo de 2.8 graus. */
+#define ARC_TABLE_SEGMENTS 128
+
+static float arcCos[ARC_TABLE_SEGMENTS + 1];
+static float arcSin[ARC_TABLE_SEGMENTS + 1];
+static bool arcTableReady = false;
+
+static void ArcTableInit(void)
+{
+    for (int k = 0; k <= ARC_TABLE_SEGMENTS; ++k)
+    {
+        double t = 2.0*M_PI*k/ARC_TABLE_SEGMENTS;
+        arcCos[k] = (float)cos(t);
+        arcSin[k] = (float)sin(t);
+    }
+    arcTableReady = true;
+}
+
+/**
+ * Pontos de um arco de @p angleJ rad a partir de u, no plano (u, v), com raio @p radius.
+ * Os pontos intermediários vêm da tabela unitária; só a extremidade final usa
+ * seno/cosseno. Devolve o número de pontos gravados em @p pts (0 se degenerado).
+ */
+static int ArcPolyline(Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius,
+                       Vector3 pts[ARC_TABLE_SEGMENTS + 2])
+{
+    if (angleJ <= 1e-5f) return 0;
+    if (!arcTableReady) ArcTableInit();
+    // plane normal
+    Vector3 n = Vector3CrossProduct(u, v);
+    float nn = Vector3Length(n);
+    if (nn < 1e-6f) return 0; // nearly colinear
+    n = Vector3Scale(n, 1.0f/nn);
+    // w = normalized (n x u) lies on the plane and orthogonal to u
+    Vector3 w = Vector3CrossProduct(n, u);
+    float wn = Vector3Length(w);
+    if (wn < 1e-6f) return 0;
+    w = Vector3Scale(w, 1.0f/wn);
+
+    const float step = 2.0f*(float)M_PI/ARC_TABLE_SEGMENTS;
+    if (angleJ > 2.0f*(float)M_PI) angleJ = 2.0f*(float)M_PI;
+    int full = (int)(angleJ/step);
+    if (full > ARC_TABLE_SEGMENTS) full = ARC_TABLE_SEGMENTS;
+
+    Vector3 ur = Vector3Scale(u, radius), wr = Vector3Scale(w, radius);
+    int k = 0;
+    for (; k <= full; ++k)
+        pts[k] = Vector3Add(originC, Vector3Add(Vector3Scale(ur, arcCos[k]), Vector3Scale(wr, arcSin[k])));
+    if (angleJ - full*step > 1e-5f)
+    {
+        float st, ct; TrigSinCos(hudTier, angleJ, &st, &ct);
+        pts[k++] = Vector3Add(originC, Vector3Add(Vector3Scale(ur, ct), Vector3Scale(wr, st)));
+    }
+    return k;
+}
+
+void DrawArc3D(Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius, Color col)
+{
+    Vector3 pts[ARC_TABLE_SEGMENTS + 2];
+    int np = ArcPolyline(originC, u, v, angleJ, radius, pts);
+    for (int i = 1; i < np; ++i) DrawLine3D(pts[i - 1], pts[i], col);
+}
+
+bool LineBatchInit(LineBatch *b, int capacity)
+{
+    memset(b, 0, sizeof(*b));
+    if (capacity < 1) capacity = 1;
+    b->pos = (Vector3 *)malloc(sizeof(Vector3)*2*(size_t)capacity);
+    b->col = (Color *)malloc(sizeof(Color)*(size_t)capacity);
+    if (!b->pos || !b->col) { LineBatchFree(b); return false; }
+    b->capacity = capacity;
+    return true;
+}
+
+void LineBatchFree(LineBatch *b)
+{
+    if (!b->arena)
+    {
+        free(b->pos);
+        free(b->col);
+    }
+    memset(b, 0, sizeof(*b));
+}
+
+void LineBatchClear(LineBatch *b)
+{
+    b->count = 0;
+}
+
+void LineBatchBegin(LineBatch *b, FrameArena *arena, int capacity)
+{
+    if (!b->arena)
+    {
+        free(b->pos);
+        free(b->col);
+    }
+    // one block per frame: endpoints, then the colors
+    size_t line = 2*sizeof(Vector3) + sizeof(Color), got;
+    unsigned char *p = (unsigned char *)FrameArenaAllocUpTo(arena, line*(size_t)(capacity > 1 ? capacity : 1), line, &got);
+    b->arena = arena;
+    b->capacity = (int)(got/line);
+    b->pos = (Vector3 *)p;
+    b->col = p ? (Color *)(p + 2*sizeof(Vector3)*(size_t)b->capacity) : NULL;
+    b->count = 0;
+    b->flushes = 0;
+}
+
+/** Garante espaço para mais @p extra linhas; dobra a capacidade quando preciso, ou desenha o que há se o espaço for da arena. */
+static bool LineBatchReserve(LineBatch *b, int extra)
+{
+    if (b->count + extra <= b->capacity) return true;
+    if (b->arena)
+    {
+        if (extra > b->capacity) return false;
+        LineBatchDraw(b);
+        b->count = 0;
+        b->flushes++;
+        return true;
+    }
+    int cap = b->capacity > 0 ? b->capacity : 1;
+    while (cap < b->count + extra) cap *= 2;
+    Vector3 *pos = (Vector3 *)realloc(b->pos, sizeof(Vector3)*2*(size_t)cap);
+    if (!pos) return false;
+    b->pos = pos;
+    Color *col = (Color *)realloc(b->col, sizeof(Color)*(size_t)cap);
+    if (!col) return false;
+    b->col = col;
+    b->capacity = cap;
+    return true;
+}
+
+void LineBatchAdd(LineBatch *b, Vector3 p0, Vector3 p1, Color col)
+{
+    if (!LineBatchReserve(b, 1)) return;
+    b->pos[2*b->count] = p0;
+    b->pos[2*b->count + 1] = p1;
+    b->col[b->count++] = col;
+}
+
+void LineBatchAddArc(LineBatch *b, Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius, Color col)
+{
+    Vector3 pts[ARC_TABLE_SEGMENTS + 2];
+    int np = ArcPolyline(originC, u, v, angleJ, radius, pts);
+    if (np < 2 || !LineBatchReserve(b, np - 1)) return;
+    for (int i = 1; i < np; ++i)
+    {
+        b->pos[2*b->count] = pts[i - 1];
+        b->pos[2*b->count + 1] = pts[i];
+        b->col[b->count++] = col;
+    }
+}
+
+/** Linhas enviadas por bloco rlBegin/rlEnd; cabe folgado no batch padrão da rlgl. */
+#define LINE_BATCH_CHUNK 4096
+
+void LineBatchDraw(const LineBatch *b)
+{
+    for (int first = 0; first < b->count; first += LINE_BATCH_CHUNK)
+    {
+        int last = first + LINE_BATCH_CHUNK < b->count ? first + LINE_BATCH_CHUNK : b->count;
+        rlCheckRenderBatchLimit(2*(last - first));
+        rlBegin(RL_LINES);
+        Color cur = b->col[first];
+        rlColor4ub(cur.r, cur.g, cur.b, cur.a);
+        for (int i = first; i < last; ++i)
+        {
+            Color c = b->col[i];
+            if (c.r != cur.r || c.g != cur.g || c.b != cur.b || c.a != cur.a)
+            {
+                cur = c;
+                rlColor4ub(c.r, c.g, c.b, c.a);
+            }
+            const Vector3 *p = &b->pos[2*i];
+            rlVertex3f(p[0].x, p[0].y, p[0].z);
+            rlVertex3f(p[1].x, p[1].y, p[1].z);
+        }
+        rlEnd();
+    }
+}
+
+
+// Instancing shader: per-instance model matrix in the instanceTransform attribute,
+// flat diffuse color with a fixed key light so the meshes read as solids.
+static const char *INSTANCED_VS =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec3 vertexNormal;\n"
+    "in mat4 instanceTransform;\n"
+    "uniform mat4 mvp;\n"
+    "out vec3 fragNormal;\n"
+    "void main()\n"
+    "{\n"
+    "    fragNormal = mat3(instanceTransform)*vertexNormal;\n"
+    "    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+static const char *INSTANCED_FS =
+    "#version 330\n"
+    "in vec3 fragNormal;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float l = 0.6 + 0.4*abs(dot(normalize(fragNormal), normalize(vec3(0.4, -0.5, 0.8))));\n"
+    "    finalColor = vec4(colDiffuse.rgb*l, colDiffuse.a);\n"
+    "}\n";
+
+/**
+ * Acrescenta um tronco de cone de p0 (raio r0) a p1 (raio r1), com tampas, a
+ * um buffer de triângulos não indexados. Mesma forma de DrawCylinderEx.
+ */
+static void AppendFrustum(Mesh *m, Vector3 p0, Vector3 p1, float r0, float r1, int slices)
+{
+    Vector3 d = Vector3Normalize(Vector3Subtract(p1, p0));
+    Vector3 a = fabsf(d.x) < 0.9f ? (Vector3){1,0,0} : (Vector3){0,1,0};
+    Vector3 e1 = Vector3Normalize(Vector3CrossProduct(a, d));
+    Vector3 e2 = Vector3CrossProduct(d, e1);
+
+    float *v = m->vertices + 3*m->vertexCount;
+    float *n = m->normals + 3*m->vertexCount;
+    int k = 0;
+#define PUSH(P, N) do { v[3*k] = (P).x; v[3*k+1] = (P).y; v[3*k+2] = (P).z; \
+                        n[3*k] = (N).x; n[3*k+1] = (N).y; n[3*k+2] = (N).z; ++k; } while (0)
+    for (int i = 0; i < slices; ++i)
+    {
+        float t0 = 2.0f*(float)M_PI*i/slices, t1 = 2.0f*(float)M_PI*(i + 1)/slices;
+        Vector3 c0 = Vector3Add(Vector3Scale(e1, cosf(t0)), Vector3Scale(e2, sinf(t0)));
+        Vector3 c1 = Vector3Add(Vector3Scale(e1, cosf(t1)), Vector3Scale(e2, sinf(t1)));
+        Vector3 b0 = Vector3Add(p0, Vector3Scale(c0, r0)), b1 = Vector3Add(p0, Vector3Scale(c1, r0));
+        Vector3 q0 = Vector3Add(p1, Vector3Scale(c0, r1)), q1 = Vector3Add(p1, Vector3Scale(c1, r1));
+        PUSH(b0, c0); PUSH(b1, c1); PUSH(q1, c1);
+        PUSH(b0, c0); PUSH(q1, c1); PUSH(q0, c0);
+        Vector3 nd = Vector3Negate(d);
+        PUSH(p0, nd); PUSH(b1, nd); PUSH(b0, nd);
+        PUSH(p1, d);  PUSH(q0, d);  PUSH(q1, d);
+    }
+#undef PUSH
+    m->vertexCount += k;
+    m->triangleCount += k/3;
+}
+
+bool InstancedRendererInit(InstancedRenderer *r, int capacity)
+{
+    memset(r, 0, sizeof(*r));
+    Shader sh = LoadShaderFromMemory(INSTANCED_VS, INSTANCED_FS);
+    if (sh.id == 0 || sh.id == rlGetShaderIdDefault()) return false;
+    sh.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(sh, "mvp");
+    sh.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(sh, "instanceTransform");
+    r->material = LoadMaterialDefault();
+    r->material.shader = sh;
+
+    // Aircraft mesh in body frame (x = right, y = forward, z = up), same shapes as DrawAircraft
+    const int slices[3] = { 16, 8, 8 };
+    int verts = 0;
+    for (int i = 0; i < 3; ++i) verts += slices[i]*12;
+    r->aircraft.vertices = (float *)MemAlloc(sizeof(float)*3*verts);
+    r->aircraft.normals = (float *)MemAlloc(sizeof(float)*3*verts);
+    AppendFrustum(&r->aircraft, (Vector3){0,0,0}, (Vector3){0,3.0f,0}, 0.2f, 0.01f, slices[0]);
+    AppendFrustum(&r->aircraft, (Vector3){1.2f,0,0}, (Vector3){-1.2f,0,0}, 0.05f, 0.05f, slices[1]);
+    AppendFrustum(&r->aircraft, (Vector3){0,0,0}, (Vector3){0,0,0.8f}, 0.03f, 0.03f, slices[2]);
+    UploadMesh(&r->aircraft, false);
+
+    // Mid-range arrow: same body and wing span, a few sides, no fin
+    const int simple[2] = { 4, 3 };
+    verts = (simple[0] + simple[1])*12;
+    r->aircraftSimple.vertices = (float *)MemAlloc(sizeof(float)*3*verts);
+    r->aircraftSimple.normals = (float *)MemAlloc(sizeof(float)*3*verts);
+    AppendFrustum(&r->aircraftSimple, (Vector3){0,0,0}, (Vector3){0,3.0f,0}, 0.2f, 0.01f, simple[0]);
+    AppendFrustum(&r->aircraftSimple, (Vector3){1.2f,0,0}, (Vector3){-1.2f,0,0}, 0.05f, 0.05f, simple[1]);
+    UploadMesh(&r->aircraftSimple, false);
+
+    r->target = GenMeshSphere(1.0f, 8, 12);
+    r->targetSimple = GenMeshSphere(1.0f, 4, 6);
+
+    // Far-range sprite: a unit diamond facing +z, counter-clockwise from the camera side
+    static const float diamond[6][2] = { {0,1}, {-1,0}, {0,-1}, {0,1}, {0,-1}, {1,0} };
+    r->sprite.vertices = (float *)MemAlloc(sizeof(float)*3*6);
+    r->sprite.normals = (float *)MemAlloc(sizeof(float)*3*6);
+    for (int i = 0; i < 6; ++i)
+    {
+        float *v = r->sprite.vertices + 3*i, *n = r->sprite.normals + 3*i;
+        v[0] = diamond[i][0]; v[1] = diamond[i][1]; v[2] = 0.0f;
+        n[0] = 0.0f; n[1] = 0.0f; n[2] = 1.0f;
+    }
+    r->sprite.vertexCount = 6;
+    r->sprite.triangleCount = 2;
+    UploadMesh(&r->sprite, false);
+
+    r->capacity = capacity > 0 ? capacity : 1;
+    r->transforms = (Matrix *)MemAlloc(sizeof(Matrix)*r->capacity);
+    r->lod = (unsigned char *)MemAlloc((unsigned int)r->capacity);
+    r->airModels = (Matrix *)MemAlloc(sizeof(Matrix)*r->capacity);
+    r->tgtModels = (Matrix *)MemAlloc(sizeof(Matrix)*r->capacity);
+    r->ready = r->transforms != NULL && r->lod != NULL && r->airModels != NULL && r->tgtModels != NULL;
+    if (!r->ready) InstancedRendererFree(r);
+    return r->ready;
+}
+
+void InstancedRendererFree(InstancedRenderer *r)
+{
+    if (r->aircraft.vertexCount) UnloadMesh(r->aircraft);
+    if (r->aircraftSimple.vertexCount) UnloadMesh(r->aircraftSimple);
+    if (r->target.vertexCount) UnloadMesh(r->target);
+    if (r->targetSimple.vertexCount) UnloadMesh(r->targetSimple);
+    if (r->sprite.vertexCount) UnloadMesh(r->sprite);
+    if (r->material.maps) UnloadMaterial(r->material);
+    MemFree(r->transforms);
+    MemFree(r->lod);
+    MemFree(r->airModels);
+    MemFree(r->tgtModels);
+    memset(r, 0, sizeof(*r));
+}
+
+void InstancedRendererSetCamera(InstancedRenderer *r, const Camera3D *cam, int screenH)
+{
+    r->lodEnabled = cam != NULL;
+    if (!cam) return;
+    Vector3 view = Vector3Normalize(Vector3Subtract(cam->target, cam->position));
+    r->eye = cam->position;
+    r->camRight = Vector3Normalize(Vector3CrossProduct(view, cam->up));
+    r->camUp = Vector3CrossProduct(r->camRight, view);
+    r->camBack = Vector3Negate(view);
+    r->ortho = cam->projection == CAMERA_ORTHOGRAPHIC;
+    // radius in pixels = radius*pixelScale/distance (perspective) or radius*pixelScale (orthographic)
+    r->pixelScale = r->ortho ? (float)screenH/cam->fovy
+                             : (float)screenH/(2.0f*tanf(0.5f*cam->fovy*DEG2RAD));
+}
+
+/**
+ * Distribui as entidades visíveis de [first, count) nos níveis de LOD para o
+ * raio envolvente @p bound: preenche r->lod na ordem de visita e @p counts e
+ * devolve o número de instâncias.
+ */
+static int ClassifyLod(InstancedRenderer *r, const EntityStore *s, int first, const unsigned char *visible,
+                       float bound, int counts[RENDER_LOD_COUNT])
+{
+    for (int l = 0; l < RENDER_LOD_COUNT; ++l) counts[l] = 0;
+    // squared-distance bands, so the test needs no sqrt
+    float dFull = bound*r->pixelScale/RENDER_LOD_FULL_PIXELS, dPoint = bound*r->pixelScale/RENDER_LOD_POINT_PIXELS;
+    float dFull2 = dFull*dFull, dPoint2 = dPoint*dPoint;
+    int n = 0;
+    for (int i = first; i < s->count && n < r->capacity; ++i)
+    {
+        if (visible && !visible[i]) continue;
+        RenderLod l = RENDER_LOD_FULL;
+        if (r->lodEnabled)
+        {
+            float dx = s->x[i] - r->eye.x, dy = s->y[i] - r->eye.y, dz = s->z[i] - r->eye.z;
+            float d2 = r->ortho ? 1.0f : dx*dx + dy*dy + dz*dz;
+            l = d2 <= dFull2 ? RENDER_LOD_FULL : d2 <= dPoint2 ? RENDER_LOD_SIMPLE : RENDER_LOD_POINT;
+        }
+        r->lod[n++] = (unsigned char)l;
+        counts[l]++;
+    }
+    return n;
+}
+
+/** Losango voltado para a câmera na entidade @p i, com tamanho constante na tela. */
+static Matrix SpriteTransform(const InstancedRenderer *r, const EntityStore *s, int i)
+{
+    float dx = s->x[i] - r->eye.x, dy = s->y[i] - r->eye.y, dz = s->z[i] - r->eye.z;
+    float d = r->ortho ? 1.0f : sqrtf(dx*dx + dy*dy + dz*dz);
+    float h = RENDER_LOD_SPRITE_PIXELS*d/r->pixelScale;
+    Vector3 a = Vector3Scale(r->camRight, h), b = Vector3Scale(r->camUp, h), c = Vector3Scale(r->camBack, h);
+    return (Matrix){ a.x, b.x, c.x, s->x[i],
+                     a.y, b.y, c.y, s->y[i],
+                     a.z, b.z, c.z, s->z[i],
+                     0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+/** Uma chamada instanciada por nível não vazio; as transformações vêm nível após nível, segundo @p counts. */
+static void DrawLodLevels(InstancedRenderer *r, const Mesh *meshes[RENDER_LOD_COUNT], const int counts[RENDER_LOD_COUNT],
+                          Color col)
+{
+    r->material.maps[MATERIAL_MAP_DIFFUSE].color = col;
+    int offset = 0;
+    for (int l = 0; l < RENDER_LOD_COUNT; ++l)
+    {
+        if (counts[l] > 0) DrawMeshInstanced(*meshes[l], r->material, r->transforms + offset, counts[l]);
+        offset += counts[l];
+    }
+}
+
+/** Matriz de modelo da aeronave @p i: a base do corpo de EntityBasis e depois a posição. */
+static Matrix AircraftTransform(const EntityStore *s, int i)
+{
+    // same basis the solver used this step when the store carries one
+    WoeBasis e = EntityBasis(s, i);
+    WoeVec3 fwd = e.fwd, right = e.right, up = e.up;
+    return (Matrix){ right.x, fwd.x, up.x, s->x[i],
+                     right.y, fwd.y, up.y, s->y[i],
+                     right.z, fwd.z, up.z, s->z[i],
+                     0.0f,    0.0f,  0.0f, 1.0f };
+}
+
+/** Matriz de modelo do alvo @p i: uma esfera de raio @p radius na sua posição. */
+static Matrix TargetTransform(const EntityStore *s, int i, float radius)
+{
+    return (Matrix){ radius, 0.0f,   0.0f,   s->x[i],
+                     0.0f,   radius, 0.0f,   s->y[i],
+                     0.0f,   0.0f,   radius, s->z[i],
+                     0.0f,   0.0f,   0.0f,   1.0f };
+}
+
+void InstancedRendererShare(InstancedRenderer *r, const EntityStore *air, const EntityStore *tgt, float targetRadius)
+{
+    r->sharedAir = air;
+    r->sharedTgt = tgt;
+    r->sharedAirCount = air ? (air->count < r->capacity ? air->count : r->capacity) : 0;
+    r->sharedTgtCount = tgt ? (tgt->count < r->capacity ? tgt->count : r->capacity) : 0;
+    r->sharedRadius = targetRadius;
+    for (int i = 0; i < r->sharedAirCount; ++i) r->airModels[i] = AircraftTransform(air, i);
+    for (int i = 0; i < r->sharedTgtCount; ++i) r->tgtModels[i] = TargetTransform(tgt, i, targetRadius);
+}
+
+void DrawAircraftInstanced(InstancedRenderer *r, const EntityStore *s, int first, const unsigned char *visible, Color col)
+{
+    int *counts = r->aircraftLod;
+    int n = ClassifyLod(r, s, first, visible, AIRCRAFT_BOUND_RADIUS, counts);
+    if (n == 0) return;
+    bool shared = s == r->sharedAir;
+    int next[RENDER_LOD_COUNT] = { 0, counts[0], counts[0] + counts[1] };
+    for (int i = first, k = 0; k < n; ++i)
+    {
+        if (visible && !visible[i]) continue;
+        int l = r->lod[k++];
+        if (l == RENDER_LOD_POINT)
+        {
+            r->transforms[next[l]++] = SpriteTransform(r, s, i);
+            continue;
+        }
+        r->transforms[next[l]++] = shared && i < r->sharedAirCount ? r->airModels[i] : AircraftTransform(s, i);
+    }
+    const Mesh *meshes[RENDER_LOD_COUNT] = { &r->aircraft, &r->aircraftSimple, &r->sprite };
+    DrawLodLevels(r, meshes, counts, col);
+}
+
+void DrawTargetsInstanced(InstancedRenderer *r, const EntityStore *s, int first, const unsigned char *visible,
+                          float radius, Color col)
+{
+    int *counts = r->targetLod;
+    int n = ClassifyLod(r, s, first, visible, radius, counts);
+    if (n == 0) return;
+    bool shared = s == r->sharedTgt && radius == r->sharedRadius;
+    int next[RENDER_LOD_COUNT] = { 0, counts[0], counts[0] + counts[1] };
+    for (int i = first, k = 0; k < n; ++i)
+    {
+        if (visible && !visible[i]) continue;
+        int l = r->lod[k++];
+        r->transforms[next[l]++] = l == RENDER_LOD_POINT ? SpriteTransform(r, s, i) :
+                                   shared && i < r->sharedTgtCount ? r->tgtModels[i] : TargetTransform(s, i, radius);
+    }
+    const Mesh *meshes[RENDER_LOD_COUNT] = { &r->target, &r->targetSimple, &r->sprite };
+    DrawLodLevels(r, meshes, counts, col);
+}
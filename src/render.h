@@ -0,0 +1,258 @@
+/**
+ * @file render.h
+ * @brief Desenho de aeronaves, arcos e rótulos com a raylib.
+ *
+ * Compartilhado pelo visualizador (woe3d) e pelo benchmark de renderização
+ * (woe_bench). A geometria vem de woe_core.
+ */
+#ifndef WOE_RENDER_H
+#define WOE_RENDER_H
+
+#include "raylib.h"
+#include "woe_core.h"
+
+/** Converte WoeVec3 (woe_core) para Vector3 (raylib); os layouts são idênticos. */
+static inline Vector3 FromWoe(WoeVec3 v) { return (Vector3){ v.x, v.y, v.z }; }
+
+/**
+ * @brief Define o nível de precisão da trigonometria de HUD e anotações (DrawArc3D, marcador).
+ *
+ * O padrão é TRIG_TIER_VISUAL.
+ */
+void SetHudTrigTier(TrigTier tier);
+
+/** @brief Nível de precisão atual da trigonometria de HUD e anotações. */
+TrigTier GetHudTrigTier(void);
+
+/**
+ * @brief Desenha um modelo simples de aeronave como uma seta em A com yaw/pitch/roll.
+ * @param A Posição da aeronave.
+ * @param yaw Yaw (rad).
+ * @param pitch Pitch (rad).
+ * @param roll Roll (rad).
+ * @param col Cor do corpo.
+ */
+void DrawAircraft(Vector3 A, float yaw, float pitch, float roll, Color col);
+
+/**
+ * @brief Como DrawAircraft, com a base de orientação já calculada (BasisFromYPR, EntityBasis).
+ */
+void DrawAircraftBasis(Vector3 A, WoeBasis b, Color col);
+
+/**
+ * @brief Projeta ponto 3D para tela e desenha texto próximo a ele.
+ */
+void DrawTextAt3D(Camera3D cam, Vector3 p, const char *text, int fontSize, Color col, int screenW, int screenH);
+
+/** Raio da esfera envolvente de DrawAircraft em torno de A (corpo de 3 unid à frente). */
+#define AIRCRAFT_BOUND_RADIUS 3.0f
+
+/**
+ * @brief Pirâmide de visão da câmera como seis planos (esquerda, direita, baixo, cima, perto, longe).
+ *
+ * Cada plano é (x, y, z) = normal unitária apontando para dentro e w = distância;
+ * um ponto p está do lado visível quando dot(normal, p) + w >= 0.
+ */
+typedef struct Frustum {
+    Vector4 planes[6];
+    Matrix viewProj;    /**< View seguida da projeção, para FrustumProject(). */
+} Frustum;
+
+/** Contadores de um estágio de culling no quadro. */
+typedef struct CullStats {
+    int tested;     /**< Itens testados. */
+    int visible;    /**< Itens que passaram (desenhados/enviados). */
+} CullStats;
+
+/**
+ * @brief Extrai os planos da pirâmide com a mesma view/projeção que BeginMode3D usa para @p cam.
+ * @param aspect Largura/altura da área de desenho.
+ */
+Frustum FrustumFromCamera(Camera3D cam, float aspect);
+
+/**
+ * @brief Posição na tela de @p p, como GetWorldToScreenEx, mas com a matriz já calculada.
+ *
+ * Só tem sentido para pontos dentro da pirâmide (veja CullLabel).
+ */
+Vector2 FrustumProject(const Frustum *f, Vector3 p, int screenW, int screenH);
+
+/** @brief Verdadeiro se a esfera (@p center, @p radius) toca a pirâmide (teste conservador). */
+bool FrustumSphereVisible(const Frustum *f, Vector3 center, float radius);
+
+/**
+ * @brief Marca em @p visible[i] (0/1) as entidades [first, count) de @p s cuja esfera de raio @p radius é visível.
+ *
+ * Os índices abaixo de @p first não são tocados. Soma o teste em @p stats (pode ser NULL).
+ * @return Número de entidades visíveis.
+ */
+int CullEntities(const Frustum *f, const EntityStore *s, int first, float radius, unsigned char *visible, CullStats *stats);
+
+/**
+ * @brief Teste de um rótulo ancorado em @p p, feito antes de formatar ou projetar o texto.
+ *
+ * Pontos atrás da câmera ou fora da tela dão false, então o chamador pula
+ * snprintf e DrawTextAt3D. Soma o teste em @p stats (pode ser NULL).
+ */
+bool CullLabel(const Frustum *f, Vector3 p, CullStats *stats);
+
+/**
+ * @brief Desenha um arco 3D no plano definido por u e v, centrado em originC.
+ *
+ * Os pontos vêm de uma tabela unitária de cos/sin calculada uma única vez
+ * (passo de 2pi/128); só a extremidade final avalia seno/cosseno.
+ * @param originC Centro do arco.
+ * @param u Vetor unitário inicial.
+ * @param v Vetor unitário final.
+ * @param angleJ Ângulo entre u e v (rad).
+ * @param radius Raio do arco.
+ * @param col Cor do arco.
+ */
+void DrawArc3D(Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius, Color col);
+
+/**
+ * @brief Linhas de anotação do quadro, acumuladas e enviadas de uma só vez.
+ *
+ * Com LineBatchInit os buffers são do lote, persistem entre quadros
+ * (LineBatchClear só zera a contagem) e crescem por duplicação. Com
+ * LineBatchBegin eles saem da FrameArena do quadro e não crescem: quando
+ * enchem, o que já foi acumulado é desenhado antes de continuar (contado em
+ * @c flushes). LineBatchDraw envia tudo em um bloco RL_LINES da rlgl, que
+ * vira uma única chamada de desenho ao esvaziar o batch.
+ */
+typedef struct LineBatch {
+    Vector3 *pos;   /**< Extremidades, 2 por linha. */
+    Color *col;     /**< Cor por linha. */
+    int count;      /**< Linhas no quadro atual. */
+    int capacity;   /**< Linhas alocadas. */
+    FrameArena *arena;  /**< Arena que fornece os buffers do quadro (NULL: buffers próprios). */
+    int flushes;    /**< Envios antecipados no quadro por falta de espaço (só com arena). */
+} LineBatch;
+
+/** @brief Aloca espaço inicial para @p capacity linhas. */
+bool LineBatchInit(LineBatch *b, int capacity);
+
+/** @brief Libera os buffers. */
+void LineBatchFree(LineBatch *b);
+
+/** @brief Esvazia o lote para um novo quadro, mantendo a memória. */
+void LineBatchClear(LineBatch *b);
+
+/**
+ * @brief Começa o quadro com buffers para @p capacity linhas tirados de @p arena.
+ *
+ * Se a arena tiver menos espaço, o lote fica com o que couber. Os buffers
+ * valem até o próximo FrameArenaReset. Um lote criado com LineBatchInit
+ * libera seus buffers próprios na primeira chamada.
+ */
+void LineBatchBegin(LineBatch *b, FrameArena *arena, int capacity);
+
+/** @brief Acrescenta o segmento p0-p1. */
+void LineBatchAdd(LineBatch *b, Vector3 p0, Vector3 p1, Color col);
+
+/** @brief Acrescenta um arco com os mesmos parâmetros de DrawArc3D. */
+void LineBatchAddArc(LineBatch *b, Vector3 originC, Vector3 u, Vector3 v, float angleJ, float radius, Color col);
+
+/** @brief Desenha todas as linhas do lote; chamar entre BeginMode3D/EndMode3D. */
+void LineBatchDraw(const LineBatch *b);
+
+/** Raio projetado (px) a partir do qual a entidade usa a malha completa. */
+#define RENDER_LOD_FULL_PIXELS 24.0f
+/** Raio projetado (px) abaixo do qual a entidade vira um ponto (billboard). */
+#define RENDER_LOD_POINT_PIXELS 4.0f
+/** Meio-tamanho (px) do billboard de longe, constante na tela. */
+#define RENDER_LOD_SPRITE_PIXELS 2.0f
+
+/** Nível de detalhe de uma instância. */
+typedef enum RenderLod {
+    RENDER_LOD_FULL = 0,    /**< Malha completa (a mesma forma de DrawAircraft / DrawSphere). */
+    RENDER_LOD_SIMPLE,      /**< Seta de poucos lados (aeronave) ou esfera grosseira (alvo). */
+    RENDER_LOD_POINT,       /**< Losango voltado para a câmera, de tamanho fixo na tela. */
+    RENDER_LOD_COUNT
+} RenderLod;
+
+/**
+ * @brief Malhas de aeronave e alvo carregadas uma vez e desenhadas com instancing na GPU.
+ *
+ * Cada entidade vira uma matriz de modelo (EntityBasis + posição) e todas
+ * as entidades de um tipo saem em uma única chamada DrawMeshInstanced por
+ * nível de detalhe, em vez de três DrawCylinderEx (geometria refeita na CPU)
+ * por aeronave e um DrawSphere por alvo.
+ *
+ * Com a câmera dada a InstancedRendererSetCamera, o nível de cada instância
+ * vem do raio da sua esfera envolvente projetado na tela: malha completa de
+ * perto, seta ou esfera grosseira a meia distância e um billboard de poucos
+ * pixels ao longe, então uma cena densa e distante custa quase só os
+ * vértices dos billboards.
+ */
+typedef struct InstancedRenderer {
+    Mesh aircraft;      /**< Corpo, asas e deriva no referencial do corpo (x direita, y frente, z cima). */
+    Mesh aircraftSimple;/**< Seta: corpo de 4 lados e asas de 3, no mesmo referencial. */
+    Mesh target;        /**< Esfera unitária; o raio vai na escala da instância. */
+    Mesh targetSimple;  /**< Esfera unitária grosseira. */
+    Mesh sprite;        /**< Losango unitário no plano xy (normal +z), orientado para a câmera pela instância. */
+    Material material;  /**< Shader de instancing; a cor difusa é definida a cada chamada. */
+    Matrix *transforms; /**< Matrizes por instância, reconstruídas a cada quadro, agrupadas por nível. */
+    unsigned char *lod; /**< Nível de cada instância da chamada em curso. */
+    int capacity;       /**< Máximo de instâncias por chamada. */
+    bool ready;         /**< Falso se o shader de instancing não compilou (use o modo imediato). */
+    bool lodEnabled;    /**< Falso até InstancedRendererSetCamera (tudo com a malha completa). */
+    bool ortho;         /**< Câmera ortográfica: o tamanho na tela não depende da distância. */
+    Vector3 eye;        /**< Posição da câmera. */
+    Vector3 camRight, camUp, camBack; /**< Base da câmera, para os billboards. */
+    float pixelScale;   /**< Pixels por unidade a uma unidade de distância (perspectiva) ou em qualquer distância (ortográfica). */
+    int aircraftLod[RENDER_LOD_COUNT]; /**< Aeronaves desenhadas por nível na última chamada. */
+    int targetLod[RENDER_LOD_COUNT];   /**< Alvos desenhados por nível na última chamada. */
+    Matrix *airModels;  /**< Matrizes de modelo das aeronaves de InstancedRendererShare, por índice. */
+    Matrix *tgtModels;  /**< Matrizes de modelo dos alvos de InstancedRendererShare, por índice. */
+    const EntityStore *sharedAir; /**< Store de @c airModels (NULL: nada compartilhado). */
+    const EntityStore *sharedTgt; /**< Store de @c tgtModels (NULL: nada compartilhado). */
+    int sharedAirCount, sharedTgtCount; /**< Matrizes válidas em cada um. */
+    float sharedRadius; /**< Raio dos alvos de @c tgtModels. */
+} InstancedRenderer;
+
+/**
+ * @brief Cria malhas, shader e buffer de matrizes para até @p capacity instâncias.
+ *
+ * Requer janela/contexto OpenGL 3.3. Em falha devolve false e @p r fica zerado.
+ */
+bool InstancedRendererInit(InstancedRenderer *r, int capacity);
+
+/** @brief Libera malhas, shader e buffer de matrizes. */
+void InstancedRendererFree(InstancedRenderer *r);
+
+/**
+ * @brief Liga a escolha de nível por instância com a câmera do quadro; NULL desliga (tudo completo).
+ * @param screenH Altura da área de desenho (px).
+ */
+void InstancedRendererSetCamera(InstancedRenderer *r, const Camera3D *cam, int screenH);
+
+/**
+ * @brief Calcula uma vez, para o quadro, as matrizes de modelo de todas as entidades de @p air e @p tgt.
+ *
+ * Para desenhar a mesma cena de várias câmeras: enquanto valer, as chamadas
+ * de DrawAircraftInstanced com @p air e de DrawTargetsInstanced com @p tgt e
+ * raio @p targetRadius só copiam as matrizes das instâncias visíveis, e cada
+ * vista refaz apenas o culling, o nível de detalhe e os billboards (que
+ * dependem da câmera). Os ponteiros são comparados, não o conteúdo: chamar de
+ * novo a cada quadro, e com NULL para desligar.
+ */
+void InstancedRendererShare(InstancedRenderer *r, const EntityStore *air, const EntityStore *tgt, float targetRadius);
+
+/**
+ * @brief Desenha as aeronaves [first, count) de @p s, uma chamada instanciada por nível de detalhe.
+ *
+ * O nível vem do raio AIRCRAFT_BOUND_RADIUS projetado.
+ * @param visible Máscara de CullEntities(); NULL desenha todas.
+ * @param col Cor do corpo.
+ */
+void DrawAircraftInstanced(InstancedRenderer *r, const EntityStore *s, int first, const unsigned char *visible, Color col);
+
+/**
+ * @brief Desenha os alvos [first, count) de @p s como esferas de raio @p radius, uma chamada por nível.
+ * @param visible Máscara de CullEntities(); NULL desenha todos.
+ */
+void DrawTargetsInstanced(InstancedRenderer *r, const EntityStore *s, int first, const unsigned char *visible,
+                          float radius, Color col);
+
+#endif /* WOE_RENDER_H */
@@ -0,0 +1,281 @@
+/**
+ * @file scenario.c
+ * @brief Leitura de cenários e aplicação das manobras (veja scenario.h).
+ */
+#include "scenario.h"
+#include "geometry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Comprimento máximo de uma linha do arquivo de cenário. */
+#define SCENARIO_LINE_MAX 512
+
+/**
+ * @brief Gerador LCG simples em [0, 1); determinístico para uma dada semente.
+ */
+static float Rand01(unsigned int *seed)
+{
+    *seed = *seed*1664525u + 1013904223u;
+    return (float)(*seed >> 8)/16777216.0f;
+}
+
+static ScenarioEntity ScatterAircraft(unsigned int *seed)
+{
+    ScenarioEntity e = { TRACK_KIND_AIRCRAFT, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    e.x = -15.0f + 30.0f*Rand01(seed);
+    e.y = -15.0f + 30.0f*Rand01(seed);
+    e.z = 1.0f + 6.0f*Rand01(seed);
+    e.yaw = rad(360.0f*Rand01(seed));
+    e.pitch = rad(-10.0f + 20.0f*Rand01(seed));
+    return e;
+}
+
+static ScenarioEntity ScatterTarget(unsigned int *seed)
+{
+    ScenarioEntity e = { TRACK_KIND_TARGET, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    e.x = -20.0f + 40.0f*Rand01(seed);
+    e.y = -20.0f + 40.0f*Rand01(seed);
+    e.z = 0.5f + 9.5f*Rand01(seed);
+    return e;
+}
+
+static void AddEntity(EntityStore *air, EntityStore *tgt, const ScenarioEntity *e)
+{
+    EntityStoreAdd(e->kind == TRACK_KIND_AIRCRAFT ? air : tgt, e->x, e->y, e->z, e->yaw, e->pitch, e->roll);
+}
+
+void ScenarioScatter(EntityStore *air, EntityStore *tgt, int extraAircraft, int extraTargets, unsigned int seed)
+{
+    for (int i = 0; i < extraAircraft; ++i)
+    {
+        ScenarioEntity e = ScatterAircraft(&seed);
+        AddEntity(air, tgt, &e);
+    }
+    for (int i = 0; i < extraTargets; ++i)
+    {
+        ScenarioEntity e = ScatterTarget(&seed);
+        AddEntity(air, tgt, &e);
+    }
+}
+
+/** Garante espaço para mais uma entidade; false sem memória. */
+static bool ReserveEntity(Scenario *sc, int *capacity)
+{
+    if (sc->entityCount < *capacity) return true;
+    int grown = *capacity > 0 ? *capacity*2 : 64;
+    ScenarioEntity *p = (ScenarioEntity *)realloc(sc->entities, sizeof(ScenarioEntity)*(size_t)grown);
+    if (!p) return false;
+    sc->entities = p;
+    *capacity = grown;
+    return true;
+}
+
+static bool PushEntity(Scenario *sc, int *capacity, ScenarioEntity e)
+{
+    if (!ReserveEntity(sc, capacity)) return false;
+    sc->entities[sc->entityCount++] = e;
+    if (e.kind == TRACK_KIND_AIRCRAFT) sc->aircraft++;
+    else sc->targets++;
+    return true;
+}
+
+static bool PushManeuver(Scenario *sc, int *capacity, ScenarioManeuver m)
+{
+    if (sc->maneuverCount == *capacity)
+    {
+        int grown = *capacity > 0 ? *capacity*2 : 16;
+        ScenarioManeuver *p = (ScenarioManeuver *)realloc(sc->maneuvers, sizeof(ScenarioManeuver)*(size_t)grown);
+        if (!p) return false;
+        sc->maneuvers = p;
+        *capacity = grown;
+    }
+    sc->maneuvers[sc->maneuverCount++] = m;
+    return true;
+}
+
+/** @brief "aeronave" ou "alvo" para TrackKind; false para outra palavra. */
+static bool ParseKind(const char *word, TrackKind *kind)
+{
+    if (strcmp(word, "aeronave") == 0) *kind = TRACK_KIND_AIRCRAFT;
+    else if (strcmp(word, "alvo") == 0) *kind = TRACK_KIND_TARGET;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Interpreta uma linha já sem comentário e com vírgulas trocadas por espaço.
+ * @return NULL em sucesso, ou o motivo do erro.
+ */
+static const char *ParseLine(Scenario *sc, const char *p, unsigned int *seed, int *entityCap, int *maneuverCap)
+{
+    char cmd[32], arg[32], act[32];
+    int used = 0;
+    if (sscanf(p, "%31s%n", cmd, &used) != 1) return NULL; // blank line
+    p += used;
+    if (strcmp(cmd, "passo") == 0)
+    {
+        if (sscanf(p, "%lf", &sc->dt) != 1 || !(sc->dt > 0.0)) return "passo invalido";
+    }
+    else if (strcmp(cmd, "duracao") == 0)
+    {
+        if (sscanf(p, "%lf", &sc->duration) != 1 || !(sc->duration > 0.0)) return "duracao invalida";
+    }
+    else if (strcmp(cmd, "keyframe") == 0)
+    {
+        if (sscanf(p, "%lf", &sc->keyframe) != 1 || !(sc->keyframe > 0.0)) return "keyframe invalido";
+    }
+    else if (strcmp(cmd, "semente") == 0)
+    {
+        if (sscanf(p, "%u", seed) != 1) return "semente invalida";
+    }
+    else if (strcmp(cmd, "aeronave") == 0)
+    {
+        float v[6];
+        if (sscanf(p, "%f %f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6)
+            return "aeronave espera X Y Z YAW PITCH ROLL";
+        ScenarioEntity e = { TRACK_KIND_AIRCRAFT, v[0], v[1], v[2], rad(v[3]), rad(v[4]), rad(v[5]) };
+        if (!PushEntity(sc, entityCap, e)) return "memoria insuficiente";
+    }
+    else if (strcmp(cmd, "alvo") == 0)
+    {
+        float v[3];
+        if (sscanf(p, "%f %f %f", &v[0], &v[1], &v[2]) != 3) return "alvo espera X Y Z";
+        ScenarioEntity e = { TRACK_KIND_TARGET, v[0], v[1], v[2], 0.0f, 0.0f, 0.0f };
+        if (!PushEntity(sc, entityCap, e)) return "memoria insuficiente";
+    }
+    else if (strcmp(cmd, "espalhar") == 0)
+    {
+        int na, nt;
+        if (sscanf(p, "%d %d", &na, &nt) != 2 || na < 0 || nt < 0) return "espalhar espera AERONAVES ALVOS";
+        // same draw order as ScenarioScatter, so one line with the default seed is the default scene
+        for (int i = 0; i < na; ++i)
+            if (!PushEntity(sc, entityCap, ScatterAircraft(seed))) return "memoria insuficiente";
+        for (int i = 0; i < nt; ++i)
+            if (!PushEntity(sc, entityCap, ScatterTarget(seed))) return "memoria insuficiente";
+    }
+    else if (strcmp(cmd, "manobra") == 0)
+    {
+        ScenarioManeuver m;
+        memset(&m, 0, sizeof(m));
+        if (sscanf(p, "%lf %lf %31s %d %31s %f %f %f", &m.t0, &m.t1, arg, &m.index, act,
+                   &m.rate[0], &m.rate[1], &m.rate[2]) != 8)
+            return "manobra espera T0 T1 aeronave|alvo INDICE mover|girar A B C";
+        if (!ParseKind(arg, &m.kind)) return "manobra: tipo deve ser aeronave ou alvo";
+        if (!(m.t1 > m.t0) || m.t0 < 0.0) return "manobra: intervalo invalido";
+        if (m.index < 0) return "manobra: indice invalido";
+        if (strcmp(act, "mover") == 0) m.action = SCENARIO_MOVE;
+        else if (strcmp(act, "girar") == 0)
+        {
+            if (m.kind != TRACK_KIND_AIRCRAFT) return "manobra: girar so vale para aeronaves";
+            m.action = SCENARIO_TURN;
+            for (int c = 0; c < 3; ++c) m.rate[c] = rad(m.rate[c]);
+        }
+        else return "manobra: acao deve ser mover ou girar";
+        if (!PushManeuver(sc, maneuverCap, m)) return "memoria insuficiente";
+    }
+    else
+    {
+        return "comando desconhecido";
+    }
+    return NULL;
+}
+
+bool ScenarioLoad(Scenario *sc, const char *path, int *line, const char **error)
+{
+    const char *dummy;
+    int dummyLine;
+    if (!error) error = &dummy;
+    if (!line) line = &dummyLine;
+    memset(sc, 0, sizeof(*sc));
+    *line = 0;
+    *error = NULL;
+
+    FILE *f = fopen(path, "r");
+    if (!f) { *error = "nao foi possivel abrir o arquivo"; return false; }
+    sc->dt = SCENARIO_DEFAULT_DT;
+    sc->keyframe = SCENARIO_DEFAULT_KEYFRAME;
+    unsigned int seed = SCENARIO_DEFAULT_SEED;
+    int entityCap = 0, maneuverCap = 0, n = 0;
+    bool explicitDuration = false;
+    char buf[SCENARIO_LINE_MAX];
+    while (!*error && fgets(buf, sizeof(buf), f))
+    {
+        ++n;
+        if (!strchr(buf, '\n') && !feof(f)) { *error = "linha longa demais"; break; }
+        char *hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        for (char *c = buf; *c; ++c) if (*c == ',') *c = ' ';
+        double before = sc->duration;
+        *error = ParseLine(sc, buf, &seed, &entityCap, &maneuverCap);
+        if (sc->duration != before) explicitDuration = true;
+    }
+    fclose(f);
+    if (*error)
+    {
+        ScenarioFree(sc);
+        *line = n;
+        return false;
+    }
+
+    // a maneuver on an entity declared further down is fine; one that never exists is not
+    double last = 0.0;
+    for (int i = 0; i < sc->maneuverCount; ++i)
+    {
+        const ScenarioManeuver *m = &sc->maneuvers[i];
+        if (m->index >= (m->kind == TRACK_KIND_AIRCRAFT ? sc->aircraft : sc->targets))
+        {
+            *error = "manobra de entidade inexistente";
+            ScenarioFree(sc);
+            return false;
+        }
+        if (m->t1 > last) last = m->t1;
+    }
+    if (sc->entityCount == 0)
+    {
+        *error = "cenario sem entidades";
+        ScenarioFree(sc);
+        return false;
+    }
+    if (!explicitDuration) sc->duration = last > sc->dt ? last : sc->dt;
+    return true;
+}
+
+void ScenarioFree(Scenario *sc)
+{
+    free(sc->entities);
+    free(sc->maneuvers);
+    memset(sc, 0, sizeof(*sc));
+}
+
+void ScenarioSpawn(const Scenario *sc, EntityStore *air, EntityStore *tgt)
+{
+    for (int i = 0; i < sc->entityCount; ++i) AddEntity(air, tgt, &sc->entities[i]);
+}
+
+void ScenarioApply(const Scenario *sc, double t, float dt, EntityStore *air, EntityStore *tgt)
+{
+    // the step's midpoint decides, so an interval edge never lands on two steps or none
+    double mid = t - 0.5*(double)dt;
+    for (int i = 0; i < sc->maneuverCount; ++i)
+    {
+        const ScenarioManeuver *m = &sc->maneuvers[i];
+        if (mid < m->t0 || mid >= m->t1) continue;
+        EntityStore *s = m->kind == TRACK_KIND_AIRCRAFT ? air : tgt;
+        int k = m->index;
+        if (k >= s->count) continue;
+        if (m->action == SCENARIO_MOVE)
+        {
+            s->x[k] += m->rate[0]*dt;
+            s->y[k] += m->rate[1]*dt;
+            s->z[k] += m->rate[2]*dt;
+        }
+        else
+        {
+            s->yaw[k] += m->rate[0]*dt;
+            s->pitch[k] += m->rate[1]*dt;
+            s->roll[k] += m->rate[2]*dt;
+        }
+    }
+}
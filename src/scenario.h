@@ -0,0 +1,103 @@
+/**
+ * @file scenario.h
+ * @brief Cenários roteirizados: entidades iniciais, manobras por intervalo e passo fixo, para execuções reproduzíveis.
+ *
+ * Formato: texto, um comando por linha, campos separados por espaço ou
+ * vírgula; linhas vazias e o que vem depois de '#' são ignorados. Ângulos em
+ * graus, tempos em segundos de simulação.
+ * @code
+ * passo 0.005                               # dt fixo (padrão SCENARIO_DEFAULT_DT)
+ * duracao 60                                # padrão: fim da última manobra
+ * keyframe 1                                # intervalo entre keyframes de busca
+ * semente 12345                             # para os 'espalhar' seguintes
+ * aeronave X Y Z YAW PITCH ROLL
+ * alvo X Y Z
+ * espalhar AERONAVES ALVOS                  # pseudoaleatórias, como a cena padrão
+ * manobra T0 T1 aeronave|alvo I mover VX VY VZ        # unid/s
+ * manobra T0 T1 aeronave I girar DYAW DPITCH DROLL    # graus/s
+ * @endcode
+ * As entidades entram na ordem do arquivo: a i-ésima aeronave (ou alvo)
+ * listada ou espalhada é o índice i do seu EntityStore. Uma manobra vale nos
+ * passos cujo ponto médio cai em [T0, T1) e soma taxa*dt ao estado a cada
+ * passo; sem teclado nem relógio de parede no caminho, duas execuções do
+ * mesmo arquivo com o mesmo dt produzem os mesmos estados, bit a bit.
+ */
+#ifndef WOE_SCENARIO_H
+#define WOE_SCENARIO_H
+
+#include <stdbool.h>
+#include "entities.h"
+#include "tracks.h"
+
+/** Passo padrão (s): o de SIM_DEFAULT_HZ. */
+#define SCENARIO_DEFAULT_DT 0.005
+/** Intervalo padrão (s) entre keyframes de busca. */
+#define SCENARIO_DEFAULT_KEYFRAME 1.0
+/** Semente padrão de 'espalhar'; a mesma da cena padrão do visualizador. */
+#define SCENARIO_DEFAULT_SEED 12345u
+
+/** O que uma manobra altera. */
+typedef enum ScenarioAction {
+    SCENARIO_MOVE = 0,  /**< Soma rate*dt à posição. */
+    SCENARIO_TURN       /**< Soma rate*dt a yaw, pitch e roll (só aeronaves). */
+} ScenarioAction;
+
+/** Entidade inicial. */
+typedef struct ScenarioEntity {
+    TrackKind kind;             /**< EntityStore de destino. */
+    float x, y, z;              /**< Posição (unid). */
+    float yaw, pitch, roll;     /**< Orientação (rad). */
+} ScenarioEntity;
+
+/** Taxa constante aplicada a uma entidade num intervalo. */
+typedef struct ScenarioManeuver {
+    double t0, t1;              /**< Intervalo [t0, t1) (s). */
+    TrackKind kind;             /**< Aeronave ou alvo. */
+    int index;                  /**< Índice no EntityStore. */
+    ScenarioAction action;
+    float rate[3];              /**< unid/s (vx, vy, vz) ou rad/s (yaw, pitch, roll). */
+} ScenarioManeuver;
+
+/** Cenário carregado; somente leitura depois de ScenarioLoad. */
+typedef struct Scenario {
+    double dt;                  /**< Passo fixo (s). */
+    double duration;            /**< Duração (s). */
+    double keyframe;            /**< Intervalo entre keyframes (s). */
+    ScenarioEntity *entities;   /**< [entityCount] na ordem do arquivo. */
+    int entityCount;
+    int aircraft;               /**< Entidades do tipo aeronave. */
+    int targets;                /**< Entidades do tipo alvo. */
+    ScenarioManeuver *maneuvers;/**< [maneuverCount] na ordem do arquivo. */
+    int maneuverCount;
+} Scenario;
+
+/**
+ * @brief Lê e valida @p path.
+ * @param line [out] Em erro de formato, a linha (1 em diante); 0 nos demais erros (pode ser NULL).
+ * @param error [out] Em falha, motivo em texto fixo (pode ser NULL).
+ * @return false em falha, com @p sc zerado.
+ */
+bool ScenarioLoad(Scenario *sc, const char *path, int *line, const char **error);
+
+/** @brief Libera as listas e deixa o cenário zerado. */
+void ScenarioFree(Scenario *sc);
+
+/** @brief Acrescenta as entidades iniciais de @p sc a @p air e @p tgt (até a capacidade). */
+void ScenarioSpawn(const Scenario *sc, EntityStore *air, EntityStore *tgt);
+
+/**
+ * @brief Aplica as manobras do passo que termina em @p t e dura @p dt.
+ *
+ * Manobras de entidades que não existem em @p air / @p tgt são ignoradas.
+ */
+void ScenarioApply(const Scenario *sc, double t, float dt, EntityStore *air, EntityStore *tgt);
+
+/**
+ * @brief Acrescenta @p extraAircraft aeronaves e @p extraTargets alvos em posições pseudoaleatórias.
+ *
+ * Gerador LCG a partir de @p seed: a mesma semente dá a mesma cena em qualquer
+ * máquina. É o que 'espalhar' grava no cenário.
+ */
+void ScenarioScatter(EntityStore *air, EntityStore *tgt, int extraAircraft, int extraTargets, unsigned int seed);
+
+#endif /* WOE_SCENARIO_H */
@@ -0,0 +1,540 @@
+/**
+ * @file sim.c
+ * @brief Simulação em passo fixo e buffer triplo sem travas.
+ */
+#include "sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** Bit de "instantâneo novo" no índice do slot do meio. */
+#define SIM_FRESH 4
+/** Atraso máximo (s) antes de descartar passos e ressincronizar o relógio. */
+#define SIM_MAX_LAG 0.25
+
+static bool SnapshotInit(SimSnapshot *snap, int maxAir, int maxTgt)
+{
+    memset(snap, 0, sizeof(*snap));
+    bool ok = EntityStoreInit(&snap->air, maxAir) && EntityStoreInit(&snap->tgt, maxTgt) &&
+              BasisStoreInit(&snap->airBasis, maxAir) && PairResultsInit(&snap->pairs, maxAir*maxTgt) &&
+              CandidatePairsInit(&snap->cand, maxAir, maxTgt) && PairResultsInit(&snap->primary, 1) &&
+              PredictResultsInit(&snap->predict, maxAir*maxTgt) && PredictResultsInit(&snap->predictPrimary, 1);
+    snap->air.basis = &snap->airBasis;
+    return ok;
+}
+
+static void SnapshotFree(SimSnapshot *snap)
+{
+    EntityStoreFree(&snap->air);
+    EntityStoreFree(&snap->tgt);
+    BasisStoreFree(&snap->airBasis);
+    PairResultsFree(&snap->pairs);
+    CandidatePairsFree(&snap->cand);
+    PairResultsFree(&snap->primary);
+    PredictResultsFree(&snap->predict);
+    PredictResultsFree(&snap->predictPrimary);
+}
+
+static void CopyStore(EntityStore *dst, const EntityStore *src)
+{
+    size_t bytes = sizeof(float)*(size_t)src->count;
+    memcpy(dst->x, src->x, bytes);
+    memcpy(dst->y, src->y, bytes);
+    memcpy(dst->z, src->z, bytes);
+    memcpy(dst->yaw, src->yaw, bytes);
+    memcpy(dst->pitch, src->pitch, bytes);
+    memcpy(dst->roll, src->roll, bytes);
+    memcpy(dst->vx, src->vx, bytes);
+    memcpy(dst->vy, src->vy, bytes);
+    memcpy(dst->vz, src->vz, bytes);
+    dst->count = src->count;
+}
+
+/** CopyStore só das posições, que é o que os stores do passo anterior guardam. */
+static void CopyPositions(EntityStore *dst, const EntityStore *src)
+{
+    size_t bytes = sizeof(float)*(size_t)src->count;
+    memcpy(dst->x, src->x, bytes);
+    memcpy(dst->y, src->y, bytes);
+    memcpy(dst->z, src->z, bytes);
+    dst->count = src->count;
+}
+
+static void FreeKeyframes(Simulation *s)
+{
+    for (int i = 0; s->keyframes && i < SIM_MAX_KEYFRAMES; ++i)
+    {
+        SimKeyframe *k = &s->keyframes[i];
+        EntityStoreFree(&k->air);
+        EntityStoreFree(&k->tgt);
+        EntityStoreFree(&k->prevAir);
+        EntityStoreFree(&k->prevTgt);
+        SpatialGridFree(&k->grid);
+    }
+    free(s->keyframes);
+    s->keyframes = NULL;
+}
+
+bool SimInit(Simulation *s, int maxAir, int maxTgt, double rateHz, float moveSpeed, float rotSpeed)
+{
+    memset(s, 0, sizeof(*s));
+    s->rateHz = rateHz > 0.0 ? rateHz : SIM_DEFAULT_HZ;
+    s->moveSpeed = moveSpeed;
+    s->rotSpeed = rotSpeed;
+    s->solver = SOLVER_BATCH;
+    s->trig = GetSolverTrigTier();
+    s->cullRange = SIM_DEFAULT_CULL_RANGE;
+    s->cullJMax = SIM_DEFAULT_CULL_JMAX;
+    s->incremental = 1;
+    s->predict = 1;
+    s->interceptSpeed = PREDICT_DEFAULT_SPEED;
+    s->speed = 1.0;
+    s->back = 0;
+    s->middle = 1;
+    s->front = 2;
+
+    bool ok = EntityStoreInit(&s->air, maxAir) && EntityStoreInit(&s->tgt, maxTgt) &&
+              EntityStoreInit(&s->prevAir, maxAir) && EntityStoreInit(&s->prevTgt, maxTgt) &&
+              EntityPoolInit(&s->airPool, &s->air) && EntityPoolInit(&s->tgtPool, &s->tgt) &&
+              SpatialGridInit(&s->grid, maxTgt, SIM_GRID_CELL) && IncrementalSolverInit(&s->inc, maxAir, maxTgt);
+    for (int i = 0; i < SIM_SLOTS && ok; ++i) ok = SnapshotInit(&s->slots[i], maxAir, maxTgt);
+    if (!ok) SimFree(s);
+    return ok;
+}
+
+void SimFree(Simulation *s)
+{
+    EntityStoreFree(&s->air);
+    EntityStoreFree(&s->tgt);
+    EntityStoreFree(&s->prevAir);
+    EntityStoreFree(&s->prevTgt);
+    EntityPoolFree(&s->airPool);
+    EntityPoolFree(&s->tgtPool);
+    SpatialGridFree(&s->grid);
+    IncrementalSolverFree(&s->inc);
+    for (int i = 0; i < SIM_SLOTS; ++i) SnapshotFree(&s->slots[i]);
+    FreeKeyframes(s);
+}
+
+bool SimEnableKeyframes(Simulation *s, double interval)
+{
+    if (s->keyframes) return true;
+    double dt = 1.0/s->rateHz;
+    long steps = (long)(interval/dt + 0.5);
+    s->keyframeSteps = steps > 0 ? steps : 1;
+    s->keyframeCount = 0;
+    s->keyframes = (SimKeyframe *)calloc(SIM_MAX_KEYFRAMES, sizeof(SimKeyframe));
+    bool ok = s->keyframes != NULL;
+    for (int i = 0; i < SIM_MAX_KEYFRAMES && ok; ++i)
+    {
+        // same capacities as the working state, so a restore is plain copies
+        SimKeyframe *k = &s->keyframes[i];
+        ok = EntityStoreInit(&k->air, s->air.capacity) && EntityStoreInit(&k->tgt, s->tgt.capacity) &&
+             EntityStoreInit(&k->prevAir, s->prevAir.capacity) && EntityStoreInit(&k->prevTgt, s->prevTgt.capacity) &&
+             SpatialGridInit(&k->grid, s->grid.capacity, s->grid.cellSize);
+    }
+    if (!ok) FreeKeyframes(s);
+    return ok;
+}
+
+/** Grava o keyframe do passo atual se ele for múltiplo do intervalo e ainda não tiver um. */
+static void SaveKeyframe(Simulation *s)
+{
+    if (!s->keyframes || s->tick < 0 || s->tick % s->keyframeSteps != 0) return;
+    if (s->keyframeCount > 0 && s->keyframes[s->keyframeCount - 1].tick >= s->tick) return;
+    if (s->keyframeCount == SIM_MAX_KEYFRAMES)
+    {
+        // full: keep every other one (swapped, so each slot keeps its buffers) at twice the interval
+        for (int i = 1; 2*i < SIM_MAX_KEYFRAMES; ++i)
+        {
+            SimKeyframe tmp = s->keyframes[i];
+            s->keyframes[i] = s->keyframes[2*i];
+            s->keyframes[2*i] = tmp;
+        }
+        s->keyframeCount = SIM_MAX_KEYFRAMES/2;
+        s->keyframeSteps *= 2;
+        if (s->tick % s->keyframeSteps != 0) return;
+    }
+    SimKeyframe *k = &s->keyframes[s->keyframeCount++];
+    k->tick = s->tick;
+    k->time = s->time;
+    CopyStore(&k->air, &s->air);
+    CopyStore(&k->tgt, &s->tgt);
+    CopyPositions(&k->prevAir, &s->prevAir);
+    CopyPositions(&k->prevTgt, &s->prevTgt);
+    SpatialGridCopy(&k->grid, &s->grid);
+}
+
+/** Integra as entidades controladas (índice 0) com as teclas mantidas. */
+static void Integrate(Simulation *s, float dt)
+{
+    int k = WoeAtomicLoad(&s->keys);
+    float mv = s->moveSpeed*dt, rt = s->rotSpeed*dt;
+    EntityStore *a = &s->air, *t = &s->tgt;
+
+    if (a->count > 0)
+    {
+        if (k & SIM_KEY_AIR_YP) a->y[0] += mv;
+        if (k & SIM_KEY_AIR_YN) a->y[0] -= mv;
+        if (k & SIM_KEY_AIR_XN) a->x[0] -= mv;
+        if (k & SIM_KEY_AIR_XP) a->x[0] += mv;
+        if (k & SIM_KEY_AIR_ZP) a->z[0] += mv;
+        if (k & SIM_KEY_AIR_ZN) a->z[0] -= mv;
+        if (k & SIM_KEY_YAW_N)   a->yaw[0] -= rt;
+        if (k & SIM_KEY_YAW_P)   a->yaw[0] += rt;
+        if (k & SIM_KEY_PITCH_P) a->pitch[0] += rt;
+        if (k & SIM_KEY_PITCH_N) a->pitch[0] -= rt;
+        if (k & SIM_KEY_ROLL_N)  a->roll[0] -= rt;
+        if (k & SIM_KEY_ROLL_P)  a->roll[0] += rt;
+    }
+    if (t->count > 0)
+    {
+        if (k & SIM_KEY_TGT_YP) t->y[0] += mv;
+        if (k & SIM_KEY_TGT_YN) t->y[0] -= mv;
+        if (k & SIM_KEY_TGT_XN) t->x[0] -= mv;
+        if (k & SIM_KEY_TGT_XP) t->x[0] += mv;
+        if (k & SIM_KEY_TGT_ZP) t->z[0] += mv;
+        if (k & SIM_KEY_TGT_ZN) t->z[0] -= mv;
+    }
+}
+
+/**
+ * @brief Velocidades de @p s pela diferença de posições desde o passo anterior, guardadas em @p prev.
+ *
+ * Teclado, trilhas e rede só dão posições, e a rede chega em taxa menor que a
+ * do passo: a diferença bruta alterna entre saltos e zeros, então passa por um
+ * filtro de primeira ordem com constante SIM_VELOCITY_TAU. Entidades novas,
+ * inclusive as que o pool moveu para o lugar de uma removida, começam paradas.
+ */
+static void EstimateVelocity(EntityStore *s, EntityStore *prev, EntityPool *pool, float dt)
+{
+    float alpha = dt/(SIM_VELOCITY_TAU + dt), inv = 1.0f/dt;
+    int known = prev->count < s->count ? prev->count : s->count;
+    for (int i = 0; pool->renewedCount > 0 && i < known; ++i)
+    {
+        if (!pool->renewed[i]) continue;
+        prev->x[i] = s->x[i]; prev->y[i] = s->y[i]; prev->z[i] = s->z[i];
+        s->vx[i] = s->vy[i] = s->vz[i] = 0.0f;
+    }
+    EntityPoolClearRenewed(pool);
+    for (int i = 0; i < known; ++i)
+    {
+        s->vx[i] += ((s->x[i] - prev->x[i])*inv - s->vx[i])*alpha;
+        s->vy[i] += ((s->y[i] - prev->y[i])*inv - s->vy[i])*alpha;
+        s->vz[i] += ((s->z[i] - prev->z[i])*inv - s->vz[i])*alpha;
+    }
+    for (int i = known; i < s->count; ++i) s->vx[i] = s->vy[i] = s->vz[i] = 0.0f;
+    size_t bytes = sizeof(float)*(size_t)s->count;
+    memcpy(prev->x, s->x, bytes);
+    memcpy(prev->y, s->y, bytes);
+    memcpy(prev->z, s->z, bytes);
+    prev->count = s->count;
+}
+
+/** Avança o estado de trabalho um passo: teclado, roteiro, trilhas, rede e velocidades. */
+static void Advance(Simulation *s, double dt)
+{
+    Integrate(s, (float)dt);
+    s->time += dt;
+    s->tick++;
+    if (s->scenario) ScenarioApply(s->scenario, s->time, (float)dt, &s->air, &s->tgt);
+    // recorded tracks replace the integrated state of the entities they cover
+    if (s->tracks) TrackFileApply(s->tracks, s->tracks->start + s->time, &s->air, &s->tgt);
+    // live updates received since the last step win over both
+    // entities added by the caller or the tracks get ids before the network can address them
+    EntityPoolSync(&s->airPool, &s->air);
+    EntityPoolSync(&s->tgtPool, &s->tgt);
+    if (s->ingest) IngestApply(s->ingest, &s->air, &s->tgt, &s->airPool, &s->tgtPool);
+    EstimateVelocity(&s->air, &s->prevAir, &s->airPool, (float)dt);
+    EstimateVelocity(&s->tgt, &s->prevTgt, &s->tgtPool, (float)dt);
+}
+
+/** Resolve o estado de trabalho atual no slot de trás e o publica. */
+static void SolveAndPublish(Simulation *s)
+{
+    ProfileBegin(s->ring, "solucao");
+    SimSnapshot *snap = &s->slots[s->back];
+    snap->solver = (SolverMode)WoeAtomicLoad(&s->solver);
+    snap->trig = (TrigTier)WoeAtomicLoad(&s->trig);
+    // the solver's tier belongs to this thread and its workers; the renderer solves with snap->trig
+    SetSolverTrigTier(snap->trig);
+    CopyStore(&snap->air, &s->air);
+    CopyStore(&snap->tgt, &s->tgt);
+    // one basis per aircraft per step, shared by every solve below and by the renderer
+    BasisStoreUpdate(&snap->airBasis, &snap->air);
+    snap->gpu = WoeAtomicLoad(&s->gpu) != 0;
+    snap->culled = !snap->gpu && WoeAtomicLoad(&s->cull) != 0;
+    if (snap->gpu)
+    {
+        // the render thread solves the whole matrix from this snapshot
+        snap->pairs.aircraft = snap->pairs.targets = 0;
+        snap->recomputed = (long)snap->air.count*snap->tgt.count;
+        IncrementalSolverInvalidate(&s->inc);
+    }
+    else if (snap->culled)
+    {
+        SpatialGridUpdate(&s->grid, &snap->tgt);
+        SolveEngagementsCulled(s->pool, &snap->air, &snap->tgt, &s->grid, s->cullRange, s->cullJMax,
+                               &snap->cand, snap->solver);
+        snap->pairs.aircraft = snap->pairs.targets = 0;
+        snap->recomputed = snap->cand.total;
+        IncrementalSolverInvalidate(&s->inc); // the full matrix is not kept up to date meanwhile
+    }
+    else if (WoeAtomicLoad(&s->incremental))
+    {
+        snap->recomputed = SolveEngagementsIncremental(s->pool, &s->inc, &snap->air, &snap->tgt, &snap->pairs,
+                                                       snap->solver);
+    }
+    else
+    {
+        SolveEngagementsParallel(s->pool, &snap->air, &snap->tgt, &snap->pairs, snap->solver);
+        snap->recomputed = (long)snap->air.count*snap->tgt.count;
+        IncrementalSolverInvalidate(&s->inc);
+    }
+    // the controlled pair drives the main readouts even when culled away
+    if (snap->air.count > 0 && snap->tgt.count > 0)
+        SolveEngagementRow(&snap->air, 0, 1, snap->tgt.x, snap->tgt.y, snap->tgt.z, &snap->primary, 0, snap->solver);
+    ProfileEnd(s->ring);
+
+    // lead and intercept for the same pairs the solver just published
+    snap->predicted = WoeAtomicLoad(&s->predict) != 0;
+    snap->predict.aircraft = snap->predict.targets = 0;
+    if (snap->predicted)
+    {
+        ProfileBegin(s->ring, "predicao");
+        if (snap->culled)
+            PredictCandidates(s->pool, &snap->air, &snap->cand, s->interceptSpeed, &snap->predict, snap->solver);
+        else
+            PredictEngagements(s->pool, &snap->air, &snap->tgt, s->interceptSpeed, &snap->predict, snap->solver);
+        if (snap->air.count > 0 && snap->tgt.count > 0)
+            PredictRow(&snap->air, 0, s->interceptSpeed, 1, snap->tgt.x, snap->tgt.y, snap->tgt.z,
+                       snap->tgt.vx, snap->tgt.vy, snap->tgt.vz, &snap->predictPrimary, 0, snap->solver);
+        ProfileEnd(s->ring);
+    }
+    snap->time = s->time;
+    snap->tick = s->tick;
+    // only a copy into the recorder's block; the file is written by its own thread
+    if (s->recorder && !snap->gpu)
+    {
+        ProfileBegin(s->ring, "gravacao");
+        if (snap->culled) RecorderAppendCandidates(s->recorder, snap->tick, snap->time, &snap->cand);
+        else RecorderAppendPairs(s->recorder, snap->tick, snap->time, &snap->pairs);
+        snap->recorded = s->recorder->rows;
+        snap->recordDropped = s->recorder->dropped;
+        ProfileEnd(s->ring);
+    }
+    if (s->ingest)
+    {
+        snap->ingested = s->ingest->applied;
+        snap->ingestLatency = s->ingest->latency;
+    }
+    snap->airPeak = s->airPool.peak;
+    snap->tgtPeak = s->tgtPool.peak;
+    snap->despawned = s->airPool.despawned + s->tgtPool.despawned;
+    snap->published = WoeNow();
+
+    // publish: the filled slot becomes the middle one, flagged fresh
+    s->back = WoeAtomicExchange(&s->middle, s->back | SIM_FRESH) & (SIM_FRESH - 1);
+}
+
+void SimStep(Simulation *s)
+{
+    ProfileBegin(s->ring, "passo");
+    ProfileBegin(s->ring, "entrada");
+    Advance(s, 1.0/s->rateHz);
+    ProfileEnd(s->ring);
+    SolveAndPublish(s);
+    SaveKeyframe(s);
+    ProfileEnd(s->ring);
+}
+
+bool SimSeek(Simulation *s, double time)
+{
+    if (!s->keyframes || s->keyframeCount == 0 || WoeAtomicLoad(&s->running)) return false;
+    double dt = 1.0/s->rateHz;
+    long target = (long)(time/dt + 0.5);
+    if (target < 0) target = 0;
+    int k = s->keyframeCount - 1;
+    while (k > 0 && s->keyframes[k].tick > target) --k;
+    // resume from the keyframe unless the current state is already between it and the target
+    if (!(s->tick >= s->keyframes[k].tick && s->tick <= target))
+    {
+        const SimKeyframe *f = &s->keyframes[k];
+        s->tick = f->tick;
+        s->time = f->time;
+        CopyStore(&s->air, &f->air);
+        CopyStore(&s->tgt, &f->tgt);
+        CopyPositions(&s->prevAir, &f->prevAir);
+        CopyPositions(&s->prevTgt, &f->prevTgt);
+        SpatialGridCopy(&s->grid, &f->grid);
+    }
+    // the skipped steps are not solved, so the pair cache no longer matches
+    IncrementalSolverInvalidate(&s->inc);
+    bool cull = !WoeAtomicLoad(&s->gpu) && WoeAtomicLoad(&s->cull);
+    while (s->tick < target)
+    {
+        Advance(s, dt);
+        // the grid is incremental: skipping its updates would change the bucket order
+        if (cull) SpatialGridUpdate(&s->grid, &s->tgt);
+        SaveKeyframe(s);
+    }
+    SolveAndPublish(s);
+    return true;
+}
+
+const SimSnapshot *SimAcquire(Simulation *s)
+{
+    if (WoeAtomicLoad(&s->middle) & SIM_FRESH)
+        s->front = WoeAtomicExchange(&s->middle, s->front) & (SIM_FRESH - 1);
+    return &s->slots[s->front];
+}
+
+static int SimThreadMain(void *arg)
+{
+    Simulation *s = (Simulation *)arg;
+    if (s->profiler) s->ring = ProfilerThread(s->profiler, "simulacao");
+    double dt = s->speed > 0.0 ? 1.0/(s->rateHz*s->speed) : 0.0;
+    double next = WoeNow();
+    while (WoeAtomicLoad(&s->running))
+    {
+        SimStep(s);
+        if (dt == 0.0) continue; // as fast as possible
+        next += dt;
+        double now = WoeNow();
+        if (next > now) WoeSleep(next - now);
+        else if (now - next > SIM_MAX_LAG)
+        {
+            // far behind (debugger, suspended process): drop the backlog instead of spiralling
+            next = now;
+            WoeAtomicAdd(&s->overruns, 1);
+        }
+    }
+    return 0;
+}
+
+void SimReset(Simulation *s)
+{
+    // first snapshot synchronously so the reader never sees an empty slot
+    s->tick = -1;
+    s->time = -1.0/s->rateHz;
+    s->keyframeCount = 0;
+    SimStep(s);
+    SimAcquire(s);
+}
+
+bool SimStart(Simulation *s)
+{
+    SimReset(s);
+    return SimResume(s);
+}
+
+bool SimResume(Simulation *s)
+{
+    if (WoeAtomicLoad(&s->running)) return true;
+    WoeAtomicStore(&s->running, 1);
+    if (!WoeThreadCreate(&s->thread, SimThreadMain, s))
+    {
+        WoeAtomicStore(&s->running, 0);
+        return false;
+    }
+    return true;
+}
+
+void SimStop(Simulation *s)
+{
+    if (!WoeAtomicLoad(&s->running)) return;
+    WoeAtomicStore(&s->running, 0);
+    WoeThreadJoin(&s->thread);
+}
+
+void SimSetInput(Simulation *s, int keys)
+{
+    WoeAtomicStore(&s->keys, keys);
+}
+
+void SimSetSolver(Simulation *s, SolverMode mode)
+{
+    WoeAtomicStore(&s->solver, (int)mode);
+}
+
+void SimSetCulling(Simulation *s, bool on)
+{
+    WoeAtomicStore(&s->cull, on ? 1 : 0);
+}
+
+void SimSetIncremental(Simulation *s, bool on)
+{
+    WoeAtomicStore(&s->incremental, on ? 1 : 0);
+}
+
+void SimSetPrediction(Simulation *s, bool on)
+{
+    WoeAtomicStore(&s->predict, on ? 1 : 0);
+}
+
+void SimSetGpuSolve(Simulation *s, bool on)
+{
+    WoeAtomicStore(&s->gpu, on ? 1 : 0);
+}
+
+void SimSetTrigTier(Simulation *s, TrigTier tier)
+{
+    WoeAtomicStore(&s->trig, (int)tier);
+}
+
+void SimSetSpeed(Simulation *s, double speed)
+{
+    s->speed = speed;
+}
+
+/** FNV-1a de 64 bits sobre @p bytes bytes a partir de @p h. */
+static unsigned long long Fnv1a(unsigned long long h, const void *data, size_t bytes)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static unsigned long long DigestPairs(unsigned long long h, const PairResults *r, int first, int n)
+{
+    const float *cols[] = { r->AzT, r->ElT, r->AzR, r->ElR, r->j, r->G, r->E, r->F, r->J };
+    size_t bytes = sizeof(float)*(size_t)n;
+    for (size_t c = 0; c < sizeof(cols)/sizeof(cols[0]); ++c) h = Fnv1a(h, cols[c] + first, bytes);
+    return h;
+}
+
+unsigned long long SimSnapshotDigest(const SimSnapshot *snap)
+{
+    unsigned long long h = 14695981039346656037ull;
+    const EntityStore *stores[] = { &snap->air, &snap->tgt };
+    for (int i = 0; i < 2; ++i)
+    {
+        const EntityStore *e = stores[i];
+        const float *cols[] = { e->x, e->y, e->z, e->yaw, e->pitch, e->roll };
+        size_t bytes = sizeof(float)*(size_t)e->count;
+        h = Fnv1a(h, &e->count, sizeof(e->count));
+        for (int c = 0; c < 6; ++c) h = Fnv1a(h, cols[c], bytes);
+    }
+    h = Fnv1a(h, &snap->tick, sizeof(snap->tick));
+    if (snap->culled)
+    {
+        // only the filled part of each row: the rest is whatever an earlier step left there
+        const CandidatePairs *c = &snap->cand;
+        for (int a = 0; a < c->aircraft; ++a)
+        {
+            h = Fnv1a(h, &c->count[a], sizeof(int));
+            h = Fnv1a(h, &c->target[a*c->stride], sizeof(int)*(size_t)c->count[a]);
+            h = DigestPairs(h, &c->pairs, a*c->stride, c->count[a]);
+        }
+    }
+    else
+    {
+        h = DigestPairs(h, &snap->pairs, 0, snap->pairs.aircraft*snap->pairs.targets);
+    }
+    if (snap->air.count > 0 && snap->tgt.count > 0) h = DigestPairs(h, &snap->primary, 0, 1);
+    return h;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file sim.h
+ * @brief Simulação em passo fixo numa thread própria, publicada por buffer triplo.
+ *
+ * A thread de simulação integra a aeronave e o alvo controlados (entidade 0 de
+ * cada conjunto) a partir das teclas mantidas, resolve todos os pares com
+ * SolveEngagementsParallel (no pool opcional) e publica um instantâneo completo a cada passo, numa taxa
+ * fixa e configurável (p.ex. 200 Hz).
+ *
+ * A troca entre as threads é um buffer triplo sem travas: a simulação escreve
+ * sempre no slot "de trás" e o troca atomicamente pelo slot do meio; o render
+ * troca o meio pelo seu slot "da frente" apenas quando há um instantâneo novo.
+ * Nenhum lado espera o outro: um quadro lento não atrasa o cálculo do
+ * engajamento, e um passo lento não bloqueia o desenho (o render reusa o
+ * último instantâneo).
+ *
+ * Para execuções reproduzíveis, um Scenario (scenario.h) substitui o teclado:
+ * as manobras roteirizadas entram no mesmo ponto do passo e a thread pode
+ * correr várias vezes mais rápido que o tempo real (SimSetSpeed). Keyframes
+ * do estado de trabalho a intervalos fixos permitem saltar para um instante
+ * (SimSeek) sem refazer a simulação desde o início.
+ */
+#ifndef WOE_SIM_H
+#define WOE_SIM_H
+
+#include "entities.h"
+#include "fastmath.h"
+#include "geometry.h"
+#include "incremental.h"
+#include "ingest.h"
+#include "jobs.h"
+#include "predict.h"
+#include "profile.h"
+#include "recorder.h"
+#include "scenario.h"
+#include "spatial.h"
+#include "threads.h"
+#include "tracks.h"
+
+/** Taxa padrão da simulação (Hz). */
+#define SIM_DEFAULT_HZ 200.0
+/** Número de slots do buffer triplo. */
+#define SIM_SLOTS 3
+/** Alcance padrão do descarte por grade espacial (unid). */
+#define SIM_DEFAULT_CULL_RANGE 60.0f
+/** Meio-ângulo padrão do cone de descarte (rad): o anel externo do HUD, 30°. */
+#define SIM_DEFAULT_CULL_JMAX 0.5235988f
+/** Aresta da célula da grade espacial de alvos (unid), ~1/4 do alcance. */
+#define SIM_GRID_CELL (SIM_DEFAULT_CULL_RANGE/4.0f)
+/** Máximo de keyframes guardados; ao encher, metade é descartada e o intervalo dobra. */
+#define SIM_MAX_KEYFRAMES 256
+
+/** Constante de tempo (s) do filtro das velocidades estimadas por diferença de posições. */
+#define SIM_VELOCITY_TAU 0.05f
+
+/** Teclas mantidas repassadas à simulação (máscara de bits). */
+typedef enum SimKey {
+    SIM_KEY_AIR_YP = 1 << 0,    /**< Aeronave +Y. */
+    SIM_KEY_AIR_YN = 1 << 1,    /**< Aeronave -Y. */
+    SIM_KEY_AIR_XN = 1 << 2,    /**< Aeronave -X. */
+    SIM_KEY_AIR_XP = 1 << 3,    /**< Aeronave +X. */
+    SIM_KEY_AIR_ZP = 1 << 4,    /**< Aeronave +Z. */
+    SIM_KEY_AIR_ZN = 1 << 5,    /**< Aeronave -Z. */
+    SIM_KEY_TGT_YP = 1 << 6,    /**< Alvo +Y. */
+    SIM_KEY_TGT_YN = 1 << 7,    /**< Alvo -Y. */
+    SIM_KEY_TGT_XN = 1 << 8,    /**< Alvo -X. */
+    SIM_KEY_TGT_XP = 1 << 9,    /**< Alvo +X. */
+    SIM_KEY_TGT_ZP = 1 << 10,   /**< Alvo +Z. */
+    SIM_KEY_TGT_ZN = 1 << 11,   /**< Alvo -Z. */
+    SIM_KEY_YAW_N = 1 << 12,    /**< Yaw negativo. */
+    SIM_KEY_YAW_P = 1 << 13,    /**< Yaw positivo. */
+    SIM_KEY_PITCH_P = 1 << 14,  /**< Pitch positivo. */
+    SIM_KEY_PITCH_N = 1 << 15,  /**< Pitch negativo. */
+    SIM_KEY_ROLL_N = 1 << 16,   /**< Roll negativo. */
+    SIM_KEY_ROLL_P = 1 << 17    /**< Roll positivo. */
+} SimKey;
+
+/** Estado publicado a cada passo; somente leitura para quem o adquire. */
+typedef struct SimSnapshot {
+    EntityStore air;    /**< Aeronaves no instante do passo; @c air.basis aponta para @c airBasis. */
+    EntityStore tgt;    /**< Alvos no instante do passo. */
+    BasisStore airBasis;/**< Base de orientação das aeronaves, calculada uma vez por passo. */
+    PairResults pairs;  /**< Ângulos de todos os pares (vazio quando @c culled). */
+    CandidatePairs cand;/**< Pares candidatos e seus ângulos (quando @c culled). */
+    PairResults primary;/**< Par (0, 0), sempre resolvido, descartado ou não. */
+    PredictResults predict; /**< Predição dos pares resolvidos (mesmo leiaute de @c pairs ou de @c cand.pairs); vazia sem @c predicted. */
+    PredictResults predictPrimary; /**< Predição do par (0, 0) quando @c predicted. */
+    bool predicted;     /**< true se a predição de interceptação rodou neste passo. */
+    bool culled;        /**< true se só os candidatos da grade foram resolvidos. */
+    bool gpu;           /**< true se a matriz de pares fica para a GPU (GpuSolver): só @c primary foi resolvido aqui. */
+    long recomputed;    /**< Pares efetivamente calculados neste passo (menos que os publicados com o recálculo incremental). */
+    SolverMode solver;  /**< Solver usado neste passo. */
+    TrigTier trig;      /**< Nível de trigonometria usado neste passo. */
+    double time;        /**< Tempo simulado (s). */
+    long tick;          /**< Número do passo. */
+    double published;   /**< WoeNow() no momento da publicação. */
+    long long recorded; /**< Linhas aceitas pelo gravador até este passo (0 sem gravador). */
+    long long recordDropped; /**< Linhas descartadas pelo gravador até este passo. */
+    long long ingested; /**< Atualizações de rede aplicadas até este passo (0 sem recepção). */
+    double ingestLatency; /**< Maior atraso (s) entre recepção e aplicação na última leva de datagramas. */
+    int airPeak;        /**< Maior número de aeronaves vivas até este passo (EntityPool::peak). */
+    int tgtPeak;        /**< Maior número de alvos vivos até este passo. */
+    long long despawned; /**< Entidades removidas até este passo (aeronaves e alvos). */
+} SimSnapshot;
+
+/** Estado de trabalho ao fim de um passo, do qual SimSeek retoma. */
+typedef struct SimKeyframe {
+    long tick;              /**< Passo salvo. */
+    double time;            /**< Tempo simulado do passo. */
+    EntityStore air;        /**< Estado completo, velocidades inclusive. */
+    EntityStore tgt;
+    EntityStore prevAir;    /**< Posições do passo anterior (só x, y, z). */
+    EntityStore prevTgt;
+    SpatialGrid grid;       /**< Grade dos alvos, com a ordem dos buckets. */
+} SimKeyframe;
+
+/** Simulação e seu buffer triplo. Os campos são internos; use as funções abaixo. */
+typedef struct Simulation {
+    EntityStore air;        /**< Estado de trabalho; preencha antes de SimStart. */
+    EntityStore tgt;        /**< Estado de trabalho; preencha antes de SimStart. */
+    JobPool *pool;          /**< Opcional (não é dono): threads para SolveEngagementsParallel; defina antes de SimStart. */
+    float cullRange;        /**< Alcance do descarte; defina antes de SimStart. */
+    float cullJMax;         /**< Meio-ângulo do cone de descarte (rad); defina antes de SimStart. */
+    float interceptSpeed;   /**< Velocidade do interceptador da predição (unid/s); defina antes de SimStart. */
+    EntityStore prevAir;    /**< Posições do passo anterior, para estimar as velocidades (só x, y, z). */
+    EntityStore prevTgt;
+    EntityPool airPool;     /**< Slots de vida longa das aeronaves: identificadores da rede, reaproveitados ao remover. */
+    EntityPool tgtPool;     /**< Slots de vida longa dos alvos. */
+    SpatialGrid grid;       /**< Grade dos alvos, atualizada a cada passo com descarte. */
+    IncrementalSolver inc;  /**< Cache da matriz de pares para o recálculo incremental (sem descarte). */
+    TrackFile *tracks;      /**< Opcional (não é dono): trilhas gravadas que sobrepõem o teclado; defina antes de SimStart. */
+    Recorder *recorder;     /**< Opcional (não é dono): recebe os ângulos de cada passo; defina antes de SimStart. */
+    Ingest *ingest;         /**< Opcional (não é dono): atualizações por UDP, aplicadas por cima de trilhas e teclado; defina antes de SimStart. */
+    const Scenario *scenario; /**< Opcional (não é dono): manobras aplicadas a cada passo, depois do teclado; defina antes de SimStart. */
+    Profiler *profiler;     /**< Opcional (não é dono): a thread registra nele as fases de cada passo; defina antes de SimStart. */
+    ProfileRing *ring;      /**< Buffer da thread de simulação em @c profiler (NULL sem profiler). */
+    float moveSpeed;        /**< Velocidade de translação (unid/s). */
+    float rotSpeed;         /**< Velocidade de rotação (rad/s). */
+    double rateHz;          /**< Taxa do passo fixo. */
+    double time;            /**< Tempo simulado (s). */
+    long tick;              /**< Passos executados. */
+    double speed;           /**< Passos simulados por passo de tempo real (<= 0: sem espera). */
+    SimKeyframe *keyframes; /**< [SIM_MAX_KEYFRAMES] em ordem de passo (NULL sem SimEnableKeyframes). */
+    int keyframeCount;      /**< Keyframes válidos. */
+    long keyframeSteps;     /**< Passos entre keyframes. */
+
+    SimSnapshot slots[SIM_SLOTS];
+    int back;               /**< Slot da simulação. */
+    int front;              /**< Slot do leitor. */
+    volatile int middle;    /**< Slot intermediário | SIM_FRESH quando há instantâneo novo. */
+
+    volatile int keys;      /**< Máscara SimKey atual. */
+    volatile int solver;    /**< SolverMode pedido. */
+    volatile int trig;      /**< TrigTier pedido. */
+    volatile int cull;      /**< 1 para resolver só os candidatos da grade. */
+    volatile int incremental; /**< 1 para recalcular só os pares com entidade alterada (sem descarte). */
+    volatile int predict;   /**< 1 para prever interceptação e avanço de todos os pares resolvidos. */
+    volatile int gpu;       /**< 1 quando a thread de render resolve os pares na GPU. */
+    volatile int running;   /**< 1 enquanto a thread deve continuar. */
+    volatile int overruns;  /**< Vezes em que a simulação atrasou além de SIM_MAX_LAG e ressincronizou. */
+    WoeThread thread;
+} Simulation;
+
+/**
+ * @brief Aloca estado de trabalho e slots para até maxAir x maxTgt pares.
+ * @param rateHz Taxa do passo fixo (Hz), > 0.
+ * @param moveSpeed Velocidade de translação das entidades controladas (unid/s).
+ * @param rotSpeed Velocidade de rotação da aeronave controlada (rad/s).
+ */
+bool SimInit(Simulation *s, int maxAir, int maxTgt, double rateHz, float moveSpeed, float rotSpeed);
+
+/** @brief Libera todos os buffers (chamar após SimStop). */
+void SimFree(Simulation *s);
+
+/**
+ * @brief Reserva keyframes do estado de trabalho a cada @p interval segundos simulados.
+ *
+ * Chamar antes de SimStart, com as entidades já criadas. Os keyframes são
+ * gravados ao fim dos passos múltiplos do intervalo, de modo que o passo 0
+ * sempre tem um. Pools e trilhas de rede não entram no keyframe: a busca vale
+ * para cenários e trilhas gravadas, que não criam nem removem entidades.
+ */
+bool SimEnableKeyframes(Simulation *s, double interval);
+
+/**
+ * @brief Volta ao passo 0 e publica seu instantâneo, sem iniciar a thread.
+ *
+ * Para execução sem thread (SimStep em laço) ou antes de SimSeek/SimResume.
+ */
+void SimReset(Simulation *s);
+
+/**
+ * @brief SimReset seguido de SimResume.
+ *
+ * A partir daqui s->air e s->tgt pertencem à thread de simulação.
+ */
+bool SimStart(Simulation *s);
+
+/** @brief Inicia (ou retoma, após SimStop) a thread a partir do passo atual. */
+bool SimResume(Simulation *s);
+
+/** @brief Para e aguarda a thread de simulação. */
+void SimStop(Simulation *s);
+
+/** @brief Executa um passo (dt = 1/rateHz) e publica o instantâneo. Usado pela thread. */
+void SimStep(Simulation *s);
+
+/**
+ * @brief Leva a simulação ao passo mais próximo de @p time e publica seu instantâneo.
+ *
+ * Só com a thread parada e com SimEnableKeyframes. Restaura o último keyframe
+ * até @p time e avança dali sem resolver os pares nem gravar, até o passo
+ * pedido, que é resolvido e publicado normalmente. Com as mesmas opções de
+ * solver, o instantâneo é idêntico ao de uma execução sem interrupção.
+ * Passos além do último keyframe são simulados (e ganham keyframes).
+ * @return false sem keyframes.
+ */
+bool SimSeek(Simulation *s, double time);
+
+/**
+ * @brief Multiplicador de tempo da thread: 1 é o tempo real, 10 corre dez passos por dt de parede.
+ *
+ * Com @p speed <= 0 a thread não espera entre passos. Defina com a thread
+ * parada. O render continua em sua taxa: com o buffer triplo ele só vê o
+ * instantâneo mais recente de cada quadro.
+ */
+void SimSetSpeed(Simulation *s, double speed);
+
+/**
+ * @brief Resumo FNV-1a de 64 bits das posições, orientações e ângulos publicados em @p snap.
+ *
+ * Duas execuções com a mesma entrada, o mesmo passo e as mesmas opções de
+ * solver dão o mesmo valor; serve de assinatura em testes de regressão.
+ */
+unsigned long long SimSnapshotDigest(const SimSnapshot *snap);
+
+/** @brief Atualiza as teclas mantidas (máscara SimKey). */
+void SimSetInput(Simulation *s, int keys);
+
+/** @brief Troca o solver usado a partir do próximo passo. */
+void SimSetSolver(Simulation *s, SolverMode mode);
+
+/** @brief Liga/desliga o descarte por alcance e cone (SolveEngagementsCulled) a partir do próximo passo. */
+void SimSetCulling(Simulation *s, bool on);
+
+/** @brief Liga/desliga o recálculo incremental (SolveEngagementsIncremental) a partir do próximo passo. */
+void SimSetIncremental(Simulation *s, bool on);
+
+/** @brief Liga/desliga a predição de interceptação (PredictEngagements) a partir do próximo passo. */
+void SimSetPrediction(Simulation *s, bool on);
+
+/**
+ * @brief Deixa a matriz de pares para a GPU (GpuSolver) a partir do próximo passo, ou a retoma.
+ *
+ * Ligado, o passo resolve só o par (0, 0), publica @c pairs vazio e não grava
+ * no Recorder: quem resolve na GPU passa a ser o produtor da gravação. Tem
+ * precedência sobre o descarte e o recálculo incremental; a predição continua
+ * na CPU. Com gravação, alterne só com a simulação parada.
+ */
+void SimSetGpuSolve(Simulation *s, bool on);
+
+/** @brief Troca o nível de trigonometria a partir do próximo passo. */
+void SimSetTrigTier(Simulation *s, TrigTier tier);
+
+/**
+ * @brief Instantâneo mais recente para a thread leitora.
+ *
+ * Não bloqueia. O ponteiro vale até a próxima chamada; se nenhum passo novo foi
+ * publicado, devolve o mesmo instantâneo da chamada anterior.
+ */
+const SimSnapshot *SimAcquire(Simulation *s);
+
+#endif /* WOE_SIM_H */
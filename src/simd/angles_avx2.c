@@ -0,0 +1,33 @@
+/**
+ * @file angles_avx2.c
+ * @brief Instância AVX2 (8 lanes) do kernel em lote. Compilada com -mavx2.
+ */
+#include <immintrin.h>
+
+typedef __m256 V;
+typedef __m256 M;
+#define VLEN 8
+
+#define V_SET1(x)      _mm256_set1_ps(x)
+#define V_LOAD(p)      _mm256_loadu_ps(p)
+#define V_STORE(p, v)  _mm256_storeu_ps((p), (v))
+#define V_ADD(a, b)    _mm256_add_ps((a), (b))
+#define V_SUB(a, b)    _mm256_sub_ps((a), (b))
+#define V_MUL(a, b)    _mm256_mul_ps((a), (b))
+#define V_DIV(a, b)    _mm256_div_ps((a), (b))
+#define V_SQRT(a)      _mm256_sqrt_ps(a)
+#define V_MIN(a, b)    _mm256_min_ps((a), (b))
+#define V_MAX(a, b)    _mm256_max_ps((a), (b))
+#define V_FLOOR(a)     _mm256_floor_ps(a)
+#define V_ABS(a)       _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (a))
+#define V_SIGN(a)      _mm256_and_ps(_mm256_set1_ps(-0.0f), (a))
+#define V_XOR(a, b)    _mm256_xor_ps((a), (b))
+#define M_GT(a, b)     _mm256_cmp_ps((a), (b), _CMP_GT_OQ)
+#define M_LT(a, b)     _mm256_cmp_ps((a), (b), _CMP_LT_OQ)
+#define M_EQ(a, b)     _mm256_cmp_ps((a), (b), _CMP_EQ_OQ)
+#define M_AND(a, b)    _mm256_and_ps((a), (b))
+#define M_OR(a, b)     _mm256_or_ps((a), (b))
+#define V_SEL(m, a, b) _mm256_blendv_ps((b), (a), (m))
+#define SIMD_FN(name)  name##_avx2
+
+#include "angles_kernel.h"
@@ -0,0 +1,36 @@
+/**
+ * @file angles_avx512.c
+ * @brief Instância AVX-512F (16 lanes) do kernel em lote. Compilada com -mavx512f.
+ *
+ * AVX-512F não tem and/xor para float (isso é do AVX-512DQ), então as operações
+ * de bit de sinal passam pelo domínio inteiro.
+ */
+#include <immintrin.h>
+
+typedef __m512 V;
+typedef __mmask16 M;
+#define VLEN 16
+
+#define V_SET1(x)      _mm512_set1_ps(x)
+#define V_LOAD(p)      _mm512_loadu_ps(p)
+#define V_STORE(p, v)  _mm512_storeu_ps((p), (v))
+#define V_ADD(a, b)    _mm512_add_ps((a), (b))
+#define V_SUB(a, b)    _mm512_sub_ps((a), (b))
+#define V_MUL(a, b)    _mm512_mul_ps((a), (b))
+#define V_DIV(a, b)    _mm512_div_ps((a), (b))
+#define V_SQRT(a)      _mm512_sqrt_ps(a)
+#define V_MIN(a, b)    _mm512_min_ps((a), (b))
+#define V_MAX(a, b)    _mm512_max_ps((a), (b))
+#define V_FLOOR(a)     _mm512_roundscale_ps((a), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define V_ABS(a)       _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff)))
+#define V_SIGN(a)      _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32((int)0x80000000u)))
+#define V_XOR(a, b)    _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), _mm512_castps_si512(b)))
+#define M_GT(a, b)     _mm512_cmp_ps_mask((a), (b), _CMP_GT_OQ)
+#define M_LT(a, b)     _mm512_cmp_ps_mask((a), (b), _CMP_LT_OQ)
+#define M_EQ(a, b)     _mm512_cmp_ps_mask((a), (b), _CMP_EQ_OQ)
+#define M_AND(a, b)    ((__mmask16)((a) & (b)))
+#define M_OR(a, b)     ((__mmask16)((a) | (b)))
+#define V_SEL(m, a, b) _mm512_mask_blend_ps((m), (b), (a))
+#define SIMD_FN(name)  name##_avx512
+
+#include "angles_kernel.h"
@@ -0,0 +1,481 @@
+/**
+ * @file angles_kernel.h
+ * @brief Núcleo genérico (template via macros) dos solvers em lote de Az/El, ângulos esféricos e interceptação.
+ *
+ * Este arquivo NÃO tem include guard: cada unidade de tradução por ISA
+ * (angles_scalar.c, angles_sse41.c, angles_avx2.c, angles_avx512.c, angles_neon.c)
+ * define o tipo vetorial e as operações abaixo e então o inclui uma vez.
+ *
+ * Macros esperadas:
+ *  - @c V, @c M, @c VLEN: tipo vetorial, tipo máscara e número de lanes;
+ *  - @c V_SET1, @c V_LOAD, @c V_STORE (acessos não alinhados);
+ *  - @c V_ADD, @c V_SUB, @c V_MUL, @c V_DIV, @c V_SQRT, @c V_MIN, @c V_MAX, @c V_FLOOR;
+ *  - @c V_ABS, @c V_SIGN (só o bit de sinal), @c V_XOR (xor bit a bit);
+ *  - @c M_GT, @c M_LT, @c M_EQ, @c M_AND, @c M_OR, @c V_SEL(m, a, b) = m ? a : b;
+ *  - @c SIMD_FN(nome): sufixa o nome público com a ISA.
+ *
+ * Apenas multiplicações e somas separadas são usadas (sem FMA) e as UTs são
+ * compiladas com contração de ponto flutuante desligada; assim todas as ISAs
+ * produzem resultados bit a bit idênticos entre si para a mesma entrada.
+ *
+ * As aproximações seguem os polinômios do Cephes (sinf/cosf/atanf/asinf):
+ * redução de argumento por pi/2 em três partes (Cody–Waite) para seno/cosseno,
+ * redução de atan ao intervalo [0, 1] e asin/acos pela identidade do meio-ângulo.
+ */
+
+#include <stddef.h>
+
+/* --- Constantes --------------------------------------------------------- */
+#define K_PI     3.14159265358979323846f
+#define K_PIO2   1.57079632679489661923f
+/* pi - K_PI e pi/2 - K_PIO2: o que o float de pi arredonda para cima */
+#define K_PI_LO   -8.7422776e-8f
+#define K_PIO2_LO -4.3711388e-8f
+#define K_PIO4   0.78539816339744830962f
+#define K_2OPI   0.63661977236758134308f
+/* pi/2 em três partes para a redução de Cody–Waite */
+#define K_PIO2_1 1.5703125f
+#define K_PIO2_2 4.837512969970703125e-4f
+#define K_PIO2_3 7.54978995489188216e-8f
+/* tan(pi/8): limiar da redução de atan */
+#define K_TAN_PIO8 0.4142135623730950f
+
+/** Aplica ao valor @p x o sinal de @p s (x deve ser não negativo). */
+static inline V K_copysign(V x, V s) { return V_XOR(x, V_SIGN(s)); }
+
+/** Troca o sinal de @p x (como o - unário, também em zeros). */
+static inline V K_neg(V x) { return V_XOR(x, V_SET1(-0.0f)); }
+
+/**
+ * @brief Calcula seno e cosseno de @p x simultaneamente.
+ * @param x Ângulo (rad); precisão plena para |x| até algumas centenas de rad.
+ * @param[out] c Cosseno de x.
+ * @return Seno de x.
+ */
+static inline V K_sincos(V x, V *c)
+{
+    V k = V_FLOOR(V_ADD(V_MUL(x, V_SET1(K_2OPI)), V_SET1(0.5f)));
+    V r = V_SUB(x, V_MUL(k, V_SET1(K_PIO2_1)));
+    r = V_SUB(r, V_MUL(k, V_SET1(K_PIO2_2)));
+    r = V_SUB(r, V_MUL(k, V_SET1(K_PIO2_3)));
+
+    // quadrant q = k mod 4, kept in float to avoid integer SIMD
+    V q = V_SUB(k, V_MUL(V_SET1(4.0f), V_FLOOR(V_MUL(k, V_SET1(0.25f)))));
+
+    V z = V_MUL(r, r);
+    V ps = V_ADD(V_MUL(V_SET1(-1.9515295891e-4f), z), V_SET1(8.3321608736e-3f));
+    ps = V_ADD(V_MUL(ps, z), V_SET1(-1.6666654611e-1f));
+    ps = V_ADD(V_MUL(V_MUL(ps, z), r), r);
+
+    V pc = V_ADD(V_MUL(V_SET1(2.443315711809948e-5f), z), V_SET1(-1.388731625493765e-3f));
+    pc = V_ADD(V_MUL(pc, z), V_SET1(4.166664568298827e-2f));
+    pc = V_ADD(V_SUB(V_MUL(V_MUL(pc, z), z), V_MUL(V_SET1(0.5f), z)), V_SET1(1.0f));
+
+    M odd = M_OR(M_EQ(q, V_SET1(1.0f)), M_EQ(q, V_SET1(3.0f)));
+    V s = V_SEL(odd, pc, ps);
+    V co = V_SEL(odd, ps, pc);
+    // sin < 0 for q in {2,3}; cos < 0 for q in {1,2}
+    M sneg = M_GT(q, V_SET1(1.5f));
+    M cneg = M_AND(M_GT(q, V_SET1(0.5f)), M_LT(q, V_SET1(2.5f)));
+    *c = V_SEL(cneg, V_SUB(V_SET1(0.0f), co), co);
+    return V_SEL(sneg, V_SUB(V_SET1(0.0f), s), s);
+}
+
+/**
+ * @brief atan2(y, x) com a mesma convenção de quadrantes e zeros com sinal da libm.
+ */
+static inline V K_atan2(V y, V x)
+{
+    V ax = V_ABS(x), ay = V_ABS(y);
+    V mx = V_MAX(ax, ay), mn = V_MIN(ax, ay);
+    M zero = M_EQ(mx, V_SET1(0.0f));
+    V a = V_DIV(mn, V_SEL(zero, V_SET1(1.0f), mx));
+
+    // atan on [0,1]: shift by pi/4 above tan(pi/8)
+    M big = M_GT(a, V_SET1(K_TAN_PIO8));
+    V t = V_SEL(big, V_DIV(V_SUB(a, V_SET1(1.0f)), V_ADD(a, V_SET1(1.0f))), a);
+    V base = V_SEL(big, V_SET1(K_PIO4), V_SET1(0.0f));
+    V z = V_MUL(t, t);
+    V p = V_ADD(V_MUL(V_SET1(8.05374449538e-2f), z), V_SET1(-1.38776856032e-1f));
+    p = V_ADD(V_MUL(p, z), V_SET1(1.99777106478e-1f));
+    p = V_ADD(V_MUL(p, z), V_SET1(-3.33329491539e-1f));
+    V r = V_ADD(base, V_ADD(V_MUL(V_MUL(p, z), t), t));
+
+    // low parts first, as in TrigAtan2: results near +-pi stay on the correct side of it
+    r = V_SEL(M_GT(ay, ax), V_ADD(V_SET1(K_PIO2), V_SUB(V_SET1(K_PIO2_LO), r)), r);
+    // x < 0 (including -0) mirrors into the left half-plane
+    M xneg = M_LT(K_copysign(V_SET1(1.0f), x), V_SET1(0.0f));
+    r = V_SEL(xneg, V_ADD(V_SET1(K_PI), V_SUB(V_SET1(K_PI_LO), r)), r);
+    return K_copysign(r, y);
+}
+
+/** Polinômio de asin para |v| <= 0.5 (z = v*v). */
+static inline V K_asin_poly(V v)
+{
+    V z = V_MUL(v, v);
+    V p = V_ADD(V_MUL(V_SET1(4.2163199048e-2f), z), V_SET1(2.4181311049e-2f));
+    p = V_ADD(V_MUL(p, z), V_SET1(4.5470025998e-2f));
+    p = V_ADD(V_MUL(p, z), V_SET1(7.4953002686e-2f));
+    p = V_ADD(V_MUL(p, z), V_SET1(1.6666752422e-1f));
+    return V_ADD(V_MUL(V_MUL(p, z), v), v);
+}
+
+/** asin(x) com clamp de x em [-1, 1]. */
+static inline V K_asin(V x)
+{
+    V a = V_MIN(V_ABS(x), V_SET1(1.0f));
+    M half = M_GT(a, V_SET1(0.5f));
+    V v = V_SEL(half, V_SQRT(V_MUL(V_SET1(0.5f), V_SUB(V_SET1(1.0f), a))), a);
+    V p = K_asin_poly(v);
+    V r = V_SEL(half, V_SUB(V_SET1(K_PIO2), V_ADD(p, p)), p);
+    return K_copysign(r, x);
+}
+
+/** acos(x) com clamp de x em [-1, 1] (equivalente a safe_acos). */
+static inline V K_acos(V x)
+{
+    V a = V_MIN(V_ABS(x), V_SET1(1.0f));
+    M half = M_GT(a, V_SET1(0.5f));
+    V v = V_SEL(half, V_SQRT(V_MUL(V_SET1(0.5f), V_SUB(V_SET1(1.0f), a))), x);
+    V p = K_asin_poly(v);
+    // |x| > 0.5: acos(|x|) = 2*asin(sqrt((1-|x|)/2)), mirrored for x < 0
+    V rh = V_ADD(p, p);
+    rh = V_SEL(M_LT(x, V_SET1(0.0f)), V_SUB(V_SET1(K_PI), rh), rh);
+    return V_SEL(half, rh, V_SUB(V_SET1(K_PIO2), p));
+}
+
+/** Saídas pedidas a K_spherical; sempre constantes na chamada, para o compilador podar o que não é lido. */
+#define K_OUT_J   1
+#define K_OUT_G   2
+#define K_OUT_EFJ 4
+#define K_OUT_ALL (K_OUT_J | K_OUT_G | K_OUT_EFJ)
+
+/**
+ * @brief Ângulos esféricos de um vetor de lanes; mesma cadeia de ComputeSphericalAngles.
+ *
+ * Só as saídas em @p outs (K_OUT_*) são calculadas e escritas: sem G, E e F
+ * ficam de fora (um atan2, um asin, um sincos e duas divisões). O que é
+ * calculado segue as mesmas operações de K_OUT_ALL, bit a bit.
+ */
+static inline void K_spherical(V AzT, V ElT, V AzR, V ElR, int outs,
+                               V *oj, V *oG, V *oE, V *oF, V *oJ)
+{
+    V cAzT, cElT, cAzR, cElR;
+    V sAzT = K_sincos(AzT, &cAzT);
+    V sElT = K_sincos(ElT, &cElT);
+    V sAzR = K_sincos(AzR, &cAzR);
+    V sElR = K_sincos(ElR, &cElR);
+
+    V f = K_acos(V_MUL(cAzT, cElT));
+    V h = K_acos(V_MUL(cAzR, cElR));
+
+    V C = K_atan2(V_DIV(sElT, cElT), sAzT);
+    V D = K_atan2(V_DIV(sElR, cElR), sAzR);
+    V J = V_SUB(V_SUB(V_SET1(K_PI), C), D);
+
+    V cf, ch, cJ;
+    V sf = K_sincos(f, &cf);
+    V sh = K_sincos(h, &ch);
+    V sJ = K_sincos(J, &cJ);
+    V j = K_acos(V_ADD(V_MUL(cf, ch), V_MUL(V_MUL(sf, sh), cJ)));
+    *oj = j;
+    if (outs & K_OUT_EFJ) *oJ = J;
+    if (!(outs & (K_OUT_G | K_OUT_EFJ))) return;
+
+    V E = K_atan2(V_DIV(sAzR, cAzR), sElR);
+
+    V cj;
+    V denom = K_sincos(j, &cj);
+    M ok = M_GT(V_ABS(denom), V_SET1(1e-6f));
+    V s = V_DIV(V_MUL(sJ, sf), V_SEL(ok, denom, V_SET1(1.0f)));
+    V F = V_SEL(ok, K_asin(s), V_SET1(0.0f));
+
+    if (outs & K_OUT_G) *oG = V_SUB(V_SUB(V_SET1(K_PI), E), F);
+    if (outs & K_OUT_EFJ)
+    {
+        *oE = E;
+        *oF = F;
+    }
+}
+
+/** Azimute/elevação de um vetor de lanes de deslocamentos (dx, dy, dz). */
+static inline void K_azel(V dx, V dy, V dz, V *oAz, V *oEl)
+{
+    V horiz = V_SQRT(V_ADD(V_MUL(dx, dx), V_MUL(dy, dy)));
+    *oAz = K_atan2(dx, dy);
+    *oEl = K_atan2(dz, horiz);
+}
+
+/**
+ * @brief Colunas de R = Rz(yaw)*Rx(pitch)*Ry(roll) de um vetor de lanes, na forma fechada de BasisFromYPR.
+ *
+ * Um K_sincos por ângulo dá seno e cosseno juntos; o vetor frente é o mesmo
+ * produto de ForwardFromYPR, então bate bit a bit com o nível float escalar.
+ */
+static inline void K_basis(V yaw, V pitch, V roll, V *r, V *f, V *u)
+{
+    V cy, cp, cr;
+    V sy = K_sincos(yaw, &cy);
+    V sp = K_sincos(pitch, &cp);
+    V sr = K_sincos(roll, &cr);
+    V sysp = V_MUL(sy, sp), cysp = V_MUL(cy, sp);
+    r[0] = V_SUB(V_MUL(cy, cr), V_MUL(sysp, sr));
+    r[1] = V_ADD(V_MUL(sy, cr), V_MUL(cysp, sr));
+    r[2] = K_neg(V_MUL(cp, sr));
+    f[0] = V_SUB(V_SET1(0.0f), V_MUL(sy, cp));   // +0 at yaw = 0, see ForwardFromYPR
+    f[1] = V_MUL(cy, cp);
+    f[2] = sp;
+    u[0] = V_ADD(V_MUL(cy, sr), V_MUL(sysp, cr));
+    u[1] = V_SUB(V_MUL(sy, sr), V_MUL(cysp, cr));
+    u[2] = V_MUL(cp, cr);
+}
+
+/**
+ * @brief Interceptação e maior aproximação de um vetor de lanes.
+ *
+ * (dx, dy, dz) é a posição do alvo relativa à aeronave e (wx, wy, wz) a
+ * velocidade relativa. Resolve |r + w*t| = s*t com a raiz estável de Vieta
+ * (sem cancelamento em nenhum dos ramos) e devolve a direção de mira r + w*t
+ * — ou r + w*tca quando não há interceptação em [0, tmax] —, o tempo até a
+ * interceptação (-1 sem solução), o instante e a distância da maior aproximação.
+ */
+static inline void K_intercept(V dx, V dy, V dz, V wx, V wy, V wz, V s2, V tmax,
+                               V *ox, V *oy, V *oz, V *otgo, V *otca, V *omiss)
+{
+    V ww = V_ADD(V_ADD(V_MUL(wx, wx), V_MUL(wy, wy)), V_MUL(wz, wz));
+    V b = V_ADD(V_ADD(V_MUL(dx, wx), V_MUL(dy, wy)), V_MUL(dz, wz));
+    V c = V_ADD(V_ADD(V_MUL(dx, dx), V_MUL(dy, dy)), V_MUL(dz, dz));
+
+    // closest approach of the relative motion, never in the past
+    V tca = V_MAX(V_DIV(V_SUB(V_SET1(0.0f), b), V_MAX(ww, V_SET1(1e-12f))), V_SET1(0.0f));
+    V mx = V_ADD(dx, V_MUL(wx, tca)), my = V_ADD(dy, V_MUL(wy, tca)), mz = V_ADD(dz, V_MUL(wz, tca));
+    V miss = V_SQRT(V_ADD(V_ADD(V_MUL(mx, mx), V_MUL(my, my)), V_MUL(mz, mz)));
+
+    // (w.w - s^2) t^2 + 2 (r.w) t + r.r = 0
+    V a = V_SUB(ww, s2);
+    V disc = V_SUB(V_MUL(b, b), V_MUL(a, c));
+    V sq = V_SQRT(V_MAX(disc, V_SET1(0.0f)));
+    M closing = M_LT(b, V_SET1(0.0f));
+    M slower = M_LT(a, V_SET1(0.0f));
+    // closing: t = c/(sq - b) is the smallest positive root for any sign of a;
+    // opening: only a slower target is caught, at t = (-b - sq)/a
+    V tc = V_DIV(c, V_MAX(V_SUB(sq, b), V_SET1(1e-30f)));
+    V to = V_DIV(V_SUB(V_SUB(V_SET1(0.0f), b), sq), V_SEL(slower, a, V_SET1(-1.0f)));
+    V t = V_SEL(closing, tc, to);
+    M ok = M_AND(M_OR(M_GT(disc, V_SET1(0.0f)), M_EQ(disc, V_SET1(0.0f))), M_OR(closing, slower));
+    ok = M_AND(ok, M_LT(t, tmax));
+
+    V ta = V_SEL(ok, t, tca);
+    *ox = V_ADD(dx, V_MUL(wx, ta));
+    *oy = V_ADD(dy, V_MUL(wy, ta));
+    *oz = V_ADD(dz, V_MUL(wz, ta));
+    *otgo = V_SEL(ok, t, V_SET1(-1.0f));
+    *otca = tca;
+    *omiss = miss;
+}
+
+void SIMD_FN(ComputeAzElBatch)(int n, float ax, float ay, float az,
+                               const float *tx, const float *ty, const float *tz,
+                               float *out_Az, float *out_El)
+{
+    V vax = V_SET1(ax), vay = V_SET1(ay), vaz = V_SET1(az);
+    int i = 0;
+    for (; i + VLEN <= n; i += VLEN)
+    {
+        V Az, El;
+        K_azel(V_SUB(V_LOAD(tx + i), vax), V_SUB(V_LOAD(ty + i), vay), V_SUB(V_LOAD(tz + i), vaz), &Az, &El);
+        if (out_Az) V_STORE(out_Az + i, Az);
+        if (out_El) V_STORE(out_El + i, El);
+    }
+    if (i < n)
+    {
+        // Tail: pad a full vector so every element goes through the same code path
+        float bx[VLEN], by[VLEN], bz[VLEN], oa[VLEN], oe[VLEN];
+        int rem = n - i;
+        for (int l = 0; l < VLEN; ++l)
+        {
+            bx[l] = l < rem ? tx[i + l] : ax;
+            by[l] = l < rem ? ty[i + l] : ay;
+            bz[l] = l < rem ? tz[i + l] : az;
+        }
+        V Az, El;
+        K_azel(V_SUB(V_LOAD(bx), vax), V_SUB(V_LOAD(by), vay), V_SUB(V_LOAD(bz), vaz), &Az, &El);
+        V_STORE(oa, Az);
+        V_STORE(oe, El);
+        for (int l = 0; l < rem; ++l)
+        {
+            if (out_Az) out_Az[i + l] = oa[l];
+            if (out_El) out_El[i + l] = oe[l];
+        }
+    }
+}
+
+/**
+ * @brief Laço em lote de K_spherical com as saídas @p outs.
+ *
+ * Com @p nullable, cada saída NULL é ignorada (a API completa); sem, todas as
+ * de @p outs são obrigatórias e não há teste por vetor.
+ */
+static inline void K_sphericalBatch(int n, const float *AzT, const float *ElT, const float *AzR, const float *ElR,
+                                    int outs, int nullable,
+                                    float *out_j, float *out_G, float *out_E, float *out_F, float *out_J)
+{
+    int wj = outs & K_OUT_J, wG = outs & K_OUT_G, wEFJ = outs & K_OUT_EFJ;
+    if (nullable)
+    {
+        wj = wj && out_j;
+        wG = wG && out_G;
+    }
+    int wE = wEFJ && (!nullable || out_E), wF = wEFJ && (!nullable || out_F), wJ = wEFJ && (!nullable || out_J);
+    int i = 0;
+    for (; i + VLEN <= n; i += VLEN)
+    {
+        V j, G, E, F, J;
+        K_spherical(V_LOAD(AzT + i), V_LOAD(ElT + i), V_LOAD(AzR + i), V_LOAD(ElR + i), outs, &j, &G, &E, &F, &J);
+        if (wj) V_STORE(out_j + i, j);
+        if (wG) V_STORE(out_G + i, G);
+        if (wE) V_STORE(out_E + i, E);
+        if (wF) V_STORE(out_F + i, F);
+        if (wJ) V_STORE(out_J + i, J);
+    }
+    if (i < n)
+    {
+        float b[4][VLEN], o[5][VLEN];
+        int rem = n - i;
+        for (int l = 0; l < VLEN; ++l)
+        {
+            int src = i + (l < rem ? l : rem - 1);
+            b[0][l] = AzT[src]; b[1][l] = ElT[src]; b[2][l] = AzR[src]; b[3][l] = ElR[src];
+        }
+        V j, G, E, F, J;
+        K_spherical(V_LOAD(b[0]), V_LOAD(b[1]), V_LOAD(b[2]), V_LOAD(b[3]), outs, &j, &G, &E, &F, &J);
+        V_STORE(o[0], j);
+        if (outs & K_OUT_G) V_STORE(o[1], G);
+        if (outs & K_OUT_EFJ) { V_STORE(o[2], E); V_STORE(o[3], F); V_STORE(o[4], J); }
+        for (int l = 0; l < rem; ++l)
+        {
+            if (wj) out_j[i + l] = o[0][l];
+            if (wG) out_G[i + l] = o[1][l];
+            if (wE) out_E[i + l] = o[2][l];
+            if (wF) out_F[i + l] = o[3][l];
+            if (wJ) out_J[i + l] = o[4][l];
+        }
+    }
+}
+
+void SIMD_FN(ComputeSphericalAnglesBatch)(int n,
+                                          const float *AzT, const float *ElT,
+                                          const float *AzR, const float *ElR,
+                                          float *out_j, float *out_G,
+                                          float *out_E, float *out_F, float *out_J)
+{
+    K_sphericalBatch(n, AzT, ElT, AzR, ElR, K_OUT_ALL, 1, out_j, out_G, out_E, out_F, out_J);
+}
+
+void SIMD_FN(ComputeSphericalAnglesJGBatch)(int n,
+                                            const float *AzT, const float *ElT,
+                                            const float *AzR, const float *ElR,
+                                            float *out_j, float *out_G)
+{
+    K_sphericalBatch(n, AzT, ElT, AzR, ElR, K_OUT_J | K_OUT_G, 0, out_j, out_G, NULL, NULL, NULL);
+}
+
+void SIMD_FN(ComputeSphericalAnglesJBatch)(int n,
+                                           const float *AzT, const float *ElT,
+                                           const float *AzR, const float *ElR,
+                                           float *out_j)
+{
+    K_sphericalBatch(n, AzT, ElT, AzR, ElR, K_OUT_J, 0, out_j, NULL, NULL, NULL, NULL);
+}
+
+void SIMD_FN(ComputeInterceptBatch)(int n, float ax, float ay, float az, float avx, float avy, float avz,
+                                    float speed, float maxTime,
+                                    const float *tx, const float *ty, const float *tz,
+                                    const float *tvx, const float *tvy, const float *tvz,
+                                    float *out_x, float *out_y, float *out_z,
+                                    float *out_tgo, float *out_tca, float *out_miss)
+{
+    V vax = V_SET1(ax), vay = V_SET1(ay), vaz = V_SET1(az);
+    V vvx = V_SET1(avx), vvy = V_SET1(avy), vvz = V_SET1(avz);
+    V s2 = V_SET1(speed*speed), tmax = V_SET1(maxTime);
+    int i = 0;
+    for (; i + VLEN <= n; i += VLEN)
+    {
+        V x, y, z, tgo, tca, miss;
+        K_intercept(V_SUB(V_LOAD(tx + i), vax), V_SUB(V_LOAD(ty + i), vay), V_SUB(V_LOAD(tz + i), vaz),
+                    V_SUB(V_LOAD(tvx + i), vvx), V_SUB(V_LOAD(tvy + i), vvy), V_SUB(V_LOAD(tvz + i), vvz),
+                    s2, tmax, &x, &y, &z, &tgo, &tca, &miss);
+        // aim points go back to world coordinates so the angle kernels can take them as targets
+        V_STORE(out_x + i, V_ADD(x, vax));
+        V_STORE(out_y + i, V_ADD(y, vay));
+        V_STORE(out_z + i, V_ADD(z, vaz));
+        if (out_tgo) V_STORE(out_tgo + i, tgo);
+        if (out_tca) V_STORE(out_tca + i, tca);
+        if (out_miss) V_STORE(out_miss + i, miss);
+    }
+    if (i < n)
+    {
+        float b[6][VLEN], o[6][VLEN];
+        int rem = n - i;
+        for (int l = 0; l < VLEN; ++l)
+        {
+            int src = i + (l < rem ? l : rem - 1);
+            b[0][l] = tx[src]; b[1][l] = ty[src]; b[2][l] = tz[src];
+            b[3][l] = tvx[src]; b[4][l] = tvy[src]; b[5][l] = tvz[src];
+        }
+        V x, y, z, tgo, tca, miss;
+        K_intercept(V_SUB(V_LOAD(b[0]), vax), V_SUB(V_LOAD(b[1]), vay), V_SUB(V_LOAD(b[2]), vaz),
+                    V_SUB(V_LOAD(b[3]), vvx), V_SUB(V_LOAD(b[4]), vvy), V_SUB(V_LOAD(b[5]), vvz),
+                    s2, tmax, &x, &y, &z, &tgo, &tca, &miss);
+        V_STORE(o[0], V_ADD(x, vax)); V_STORE(o[1], V_ADD(y, vay)); V_STORE(o[2], V_ADD(z, vaz));
+        V_STORE(o[3], tgo); V_STORE(o[4], tca); V_STORE(o[5], miss);
+        for (int l = 0; l < rem; ++l)
+        {
+            out_x[i + l] = o[0][l]; out_y[i + l] = o[1][l]; out_z[i + l] = o[2][l];
+            if (out_tgo) out_tgo[i + l] = o[3][l];
+            if (out_tca) out_tca[i + l] = o[4][l];
+            if (out_miss) out_miss[i + l] = o[5][l];
+        }
+    }
+}
+
+void SIMD_FN(ComputeBasisBatch)(int n, const float *yaw, const float *pitch, const float *roll,
+                                float *out_rx, float *out_ry, float *out_rz,
+                                float *out_fx, float *out_fy, float *out_fz,
+                                float *out_ux, float *out_uy, float *out_uz,
+                                float *out_AzR, float *out_ElR)
+{
+    float *col[11] = { out_rx, out_ry, out_rz, out_fx, out_fy, out_fz, out_ux, out_uy, out_uz, out_AzR, out_ElR };
+    // same contract in the body and the tail: every NULL column is skipped, Az/El only when asked for
+    int wa = out_AzR != NULL || out_ElR != NULL;
+    int i = 0;
+    for (; i + VLEN <= n; i += VLEN)
+    {
+        V o[11];
+        K_basis(V_LOAD(yaw + i), V_LOAD(pitch + i), V_LOAD(roll + i), &o[0], &o[3], &o[6]);
+        if (wa) K_azel(o[3], o[4], o[5], &o[9], &o[10]);
+        else o[9] = o[10] = V_SET1(0.0f);
+        for (int c = 0; c < 11; ++c)
+            if (col[c]) V_STORE(col[c] + i, o[c]);
+    }
+    if (i < n)
+    {
+        float b[3][VLEN], o[11][VLEN];
+        int rem = n - i;
+        for (int l = 0; l < VLEN; ++l)
+        {
+            int src = i + (l < rem ? l : rem - 1);
+            b[0][l] = yaw[src]; b[1][l] = pitch[src]; b[2][l] = roll[src];
+        }
+        V v[11];
+        K_basis(V_LOAD(b[0]), V_LOAD(b[1]), V_LOAD(b[2]), &v[0], &v[3], &v[6]);
+        if (wa) K_azel(v[3], v[4], v[5], &v[9], &v[10]);
+        else v[9] = v[10] = V_SET1(0.0f);
+        for (int c = 0; c < 11; ++c) V_STORE(o[c], v[c]);
+        for (int c = 0; c < 11; ++c)
+        {
+            if (!col[c]) continue;
+            for (int l = 0; l < rem; ++l) col[c][i + l] = o[c][l];
+        }
+    }
+}
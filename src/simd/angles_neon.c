@@ -0,0 +1,33 @@
+/**
+ * @file angles_neon.c
+ * @brief Instância NEON (4 lanes, AArch64) do kernel em lote.
+ */
+#include <arm_neon.h>
+
+typedef float32x4_t V;
+typedef uint32x4_t M;
+#define VLEN 4
+
+#define V_SET1(x)      vdupq_n_f32(x)
+#define V_LOAD(p)      vld1q_f32(p)
+#define V_STORE(p, v)  vst1q_f32((p), (v))
+#define V_ADD(a, b)    vaddq_f32((a), (b))
+#define V_SUB(a, b)    vsubq_f32((a), (b))
+#define V_MUL(a, b)    vmulq_f32((a), (b))
+#define V_DIV(a, b)    vdivq_f32((a), (b))
+#define V_SQRT(a)      vsqrtq_f32(a)
+#define V_MIN(a, b)    vminq_f32((a), (b))
+#define V_MAX(a, b)    vmaxq_f32((a), (b))
+#define V_FLOOR(a)     vrndmq_f32(a)
+#define V_ABS(a)       vabsq_f32(a)
+#define V_SIGN(a)      vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vdupq_n_u32(0x80000000u)))
+#define V_XOR(a, b)    vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)))
+#define M_GT(a, b)     vcgtq_f32((a), (b))
+#define M_LT(a, b)     vcltq_f32((a), (b))
+#define M_EQ(a, b)     vceqq_f32((a), (b))
+#define M_AND(a, b)    vandq_u32((a), (b))
+#define M_OR(a, b)     vorrq_u32((a), (b))
+#define V_SEL(m, a, b) vbslq_f32((m), (a), (b))
+#define SIMD_FN(name)  name##_neon
+
+#include "angles_kernel.h"
@@ -0,0 +1,50 @@
+/**
+ * @file angles_scalar.c
+ * @brief Instância escalar (1 lane) do kernel em lote; usada quando não há SIMD.
+ */
+#include <math.h>
+#include <string.h>
+
+typedef float V;
+typedef int M;
+#define VLEN 1
+
+static inline float ScalarSign(float x)
+{
+    unsigned int u; memcpy(&u, &x, sizeof(u));
+    u &= 0x80000000u;
+    float r; memcpy(&r, &u, sizeof(r));
+    return r;
+}
+
+static inline float ScalarXor(float a, float b)
+{
+    unsigned int ua, ub; memcpy(&ua, &a, sizeof(ua)); memcpy(&ub, &b, sizeof(ub));
+    ua ^= ub;
+    float r; memcpy(&r, &ua, sizeof(r));
+    return r;
+}
+
+#define V_SET1(x)      ((float)(x))
+#define V_LOAD(p)      (*(p))
+#define V_STORE(p, v)  (*(p) = (v))
+#define V_ADD(a, b)    ((a) + (b))
+#define V_SUB(a, b)    ((a) - (b))
+#define V_MUL(a, b)    ((a) * (b))
+#define V_DIV(a, b)    ((a) / (b))
+#define V_SQRT(a)      sqrtf(a)
+#define V_MIN(a, b)    ((a) < (b) ? (a) : (b))
+#define V_MAX(a, b)    ((a) > (b) ? (a) : (b))
+#define V_FLOOR(a)     floorf(a)
+#define V_ABS(a)       fabsf(a)
+#define V_SIGN(a)      ScalarSign(a)
+#define V_XOR(a, b)    ScalarXor((a), (b))
+#define M_GT(a, b)     ((a) > (b))
+#define M_LT(a, b)     ((a) < (b))
+#define M_EQ(a, b)     ((a) == (b))
+#define M_AND(a, b)    ((a) && (b))
+#define M_OR(a, b)     ((a) || (b))
+#define V_SEL(m, a, b) ((m) ? (a) : (b))
+#define SIMD_FN(name)  name##_scalar
+
+#include "angles_kernel.h"
@@ -0,0 +1,256 @@
+/**
+ * @file angles_simd.c
+ * @brief Detecção de ISA em tempo de execução e despacho dos kernels em lote.
+ *
+ * As instâncias por ISA só existem quando o CMake as compila: WOE_SIMD_X86
+ * habilita SSE4.1/AVX2/AVX-512 e WOE_SIMD_NEON habilita NEON. A instância
+ * escalar está sempre presente.
+ */
+#include "angles_simd.h"
+#include "threads.h"
+
+#include <stddef.h>
+#if defined(WOE_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/** Declara as entradas em lote de uma ISA. */
+#define DECLARE_ISA(sfx) \
+    void ComputeAzElBatch_##sfx(int n, float ax, float ay, float az, \
+                                const float *tx, const float *ty, const float *tz, \
+                                float *out_Az, float *out_El); \
+    void ComputeSphericalAnglesBatch_##sfx(int n, \
+                                           const float *AzT, const float *ElT, \
+                                           const float *AzR, const float *ElR, \
+                                           float *out_j, float *out_G, \
+                                           float *out_E, float *out_F, float *out_J); \
+    void ComputeSphericalAnglesJGBatch_##sfx(int n, \
+                                             const float *AzT, const float *ElT, \
+                                             const float *AzR, const float *ElR, \
+                                             float *out_j, float *out_G); \
+    void ComputeSphericalAnglesJBatch_##sfx(int n, \
+                                            const float *AzT, const float *ElT, \
+                                            const float *AzR, const float *ElR, \
+                                            float *out_j); \
+    void ComputeInterceptBatch_##sfx(int n, float ax, float ay, float az, float avx, float avy, float avz, \
+                                     float speed, float maxTime, \
+                                     const float *tx, const float *ty, const float *tz, \
+                                     const float *tvx, const float *tvy, const float *tvz, \
+                                     float *out_x, float *out_y, float *out_z, \
+                                     float *out_tgo, float *out_tca, float *out_miss); \
+    void ComputeBasisBatch_##sfx(int n, const float *yaw, const float *pitch, const float *roll, \
+                                 float *out_rx, float *out_ry, float *out_rz, \
+                                 float *out_fx, float *out_fy, float *out_fz, \
+                                 float *out_ux, float *out_uy, float *out_uz, \
+                                 float *out_AzR, float *out_ElR);
+
+DECLARE_ISA(scalar)
+#if defined(WOE_SIMD_X86)
+DECLARE_ISA(sse41)
+DECLARE_ISA(avx2)
+DECLARE_ISA(avx512)
+#endif
+#if defined(WOE_SIMD_NEON)
+DECLARE_ISA(neon)
+#endif
+
+/** Tabela de kernels de uma ISA. */
+typedef struct SimdKernels {
+    void (*azel)(int, float, float, float, const float *, const float *, const float *, float *, float *);
+    void (*spherical)(int, const float *, const float *, const float *, const float *,
+                      float *, float *, float *, float *, float *);
+    void (*sphericalJG)(int, const float *, const float *, const float *, const float *, float *, float *);
+    void (*sphericalJ)(int, const float *, const float *, const float *, const float *, float *);
+    void (*intercept)(int, float, float, float, float, float, float, float, float,
+                      const float *, const float *, const float *, const float *, const float *, const float *,
+                      float *, float *, float *, float *, float *, float *);
+    void (*basis)(int, const float *, const float *, const float *, float *, float *, float *,
+                  float *, float *, float *, float *, float *, float *, float *, float *);
+} SimdKernels;
+
+static const SimdKernels KERNELS[SIMD_ISA_COUNT] = {
+    [SIMD_ISA_SCALAR] = { ComputeAzElBatch_scalar, ComputeSphericalAnglesBatch_scalar,
+                          ComputeSphericalAnglesJGBatch_scalar, ComputeSphericalAnglesJBatch_scalar,
+                          ComputeInterceptBatch_scalar, ComputeBasisBatch_scalar },
+#if defined(WOE_SIMD_X86)
+    [SIMD_ISA_SSE41]  = { ComputeAzElBatch_sse41,  ComputeSphericalAnglesBatch_sse41,
+                          ComputeSphericalAnglesJGBatch_sse41, ComputeSphericalAnglesJBatch_sse41,
+                          ComputeInterceptBatch_sse41, ComputeBasisBatch_sse41 },
+    [SIMD_ISA_AVX2]   = { ComputeAzElBatch_avx2,   ComputeSphericalAnglesBatch_avx2,
+                          ComputeSphericalAnglesJGBatch_avx2, ComputeSphericalAnglesJBatch_avx2,
+                          ComputeInterceptBatch_avx2, ComputeBasisBatch_avx2 },
+    [SIMD_ISA_AVX512] = { ComputeAzElBatch_avx512, ComputeSphericalAnglesBatch_avx512,
+                          ComputeSphericalAnglesJGBatch_avx512, ComputeSphericalAnglesJBatch_avx512,
+                          ComputeInterceptBatch_avx512, ComputeBasisBatch_avx512 },
+#endif
+#if defined(WOE_SIMD_NEON)
+    [SIMD_ISA_NEON]   = { ComputeAzElBatch_neon,   ComputeSphericalAnglesBatch_neon,
+                          ComputeSphericalAnglesJGBatch_neon, ComputeSphericalAnglesJBatch_neon,
+                          ComputeInterceptBatch_neon, ComputeBasisBatch_neon },
+#endif
+};
+
+/**
+ * ISA ativa; -1 até a primeira chamada. Os workers do JobPool despacham por
+ * ela, então só é acessada por WoeAtomicLoad/WoeAtomicStore/WoeAtomicCas.
+ */
+static volatile int activeIsa = -1;
+
+#if defined(WOE_SIMD_X86)
+/** Consulta a CPU (e o suporte do SO a registradores estendidos) por uma ISA x86. */
+static bool CpuHasX86(SimdIsa isa)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    switch (isa) {
+        case SIMD_ISA_SSE41:  return __builtin_cpu_supports("sse4.1");
+        case SIMD_ISA_AVX2:   return __builtin_cpu_supports("avx2");
+        case SIMD_ISA_AVX512: return __builtin_cpu_supports("avx512f");
+        default: return false;
+    }
+#elif defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    bool sse41 = (r[2] & (1 << 19)) != 0;
+    bool osxsave = (r[2] & (1 << 27)) != 0;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(r, 7, 0);
+    switch (isa) {
+        case SIMD_ISA_SSE41:  return sse41;
+        case SIMD_ISA_AVX2:   return (xcr0 & 0x6) == 0x6 && (r[1] & (1 << 5)) != 0;
+        case SIMD_ISA_AVX512: return (xcr0 & 0xe6) == 0xe6 && (r[1] & (1 << 16)) != 0;
+        default: return false;
+    }
+#else
+    return false;
+#endif
+}
+#endif
+
+bool SimdIsaSupported(SimdIsa isa)
+{
+    switch (isa) {
+        case SIMD_ISA_SCALAR: return true;
+#if defined(WOE_SIMD_X86)
+        case SIMD_ISA_SSE41:
+        case SIMD_ISA_AVX2:
+        case SIMD_ISA_AVX512: return CpuHasX86(isa);
+#endif
+#if defined(WOE_SIMD_NEON)
+        case SIMD_ISA_NEON: return true;
+#endif
+        default: return false;
+    }
+}
+
+SimdIsa SimdDetectIsa(void)
+{
+    static const SimdIsa preference[] = { SIMD_ISA_AVX512, SIMD_ISA_AVX2, SIMD_ISA_SSE41, SIMD_ISA_NEON };
+    for (size_t i = 0; i < sizeof(preference)/sizeof(preference[0]); ++i)
+    {
+        if (SimdIsaSupported(preference[i])) return preference[i];
+    }
+    return SIMD_ISA_SCALAR;
+}
+
+SimdIsa SimdGetIsa(void)
+{
+    int isa = WoeAtomicLoad(&activeIsa);
+    if (isa < 0)
+    {
+        // concurrent first calls all detect the same ISA; the CAS only keeps a SimdSetIsa in between
+        int expected = -1;
+        isa = (int)SimdDetectIsa();
+        if (!WoeAtomicCas(&activeIsa, &expected, isa)) isa = expected;
+    }
+    return (SimdIsa)isa;
+}
+
+bool SimdSetIsa(SimdIsa isa)
+{
+    if (isa < 0 || isa >= SIMD_ISA_COUNT || !SimdIsaSupported(isa)) return false;
+    WoeAtomicStore(&activeIsa, (int)isa);
+    return true;
+}
+
+const char *SimdIsaName(SimdIsa isa)
+{
+    switch (isa) {
+        case SIMD_ISA_SCALAR: return "scalar";
+        case SIMD_ISA_SSE41:  return "sse4.1";
+        case SIMD_ISA_AVX2:   return "avx2";
+        case SIMD_ISA_AVX512: return "avx512";
+        case SIMD_ISA_NEON:   return "neon";
+        default: return "?";
+    }
+}
+
+int SimdIsaLanes(SimdIsa isa)
+{
+    switch (isa) {
+        case SIMD_ISA_SSE41:  return 4;
+        case SIMD_ISA_AVX2:   return 8;
+        case SIMD_ISA_AVX512: return 16;
+        case SIMD_ISA_NEON:   return 4;
+        default: return 1;
+    }
+}
+
+void ComputeAzElBatch(int n, float ax, float ay, float az,
+                      const float *tx, const float *ty, const float *tz,
+                      float *out_Az, float *out_El)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].azel(n, ax, ay, az, tx, ty, tz, out_Az, out_El);
+}
+
+void ComputeSphericalAnglesBatch(int n,
+                                 const float *AzT, const float *ElT,
+                                 const float *AzR, const float *ElR,
+                                 float *out_j, float *out_G,
+                                 float *out_E, float *out_F, float *out_J)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].spherical(n, AzT, ElT, AzR, ElR, out_j, out_G, out_E, out_F, out_J);
+}
+
+void ComputeSphericalAnglesJGBatch(int n,
+                                   const float *AzT, const float *ElT,
+                                   const float *AzR, const float *ElR,
+                                   float *out_j, float *out_G)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].sphericalJG(n, AzT, ElT, AzR, ElR, out_j, out_G);
+}
+
+void ComputeSphericalAnglesJBatch(int n,
+                                  const float *AzT, const float *ElT,
+                                  const float *AzR, const float *ElR,
+                                  float *out_j)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].sphericalJ(n, AzT, ElT, AzR, ElR, out_j);
+}
+
+void ComputeInterceptBatch(int n, float ax, float ay, float az, float avx, float avy, float avz,
+                           float speed, float maxTime,
+                           const float *tx, const float *ty, const float *tz,
+                           const float *tvx, const float *tvy, const float *tvz,
+                           float *out_x, float *out_y, float *out_z,
+                           float *out_tgo, float *out_tca, float *out_miss)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].intercept(n, ax, ay, az, avx, avy, avz, speed, maxTime, tx, ty, tz, tvx, tvy, tvz,
+                                    out_x, out_y, out_z, out_tgo, out_tca, out_miss);
+}
+
+void ComputeBasisBatch(int n, const float *yaw, const float *pitch, const float *roll,
+                       float *out_rx, float *out_ry, float *out_rz,
+                       float *out_fx, float *out_fy, float *out_fz,
+                       float *out_ux, float *out_uy, float *out_uz,
+                       float *out_AzR, float *out_ElR)
+{
+    if (n <= 0) return;
+    KERNELS[SimdGetIsa()].basis(n, yaw, pitch, roll, out_rx, out_ry, out_rz, out_fx, out_fy, out_fz,
+                                out_ux, out_uy, out_uz, out_AzR, out_ElR);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file angles_simd.h
+ * @brief Versões em lote (SIMD) de ComputeAzEl, ComputeSphericalAngles, da base de orientação e da interceptação, com despacho por ISA.
+ *
+ * Os kernels processam 4 (SSE4.1/NEON), 8 (AVX2) ou 16 (AVX-512) lanes por
+ * iteração. A ISA é escolhida em tempo de execução na primeira chamada (a melhor
+ * suportada pela CPU) e pode ser forçada com SimdSetIsa().
+ *
+ * Precisão: seno/cosseno/atan2/asin/acos usam polinômios do Cephes em float.
+ * Todas as ISAs (inclusive a de referência escalar polinomial) são bit a bit
+ * idênticas entre si. Em relação ao caminho escalar da libm (medido em 10^6
+ * amostras uniformes mais casos com El = ±90° e T = R):
+ *  - Az/El de ComputeAzElBatch: até SIMD_AZEL_MAX_ULP ULP;
+ *  - E e J: erro absoluto até SIMD_ANGLES_ERR_BOUND rad;
+ *  - j: |Δj|·sin(j) até SIMD_ANGLES_ERR_BOUND;
+ *  - F e G: |ΔF|·sin²(j)·cos(F) até SIMD_ANGLES_ERR_BOUND.
+ *
+ * Os fatores sin(j) e cos(F) refletem o condicionamento da própria cadeia
+ * acos -> cos -> acos -> asin: perto de j = 0, j = pi e |F| = 90° qualquer
+ * diferença de arredondamento (inclusive entre duas libm) é amplificada, e ali
+ * nem o caminho escalar tem dígitos significativos a comparar.
+ */
+#ifndef WOE_ANGLES_SIMD_H
+#define WOE_ANGLES_SIMD_H
+
+#include <stdbool.h>
+
+/** Limite documentado (rad) do erro condicionado dos ângulos esféricos em lote vs. libm. */
+#define SIMD_ANGLES_ERR_BOUND 2e-6f
+/** Limite documentado (ULP) de Az/El em lote vs. libm. */
+#define SIMD_AZEL_MAX_ULP 4
+
+/** Conjuntos de instruções suportados pelos kernels em lote. */
+typedef enum SimdIsa {
+    SIMD_ISA_SCALAR = 0, /**< Referência portátil (1 lane), mesmos polinômios. */
+    SIMD_ISA_SSE41,      /**< x86 SSE4.1, 4 lanes. */
+    SIMD_ISA_AVX2,       /**< x86 AVX2, 8 lanes. */
+    SIMD_ISA_AVX512,     /**< x86 AVX-512F, 16 lanes. */
+    SIMD_ISA_NEON,       /**< AArch64 NEON, 4 lanes. */
+    SIMD_ISA_COUNT
+} SimdIsa;
+
+/** @brief Melhor ISA suportada por esta CPU e por este binário. */
+SimdIsa SimdDetectIsa(void);
+
+/** @brief ISA em uso pelos kernels em lote. */
+SimdIsa SimdGetIsa(void);
+
+/**
+ * @brief Força a ISA usada pelos kernels em lote.
+ * @return false (e mantém a atual) se a ISA não for suportada.
+ */
+bool SimdSetIsa(SimdIsa isa);
+
+/** @brief Informa se a ISA está compilada neste binário e é suportada pela CPU. */
+bool SimdIsaSupported(SimdIsa isa);
+
+/** @brief Nome curto da ISA ("scalar", "sse4.1", "avx2", "avx512", "neon"). */
+const char *SimdIsaName(SimdIsa isa);
+
+/** @brief Número de lanes float da ISA. */
+int SimdIsaLanes(SimdIsa isa);
+
+/**
+ * @brief Az/El de @p n alvos em relação à aeronave (ax, ay, az).
+ *
+ * Equivale a ComputeAzEl(A, T[i], &Az[i], &El[i]) para cada i.
+ * Saídas NULL são ignoradas.
+ */
+void ComputeAzElBatch(int n, float ax, float ay, float az,
+                      const float *tx, const float *ty, const float *tz,
+                      float *out_Az, float *out_El);
+
+/**
+ * @brief Ângulos esféricos de @p n pares a partir de arrays de Az/El do alvo e do vetor frente.
+ *
+ * Equivale a ComputeSphericalAngles elemento a elemento. Saídas NULL são ignoradas.
+ * As entradas e saídas podem ter qualquer alinhamento.
+ */
+void ComputeSphericalAnglesBatch(int n,
+                                 const float *AzT, const float *ElT,
+                                 const float *AzR, const float *ElR,
+                                 float *out_j, float *out_G,
+                                 float *out_E, float *out_F, float *out_J);
+
+/**
+ * @brief ComputeSphericalAnglesBatch só com j e G, as saídas que o HUD e o descarte leem.
+ *
+ * Mesmos valores da versão completa, bit a bit, sem os testes de NULL nem as
+ * gravações de E, F e J. As duas saídas são obrigatórias. G depende de E e F,
+ * então a trigonometria é quase a mesma: o ganho é de memória e de desvios.
+ */
+void ComputeSphericalAnglesJGBatch(int n,
+                                   const float *AzT, const float *ElT,
+                                   const float *AzR, const float *ElR,
+                                   float *out_j, float *out_G);
+
+/**
+ * @brief ComputeSphericalAnglesBatch só com j (p.ex. o teste de cone).
+ *
+ * Para em j: sem E, F e G, poupa um atan2, um asin, um sincos e duas divisões
+ * por lane. Mesmo j da versão completa, bit a bit; @p out_j é obrigatória.
+ */
+void ComputeSphericalAnglesJBatch(int n,
+                                  const float *AzT, const float *ElT,
+                                  const float *AzR, const float *ElR,
+                                  float *out_j);
+
+/**
+ * @brief Ponto de mira, tempo até a interceptação e maior aproximação de @p n alvos.
+ *
+ * A aeronave está em (ax, ay, az) com velocidade (avx, avy, avz); o
+ * interceptador sai dela com velocidade @p speed relativa à aeronave (herda a
+ * velocidade dela). Para cada alvo com posição (tx, ty, tz)[i] e velocidade
+ * (tvx, tvy, tvz)[i]:
+ *  - out_tgo: menor t em [0, @p maxTime) com |r + w*t| = speed*t (r e w relativos
+ *    à aeronave), ou -1 se não houver;
+ *  - out_tca, out_miss: instante (>= 0) e distância da maior aproximação sem manobra;
+ *  - out_x/y/z: ponto de mira em coordenadas do mundo, A + r + w*tgo (ou
+ *    A + r + w*tca sem interceptação); a direção A -> mira é a de perseguição
+ *    com avanço, e pode ir direto para ComputeAzElBatch como alvo.
+ *
+ * Só somas, produtos, divisões, raiz e seleções: bit a bit igual em todas as ISAs.
+ * out_x/y/z são obrigatórias; as demais saídas podem ser NULL.
+ */
+void ComputeInterceptBatch(int n, float ax, float ay, float az, float avx, float avy, float avz,
+                           float speed, float maxTime,
+                           const float *tx, const float *ty, const float *tz,
+                           const float *tvx, const float *tvy, const float *tvz,
+                           float *out_x, float *out_y, float *out_z,
+                           float *out_tgo, float *out_tca, float *out_miss);
+
+/**
+ * @brief Base de orientação e Az/El do vetor frente de @p n orientações yaw/pitch/roll.
+ *
+ * Equivale a BasisFromYPR seguido de ComputeAzElFromVector(fwd) elemento a
+ * elemento, com os polinômios do nível float: seno e cosseno de cada ângulo
+ * saem da mesma redução de argumento, e o vetor frente é bit a bit igual a
+ * ForwardFromYPR no nível float. São seis funções transcendentais por lane
+ * (três sincos e dois atan2), sem normalização nem produto vetorial.
+ *
+ * Qualquer saída pode ser NULL e é então ignorada, coluna a coluna, tanto no
+ * laço vetorial quanto na cauda; o atan2 do Az/El só é avaliado se AzR ou
+ * ElR for pedido.
+ */
+void ComputeBasisBatch(int n, const float *yaw, const float *pitch, const float *roll,
+                       float *out_rx, float *out_ry, float *out_rz,
+                       float *out_fx, float *out_fy, float *out_fz,
+                       float *out_ux, float *out_uy, float *out_uz,
+                       float *out_AzR, float *out_ElR);
+
+#endif /* WOE_ANGLES_SIMD_H */
@@ -0,0 +1,33 @@
+/**
+ * @file angles_sse41.c
+ * @brief Instância SSE4.1 (4 lanes) do kernel em lote. Compilada com -msse4.1.
+ */
+#include <smmintrin.h>
+
+typedef __m128 V;
+typedef __m128 M;
+#define VLEN 4
+
+#define V_SET1(x)      _mm_set1_ps(x)
+#define V_LOAD(p)      _mm_loadu_ps(p)
+#define V_STORE(p, v)  _mm_storeu_ps((p), (v))
+#define V_ADD(a, b)    _mm_add_ps((a), (b))
+#define V_SUB(a, b)    _mm_sub_ps((a), (b))
+#define V_MUL(a, b)    _mm_mul_ps((a), (b))
+#define V_DIV(a, b)    _mm_div_ps((a), (b))
+#define V_SQRT(a)      _mm_sqrt_ps(a)
+#define V_MIN(a, b)    _mm_min_ps((a), (b))
+#define V_MAX(a, b)    _mm_max_ps((a), (b))
+#define V_FLOOR(a)     _mm_floor_ps(a)
+#define V_ABS(a)       _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+#define V_SIGN(a)      _mm_and_ps(_mm_set1_ps(-0.0f), (a))
+#define V_XOR(a, b)    _mm_xor_ps((a), (b))
+#define M_GT(a, b)     _mm_cmpgt_ps((a), (b))
+#define M_LT(a, b)     _mm_cmplt_ps((a), (b))
+#define M_EQ(a, b)     _mm_cmpeq_ps((a), (b))
+#define M_AND(a, b)    _mm_and_ps((a), (b))
+#define M_OR(a, b)     _mm_or_ps((a), (b))
+#define V_SEL(m, a, b) _mm_blendv_ps((b), (a), (m))
+#define SIMD_FN(name)  name##_sse41
+
+#include "angles_kernel.h"
@@ -0,0 +1,294 @@
+/**
+ * @file spatial.c
+ * @brief Grade uniforme com hash espacial e solver restrito aos candidatos.
+ */
+#include "spatial.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Coordenadas de célula são limitadas a ±2^20 para o hash não estourar. */
+#define CELL_COORD_LIMIT (1 << 20)
+
+static inline int CellCoord(float v, float invCell)
+{
+    float c = floorf(v*invCell);
+    if (c > (float)CELL_COORD_LIMIT) return CELL_COORD_LIMIT;
+    if (c < -(float)CELL_COORD_LIMIT) return -CELL_COORD_LIMIT;
+    return (int)c;
+}
+
+static inline int CellBucket(const SpatialGrid *g, int ix, int iy, int iz)
+{
+    unsigned int h = (unsigned int)ix*73856093u ^ (unsigned int)iy*19349663u ^ (unsigned int)iz*83492791u;
+    return (int)(h & (unsigned int)(g->buckets - 1));
+}
+
+static inline int EntityBucket(const SpatialGrid *g, const EntityStore *s, int i)
+{
+    return CellBucket(g, CellCoord(s->x[i], g->invCell), CellCoord(s->y[i], g->invCell), CellCoord(s->z[i], g->invCell));
+}
+
+bool SpatialGridInit(SpatialGrid *g, int capacity, float cellSize)
+{
+    memset(g, 0, sizeof(*g));
+    if (capacity < 1) capacity = 1;
+    if (!(cellSize > 0.0f)) cellSize = 1.0f;
+    int buckets = 64;
+    while (buckets < 2*capacity) buckets *= 2;
+
+    g->cellSize = cellSize;
+    g->invCell = 1.0f/cellSize;
+    g->buckets = buckets;
+    g->capacity = capacity;
+    g->head = (int *)malloc(sizeof(int)*(size_t)buckets);
+    g->next = (int *)malloc(sizeof(int)*(size_t)capacity*3);
+    if (!g->head || !g->next) { SpatialGridFree(g); return false; }
+    g->prev = g->next + capacity;
+    g->bucketOf = g->prev + capacity;
+    memset(g->head, 0xff, sizeof(int)*(size_t)buckets);
+    memset(g->bucketOf, 0xff, sizeof(int)*(size_t)capacity);
+    return true;
+}
+
+void SpatialGridFree(SpatialGrid *g)
+{
+    free(g->head);
+    free(g->next);
+    memset(g, 0, sizeof(*g));
+}
+
+void SpatialGridCopy(SpatialGrid *dst, const SpatialGrid *src)
+{
+    if (dst->buckets != src->buckets || dst->capacity != src->capacity) return;
+    memcpy(dst->head, src->head, sizeof(int)*(size_t)src->buckets);
+    memcpy(dst->next, src->next, sizeof(int)*(size_t)src->capacity*3);
+    dst->count = src->count;
+    dst->moved = src->moved;
+}
+
+static void Unlink(SpatialGrid *g, int i)
+{
+    int b = g->bucketOf[i];
+    if (b < 0) return;
+    if (g->prev[i] >= 0) g->next[g->prev[i]] = g->next[i];
+    else g->head[b] = g->next[i];
+    if (g->next[i] >= 0) g->prev[g->next[i]] = g->prev[i];
+    g->bucketOf[i] = -1;
+}
+
+static void Link(SpatialGrid *g, int i, int b)
+{
+    g->prev[i] = -1;
+    g->next[i] = g->head[b];
+    if (g->head[b] >= 0) g->prev[g->head[b]] = i;
+    g->head[b] = i;
+    g->bucketOf[i] = b;
+}
+
+void SpatialGridUpdate(SpatialGrid *g, const EntityStore *s)
+{
+    int n = s->count < g->capacity ? s->count : g->capacity;
+    int moved = 0;
+    for (int i = n; i < g->count; ++i) Unlink(g, i);
+    for (int i = 0; i < n; ++i)
+    {
+        int b = EntityBucket(g, s, i);
+        if (b == g->bucketOf[i]) continue;
+        Unlink(g, i);
+        Link(g, i, b);
+        ++moved;
+    }
+    g->count = n;
+    g->moved = moved;
+}
+
+/** Filtro por alvo de uma consulta. */
+typedef struct ConeTest {
+    WoeVec3 apex, fwd;
+    float range2;
+    float cosJ;
+    bool angular;
+} ConeTest;
+
+static inline bool ConeAccepts(const ConeTest *c, float x, float y, float z)
+{
+    float dx = x - c->apex.x, dy = y - c->apex.y, dz = z - c->apex.z;
+    float d2 = dx*dx + dy*dy + dz*dz;
+    if (d2 > c->range2) return false;
+    if (!c->angular) return true;
+    float dot = dx*c->fwd.x + dy*c->fwd.y + dz*c->fwd.z;
+    // dot >= |d| cos(jMax), without the square root when both sides are non-negative
+    if (c->cosJ >= 0.0f) return dot >= 0.0f && dot*dot >= d2*c->cosJ*c->cosJ;
+    return dot >= 0.0f || dot*dot <= d2*c->cosJ*c->cosJ;
+}
+
+int SpatialQueryCone(const SpatialGrid *g, const EntityStore *s, WoeVec3 apex, WoeVec3 fwd,
+                     float range, float jMax, int *out, int maxOut)
+{
+    if (g->count == 0 || !(range >= 0.0f)) return 0;
+    ConeTest c = { apex, fwd, range*range, cosf(jMax), jMax < (float)M_PI };
+    int found = 0;
+
+    // exact box of the spherical sector: along axis k the reachable directions span
+    // angles [alpha_k - jMax, alpha_k + jMax] from e_k, where alpha_k = acos(fwd_k)
+    int lo[3], hi[3];
+    const float p[3] = { apex.x, apex.y, apex.z };
+    const float f[3] = { fwd.x, fwd.y, fwd.z };
+    double cells = 1.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        float uMax = 1.0f, uMin = -1.0f;
+        if (c.angular)
+        {
+            float alpha = acosf(f[k] < -1.0f ? -1.0f : f[k] > 1.0f ? 1.0f : f[k]);
+            uMax = alpha - jMax <= 0.0f ? 1.0f : cosf(alpha - jMax);
+            uMin = alpha + jMax >= (float)M_PI ? -1.0f : cosf(alpha + jMax);
+        }
+        lo[k] = CellCoord(p[k] + range*(uMin < 0.0f ? uMin : 0.0f), g->invCell);
+        hi[k] = CellCoord(p[k] + range*(uMax > 0.0f ? uMax : 0.0f), g->invCell);
+        cells *= (double)(hi[k] - lo[k] + 1);
+    }
+
+    if (cells > (double)g->buckets)
+    {
+        // the query box covers more cells than there are buckets: scan each bucket once
+        for (int b = 0; b < g->buckets && found < maxOut; ++b)
+        {
+            for (int i = g->head[b]; i >= 0 && found < maxOut; i = g->next[i])
+            {
+                if (ConeAccepts(&c, s->x[i], s->y[i], s->z[i])) out[found++] = i;
+            }
+        }
+        return found;
+    }
+
+    // bounding-sphere radius of a cell, for rejecting whole cells by range and cone.
+    // A sphere touches the cone only if its centre lies in the cone widened by moving
+    // the apex back by rc/sin(jMax) along -fwd (conservative, no trig per cell).
+    float rc = 0.8660254f*g->cellSize;
+    float sinJ = sinf(jMax);
+    bool cellCone = c.angular && jMax < 0.5f*(float)M_PI && sinJ > 1e-4f;
+    float back = cellCone ? rc/sinJ : 0.0f;
+    for (int iz = lo[2]; iz <= hi[2]; ++iz)
+    for (int iy = lo[1]; iy <= hi[1]; ++iy)
+    for (int ix = lo[0]; ix <= hi[0]; ++ix)
+    {
+        int b = CellBucket(g, ix, iy, iz);
+        if (g->head[b] < 0) continue;
+
+        float cx = ((float)ix + 0.5f)*g->cellSize - apex.x;
+        float cy = ((float)iy + 0.5f)*g->cellSize - apex.y;
+        float cz = ((float)iz + 0.5f)*g->cellSize - apex.z;
+        float d2 = cx*cx + cy*cy + cz*cz;
+        if (d2 > (range + rc)*(range + rc)) continue;
+        if (cellCone)
+        {
+            float bx = cx + back*fwd.x, by = cy + back*fwd.y, bz = cz + back*fwd.z;
+            float dot = bx*fwd.x + by*fwd.y + bz*fwd.z;
+            if (dot < 0.0f || dot*dot < (bx*bx + by*by + bz*bz)*c.cosJ*c.cosJ) continue;
+        }
+
+        for (int i = g->head[b]; i >= 0; i = g->next[i])
+        {
+            // buckets are shared by colliding cells: keep only members of this cell
+            if (CellCoord(s->x[i], g->invCell) != ix || CellCoord(s->y[i], g->invCell) != iy ||
+                CellCoord(s->z[i], g->invCell) != iz) continue;
+            if (!ConeAccepts(&c, s->x[i], s->y[i], s->z[i])) continue;
+            if (found == maxOut) return found;
+            out[found++] = i;
+        }
+    }
+    return found;
+}
+
+int SpatialQueryRange(const SpatialGrid *g, const EntityStore *s, WoeVec3 center, float range,
+                      int *out, int maxOut)
+{
+    return SpatialQueryCone(g, s, center, (WoeVec3){ 0.0f, 0.0f, 1.0f }, range, (float)M_PI, out, maxOut);
+}
+
+bool CandidatePairsInit(CandidatePairs *c, int maxAircraft, int maxTargets)
+{
+    memset(c, 0, sizeof(*c));
+    if (maxAircraft < 1) maxAircraft = 1;
+    if (maxTargets < 1) maxTargets = 1;
+    // rows start on a lane boundary so each row's batch kernel sees aligned data
+    int stride = (maxTargets + ENTITY_LANE_PAD - 1)/ENTITY_LANE_PAD*ENTITY_LANE_PAD;
+    c->stride = stride;
+    c->count = (int *)calloc((size_t)maxAircraft, sizeof(int));
+    c->target = (int *)malloc(sizeof(int)*(size_t)maxAircraft*(size_t)stride);
+    bool ok = c->count && c->target && EntityStoreInit(&c->gather, maxAircraft*stride) &&
+              PairResultsInit(&c->pairs, maxAircraft*stride);
+    if (!ok) { CandidatePairsFree(c); return false; }
+    c->pairs.targets = stride;
+    return true;
+}
+
+void CandidatePairsFree(CandidatePairs *c)
+{
+    free(c->count);
+    free(c->target);
+    EntityStoreFree(&c->gather);
+    PairResultsFree(&c->pairs);
+    memset(c, 0, sizeof(*c));
+}
+
+/** Contexto de um despacho de SolveEngagementsCulled. */
+typedef struct CulledSolve {
+    const EntityStore *air;
+    const EntityStore *tgt;
+    const SpatialGrid *grid;
+    CandidatePairs *out;
+    float range, jMax;
+    SolverMode mode;
+} CulledSolve;
+
+static void SolveCulledRow(void *ctx, int a, int worker)
+{
+    const CulledSolve *cs = (const CulledSolve *)ctx;
+    CandidatePairs *c = cs->out;
+    const EntityStore *tgt = cs->tgt;
+    (void)worker;
+
+    WoeVec3 apex = { cs->air->x[a], cs->air->y[a], cs->air->z[a] };
+    WoeVec3 fwd;
+    float AzR, ElR;
+    EntityForward(cs->air, a, &fwd, &AzR, &ElR);
+    int base = a*c->stride;
+    int *idx = c->target + base;
+    int n = SpatialQueryCone(cs->grid, tgt, apex, fwd, cs->range, cs->jMax, idx, c->stride);
+
+    float *gx = c->gather.x + base, *gy = c->gather.y + base, *gz = c->gather.z + base;
+    float *gvx = c->gather.vx + base, *gvy = c->gather.vy + base, *gvz = c->gather.vz + base;
+    for (int k = 0; k < n; ++k)
+    {
+        gx[k] = tgt->x[idx[k]]; gy[k] = tgt->y[idx[k]]; gz[k] = tgt->z[idx[k]];
+        // velocities ride along for the lead predictor, which reuses the candidate rows
+        gvx[k] = tgt->vx[idx[k]]; gvy[k] = tgt->vy[idx[k]]; gvz[k] = tgt->vz[idx[k]];
+    }
+    SolveEngagementRow(cs->air, a, n, gx, gy, gz, &c->pairs, base, cs->mode);
+    c->count[a] = n;
+}
+
+void SolveEngagementsCulled(JobPool *pool, const EntityStore *air, const EntityStore *tgt, const SpatialGrid *grid,
+                            float range, float jMax, CandidatePairs *out, SolverMode mode)
+{
+    if (air->count*out->stride > out->pairs.capacity) return;
+    out->aircraft = air->count;
+    out->pairs.aircraft = air->count;
+
+    CulledSolve cs = { air, tgt, grid, out, range, jMax, mode };
+    if (pool && JobPoolThreads(pool) > 1)
+    {
+        JobPoolRun(pool, air->count, SolveCulledRow, &cs);
+    }
+    else
+    {
+        for (int a = 0; a < air->count; ++a) SolveCulledRow(&cs, a, 0);
+    }
+
+    out->total = 0;
+    for (int a = 0; a < air->count; ++a) out->total += out->count[a];
+}
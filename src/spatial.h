@@ -0,0 +1,109 @@
+/**
+ * @file spatial.h
+ * @brief Grade uniforme (hash espacial) sobre posições de alvos e consultas por alcance/cone.
+ *
+ * Cada alvo fica na lista encadeada do bucket da sua célula; SpatialGridUpdate()
+ * só religa os alvos que mudaram de célula desde a última chamada. As consultas
+ * descartam células inteiras pelo alcance e pelo cone (ângulo j máximo em torno
+ * do vetor frente) antes de testar cada alvo, para que o solver de ângulos rode
+ * apenas nos candidatos (SolveEngagementsCulled()).
+ */
+#ifndef WOE_SPATIAL_H
+#define WOE_SPATIAL_H
+
+#include <stdbool.h>
+#include "entities.h"
+#include "geometry.h"
+#include "jobs.h"
+
+/** Grade uniforme com buckets por hash das coordenadas inteiras da célula. */
+typedef struct SpatialGrid {
+    float cellSize;     /**< Aresta da célula (unid). */
+    float invCell;      /**< 1/cellSize. */
+    int buckets;        /**< Número de buckets (potência de 2). */
+    int capacity;       /**< Máximo de entidades. */
+    int count;          /**< Entidades inseridas na última atualização. */
+    int moved;          /**< Entidades religadas na última atualização. */
+    int *head;          /**< [buckets] primeira entidade do bucket, -1 se vazio. */
+    int *next;          /**< [capacity] próxima entidade do mesmo bucket. */
+    int *prev;          /**< [capacity] entidade anterior do mesmo bucket, -1 na cabeça. */
+    int *bucketOf;      /**< [capacity] bucket atual, -1 se fora da grade. */
+} SpatialGrid;
+
+/**
+ * @brief Cria uma grade vazia para até @p capacity entidades.
+ * @param cellSize Aresta da célula; algo como 1/4 do alcance típico de consulta.
+ */
+bool SpatialGridInit(SpatialGrid *g, int capacity, float cellSize);
+
+/** @brief Libera a grade e a deixa zerada. */
+void SpatialGridFree(SpatialGrid *g);
+
+/**
+ * @brief Copia buckets e listas de @p src para @p dst, criada com a mesma capacidade e célula.
+ *
+ * A ordem dentro dos buckets depende do histórico de SpatialGridUpdate; a
+ * cópia a preserva, para que uma simulação restaurada consulte os candidatos
+ * na mesma ordem.
+ */
+void SpatialGridCopy(SpatialGrid *dst, const SpatialGrid *src);
+
+/**
+ * @brief Sincroniza a grade com as posições de @p s (incremental).
+ *
+ * Entidades que continuam na mesma célula não são tocadas; as que saíram de
+ * [0, s->count) são removidas. Após a chamada, g->moved conta as religadas.
+ */
+void SpatialGridUpdate(SpatialGrid *g, const EntityStore *s);
+
+/**
+ * @brief Alvos a até @p range de @p apex e a no máximo @p jMax (rad) de @p fwd.
+ *
+ * @param s Store com as mesmas posições da última SpatialGridUpdate.
+ * @param fwd Vetor frente unitário (p.ex. ForwardFromYPR).
+ * @param jMax Meio-ângulo do cone; >= pi desativa o teste angular.
+ * @param out [out] Índices dos alvos aceitos, em ordem de bucket.
+ * @param maxOut Capacidade de @p out; o excedente é descartado.
+ * @return Número de índices gravados.
+ */
+int SpatialQueryCone(const SpatialGrid *g, const EntityStore *s, WoeVec3 apex, WoeVec3 fwd,
+                     float range, float jMax, int *out, int maxOut);
+
+/** @brief Alvos a até @p range de @p center (SpatialQueryCone sem teste angular). */
+int SpatialQueryRange(const SpatialGrid *g, const EntityStore *s, WoeVec3 center, float range,
+                      int *out, int maxOut);
+
+/**
+ * @brief Pares candidatos e seus resultados, em linhas de @c stride posições por aeronave.
+ *
+ * O k-ésimo candidato da aeronave a (k < count[a]) é o alvo target[i] com
+ * resultados em pairs no índice i = PairIndex(&pairs, a, k) = a*stride + k.
+ */
+typedef struct CandidatePairs {
+    int aircraft;       /**< Aeronaves do último passe. */
+    int stride;         /**< Posições por linha (capacidade de alvos). */
+    int total;          /**< Soma de count[] no último passe. */
+    int *count;         /**< [aeronaves] candidatos por aeronave. */
+    int *target;        /**< [aeronaves*stride] índice do alvo de cada posição. */
+    EntityStore gather; /**< Posições e velocidades dos candidatos reunidas em SoA (sem orientação). */
+    PairResults pairs;  /**< Resultados por posição; pairs.targets == stride. */
+} CandidatePairs;
+
+/** @brief Reserva linhas para @p maxAircraft aeronaves com até @p maxTargets candidatos cada. */
+bool CandidatePairsInit(CandidatePairs *c, int maxAircraft, int maxTargets);
+
+/** @brief Libera os buffers e deixa a estrutura zerada. */
+void CandidatePairsFree(CandidatePairs *c);
+
+/**
+ * @brief SolveEngagements apenas nos alvos dentro de @p range e do cone @p jMax de cada aeronave.
+ *
+ * Para cada aeronave consulta @p grid (que deve estar atualizada para @p tgt),
+ * reúne as posições dos candidatos e resolve só esses pares com os mesmos
+ * kernels de SolveEngagements. As aeronaves são distribuídas em @p pool (pode
+ * ser NULL). Nada é alocado por chamada.
+ */
+void SolveEngagementsCulled(JobPool *pool, const EntityStore *air, const EntityStore *tgt, const SpatialGrid *grid,
+                            float range, float jMax, CandidatePairs *out, SolverMode mode);
+
+#endif /* WOE_SPATIAL_H */
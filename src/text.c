@@ -0,0 +1,334 @@
+/**
+ * @file text.c
+ * @brief Texto em lote com glifos pré-calculados e linhas formatadas em cache (veja text.h).
+ */
+#include "text.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Espaço vertical extra entre linhas de um mesmo texto, o padrão de DrawText (px). */
+#define TEXT_LINE_SPACING 2
+/** Quads enviados por bloco rlBegin/rlEnd; cabe folgado no batch padrão da rlgl. */
+#define TEXT_BATCH_CHUNK 2048
+
+static void BakeGlyph(TextGlyph *g, const Font *font, int i)
+{
+    Rectangle rec = font->recs[i];
+    float pad = (float)font->glyphPadding;
+    float tw = (float)font->texture.width, th = (float)font->texture.height;
+    // same source/destination rectangles as DrawTextCodepoint, in base-size pixels
+    g->u0 = (rec.x - pad)/tw;
+    g->v0 = (rec.y - pad)/th;
+    g->u1 = (rec.x + rec.width + pad)/tw;
+    g->v1 = (rec.y + rec.height + pad)/th;
+    g->x = (float)font->glyphs[i].offsetX - pad;
+    g->y = (float)font->glyphs[i].offsetY - pad;
+    g->w = rec.width + 2.0f*pad;
+    g->h = rec.height + 2.0f*pad;
+    g->advance = font->glyphs[i].advanceX == 0 ? rec.width : (float)font->glyphs[i].advanceX;
+    g->blank = font->glyphs[i].value == ' ' || font->glyphs[i].value == '\t';
+}
+
+bool TextBatchInit(TextBatch *b, Font font, int capacity)
+{
+    memset(b, 0, sizeof(*b));
+    if (font.texture.id == 0 || font.glyphCount <= 0) return false;
+    b->atlas = font.texture;
+    b->baseSize = font.baseSize > 0 ? font.baseSize : 10;
+
+    int index[TEXT_GLYPH_COUNT];
+    for (int c = 0; c < TEXT_GLYPH_COUNT; ++c) index[c] = -1;
+    for (int i = 0; i < font.glyphCount; ++i)
+    {
+        int c = font.glyphs[i].value - TEXT_GLYPH_FIRST;
+        if (c >= 0 && c < TEXT_GLYPH_COUNT && index[c] < 0) index[c] = i;
+    }
+    // codepoints missing from the font fall back to '?', as GetGlyphIndex does
+    int fallback = index['?' - TEXT_GLYPH_FIRST];
+    for (int c = 0; c < TEXT_GLYPH_COUNT; ++c)
+    {
+        int i = index[c] >= 0 ? index[c] : fallback;
+        if (i >= 0) BakeGlyph(&b->glyphs[c], &font, i);
+        else b->glyphs[c].blank = true;
+    }
+
+    if (capacity < 0) capacity = 0;
+    b->quads = capacity > 0 ? (TextQuad *)malloc(sizeof(TextQuad)*(size_t)capacity) : NULL;
+    if (capacity > 0 && !b->quads) { TextBatchFree(b); return false; }
+    b->capacity = capacity;
+    return true;
+}
+
+void TextBatchFree(TextBatch *b)
+{
+    if (!b->arena) free(b->quads);
+    memset(b, 0, sizeof(*b));
+}
+
+void TextBatchClear(TextBatch *b)
+{
+    b->count = 0;
+}
+
+void TextBatchBegin(TextBatch *b, FrameArena *arena, int capacity)
+{
+    if (!b->arena) free(b->quads);
+    size_t got;
+    b->quads = (TextQuad *)FrameArenaAllocUpTo(arena, sizeof(TextQuad)*(size_t)(capacity > 1 ? capacity : 1),
+                                               sizeof(TextQuad), &got);
+    b->arena = arena;
+    b->capacity = (int)(got/sizeof(TextQuad));
+    b->count = 0;
+    b->flushes = 0;
+}
+
+/** Garante espaço para mais @p extra quads; dobra a capacidade quando preciso, ou desenha o que há se o espaço for da arena. */
+static bool TextBatchReserve(TextBatch *b, int extra)
+{
+    if (b->count + extra <= b->capacity) return true;
+    if (b->arena)
+    {
+        if (extra > b->capacity) return false;
+        TextBatchDraw(b);
+        b->count = 0;
+        b->flushes++;
+        return true;
+    }
+    int cap = b->capacity > 0 ? b->capacity : 1;
+    while (cap < b->count + extra) cap *= 2;
+    TextQuad *q = (TextQuad *)realloc(b->quads, sizeof(TextQuad)*(size_t)cap);
+    if (!q) return false;
+    b->quads = q;
+    b->capacity = cap;
+    return true;
+}
+
+/** Próximo código de @p *s (UTF-8 de até 2 bytes; o resto vira '?'), avançando o ponteiro. */
+static int NextCodepoint(const unsigned char **s)
+{
+    const unsigned char *p = *s;
+    int c = p[0];
+    if (c < 0x80) { *s = p + 1; return c; }
+    if ((c & 0xe0) == 0xc0 && (p[1] & 0xc0) == 0x80)
+    {
+        *s = p + 2;
+        return ((c & 0x1f) << 6) | (p[1] & 0x3f);
+    }
+    // longer sequences are outside the glyph table: skip their continuation bytes
+    ++p;
+    while ((*p & 0xc0) == 0x80) ++p;
+    *s = p;
+    return '?';
+}
+
+void TextBatchAdd(TextBatch *b, const char *text, int x, int y, int fontSize, Color col)
+{
+    // DrawText's clamping and spacing
+    if (fontSize < 10) fontSize = 10;
+    float spacing = (float)(fontSize/10);
+    float scale = (float)fontSize/(float)b->baseSize;
+    int len = (int)strlen(text);
+    if (!TextBatchReserve(b, len)) return;
+
+    float penX = (float)x, penY = (float)y;
+    const unsigned char *s = (const unsigned char *)text;
+    while (*s)
+    {
+        int c = NextCodepoint(&s);
+        if (c == '\n')
+        {
+            penX = (float)x;
+            penY += (float)(fontSize + TEXT_LINE_SPACING);
+            continue;
+        }
+        c -= TEXT_GLYPH_FIRST;
+        const TextGlyph *g = &b->glyphs[c >= 0 && c < TEXT_GLYPH_COUNT ? c : '?' - TEXT_GLYPH_FIRST];
+        if (!g->blank)
+        {
+            TextQuad *q = &b->quads[b->count++];
+            q->x0 = penX + g->x*scale;
+            q->y0 = penY + g->y*scale;
+            q->x1 = q->x0 + g->w*scale;
+            q->y1 = q->y0 + g->h*scale;
+            q->u0 = g->u0; q->v0 = g->v0; q->u1 = g->u1; q->v1 = g->v1;
+            q->col = col;
+        }
+        penX += g->advance*scale + spacing;
+    }
+}
+
+void TextBatchAddAt3D(TextBatch *b, const Frustum *f, Vector3 p, const char *text, int fontSize, Color col,
+                      int screenW, int screenH)
+{
+    Vector2 s = FrustumProject(f, p, screenW, screenH);
+    TextBatchAdd(b, text, (int)s.x + 6, (int)s.y - fontSize - 2, fontSize, col);
+}
+
+void TextBatchDraw(const TextBatch *b)
+{
+    for (int first = 0; first < b->count; first += TEXT_BATCH_CHUNK)
+    {
+        int last = first + TEXT_BATCH_CHUNK < b->count ? first + TEXT_BATCH_CHUNK : b->count;
+        rlCheckRenderBatchLimit(4*(last - first));
+        rlSetTexture(b->atlas.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (int i = first; i < last; ++i)
+        {
+            const TextQuad *q = &b->quads[i];
+            rlColor4ub(q->col.r, q->col.g, q->col.b, q->col.a);
+            // same winding as DrawTexturePro: top-left, bottom-left, bottom-right, top-right
+            rlTexCoord2f(q->u0, q->v0); rlVertex2f(q->x0, q->y0);
+            rlTexCoord2f(q->u0, q->v1); rlVertex2f(q->x0, q->y1);
+            rlTexCoord2f(q->u1, q->v1); rlVertex2f(q->x1, q->y1);
+            rlTexCoord2f(q->u1, q->v0); rlVertex2f(q->x1, q->y0);
+        }
+        rlEnd();
+        rlSetTexture(0);
+    }
+}
+
+/** Tamanho do trecho "%[flags][largura][.precisão]" guardado por conversão. */
+#define TEXT_SPEC_MAX 24
+
+/**
+ * @brief Lê uma conversão de @p p (logo após o '%').
+ * @param spec [out] "%" + flags, largura e precisão, sem modificador de tamanho nem conversão.
+ * @param conv [out] Caractere de conversão (0 se o formato acabou).
+ * @param prec [out] Precisão, ou -1 se ausente.
+ * @return Ponteiro após a conversão.
+ */
+static const char *ParseSpec(const char *p, char *spec, char *conv, int *prec)
+{
+    int n = 0;
+    spec[n++] = '%';
+    while (*p && strchr("-+ #0", *p)) { if (n < TEXT_SPEC_MAX - 6) spec[n++] = *p; ++p; }
+    while (*p >= '0' && *p <= '9') { if (n < TEXT_SPEC_MAX - 6) spec[n++] = *p; ++p; }
+    *prec = -1;
+    if (*p == '.')
+    {
+        *prec = 0;
+        if (n < TEXT_SPEC_MAX - 6) spec[n++] = '.';
+        ++p;
+        while (*p >= '0' && *p <= '9')
+        {
+            *prec = *prec*10 + (*p - '0');
+            if (n < TEXT_SPEC_MAX - 6) spec[n++] = *p;
+            ++p;
+        }
+    }
+    while (*p && strchr("hlLqjzt", *p)) ++p;
+    spec[n] = '\0';
+    *conv = *p;
+    return *p ? p + 1 : p;
+}
+
+static bool IsIntConv(char c) { return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X'; }
+
+/** Valor @p v arredondado, se finito e representável; senão false. */
+static bool RoundKey(double v, long long *key)
+{
+    if (!(fabs(v) < 9.0e18)) return false;
+    *key = llround(v);
+    return true;
+}
+
+/** Valor exibido de um argumento, na forma em que é comparado. */
+static long long ArgKey(char conv, double scale, const TextArg *a)
+{
+    long long key;
+    if (conv == 's') return (long long)(intptr_t)a->str;
+    if (conv == 'f' || conv == 'F') { if (RoundKey(a->num*scale, &key)) return key; }
+    else if (IsIntConv(conv)) { if (RoundKey(a->num, &key)) return key; }
+    memcpy(&key, &a->num, sizeof(key));
+    return key;
+}
+
+/** Gera l->text a partir do formato e das chaves (ou do valor exato, fora da faixa das chaves). */
+static void RenderLine(TextLine *l, const TextArg *args)
+{
+    char *out = l->text;
+    size_t cap = sizeof(l->text), n = 0;
+    int ia = 0;
+    for (const char *p = l->fmt; *p && n + 1 < cap; )
+    {
+        if (*p != '%') { out[n++] = *p++; continue; }
+        if (p[1] == '%') { out[n++] = '%'; p += 2; continue; }
+
+        char spec[TEXT_SPEC_MAX], conv;
+        int prec;
+        p = ParseSpec(p + 1, spec, &conv, &prec);
+        if (!conv || ia >= l->argc) { ++ia; continue; }
+        const TextArg *a = &args[ia];
+        size_t len = strlen(spec);
+        long long key;
+        int w = 0;
+        if (conv == 's')
+        {
+            spec[len] = 's'; spec[len + 1] = '\0';
+            w = snprintf(out + n, cap - n, spec, a->str ? a->str : "");
+        }
+        else if (IsIntConv(conv))
+        {
+            spec[len] = 'l'; spec[len + 1] = 'l'; spec[len + 2] = conv; spec[len + 3] = '\0';
+            if (!RoundKey(a->num, &key)) key = 0;
+            w = snprintf(out + n, cap - n, spec, key);
+        }
+        else if (strchr("fFeEgGaA", conv))
+        {
+            spec[len] = conv; spec[len + 1] = '\0';
+            double v = a->num;
+            // print the rounded key, so the text is exactly what was compared
+            if ((conv == 'f' || conv == 'F') && RoundKey(v*l->scale[ia], &key)) v = (double)key/l->scale[ia];
+            w = snprintf(out + n, cap - n, spec, v);
+        }
+        ++ia;
+        if (w > 0) n += (size_t)w < cap - n ? (size_t)w : cap - n - 1;
+    }
+    out[n] = '\0';
+}
+
+bool TextLineUpdate(TextLine *l, const char *fmt, int argc, const TextArg *args)
+{
+    if (argc > TEXT_LINE_ARGS) argc = TEXT_LINE_ARGS;
+    if (argc < 0) argc = 0;
+    bool stale = fmt != l->fmt || argc != l->argc;
+    if (stale)
+    {
+        // conversions are parsed once per format, not per call
+        int ia = 0;
+        for (const char *p = fmt; *p && ia < argc; )
+        {
+            if (*p != '%') { ++p; continue; }
+            if (p[1] == '%') { p += 2; continue; }
+            char spec[TEXT_SPEC_MAX], conv;
+            int prec;
+            p = ParseSpec(p + 1, spec, &conv, &prec);
+            if (!conv) break;
+            if (prec < 0) prec = 6;
+            if (prec > 9) prec = 9;
+            l->conv[ia] = conv;
+            l->scale[ia] = pow(10.0, prec);
+            ++ia;
+        }
+        for (; ia < argc; ++ia) { l->conv[ia] = 0; l->scale[ia] = 1.0; }
+        l->fmt = fmt;
+        l->argc = argc;
+    }
+
+    long long key[TEXT_LINE_ARGS];
+    for (int i = 0; i < argc; ++i)
+    {
+        key[i] = ArgKey(l->conv[i], l->scale[i], &args[i]);
+        if (key[i] != l->key[i]) stale = true;
+    }
+    if (!stale) return false;
+    memcpy(l->key, key, sizeof(long long)*(size_t)argc);
+    RenderLine(l, args);
+    l->formats++;
+    return true;
+}
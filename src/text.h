@@ -0,0 +1,141 @@
+/**
+ * @file text.h
+ * @brief Texto de HUD e rótulos com glifos pré-calculados, enviado em um único lote.
+ *
+ * TextBatch copia para uma tabela as métricas e coordenadas de textura de cada
+ * glifo do atlas da fonte (a fonte padrão da raylib já é um atlas único), então
+ * montar um texto é só consulta de tabela. Os quads de todos os textos do quadro
+ * são acumulados e TextBatchDraw envia tudo em um bloco RL_QUADS com uma única
+ * textura, ou seja, uma chamada de desenho, em vez de um DrawTexturePro por
+ * caractere.
+ *
+ * TextLine guarda o texto formatado de uma linha e os valores exibidos da última
+ * vez. TextLineUpdate só chama snprintf quando algum valor muda na precisão em
+ * que é mostrado.
+ */
+#ifndef WOE_TEXT_H
+#define WOE_TEXT_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "render.h"
+
+/** Primeiro código de caractere da tabela de glifos. */
+#define TEXT_GLYPH_FIRST 32
+/** Códigos na tabela: ASCII imprimível e Latin-1 (inclui o '°'), como a fonte padrão. */
+#define TEXT_GLYPH_COUNT 224
+
+/** Glifo pré-calculado, em pixels do tamanho base da fonte. */
+typedef struct TextGlyph {
+    float u0, v0, u1, v1;   /**< Retângulo no atlas (coordenadas de textura, com margem). */
+    float x, y, w, h;       /**< Deslocamento e tamanho do quad a partir da caneta. */
+    float advance;          /**< Avanço horizontal da caneta. */
+    bool blank;             /**< Sem quad (espaço). */
+} TextGlyph;
+
+/** Quad de um caractere na tela. */
+typedef struct TextQuad {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+    Color col;
+} TextQuad;
+
+/**
+ * @brief Atlas de glifos e quads do quadro.
+ *
+ * O buffer de quads persiste entre quadros e cresce por duplicação, ou sai da
+ * FrameArena do quadro com TextBatchBegin e é desenhado ao encher, como LineBatch.
+ */
+typedef struct TextBatch {
+    Texture2D atlas;        /**< Textura da fonte (não pertence ao lote). */
+    int baseSize;           /**< Tamanho base da fonte (px). */
+    TextGlyph glyphs[TEXT_GLYPH_COUNT];
+    TextQuad *quads;        /**< Quads do quadro atual. */
+    int count;              /**< Quads no quadro atual. */
+    int capacity;           /**< Quads alocados. */
+    FrameArena *arena;      /**< Arena que fornece os quads do quadro (NULL: buffer próprio). */
+    int flushes;            /**< Envios antecipados no quadro por falta de espaço (só com arena). */
+} TextBatch;
+
+/**
+ * @brief Pré-calcula a tabela de glifos de @p font e reserva @p capacity quads.
+ *
+ * Com @p capacity 0 o lote não reserva buffer próprio (para usar só TextBatchBegin).
+ * Use GetFontDefault() para o mesmo visual de DrawText. A fonte deve viver
+ * enquanto o lote for usado. Códigos ausentes da fonte viram '?'.
+ */
+bool TextBatchInit(TextBatch *b, Font font, int capacity);
+
+/** @brief Libera o buffer de quads (a fonte não é descarregada). */
+void TextBatchFree(TextBatch *b);
+
+/** @brief Esvazia o lote para um novo quadro, mantendo a memória. */
+void TextBatchClear(TextBatch *b);
+
+/**
+ * @brief Começa o quadro com @p capacity quads tirados de @p arena (ou o que couber).
+ *
+ * Mesmas regras de LineBatchBegin; ao encher, TextBatchDraw é chamada antes de continuar.
+ */
+void TextBatchBegin(TextBatch *b, FrameArena *arena, int capacity);
+
+/**
+ * @brief Acrescenta @p text (UTF-8) com o canto superior esquerdo em (@p x, @p y).
+ *
+ * Mesmo posicionamento e espaçamento de DrawText(text, x, y, fontSize, col).
+ */
+void TextBatchAdd(TextBatch *b, const char *text, int x, int y, int fontSize, Color col);
+
+/**
+ * @brief Acrescenta um rótulo junto ao ponto 3D @p p, no mesmo lugar de DrawTextAt3D.
+ *
+ * Projeta com a matriz de @p f; o ponto deve ter passado por CullLabel().
+ */
+void TextBatchAddAt3D(TextBatch *b, const Frustum *f, Vector3 p, const char *text, int fontSize, Color col,
+                      int screenW, int screenH);
+
+/** @brief Desenha todos os quads do lote; chamar em modo 2D (fora de BeginMode3D). */
+void TextBatchDraw(const TextBatch *b);
+
+/** Máximo de caracteres (com o terminador) de uma TextLine. */
+#define TEXT_LINE_MAX 192
+/** Máximo de argumentos de uma TextLine. */
+#define TEXT_LINE_ARGS 12
+
+/** Argumento de TextLineUpdate: número (conversões f, d, i, u, x) ou texto (s). */
+typedef struct TextArg {
+    double num;
+    const char *str;
+} TextArg;
+
+/** Argumento numérico de TextLineUpdate. */
+#define TEXT_NUM(v) ((TextArg){ (double)(v), NULL })
+/** Argumento de texto de TextLineUpdate; comparado por ponteiro, então use textos constantes. */
+#define TEXT_STR(s) ((TextArg){ 0.0, (s) })
+
+/** Linha formatada em cache e os valores exibidos que a geraram; comece com ela zerada. */
+typedef struct TextLine {
+    const char *fmt;                    /**< Formato da última chamada (comparado por ponteiro). */
+    int argc;                           /**< Argumentos do formato. */
+    char conv[TEXT_LINE_ARGS];          /**< Conversão de cada argumento ('f', 'd', 's', ...). */
+    double scale[TEXT_LINE_ARGS];       /**< 10^precisão das conversões 'f'. */
+    long long key[TEXT_LINE_ARGS];      /**< Valores exibidos da última formatação. */
+    long formats;                       /**< Vezes que o texto foi refeito. */
+    char text[TEXT_LINE_MAX];           /**< Texto atual. */
+} TextLine;
+
+/**
+ * @brief Atualiza @p l->text com @p fmt e @p args só se algum valor exibido mudou.
+ *
+ * @p fmt segue printf, com estas restrições: cada conversão consome um
+ * TextArg; 'f' (com precisão até 9) é comparada depois de arredondada para a
+ * precisão exibida, e o texto é gerado a partir desse valor arredondado, de
+ * modo que texto e comparação nunca discordam; d, i, u, x, X comparam o valor
+ * inteiro (modificadores de tamanho são ignorados); s compara o ponteiro; e,
+ * g e afins comparam o valor exato. Trocar o ponteiro @p fmt força a
+ * reformatação.
+ * @return true se o texto foi refeito.
+ */
+bool TextLineUpdate(TextLine *l, const char *fmt, int argc, const TextArg *args);
+
+#endif /* WOE_TEXT_H */
@@ -0,0 +1,198 @@
+/**
+ * @file threads.c
+ * @brief Implementação POSIX/Win32 de threads.h.
+ */
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "threads.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+
+typedef struct ThreadStart { WoeThreadFn fn; void *arg; } ThreadStart;
+
+static unsigned __stdcall ThreadTrampoline(void *p)
+{
+    ThreadStart st = *(ThreadStart *)p;
+    free(p);
+    return (unsigned)st.fn(st.arg);
+}
+
+bool WoeThreadCreate(WoeThread *t, WoeThreadFn fn, void *arg)
+{
+    ThreadStart *st = (ThreadStart *)malloc(sizeof(ThreadStart));
+    if (!st) return false;
+    st->fn = fn; st->arg = arg;
+    uintptr_t h = _beginthreadex(NULL, 0, ThreadTrampoline, st, 0, NULL);
+    if (h == 0) { free(st); return false; }
+    t->handle = (void *)h;
+    return true;
+}
+
+void WoeThreadJoin(WoeThread *t)
+{
+    if (!t->handle) return;
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+    t->handle = NULL;
+}
+
+bool WoeSemaphoreInit(WoeSemaphore *s, int initial)
+{
+    s->handle = (void *)CreateSemaphoreA(NULL, initial, 0x7fffffff, NULL);
+    return s->handle != NULL;
+}
+
+void WoeSemaphoreFree(WoeSemaphore *s)
+{
+    if (!s->handle) return;
+    CloseHandle((HANDLE)s->handle);
+    s->handle = NULL;
+}
+
+void WoeSemaphorePost(WoeSemaphore *s)
+{
+    ReleaseSemaphore((HANDLE)s->handle, 1, NULL);
+}
+
+void WoeSemaphoreWait(WoeSemaphore *s)
+{
+    WaitForSingleObject((HANDLE)s->handle, INFINITE);
+}
+
+double WoeNow(void)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER c;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart/(double)freq.QuadPart;
+}
+
+void WoeSleep(double seconds)
+{
+    if (seconds > 0.0) Sleep((DWORD)(seconds*1000.0));
+}
+
+int WoeCpuCount(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+}
+
+#else
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct ThreadStart { WoeThreadFn fn; void *arg; pthread_t id; } ThreadStart;
+
+static void *ThreadTrampoline(void *p)
+{
+    ThreadStart *st = (ThreadStart *)p;
+    st->fn(st->arg);
+    return NULL;
+}
+
+bool WoeThreadCreate(WoeThread *t, WoeThreadFn fn, void *arg)
+{
+    // the block holds pthread_t too and lives until join
+    ThreadStart *st = (ThreadStart *)malloc(sizeof(ThreadStart));
+    if (!st) return false;
+    st->fn = fn; st->arg = arg;
+    if (pthread_create(&st->id, NULL, ThreadTrampoline, st) != 0) { free(st); return false; }
+    t->handle = st;
+    return true;
+}
+
+void WoeThreadJoin(WoeThread *t)
+{
+    if (!t->handle) return;
+    ThreadStart *st = (ThreadStart *)t->handle;
+    pthread_join(st->id, NULL);
+    free(st);
+    t->handle = NULL;
+}
+
+// POSIX unnamed semaphores are not available on macOS; use mutex + condvar
+typedef struct Semaphore { pthread_mutex_t mutex; pthread_cond_t cond; int count; } Semaphore;
+
+bool WoeSemaphoreInit(WoeSemaphore *s, int initial)
+{
+    Semaphore *sem = (Semaphore *)malloc(sizeof(Semaphore));
+    s->handle = NULL;
+    if (!sem) return false;
+    if (pthread_mutex_init(&sem->mutex, NULL) != 0) { free(sem); return false; }
+    if (pthread_cond_init(&sem->cond, NULL) != 0)
+    {
+        pthread_mutex_destroy(&sem->mutex);
+        free(sem);
+        return false;
+    }
+    sem->count = initial;
+    s->handle = sem;
+    return true;
+}
+
+void WoeSemaphoreFree(WoeSemaphore *s)
+{
+    Semaphore *sem = (Semaphore *)s->handle;
+    if (!sem) return;
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    free(sem);
+    s->handle = NULL;
+}
+
+void WoeSemaphorePost(WoeSemaphore *s)
+{
+    Semaphore *sem = (Semaphore *)s->handle;
+    pthread_mutex_lock(&sem->mutex);
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+void WoeSemaphoreWait(WoeSemaphore *s)
+{
+    Semaphore *sem = (Semaphore *)s->handle;
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count <= 0) pthread_cond_wait(&sem->cond, &sem->mutex);
+    sem->count--;
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+double WoeNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+void WoeSleep(double seconds)
+{
+    if (seconds <= 0.0) return;
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec)*1e9);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+}
+
+int WoeCpuCount(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+#endif
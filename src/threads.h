@@ -0,0 +1,90 @@
+/**
+ * @file threads.h
+ * @brief Threads, relógio monotônico e operações atômicas portáveis (POSIX/Win32).
+ *
+ * Camada mínima para o núcleo não depender de C11 <threads.h>/<stdatomic.h>:
+ * threads via pthreads ou Win32 e atômicos via builtins do GCC/Clang ou
+ * intrínsecos Interlocked do MSVC. Todas as operações atômicas têm semântica
+ * acquire/release (exchange e CAS são acq_rel).
+ */
+#ifndef WOE_THREADS_H
+#define WOE_THREADS_H
+
+#include <stdbool.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/** Função de entrada de uma thread. */
+typedef int (*WoeThreadFn)(void *arg);
+
+/** Identificador opaco de thread. */
+typedef struct WoeThread {
+    void *handle;   /**< pthread_t (em bloco alocado) ou HANDLE do Win32. */
+} WoeThread;
+
+/**
+ * @brief Cria uma thread que executa fn(arg).
+ * @return false se o sistema não criou a thread.
+ */
+bool WoeThreadCreate(WoeThread *t, WoeThreadFn fn, void *arg);
+
+/** @brief Espera a thread terminar e libera seus recursos. */
+void WoeThreadJoin(WoeThread *t);
+
+/** Semáforo contador. */
+typedef struct WoeSemaphore {
+    void *handle;   /**< Mutex + variável de condição (POSIX) ou HANDLE do Win32. */
+} WoeSemaphore;
+
+/** @brief Cria um semáforo com contagem inicial @p initial. */
+bool WoeSemaphoreInit(WoeSemaphore *s, int initial);
+
+/** @brief Destrói o semáforo (nenhuma thread pode estar esperando). */
+void WoeSemaphoreFree(WoeSemaphore *s);
+
+/** @brief Incrementa a contagem, acordando uma thread em espera. */
+void WoeSemaphorePost(WoeSemaphore *s);
+
+/** @brief Espera a contagem ficar positiva e a decrementa. */
+void WoeSemaphoreWait(WoeSemaphore *s);
+
+/** @brief Relógio monotônico em segundos (origem arbitrária). */
+double WoeNow(void);
+
+/** @brief Dorme por @p seconds segundos (granularidade do sistema). */
+void WoeSleep(double seconds);
+
+/** @brief Número de CPUs lógicas disponíveis (>= 1). */
+int WoeCpuCount(void);
+
+#if defined(_MSC_VER)
+static inline int WoeAtomicLoad(volatile int *p) { return (int)_InterlockedOr((volatile long *)p, 0); }
+static inline void WoeAtomicStore(volatile int *p, int v) { _InterlockedExchange((volatile long *)p, (long)v); }
+static inline int WoeAtomicExchange(volatile int *p, int v) { return (int)_InterlockedExchange((volatile long *)p, (long)v); }
+static inline int WoeAtomicAdd(volatile int *p, int v) { return (int)_InterlockedExchangeAdd((volatile long *)p, (long)v); }
+static inline bool WoeAtomicCas(volatile int *p, int *expected, int desired)
+{
+    long old = _InterlockedCompareExchange((volatile long *)p, (long)desired, (long)*expected);
+    if (old == (long)*expected) return true;
+    *expected = (int)old;
+    return false;
+}
+#else
+/** @brief Leitura atômica (acquire). */
+static inline int WoeAtomicLoad(volatile int *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+/** @brief Escrita atômica (release). */
+static inline void WoeAtomicStore(volatile int *p, int v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+/** @brief Troca atômica; devolve o valor anterior. */
+static inline int WoeAtomicExchange(volatile int *p, int v) { return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL); }
+/** @brief Soma atômica; devolve o valor anterior. */
+static inline int WoeAtomicAdd(volatile int *p, int v) { return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL); }
+/** @brief Compare-and-swap; em falha grava o valor atual em @p expected. */
+static inline bool WoeAtomicCas(volatile int *p, int *expected, int desired)
+{
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+#endif /* WOE_THREADS_H */
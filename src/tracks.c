@@ -0,0 +1,272 @@
+/**
+ * @file tracks.c
+ * @brief Leitura por mapeamento em memória e gravação de arquivos de trilhas (veja tracks.h).
+ */
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "tracks.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(M_PI)
+#define M_PI 3.14159265358979323846
+#endif
+
+// the on-disk layout is the in-memory layout of these structs
+typedef char TrackHeaderSizeCheck[sizeof(TrackFileHeader) == 64 ? 1 : -1];
+typedef char TrackEntitySizeCheck[sizeof(TrackFileEntity) == 24 ? 1 : -1];
+typedef char TrackSampleSizeCheck[sizeof(TrackSample) == 32 ? 1 : -1];
+
+/** Mapeia o arquivo inteiro só para leitura; preenche base/size/file/mapping. */
+static bool MapFile(TrackFile *f, const char *path, const char **error)
+{
+#if defined(_WIN32)
+    HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) { *error = "nao foi possivel abrir o arquivo"; return false; }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(h, &sz) || sz.QuadPart <= 0 || (unsigned long long)sz.QuadPart > (size_t)-1)
+    {
+        CloseHandle(h);
+        *error = "arquivo vazio ou grande demais para mapear";
+        return false;
+    }
+    HANDLE m = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *p = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!p)
+    {
+        if (m) CloseHandle(m);
+        CloseHandle(h);
+        *error = "nao foi possivel mapear o arquivo";
+        return false;
+    }
+    f->file = (void *)h;
+    f->mapping = (void *)m;
+    f->base = (const unsigned char *)p;
+    f->size = (uint64_t)sz.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { *error = "nao foi possivel abrir o arquivo"; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (unsigned long long)st.st_size > (size_t)-1)
+    {
+        close(fd);
+        *error = "arquivo vazio ou grande demais para mapear";
+        return false;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        close(fd);
+        *error = "nao foi possivel mapear o arquivo";
+        return false;
+    }
+    f->file = (void *)(intptr_t)(fd + 1); // +1 so that a zeroed TrackFile holds no descriptor
+    f->base = (const unsigned char *)p;
+    f->size = (uint64_t)st.st_size;
+#endif
+    return true;
+}
+
+static void UnmapFile(TrackFile *f)
+{
+#if defined(_WIN32)
+    if (f->base) UnmapViewOfFile((void *)f->base);
+    if (f->mapping) CloseHandle((HANDLE)f->mapping);
+    if (f->file) CloseHandle((HANDLE)f->file);
+#else
+    if (f->base) munmap((void *)f->base, (size_t)f->size);
+    if (f->file) close((int)(intptr_t)f->file - 1);
+#endif
+}
+
+bool TrackFileOpen(TrackFile *f, const char *path, const char **error)
+{
+    const char *dummy;
+    if (!error) error = &dummy;
+    memset(f, 0, sizeof(*f));
+    if (!MapFile(f, path, error)) return false;
+
+    const TrackFileHeader *h = (const TrackFileHeader *)f->base;
+    *error = NULL;
+    if (f->size < sizeof(TrackFileHeader) || memcmp(h->magic, TRACK_FILE_MAGIC, 8) != 0)
+        *error = "nao e um arquivo de trilhas";
+    else if (h->byteOrder != TRACK_FILE_BYTE_ORDER)
+        *error = "ordem de bytes diferente da desta maquina";
+    else if (h->version != TRACK_FILE_VERSION || h->sampleSize != sizeof(TrackSample))
+        *error = "versao do formato nao suportada";
+    else if (h->entities > (uint32_t)0x7fffffff ||
+             (f->size - sizeof(TrackFileHeader))/sizeof(TrackFileEntity) < h->entities)
+        *error = "tabela de entidades truncada";
+
+    const TrackFileEntity *ent = (const TrackFileEntity *)(f->base + sizeof(TrackFileHeader));
+    for (uint32_t e = 0; !*error && e < h->entities; ++e)
+    {
+        // bounds from the table only: the samples themselves are never touched here
+        uint64_t off = ent[e].offset;
+        if (off % 8 != 0 || off > f->size || (f->size - off)/sizeof(TrackSample) < ent[e].count)
+            *error = "amostras fora do arquivo";
+        else if (ent[e].kind != TRACK_KIND_AIRCRAFT && ent[e].kind != TRACK_KIND_TARGET)
+            *error = "tipo de entidade desconhecido";
+    }
+    if (!*error)
+    {
+        f->cursor = (int64_t *)calloc(h->entities ? h->entities : 1, sizeof(int64_t));
+        if (!f->cursor) *error = "memoria insuficiente";
+    }
+    if (*error)
+    {
+        UnmapFile(f);
+        memset(f, 0, sizeof(*f));
+        return false;
+    }
+
+    f->header = h;
+    f->entities = ent;
+    f->count = (int)h->entities;
+    f->start = h->start;
+    f->end = h->end;
+    return true;
+}
+
+void TrackFileClose(TrackFile *f)
+{
+    UnmapFile(f);
+    free(f->cursor);
+    memset(f, 0, sizeof(*f));
+}
+
+const TrackSample *TrackSamples(const TrackFile *f, int e, int64_t *count)
+{
+    *count = (int64_t)f->entities[e].count;
+    return (const TrackSample *)(f->base + f->entities[e].offset);
+}
+
+int64_t TrackSeek(const TrackFile *f, int e, double t)
+{
+    int64_t n;
+    const TrackSample *s = TrackSamples(f, e, &n);
+    if (n <= 0) return -1;
+    // last index with s[i].t <= t; lo stays valid, hi is always past it
+    int64_t lo = 0, hi = n;
+    while (hi - lo > 1)
+    {
+        int64_t mid = lo + (hi - lo)/2;
+        if (s[mid].t <= t) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/** Interpolação do ângulo pelo menor arco. */
+static float LerpAngle(float a, float b, float u)
+{
+    float d = b - a;
+    d -= (float)(2.0*M_PI)*floorf(d/(float)(2.0*M_PI) + 0.5f);
+    return a + d*u;
+}
+
+bool TrackSampleAt(TrackFile *f, int e, double t, TrackSample *out)
+{
+    int64_t n;
+    const TrackSample *s = TrackSamples(f, e, &n);
+    if (n <= 0) return false;
+
+    // playback mostly stays in, or just past, the previous interval
+    int64_t i = f->cursor[e];
+    if (i < 0 || i >= n || s[i].t > t) i = TrackSeek(f, e, t);
+    else if (i + 1 < n && s[i + 1].t <= t)
+    {
+        if (i + 2 >= n || s[i + 2].t > t) ++i;
+        else i = TrackSeek(f, e, t);
+    }
+    f->cursor[e] = i;
+
+    const TrackSample *a = &s[i];
+    if (i + 1 >= n || t <= a->t) { *out = *a; out->t = t; return true; }
+    const TrackSample *b = &s[i + 1];
+    double span = b->t - a->t;
+    float u = span > 0.0 ? (float)((t - a->t)/span) : 1.0f;
+    out->t = t;
+    out->x = a->x + (b->x - a->x)*u;
+    out->y = a->y + (b->y - a->y)*u;
+    out->z = a->z + (b->z - a->z)*u;
+    out->yaw = LerpAngle(a->yaw, b->yaw, u);
+    out->pitch = a->pitch + (b->pitch - a->pitch)*u;
+    out->roll = LerpAngle(a->roll, b->roll, u);
+    return true;
+}
+
+int TrackFileApply(TrackFile *f, double t, EntityStore *air, EntityStore *tgt)
+{
+    int slot[2] = { 0, 0 }, written = 0;
+    for (int e = 0; e < f->count; ++e)
+    {
+        int kind = f->entities[e].kind == TRACK_KIND_TARGET ? 1 : 0;
+        EntityStore *st = kind ? tgt : air;
+        int k = slot[kind]++;
+        TrackSample s;
+        if (k >= st->capacity || !TrackSampleAt(f, e, t, &s)) continue;
+        st->x[k] = s.x; st->y[k] = s.y; st->z[k] = s.z;
+        st->yaw[k] = s.yaw; st->pitch[k] = s.pitch; st->roll[k] = s.roll;
+        if (k >= st->count) st->count = k + 1;
+        ++written;
+    }
+    return written;
+}
+
+bool TrackFileWrite(const char *path, int entities, const TrackKind *kinds,
+                    const TrackSample *const *samples, const int64_t *counts)
+{
+    if (entities < 0) return false;
+    FILE *out = fopen(path, "wb");
+    if (!out) return false;
+
+    TrackFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TRACK_FILE_MAGIC, 8);
+    h.version = TRACK_FILE_VERSION;
+    h.byteOrder = TRACK_FILE_BYTE_ORDER;
+    h.entities = (uint32_t)entities;
+    h.sampleSize = sizeof(TrackSample);
+    h.start = HUGE_VAL;
+    h.end = -HUGE_VAL;
+    for (int e = 0; e < entities; ++e)
+    {
+        if (counts[e] <= 0) continue;
+        if (samples[e][0].t < h.start) h.start = samples[e][0].t;
+        if (samples[e][counts[e] - 1].t > h.end) h.end = samples[e][counts[e] - 1].t;
+    }
+    if (h.start > h.end) h.start = h.end = 0.0;
+
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+    // table entries; header and entries are multiples of 8, so every sample block is 8-aligned
+    uint64_t off = sizeof(TrackFileHeader) + (uint64_t)entities*sizeof(TrackFileEntity);
+    for (int e = 0; e < entities && ok; ++e)
+    {
+        TrackFileEntity te = { (uint32_t)kinds[e], 0u, off, counts[e] > 0 ? (uint64_t)counts[e] : 0u };
+        ok = fwrite(&te, sizeof(te), 1, out) == 1;
+        off += te.count*sizeof(TrackSample);
+    }
+    for (int e = 0; e < entities && ok; ++e)
+    {
+        if (counts[e] > 0) ok = fwrite(samples[e], sizeof(TrackSample), (size_t)counts[e], out) == (size_t)counts[e];
+    }
+    if (fclose(out) != 0) ok = false;
+    return ok;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file tracks.h
+ * @brief Arquivos binários de trajetórias gravadas, lidos por mapeamento em memória.
+ *
+ * Formato (little-endian, versão 1):
+ * @code
+ * TrackFileHeader                      64 bytes
+ * TrackFileEntity[entities]            24 bytes cada
+ * TrackSample[count] por entidade      32 bytes cada, em offset múltiplo de 8
+ * @endcode
+ * As amostras de cada entidade são contíguas e ordenadas por @c t (não
+ * decrescente). O arquivo inteiro é mapeado somente leitura e as amostras são
+ * lidas direto do mapeamento, sem cópia nem leitura antecipada, de modo que
+ * gravações de vários GB abrem instantaneamente e só as páginas tocadas vão
+ * para a memória. TrackSampleAt() localiza o intervalo por busca binária
+ * (O(log n)), com um cursor por entidade que torna a reprodução sequencial O(1).
+ */
+#ifndef WOE_TRACKS_H
+#define WOE_TRACKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entities.h"
+
+/** Assinatura no início do arquivo. */
+#define TRACK_FILE_MAGIC "WOETRK\0\0"
+/** Versão do formato gravada por TrackFileWrite. */
+#define TRACK_FILE_VERSION 1u
+/** Valor de byteOrder num arquivo gravado em little-endian. */
+#define TRACK_FILE_BYTE_ORDER 0x01020304u
+
+/** Tipo de entidade de uma trilha: em qual EntityStore ela é reproduzida. */
+typedef enum TrackKind {
+    TRACK_KIND_AIRCRAFT = 0,
+    TRACK_KIND_TARGET = 1
+} TrackKind;
+
+/** Cabeçalho do arquivo. */
+typedef struct TrackFileHeader {
+    char magic[8];          /**< TRACK_FILE_MAGIC. */
+    uint32_t version;       /**< TRACK_FILE_VERSION. */
+    uint32_t byteOrder;     /**< TRACK_FILE_BYTE_ORDER como gravado. */
+    uint32_t entities;      /**< Entradas na tabela de entidades. */
+    uint32_t sampleSize;    /**< sizeof(TrackSample). */
+    double start;           /**< Menor t do arquivo (s). */
+    double end;             /**< Maior t do arquivo (s). */
+    uint64_t reserved[3];
+} TrackFileHeader;
+
+/** Entrada da tabela de entidades. */
+typedef struct TrackFileEntity {
+    uint32_t kind;          /**< TrackKind. */
+    uint32_t flags;         /**< Reservado (0). */
+    uint64_t offset;        /**< Offset (bytes, desde o início do arquivo) da primeira amostra. */
+    uint64_t count;         /**< Número de amostras. */
+} TrackFileEntity;
+
+/** Amostra de uma entidade: instante, posição e orientação. */
+typedef struct TrackSample {
+    double t;               /**< Instante (s). */
+    float x, y, z;          /**< Posição (unid). */
+    float yaw, pitch, roll; /**< Orientação (rad). */
+} TrackSample;
+
+/** Arquivo de trilhas aberto. Os ponteiros apontam para dentro do mapeamento. */
+typedef struct TrackFile {
+    const unsigned char *base;          /**< Início do mapeamento. */
+    uint64_t size;                      /**< Tamanho do arquivo (bytes). */
+    const TrackFileHeader *header;
+    const TrackFileEntity *entities;    /**< [count] tabela de entidades. */
+    int count;                          /**< Entidades. */
+    double start, end;                  /**< Intervalo de tempo do arquivo (s). */
+    int64_t *cursor;                    /**< [count] último intervalo usado por entidade. */
+    void *file;                         /**< Descritor/handle do arquivo (interno). */
+    void *mapping;                      /**< Handle do mapeamento (interno, Win32). */
+} TrackFile;
+
+/**
+ * @brief Mapeia @p path e valida cabeçalho e tabela de entidades.
+ *
+ * Não lê as amostras: a verificação de limites usa só a tabela, e a ordem
+ * por @c t é responsabilidade de quem grava.
+ * @param error [out] Em falha, motivo em texto fixo (pode ser NULL).
+ * @return false em falha, com @p f zerado.
+ */
+bool TrackFileOpen(TrackFile *f, const char *path, const char **error);
+
+/** @brief Desfaz o mapeamento e fecha o arquivo. */
+void TrackFileClose(TrackFile *f);
+
+/** @brief Amostras da entidade @p e (direto do mapeamento); @p count recebe o total. */
+const TrackSample *TrackSamples(const TrackFile *f, int e, int64_t *count);
+
+/**
+ * @brief Índice da última amostra de @p e com t <= @p t, por busca binária.
+ * @return 0 se @p t for anterior à primeira amostra; -1 se a entidade não tiver amostras.
+ */
+int64_t TrackSeek(const TrackFile *f, int e, double t);
+
+/**
+ * @brief Estado interpolado da entidade @p e no instante @p t.
+ *
+ * Posição e pitch são interpolados linearmente; yaw e roll pelo menor arco.
+ * Antes do início ou depois do fim vale a primeira/última amostra. Usa e
+ * atualiza o cursor da entidade: quando @p t avança pouco desde a última
+ * chamada, não há busca.
+ * @return false se a entidade não tiver amostras.
+ */
+bool TrackSampleAt(TrackFile *f, int e, double t, TrackSample *out);
+
+/**
+ * @brief Escreve o estado de todas as entidades no instante @p t em @p air e @p tgt.
+ *
+ * A k-ésima trilha de aeronave vai para air[k] e a k-ésima de alvo para tgt[k];
+ * @c count cresce se preciso e trilhas além da capacidade são ignoradas.
+ * @return Número de entidades escritas.
+ */
+int TrackFileApply(TrackFile *f, double t, EntityStore *air, EntityStore *tgt);
+
+/**
+ * @brief Grava um arquivo de trilhas com @p entities entidades.
+ * @param kinds [entities] TrackKind de cada entidade.
+ * @param samples [entities] amostras de cada entidade, ordenadas por t.
+ * @param counts [entities] número de amostras de cada entidade.
+ * @return false em erro de E/S.
+ */
+bool TrackFileWrite(const char *path, int entities, const TrackKind *kinds,
+                    const TrackSample *const *samples, const int64_t *counts);
+
+#endif /* WOE_TRACKS_H */
@@ -0,0 +1,93 @@
+/**
+ * @file views.c
+ * @brief Grade de vistas com render textures (veja views.h).
+ */
+#include "views.h"
+#include "raymath.h"
+
+#include <math.h>
+#include <string.h>
+
+/** Posição inicial da câmera de cada vista em relação à aeronave. */
+static const Vector3 VIEW_CAMERA_OFFSET = { 8.0f, -10.0f, 6.0f };
+
+bool ViewGridInit(ViewGrid *g, int count, int screenW, int screenH)
+{
+    memset(g, 0, sizeof(*g));
+    if (count < 1) count = 1;
+    if (count > VIEW_MAX) count = VIEW_MAX;
+    // nearly square: 2 -> 2x1, 4 -> 2x2, 5..6 -> 3x2, 7..9 -> 3x3
+    int cols = (int)ceilf(sqrtf((float)count));
+    int rows = (count + cols - 1)/cols;
+    g->count = count;
+    g->cols = cols;
+    g->rows = rows;
+    g->cellW = screenW/cols;
+    g->cellH = screenH/rows;
+    for (int v = 0; v < count; ++v)
+    {
+        g->target[v] = LoadRenderTexture(g->cellW, g->cellH);
+        if (g->target[v].id == 0)
+        {
+            ViewGridFree(g);
+            return false;
+        }
+        Camera3D *c = &g->cam[v];
+        c->target = (Vector3){ 0.0f, 0.0f, 0.0f };
+        c->position = VIEW_CAMERA_OFFSET;
+        c->up = (Vector3){ 0.0f, 0.0f, 1.0f };
+        c->fovy = 60.0f;
+        c->projection = CAMERA_PERSPECTIVE;
+    }
+    g->ready = true;
+    return true;
+}
+
+void ViewGridFree(ViewGrid *g)
+{
+    for (int v = 0; v < VIEW_MAX; ++v)
+        if (g->target[v].id != 0) UnloadRenderTexture(g->target[v]);
+    memset(g, 0, sizeof(*g));
+}
+
+Rectangle ViewGridCell(const ViewGrid *g, int v)
+{
+    return (Rectangle){ (float)(v % g->cols*g->cellW), (float)(v/g->cols*g->cellH), (float)g->cellW, (float)g->cellH };
+}
+
+int ViewGridAt(const ViewGrid *g, Vector2 p)
+{
+    for (int v = 0; v < g->count; ++v)
+        if (CheckCollisionPointRec(p, ViewGridCell(g, v))) return v;
+    return -1;
+}
+
+void ViewGridFollow(ViewGrid *g, int v, Vector3 target)
+{
+    Camera3D *c = &g->cam[v];
+    c->position = Vector3Add(target, Vector3Subtract(c->position, c->target));
+    c->target = target;
+}
+
+void CameraOrbit(Camera3D *cam, Vector2 delta)
+{
+    Matrix rotZ = MatrixRotate((Vector3){0,0,1}, -delta.x*0.003f);
+    Vector3 off = Vector3Subtract(cam->position, cam->target);
+    off = Vector3Transform(off, rotZ);
+    // elevate
+    Matrix rotX = MatrixRotate((Vector3){1,0,0}, delta.y*0.003f);
+    off = Vector3Transform(off, rotX);
+    cam->position = Vector3Add(cam->target, off);
+}
+
+void ViewGridComposite(const ViewGrid *g, Color border)
+{
+    for (int v = 0; v < g->count; ++v)
+    {
+        Rectangle cell = ViewGridCell(g, v);
+        // render textures are stored bottom-up: a negative source height flips them
+        DrawTextureRec(g->target[v].texture, (Rectangle){ 0.0f, 0.0f, cell.width, -cell.height },
+                       (Vector2){ cell.x, cell.y }, WHITE);
+        DrawRectangleLines((int)cell.x, (int)cell.y, (int)cell.width, (int)cell.height, border);
+    }
+}
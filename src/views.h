@@ -0,0 +1,64 @@
+/**
+ * @file views.h
+ * @brief Grade de vistas: uma render texture, uma câmera e um HUD por aeronave observada.
+ *
+ * No modo de várias vistas (--views=N, tecla N) a tela é dividida em uma
+ * grade de colunas x linhas quase quadrada; a vista v acompanha a aeronave v
+ * com sua própria câmera orbital e é desenhada na sua render texture, que
+ * ViewGridComposite cola na célula correspondente. As matrizes de modelo das
+ * entidades são calculadas uma vez por quadro (InstancedRendererShare) e cada
+ * vista só refaz o culling, o nível de detalhe e o lote de linhas da sua
+ * câmera.
+ */
+#ifndef WOE_VIEWS_H
+#define WOE_VIEWS_H
+
+#include "raylib.h"
+
+/** Vistas no máximo (grade 3x3). */
+#define VIEW_MAX 9
+/** Vistas da tecla N quando --views não foi dado. */
+#define VIEW_DEFAULT_COUNT 4
+
+/** Vistas, suas render textures e câmeras; usado só pela thread do contexto GL. */
+typedef struct ViewGrid {
+    int count;              /**< Vistas em uso (1 a VIEW_MAX). */
+    int cols, rows;         /**< Leiaute da grade. */
+    int cellW, cellH;       /**< Tamanho de cada célula e da sua render texture (px). */
+    RenderTexture2D target[VIEW_MAX]; /**< Onde cada vista é desenhada. */
+    Camera3D cam[VIEW_MAX]; /**< Câmera de cada vista; o alvo segue a aeronave. */
+    bool ready;             /**< Falso se alguma render texture não pôde ser criada. */
+} ViewGrid;
+
+/**
+ * @brief Cria @p count vistas em grade sobre uma tela de @p screenW x @p screenH.
+ *
+ * Requer a janela aberta. Em falha devolve false e @p g fica zerado.
+ */
+bool ViewGridInit(ViewGrid *g, int count, int screenW, int screenH);
+
+/** @brief Libera as render textures. */
+void ViewGridFree(ViewGrid *g);
+
+/** @brief Retângulo da vista @p v na tela. */
+Rectangle ViewGridCell(const ViewGrid *g, int v);
+
+/** @brief Vista sob o ponto @p p da tela, ou -1. */
+int ViewGridAt(const ViewGrid *g, Vector2 p);
+
+/**
+ * @brief Leva a câmera da vista @p v até @p target, mantendo a distância e a direção de observação.
+ */
+void ViewGridFollow(ViewGrid *g, int v, Vector3 target);
+
+/**
+ * @brief Gira @p cam em torno do seu alvo pelo arraste @p delta do mouse (px).
+ *
+ * A mesma órbita da câmera única: horizontal em torno de Z, vertical em torno de X.
+ */
+void CameraOrbit(Camera3D *cam, Vector2 delta);
+
+/** @brief Desenha as render textures nas células, com borda @p border; chamar entre BeginDrawing/EndDrawing. */
+void ViewGridComposite(const ViewGrid *g, Color border);
+
+#endif /* WOE_VIEWS_H */
@@ -0,0 +1,30 @@
+/**
+ * @file woe_core.h
+ * @brief Cabeçalho público da biblioteca woe_core.
+ *
+ * Reúne o armazenamento SoA de entidades, a trigonometria por níveis, os
+ * kernels em lote (SIMD) e a geometria de engajamento. Não depende da raylib:
+ * ferramentas de linha de comando, benchmarks e o visualizador usam o mesmo
+ * núcleo.
+ */
+#ifndef WOE_CORE_H
+#define WOE_CORE_H
+
+#include "arena.h"
+#include "entities.h"
+#include "fastmath.h"
+#include "geometry.h"
+#include "simd/angles_simd.h"
+#include "threads.h"
+#include "tracks.h"
+#include "jobs.h"
+#include "spatial.h"
+#include "incremental.h"
+#include "predict.h"
+#include "profile.h"
+#include "recorder.h"
+#include "ingest.h"
+#include "scenario.h"
+#include "sim.h"
+
+#endif /* WOE_CORE_H */